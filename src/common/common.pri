@@ -0,0 +1,8 @@
+# sync.profile installs these with the private headers of QtContacts and QtOrganizer,
+# whose own private headers include them
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    $$PWD/qpimdetailfieldmap_p.h \
+    $$PWD/qpimdetailpool_p.h \
+    $$PWD/qpimmanageruriregistry_p.h
@@ -0,0 +1,159 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtPIM module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPIMDETAILFIELDMAP_P_H
+#define QPIMDETAILFIELDMAP_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qmap.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * A field-to-value map for detail values, stored as an array of (field, value) pairs sorted by
+ * field.  Details only have a handful of fields, so a binary search of one array beats walking a
+ * QMap, and the fields need one allocation (or none, with an inline Container) rather than one per
+ * field.  Container must be an array of QPair<int, QVariant>, such as QList or QVarLengthArray.
+ * It is shared by the contacts and organizer detail privates; each library instantiates its own.
+ */
+template <typename Container>
+class QPimDetailFieldMap
+{
+public:
+    typedef QPair<int, QVariant> Field;
+
+    bool isEmpty() const { return m_fields.isEmpty(); }
+    int size() const { return m_fields.size(); }
+    int keyAt(int i) const { return m_fields.at(i).first; }
+    const QVariant& valueAt(int i) const { return m_fields.at(i).second; }
+
+    bool contains(int field) const { return indexOf(field) >= 0; }
+
+    // Returns the value of the field, or null if it isn't set
+    const QVariant* find(int field) const
+    {
+        const int i = indexOf(field);
+        return i >= 0 ? &m_fields.at(i).second : 0;
+    }
+
+    QVariant value(int field) const
+    {
+        const QVariant* found = find(field);
+        return found ? *found : QVariant();
+    }
+
+    void insert(int field, const QVariant& value)
+    {
+        const int i = lowerBound(field);
+        if (i < m_fields.size() && m_fields.at(i).first == field)
+            m_fields[i].second = value;
+        else
+            m_fields.insert(i, Field(field, value));
+    }
+
+    bool remove(int field)
+    {
+        const int i = indexOf(field);
+        if (i < 0)
+            return false;
+        m_fields.remove(i);
+        return true;
+    }
+
+    void clear() { m_fields.clear(); }
+
+    QMap<int, QVariant> toMap() const
+    {
+        QMap<int, QVariant> map;
+        for (int i = 0; i < m_fields.size(); i++)
+            map.insert(m_fields.at(i).first, m_fields.at(i).second);
+        return map;
+    }
+
+    bool operator==(const QPimDetailFieldMap& other) const
+    {
+        if (m_fields.size() != other.m_fields.size())
+            return false;
+        for (int i = 0; i < m_fields.size(); i++) {
+            if (m_fields.at(i) != other.m_fields.at(i))
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const QPimDetailFieldMap& other) const { return !(*this == other); }
+
+private:
+    int lowerBound(int field) const
+    {
+        int low = 0;
+        int high = m_fields.size();
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (m_fields.at(middle).first < field)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    int indexOf(int field) const
+    {
+        const int i = lowerBound(field);
+        return i < m_fields.size() && m_fields.at(i).first == field ? i : -1;
+    }
+
+    Container m_fields;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIMDETAILFIELDMAP_P_H
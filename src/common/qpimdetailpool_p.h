@@ -0,0 +1,227 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtPIM module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPIMDETAILPOOL_P_H
+#define QPIMDETAILPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qmutex.h>
+
+#include <new>
+#include <stddef.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * Allocates the memory of detail private objects.  Blocks of the same size class are carved out
+ * of larger slabs and recycled through a per-thread free list, so creating and destroying many
+ * details rarely reaches malloc.  Blocks freed on another thread than the one which allocated
+ * them simply join that thread's free list.
+ *
+ * Each library instantiates its own pool, with a Traits class whose enableVariable() names an
+ * environment variable.  The pool is opt-in: unless that variable is set, every call goes straight
+ * to the global operator new and delete.  Slabs are never released, so the memory of the largest
+ * number of details alive at once stays with the process, which only pays off for applications
+ * repeatedly creating and dropping many details, e.g. while synchronizing.
+ */
+template <typename Traits>
+class QPimDetailPool
+{
+public:
+    static void *allocate(size_t size);
+    static void deallocate(void *block, size_t size);
+
+private:
+    enum {
+        Granularity = 16,       // block sizes are multiples of this
+        SizeClassCount = 32,    // so blocks of up to 512 bytes are pooled
+        SlabSize = 16384,       // bytes taken from the global allocator at a time
+        LocalCacheLimit = 512   // free blocks a thread keeps per size class before sharing them
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock *head = 0;
+        int count = 0;
+
+        void push(FreeBlock *block)
+        {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        FreeBlock *pop()
+        {
+            FreeBlock *block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+
+        void moveTo(FreeList *other, int n)
+        {
+            while (n-- > 0 && count > 0)
+                other->push(pop());
+        }
+    };
+
+    // Free blocks which no thread is caching.  Slabs are never given back to the global allocator,
+    // because the blocks of one slab end up spread over the caches of many threads.
+    struct SharedPool
+    {
+        QBasicMutex mutex;
+        FreeList freeLists[SizeClassCount];
+    };
+
+    // Gives the cached blocks of an exiting thread back to the shared pool
+    struct LocalCacheFlusher
+    {
+        ~LocalCacheFlusher()
+        {
+            QMutexLocker locker(&sharedPool.mutex);
+            for (int i = 0; i < SizeClassCount; ++i)
+                localFreeLists[i].moveTo(&sharedPool.freeLists[i], localFreeLists[i].count);
+            localCacheFlushed = true;
+        }
+    };
+
+    static bool poolEnabled()
+    {
+        static const bool enabled = qEnvironmentVariableIsSet(Traits::enableVariable());
+        return enabled;
+    }
+
+    // Carves a new slab into blocks of the size class and adds them to freeList
+    static void addSlab(FreeList *freeList, size_t sizeClass)
+    {
+        const size_t blockSize = (sizeClass + 1) * Granularity;
+        char *slab = static_cast<char *>(::operator new(SlabSize));
+        for (size_t offset = 0; offset + blockSize <= size_t(SlabSize); offset += blockSize)
+            freeList->push(reinterpret_cast<FreeBlock *>(slab + offset));
+    }
+
+    // These are constant-initialized and never destroyed, so they stay usable during static
+    // destruction and after the cache of an exiting thread has been flushed.
+    static SharedPool sharedPool;
+    static thread_local FreeList localFreeLists[SizeClassCount];
+    static thread_local bool localCacheFlushed;
+    static thread_local LocalCacheFlusher localCacheFlusher;
+};
+
+template <typename Traits>
+typename QPimDetailPool<Traits>::SharedPool QPimDetailPool<Traits>::sharedPool;
+template <typename Traits>
+thread_local typename QPimDetailPool<Traits>::FreeList QPimDetailPool<Traits>::localFreeLists[SizeClassCount];
+template <typename Traits>
+thread_local bool QPimDetailPool<Traits>::localCacheFlushed = false;
+template <typename Traits>
+thread_local typename QPimDetailPool<Traits>::LocalCacheFlusher QPimDetailPool<Traits>::localCacheFlusher;
+
+// Returns a block of at least size bytes
+template <typename Traits>
+void *QPimDetailPool<Traits>::allocate(size_t size)
+{
+    const size_t sizeClass = (size - 1) / Granularity;
+    if (sizeClass >= size_t(SizeClassCount) || !poolEnabled())
+        return ::operator new(size);
+
+    if (localCacheFlushed) {
+        QMutexLocker locker(&sharedPool.mutex);
+        FreeList &freeList = sharedPool.freeLists[sizeClass];
+        if (freeList.count == 0)
+            addSlab(&freeList, sizeClass);
+        return freeList.pop();
+    }
+
+    FreeList &freeList = localFreeLists[sizeClass];
+    if (freeList.count == 0) {
+        (void)&localCacheFlusher; // make sure the cache is flushed when the thread exits
+        QMutexLocker locker(&sharedPool.mutex);
+        sharedPool.freeLists[sizeClass].moveTo(&freeList, LocalCacheLimit / 2);
+        if (freeList.count == 0)
+            addSlab(&freeList, sizeClass);
+    }
+    return freeList.pop();
+}
+
+// Releases block, which was returned by allocate() for the same size
+template <typename Traits>
+void QPimDetailPool<Traits>::deallocate(void *block, size_t size)
+{
+    const size_t sizeClass = (size - 1) / Granularity;
+    if (sizeClass >= size_t(SizeClassCount) || !poolEnabled()) {
+        ::operator delete(block);
+        return;
+    }
+
+    if (localCacheFlushed) {
+        QMutexLocker locker(&sharedPool.mutex);
+        sharedPool.freeLists[sizeClass].push(static_cast<FreeBlock *>(block));
+        return;
+    }
+
+    FreeList &freeList = localFreeLists[sizeClass];
+    if (freeList.count == 0)
+        (void)&localCacheFlusher;
+    freeList.push(static_cast<FreeBlock *>(block));
+    if (freeList.count > LocalCacheLimit) {
+        QMutexLocker locker(&sharedPool.mutex);
+        freeList.moveTo(&sharedPool.freeLists[sizeClass], LocalCacheLimit / 2);
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif // QPIMDETAILPOOL_P_H
@@ -0,0 +1,189 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtPIM module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPIMMANAGERURIREGISTRY_P_H
+#define QPIMMANAGERURIREGISTRY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * Gives each manager URI a small integer handle, so that ids can store and compare the handle
+ * instead of the URI string.  Two URIs have the same handle only if they are equal, and the empty
+ * URI has handle 0.  URIs are only ever added, so a handle stays valid for the lifetime of the
+ * process.
+ *
+ * Registering a URI takes a mutex, but turning a handle back into the URI or the id prefix, which
+ * happens on every managerUri() and toString() of an id, doesn't lock.  The entries live in chunks
+ * which are never moved or freed, and an entry is only published by bumping the count once it
+ * has been written.
+ *
+ * Each library instantiates its own registry with a Traits class, as with QPimDetailPool.
+ */
+template <typename Traits>
+class QPimManagerUriRegistry
+{
+public:
+    static int handle(const QString &managerUri);
+    static QString uri(int handle);
+    static QByteArray idData(int handle, const QByteArray &escapedLocalId);
+
+private:
+    enum {
+        FirstChunkSize = 16,    // chunk i holds FirstChunkSize << i entries
+        ChunkCount = 24
+    };
+
+    struct Entry
+    {
+        QString uri;
+        QByteArray idPrefix;    // UTF-8 form of the URI, with the ':' separating the local id
+    };
+
+    // Returns the chunk holding handle, and turns handle into the index within that chunk
+    static int chunkOf(int *handle, int *chunkSize)
+    {
+        int chunk = 0;
+        *chunkSize = FirstChunkSize;
+        while (*handle >= *chunkSize) {
+            *handle -= *chunkSize;
+            *chunkSize *= 2;
+            ++chunk;
+        }
+        return chunk;
+    }
+
+    // Returns the entry of a published handle
+    static const Entry &entry(int handle)
+    {
+        int chunkSize;
+        const int chunk = chunkOf(&handle, &chunkSize);
+        return chunks[chunk].loadAcquire()[handle];
+    }
+
+    // These are constant-initialized and never destroyed, so ids stay usable during static
+    // destruction.
+    static QBasicMutex mutex;
+    static QHash<QString, int> *handles;    // guarded by mutex
+    static QBasicAtomicInt count;           // handles below it have been published
+    static QBasicAtomicPointer<Entry> chunks[ChunkCount];
+};
+
+template <typename Traits>
+QBasicMutex QPimManagerUriRegistry<Traits>::mutex;
+template <typename Traits>
+QHash<QString, int> *QPimManagerUriRegistry<Traits>::handles = 0;
+template <typename Traits>
+QBasicAtomicInt QPimManagerUriRegistry<Traits>::count = Q_BASIC_ATOMIC_INITIALIZER(1);
+template <typename Traits>
+QBasicAtomicPointer<typename QPimManagerUriRegistry<Traits>::Entry> QPimManagerUriRegistry<Traits>::chunks[ChunkCount];
+
+// Returns the handle of managerUri, registering it first if necessary
+template <typename Traits>
+int QPimManagerUriRegistry<Traits>::handle(const QString &managerUri)
+{
+    if (managerUri.isEmpty())
+        return 0;
+
+    QMutexLocker locker(&mutex);
+    if (!handles)
+        handles = new QHash<QString, int>;
+    const QHash<QString, int>::const_iterator it = handles->constFind(managerUri);
+    if (it != handles->constEnd())
+        return it.value();
+
+    const int handle = count.loadRelaxed();
+    int index = handle;
+    int chunkSize;
+    const int chunk = chunkOf(&index, &chunkSize);
+    Q_ASSERT(chunk < ChunkCount);
+    Entry *entries = chunks[chunk].loadRelaxed();
+    if (!entries) {
+        entries = new Entry[chunkSize];
+        chunks[chunk].storeRelease(entries);
+    }
+
+    entries[index].uri = managerUri;
+    entries[index].idPrefix = managerUri.toUtf8().append(':');
+    handles->insert(managerUri, handle);
+    count.storeRelease(handle + 1);
+    return handle;
+}
+
+// Returns the manager URI registered with handle
+template <typename Traits>
+QString QPimManagerUriRegistry<Traits>::uri(int handle)
+{
+    if (handle <= 0 || handle >= count.loadAcquire())
+        return QString();
+    return entry(handle).uri;
+}
+
+// Returns the id string of the escaped local id in the manager registered with handle, or the
+// manager URI alone if escapedLocalId is empty
+template <typename Traits>
+QByteArray QPimManagerUriRegistry<Traits>::idData(int handle, const QByteArray &escapedLocalId)
+{
+    if (handle <= 0 || handle >= count.loadAcquire())
+        return escapedLocalId;
+    const QByteArray &idPrefix = entry(handle).idPrefix;
+    if (escapedLocalId.isEmpty())
+        return idPrefix.chopped(1);
+    return idPrefix + escapedLocalId;
+}
+
+QT_END_NAMESPACE
+
+#endif // QPIMMANAGERURIREGISTRY_P_H
@@ -10,6 +10,7 @@ include(details/details.pri)
 include(engines/engines.pri)
 include(filters/filters.pri)
 include(requests/requests.pri)
+include(../common/common.pri)
 
 PUBLIC_HEADERS += \
     qcontact.h \
@@ -41,6 +42,7 @@ PRIVATE_HEADERS += \
     qcontactactiondescriptor_p.h \
     qcontactactionmanager_p.h \
     qcontactactiontarget_p.h \
+    qcontactbinaryformat_p.h \
     qcontactchangeset_p.h \
     qcontactcollection_p.h \
     qcontactcollectionchangeset_p.h \
@@ -60,6 +62,7 @@ SOURCES += \
     qcontactactionfactory.cpp \
     qcontactactionmanager_p.cpp \
     qcontactactiontarget.cpp \
+    qcontactbinaryformat.cpp \
     qcontactchangeset.cpp \
     qcontactcollection.cpp \
     qcontactcollectionchangeset.cpp \
@@ -47,6 +47,10 @@
 #include <QtCore/qdebug.h>
 #endif
 #include <QtCore/qset.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+#include <string.h>
 
 #include "qcontactactiondescriptor.h"
 #include "qcontactdetail_p.h"
@@ -103,6 +107,28 @@ QT_BEGIN_NAMESPACE_CONTACTS
   \sa QContactManager, QContactDetail
  */
 
+/*!
+  \class QContactDetailView
+
+  \brief The QContactDetailView class is a non-owning view of some of the details of a QContact.
+
+  \inmodule QtContacts
+
+  \ingroup contacts-main
+
+  A view is returned by QContact::detailView().  It refers to the details stored in the contact
+  rather than copying them, so it is cheap to create and to iterate over, but it is only valid
+  until the contact is modified or destroyed.
+
+  \sa QContact::details()
+ */
+
+/*!
+ * \fn QContactDetailView QContact::detailView() const
+ * Returns a view of the details of the template parameter type.  The type must be
+ * a subclass of QContactDetail.
+ */
+
 /*!
  * \fn QList<T> QContact::details() const
  * Returns a list of details of the template parameter type.  The type must be
@@ -167,6 +193,7 @@ void QContact::clearDetails()
     contactType.setType(QContactType::TypeContact);
     contactType.d->m_access = QContactDetail::Irremovable;
     d->m_details.insert(0, contactType);
+    d->invalidateTypeIndex();
 }
 
 /*! Replace the contents of this QContact with \a other
@@ -312,13 +339,9 @@ QContactDetail QContact::detail(QContactDetail::DetailType type) const
     if (type == QContactDetail::TypeUndefined)
         return d.constData()->m_details.first();
 
-    // build the sub-list of matching details.
-    for (int i = 0; i < d.constData()->m_details.size(); i++) {
-        const QContactDetail& existing = d.constData()->m_details.at(i);
-        if (existing.d->m_type == type) {
-            return existing;
-        }
-    }
+    const QContactDetailView view = d.constData()->detailView(type);
+    if (!view.isEmpty())
+        return view.first();
 
     return QContactDetail();
 }
@@ -339,22 +362,31 @@ QContactDetail QContact::detail(QContactDetail::DetailType type) const
 */
 QList<QContactDetail> QContact::details(QContactDetail::DetailType type) const
 {
+    // special case
+    if (type == QContactDetail::TypeUndefined)
+        return d.constData()->m_details;
+
     // build the sub-list of matching details.
-    QList<QContactDetail> sublist;
+    return d.constData()->detailView(type).toList();
+}
 
-    // special case
+/*!
+    Returns a view of the details of the given \a type, or of all details if \a type is
+    QContactDetail::TypeUndefined.
+
+    Unlike details(), this doesn't copy the details into a new list: the view refers to the
+    details stored in this contact, which are located without scanning the others.  The view
+    must not be used after the contact has been modified or destroyed.
+
+    \sa QContactDetailView
+*/
+QContactDetailView QContact::detailView(QContactDetail::DetailType type) const
+{
     if (type == QContactDetail::TypeUndefined) {
-        sublist = d.constData()->m_details;
-    } else {
-        for (int i = 0; i < d->m_details.size(); i++) {
-            const QContactDetail& existing = d.constData()->m_details.at(i);
-            if (existing.d->m_type == type) {
-                sublist.append(existing);
-            }
-        }
+        const QList<QContactDetail>& details = d.constData()->m_details;
+        return QContactDetailView(details.constData(), 0, details.size());
     }
-
-    return sublist;
+    return d.constData()->detailView(type);
 }
 
 /*!
@@ -387,7 +419,7 @@ bool QContact::appendDetail(const QContactDetail &detail)
         d->m_details[0].d->m_access |= QContactDetail::Irremovable;
         return true;
     }
-    d->m_details.append(detail);
+    d->appendDetail(detail);
     return true;
 }
 
@@ -466,7 +498,7 @@ bool QContact::saveDetail(QContactDetail* detail, AccessConstraintsEnforcement e
         }
     }
     // this is a new detail!  add it to the contact.
-    d->m_details.append(*detail);
+    d->appendDetail(*detail);
     return true;
 }
 
@@ -529,7 +561,7 @@ bool QContact::removeDetail(QContactDetail* detail, AccessConstraintsEnforcement
     }
 
     // then remove the detail.
-    d->m_details.removeAt(removeIndex);
+    d->removeDetailAt(removeIndex);
     return true;
 }
 
@@ -599,6 +631,7 @@ QDataStream& operator>>(QDataStream& in, QContact& contact)
         QList<QContactDetail> details;
         QMap<QString, int> preferences;
         in >> id >> contact.d->m_details >> contact.d->m_preferences;
+        contact.d->invalidateTypeIndex();
         contact.setId(id);
     } else {
         in.setStatus(QDataStream::ReadCorruptData);
@@ -829,6 +862,7 @@ void QContactData::removeOnly(QContactDetail::DetailType type)
         else
             ++dit;
     }
+    invalidateTypeIndex();
 }
 
 void QContactData::removeOnly(const QSet<QContactDetail::DetailType>& types)
@@ -841,6 +875,96 @@ void QContactData::removeOnly(const QSet<QContactDetail::DetailType>& types)
         else
             ++dit;
     }
+    invalidateTypeIndex();
+}
+
+void QContactData::appendDetail(const QContactDetail& detail)
+{
+    m_details.append(detail);
+
+    // Index the new detail at the end of its bucket, or of its type in the last bucket
+    TypeIndex* index = m_typeIndex.loadRelaxed();
+    if (!index)
+        return;
+    const QContactDetail::DetailType type = detail.type();
+    const int bucket = typeBucket(type);
+    int pos = index->offsets[bucket + 1];
+    if (bucket == TypeBucketCount - 1) {
+        pos = std::upper_bound(index->indexes.constBegin() + index->offsets[bucket],
+                               index->indexes.constBegin() + pos, type,
+                               [this](QContactDetail::DetailType t, int i) {
+                                   return t < m_details.at(i).type();
+                               }) - index->indexes.constBegin();
+    }
+    index->indexes.insert(pos, m_details.size() - 1);
+    for (int b = bucket + 1; b <= TypeBucketCount; b++)
+        index->offsets[b]++;
+}
+
+void QContactData::removeDetailAt(int index)
+{
+    m_details.removeAt(index);
+    invalidateTypeIndex();
+}
+
+/* Drops the type index after the details have changed; the next typed lookup rebuilds it */
+void QContactData::invalidateTypeIndex()
+{
+    delete m_typeIndex.fetchAndStoreRelaxed(nullptr);
+}
+
+/* Returns the type index, building it from m_details with a counting sort if needed */
+const QContactData::TypeIndex* QContactData::typeIndex() const
+{
+    TypeIndex* index = m_typeIndex.loadAcquire();
+    if (index)
+        return index;
+
+    index = new TypeIndex;
+    memset(index->offsets, 0, sizeof(index->offsets));
+    for (int i = 0; i < m_details.size(); i++)
+        index->offsets[typeBucket(m_details.at(i).type()) + 1]++;
+    for (int b = 1; b <= TypeBucketCount; b++)
+        index->offsets[b] += index->offsets[b - 1];
+
+    QVarLengthArray<int, TypeBucketCount> next(TypeBucketCount);
+    memcpy(next.data(), index->offsets, TypeBucketCount * sizeof(int));
+    index->indexes.resize(m_details.size());
+    for (int i = 0; i < m_details.size(); i++)
+        index->indexes[next[typeBucket(m_details.at(i).type())]++] = i;
+
+    // Keep each type in the last bucket contiguous
+    std::stable_sort(index->indexes.begin() + index->offsets[TypeBucketCount - 1], index->indexes.end(),
+                     [this](int a, int b) {
+                         return m_details.at(a).type() < m_details.at(b).type();
+                     });
+
+    // Another reader of the same shared data may have built it first
+    TypeIndex* existing = nullptr;
+    if (!m_typeIndex.testAndSetOrdered(nullptr, index, existing)) {
+        delete index;
+        return existing;
+    }
+    return index;
+}
+
+/* Returns a view of the details of the given \a type, located through the type index */
+QContactDetailView QContactData::detailView(QContactDetail::DetailType type) const
+{
+    const TypeIndex* index = typeIndex();
+    const int bucket = typeBucket(type);
+    const int* begin = index->indexes.constData() + index->offsets[bucket];
+    const int* end = index->indexes.constData() + index->offsets[bucket + 1];
+    if (bucket == TypeBucketCount - 1) {
+        const QList<QContactDetail>& details = m_details;
+        begin = std::lower_bound(begin, end, type, [&details](int i, QContactDetail::DetailType t) {
+            return details.at(i).type() < t;
+        });
+        end = std::upper_bound(begin, end, type, [&details](QContactDetail::DetailType t, int i) {
+            return t < details.at(i).type();
+        });
+    }
+    return QContactDetailView(m_details.constData(), begin, end - begin);
 }
 
 QT_END_NAMESPACE_CONTACTS
@@ -45,6 +45,8 @@
 #include <QtCore/qshareddata.h>
 #include <QtCore/qstring.h>
 
+#include <iterator>
+
 #include <QtContacts/qcontactdetail.h>
 #include <QtContacts/qcontactrelationship.h>
 #include <QtContacts/qcontacttype.h>
@@ -57,6 +59,74 @@ class QContactManager;
 class QContactCollectionId;
 
 class QContactData;
+
+class QContactDetailView
+{
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef QContactDetail value_type;
+        typedef int difference_type;
+        typedef const QContactDetail* pointer;
+        typedef const QContactDetail& reference;
+
+        const_iterator() : m_details(0), m_index(0), m_pos(0) {}
+        const QContactDetail& operator*() const { return m_details[m_index ? m_index[m_pos] : m_pos]; }
+        const QContactDetail* operator->() const { return &operator*(); }
+        const_iterator& operator++() { ++m_pos; return *this; }
+        const_iterator operator++(int) { const_iterator it(*this); ++m_pos; return it; }
+        bool operator==(const const_iterator& other) const
+        {
+            return m_pos == other.m_pos && m_index == other.m_index && m_details == other.m_details;
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class QContactDetailView;
+        const_iterator(const QContactDetail* details, const int* index, int pos)
+            : m_details(details), m_index(index), m_pos(pos) {}
+
+        const QContactDetail* m_details;
+        const int* m_index;
+        int m_pos;
+    };
+
+    QContactDetailView() : m_details(0), m_index(0), m_count(0) {}
+
+    int count() const { return m_count; }
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    const QContactDetail& at(int i) const
+    {
+        Q_ASSERT(i >= 0 && i < m_count);
+        return m_details[m_index ? m_index[i] : i];
+    }
+    const QContactDetail& first() const { return at(0); }
+    const_iterator begin() const { return const_iterator(m_details, m_index, 0); }
+    const_iterator end() const { return const_iterator(m_details, m_index, m_count); }
+
+    QList<QContactDetail> toList() const
+    {
+        QList<QContactDetail> ret;
+        ret.reserve(m_count);
+        for (int i = 0; i < m_count; i++)
+            ret.append(at(i));
+        return ret;
+    }
+
+private:
+    friend class QContact;
+    friend class QContactData;
+    QContactDetailView(const QContactDetail* details, const int* index, int count)
+        : m_details(details), m_index(index), m_count(count) {}
+
+    const QContactDetail* m_details;
+    const int* m_index; // Null if the view covers all of the details, in order
+    int m_count;
+};
+
 class Q_CONTACTS_EXPORT QContact
 {
 public:
@@ -96,17 +166,24 @@ public:
     /* Access details of particular type */
     QContactDetail detail(QContactDetail::DetailType type) const;
     QList<QContactDetail> details(QContactDetail::DetailType type = QContactDetail::TypeUndefined) const;
+    QContactDetailView detailView(QContactDetail::DetailType type = QContactDetail::TypeUndefined) const;
     bool appendDetail(const QContactDetail &detail);
     /* Templated (type-specific) detail retrieval */
     template<typename T> QList<T> details() const
     {
-        QList<QContactDetail> props = details(T::Type);
+        const QContactDetailView props = detailView(T::Type);
         QList<T> ret;
+        ret.reserve(props.count());
         for (int i=0; i<props.count(); i++)
             ret.append(T(props.at(i)));
         return ret;
     }
 
+    template<typename T> QContactDetailView detailView() const
+    {
+        return detailView(T::Type);
+    }
+
     template<typename T> T detail() const
     {
         return T(detail(T::Type));
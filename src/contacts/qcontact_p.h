@@ -51,6 +51,7 @@
 // We mean it.
 //
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qshareddata.h>
@@ -66,8 +67,21 @@ QT_BEGIN_NAMESPACE_CONTACTS
 class QContactData : public QSharedData
 {
 public:
+    // One bucket per QContactDetail::DetailType, plus one for any other type
+    enum { TypeBucketCount = QContactDetail::TypeVersion + 2 };
+
+    // Indices into m_details grouped by bucket, in m_details order within a bucket, except that
+    // the last bucket is ordered by type first.  Bucket b spans [offsets[b], offsets[b + 1])
+    // of indexes.
+    struct TypeIndex
+    {
+        QList<int> indexes;
+        int offsets[TypeBucketCount + 1];
+    };
+
     QContactData()
-        : QSharedData()
+        : QSharedData(),
+        m_typeIndex(nullptr)
     {
     }
 
@@ -77,11 +91,15 @@ public:
         m_collectionId(other.m_collectionId),
         m_details(other.m_details),
         m_relationshipsCache(other.m_relationshipsCache),
-        m_preferences(other.m_preferences)
+        m_preferences(other.m_preferences),
+        m_typeIndex(nullptr)
     {
     }
 
-    ~QContactData() {}
+    ~QContactData()
+    {
+        delete m_typeIndex.loadRelaxed();
+    }
 
     QContactId m_id;
     QContactCollectionId m_collectionId;
@@ -89,9 +107,25 @@ public:
     QList<QContactRelationship> m_relationshipsCache;
     QMap<QString, int> m_preferences;
 
+    // Built by the first typed detailView() and dropped when the details change, so contacts
+    // that are only copied or iterated never pay for it.  It is built from const methods of
+    // possibly shared data, hence published atomically.
+    mutable QAtomicPointer<TypeIndex> m_typeIndex;
+
+    static int typeBucket(QContactDetail::DetailType type)
+    {
+        return type >= QContactDetail::TypeUndefined && type <= QContactDetail::TypeVersion
+                ? int(type) : int(TypeBucketCount) - 1;
+    }
+
     // Helper function
     void removeOnly(QContactDetail::DetailType type);
     void removeOnly(const QSet<QContactDetail::DetailType>& types);
+    void appendDetail(const QContactDetail& detail);
+    void removeDetailAt(int index);
+    void invalidateTypeIndex();
+    const TypeIndex* typeIndex() const;
+    QContactDetailView detailView(QContactDetail::DetailType type) const;
 
     // Trampoline
     static QSharedDataPointer<QContactData>& contactData(QContact& contact) {return contact.d;}
@@ -0,0 +1,552 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcontactbinaryformat_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qiodevice.h>
+
+#include "qcontact_p.h"
+#include "qcontactmanagerengine.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+namespace {
+
+enum {
+    Magic = 0x424e4351,         // "QCNB"
+    FormatVersion = 1,
+    HeaderWords = 11,
+    ContactRecordWords = 5,
+    DetailRecordWords = 3,
+    ValueRecordWords = 2,
+    MaxHalfWord = 0xffff,       // value counts and field numbers share their word with other data
+    NoString = 0xffffffff
+};
+
+// contact record fields
+enum { ContactLocalId, ContactCollection, ContactPreferences, ContactFirstDetail, ContactDetailCount };
+// detail record fields; the last holds the value count and, in its upper half, the access constraints
+enum { DetailType, DetailFirstValue, DetailValueCountAndAccess };
+
+enum ValueKind {
+    BoolValue = 1,
+    IntValue,
+    StringValue,
+    ByteArrayValue,
+    StringListValue,
+    IntListValue,
+    VariantValue        // anything else, as written by QDataStream
+};
+
+const QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+inline quint32 word(const uchar *record, int index)
+{
+    return qFromLittleEndian<quint32>(record + index * sizeof(quint32));
+}
+
+void appendWords(QByteArray *data, const QList<quint32> &words)
+{
+    const int offset = data->size();
+    data->resize(offset + words.size() * int(sizeof(quint32)));
+    uchar *out = reinterpret_cast<uchar *>(data->data() + offset);
+    foreach (quint32 value, words) {
+        qToLittleEndian(value, out);
+        out += sizeof(quint32);
+    }
+}
+
+}
+
+/*!
+    \class QContactBinaryWriter
+    \internal
+
+    Writes contacts in the binary format read by QContactBinaryReader.
+*/
+
+QContactBinaryWriter::QContactBinaryWriter()
+    : m_unrepresentable(false)
+{
+}
+
+/*!
+    Adds \a contact, which must have an id, to the contacts to be written.  If one of its
+    details has more than 65535 values, or a field number above 65535, write() fails.
+*/
+void QContactBinaryWriter::addContact(const QContact &contact)
+{
+    ContactEntry entry;
+    entry.localId = contact.id().localId();
+    entry.record[ContactLocalId] = addString(entry.localId);
+    entry.record[ContactCollection] = contact.collectionId().isNull() ? quint32(NoString) : addString(contact.collectionId().localId());
+    entry.record[ContactFirstDetail] = m_details.size() / DetailRecordWords;
+
+    const QList<QContactDetail> details(contact.details());
+    entry.record[ContactDetailCount] = details.size();
+    foreach (const QContactDetail &detail, details) {
+        const QMap<int, QVariant> values(detail.values());
+        if (values.size() > MaxHalfWord)
+            m_unrepresentable = true;
+        m_details << quint32(detail.type())
+                  << quint32(m_values.size() / ValueRecordWords)
+                  << (quint32(values.size()) | (quint32(detail.accessConstraints()) << 16));
+        for (QMap<int, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it)
+            addValue(it.key(), it.value());
+    }
+
+    // preferences refer to details by key, which is only valid in this process; store positions
+    entry.record[ContactPreferences] = NoString;
+    QContact copy(contact);
+    const QMap<QString, int> &preferences = QContactData::contactData(copy).constData()->m_preferences;
+    if (!preferences.isEmpty()) {
+        QList<quint32> words;
+        words << quint32(preferences.size());
+        for (QMap<QString, int>::const_iterator it = preferences.constBegin(); it != preferences.constEnd(); ++it) {
+            int position = -1;
+            for (int i = 0; i < details.size() && position == -1; ++i) {
+                if (details.at(i).key() == it.value())
+                    position = i;
+            }
+            words << addString(it.key().toUtf8()) << quint32(position);
+        }
+        QByteArray blob;
+        appendWords(&blob, words);
+        entry.record[ContactPreferences] = addString(blob);
+    }
+
+    m_contacts.append(entry);
+}
+
+/*!
+    Writes the contacts added so far to \a device.  Returns false if they could not all be
+    written, or could not be represented in the format.
+*/
+bool QContactBinaryWriter::write(QIODevice *device) const
+{
+    if (m_unrepresentable)
+        return false;
+
+    QList<ContactEntry> contacts(m_contacts);
+    std::sort(contacts.begin(), contacts.end(), [](const ContactEntry &a, const ContactEntry &b) {
+        return a.localId < b.localId;
+    });
+
+    QList<quint32> contactTable;
+    contactTable.reserve(contacts.size() * ContactRecordWords);
+    foreach (const ContactEntry &entry, contacts) {
+        for (int i = 0; i < ContactRecordWords; ++i)
+            contactTable << entry.record[i];
+    }
+
+    QList<quint32> stringOffsets;
+    stringOffsets.reserve(m_strings.size() + 1);
+    quint32 stringsSize = 0;
+    foreach (const QByteArray &string, m_strings) {
+        stringOffsets << stringsSize;
+        stringsSize += string.size();
+    }
+    stringOffsets << stringsSize;
+
+    const quint32 contactOffset = HeaderWords * sizeof(quint32);
+    const quint32 detailOffset = contactOffset + contactTable.size() * sizeof(quint32);
+    const quint32 valueOffset = detailOffset + m_details.size() * sizeof(quint32);
+    const quint32 stringOffset = valueOffset + m_values.size() * sizeof(quint32);
+
+    QList<quint32> header;
+    header << quint32(Magic)
+           << (quint32(FormatVersion) | (quint32(HeaderWords * sizeof(quint32)) << 16))
+           << quint32(contacts.size()) << contactOffset
+           << quint32(m_details.size() / DetailRecordWords) << detailOffset
+           << quint32(m_values.size() / ValueRecordWords) << valueOffset
+           << quint32(m_strings.size()) << stringOffset
+           << stringsSize;
+
+    QByteArray data;
+    data.reserve(stringOffset + stringOffsets.size() * sizeof(quint32) + stringsSize);
+    appendWords(&data, header);
+    appendWords(&data, contactTable);
+    appendWords(&data, m_details);
+    appendWords(&data, m_values);
+    appendWords(&data, stringOffsets);
+    foreach (const QByteArray &string, m_strings)
+        data.append(string);
+
+    return device->write(data) == data.size();
+}
+
+quint32 QContactBinaryWriter::addString(const QByteArray &string)
+{
+    QHash<QByteArray, quint32>::const_iterator it = m_stringIndexes.constFind(string);
+    if (it != m_stringIndexes.constEnd())
+        return it.value();
+
+    const quint32 index = m_strings.size();
+    m_strings.append(string);
+    m_stringIndexes.insert(string, index);
+    return index;
+}
+
+void QContactBinaryWriter::addValue(int field, const QVariant &value)
+{
+    if (field < 0 || field > MaxHalfWord)
+        m_unrepresentable = true;
+
+    quint32 kind = VariantValue;
+    quint32 payload = 0;
+    const int type = value.userType();
+    if (type == QMetaType::Bool) {
+        kind = BoolValue;
+        payload = value.toBool();
+    } else if (type == QMetaType::Int) {
+        kind = IntValue;
+        payload = quint32(value.toInt());
+    } else if (type == QMetaType::QString) {
+        kind = StringValue;
+        payload = addString(value.toString().toUtf8());
+    } else if (type == QMetaType::QByteArray) {
+        kind = ByteArrayValue;
+        payload = addString(value.toByteArray());
+    } else if (type == QMetaType::QStringList) {
+        const QStringList strings(value.toStringList());
+        QList<quint32> words;
+        words << quint32(strings.size());
+        foreach (const QString &string, strings)
+            words << addString(string.toUtf8());
+        QByteArray blob;
+        appendWords(&blob, words);
+        kind = StringListValue;
+        payload = addString(blob);
+    } else if (type == qMetaTypeId<QList<int> >()) {
+        const QList<int> ints(value.value<QList<int> >());
+        QList<quint32> words;
+        words << quint32(ints.size());
+        foreach (int i, ints)
+            words << quint32(i);
+        QByteArray blob;
+        appendWords(&blob, words);
+        kind = IntListValue;
+        payload = addString(blob);
+    } else {
+        QByteArray blob;
+        QDataStream out(&blob, QIODevice::WriteOnly);
+        out.setVersion(StreamVersion);
+        out << value;
+        payload = addString(blob);
+    }
+
+    m_values << (quint32(field) | (kind << 16)) << payload;
+}
+
+/*!
+    \class QContactBinaryReader
+    \internal
+
+    Reads contacts in place from the binary format written by QContactBinaryWriter.  The data
+    must remain valid while the reader is used; contacts read from it copy what they need.
+*/
+
+/*!
+    Constructs an invalid reader.
+*/
+QContactBinaryReader::QContactBinaryReader()
+    : m_data(0)
+    , m_contactCount(0)
+    , m_contacts(0)
+    , m_detailCount(0)
+    , m_details(0)
+    , m_valueCount(0)
+    , m_values(0)
+    , m_stringCount(0)
+    , m_stringOffsets(0)
+    , m_strings(0)
+    , m_stringsSize(0)
+{
+}
+
+/*!
+    Constructs a reader of the \a size bytes at \a data, which must be 4-byte aligned.  The
+    reader is invalid if the header or the tables it describes do not fit in the data.
+*/
+QContactBinaryReader::QContactBinaryReader(const uchar *data, qint64 size)
+    : QContactBinaryReader()
+{
+    if (size < qint64(HeaderWords * sizeof(quint32)) || word(data, 0) != quint32(Magic)
+            || (word(data, 1) & 0xffff) != quint32(FormatVersion)) {
+        return;
+    }
+
+    // each table must lie within the data, and after the one before it
+    const quint32 counts[] = { word(data, 2), word(data, 4), word(data, 6), word(data, 8) + 1 };
+    const quint32 offsets[] = { word(data, 3), word(data, 5), word(data, 7), word(data, 9) };
+    const quint32 recordWords[] = { ContactRecordWords, DetailRecordWords, ValueRecordWords, 1 };
+    quint64 end = HeaderWords * sizeof(quint32);
+    for (int i = 0; i < 4; ++i) {
+        if (offsets[i] < end || offsets[i] % sizeof(quint32))
+            return;
+        end = offsets[i] + quint64(counts[i]) * recordWords[i] * sizeof(quint32);
+    }
+    const quint32 stringsSize = word(data, 10);
+    if (end + stringsSize > quint64(size))
+        return;
+
+    m_data = data;
+    m_contactCount = counts[0];
+    m_contacts = data + offsets[0];
+    m_detailCount = counts[1];
+    m_details = data + offsets[1];
+    m_valueCount = counts[2];
+    m_values = data + offsets[2];
+    m_stringCount = counts[3] - 1;
+    m_stringOffsets = data + offsets[3];
+    m_strings = data + end;
+    m_stringsSize = stringsSize;
+}
+
+/*!
+    Returns the index of the contact with the local id \a localId, or -1 if there is none.
+*/
+int QContactBinaryReader::indexOf(const QByteArray &localId) const
+{
+    int low = 0;
+    int high = int(m_contactCount);
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        const QByteArray id(rawString(word(contactRecord(middle), ContactLocalId)));
+        if (id < localId)
+            low = middle + 1;
+        else if (localId < id)
+            high = middle;
+        else
+            return middle;
+    }
+    return -1;
+}
+
+/*!
+    Returns the local id of the contact at \a index.
+*/
+QByteArray QContactBinaryReader::localId(int index) const
+{
+    return string(word(contactRecord(index), ContactLocalId));
+}
+
+/*!
+    Returns the local id of the collection of the contact at \a index.
+*/
+QByteArray QContactBinaryReader::collectionLocalId(int index) const
+{
+    return string(word(contactRecord(index), ContactCollection));
+}
+
+/*!
+    Returns a number which is the same for contacts in the same collection, and different
+    otherwise, without reading the collection id.
+*/
+quint32 QContactBinaryReader::collectionKey(int index) const
+{
+    return word(contactRecord(index), ContactCollection);
+}
+
+/*!
+    Returns the contact at \a index, with all of its details, giving its ids the manager URI
+    \a managerUri.
+*/
+QContact QContactBinaryReader::contact(int index, const QString &managerUri) const
+{
+    return decodeContact(index, managerUri, 0);
+}
+
+/*!
+    Returns the contact at \a index with only the details of the given \a types, and its type,
+    giving its ids the manager URI \a managerUri.  The other details are not decoded.
+*/
+QContact QContactBinaryReader::contact(int index, const QString &managerUri, const QSet<QContactDetail::DetailType> &types) const
+{
+    return decodeContact(index, managerUri, &types);
+}
+
+const uchar *QContactBinaryReader::contactRecord(int index) const
+{
+    Q_ASSERT(index >= 0 && quint32(index) < m_contactCount);
+    return m_contacts + index * ContactRecordWords * sizeof(quint32);
+}
+
+QByteArray QContactBinaryReader::string(quint32 index) const
+{
+    const QByteArray raw(rawString(index));
+    return QByteArray(raw.constData(), raw.size());
+}
+
+// The string at index, still in the data; it must not outlive the reader's use
+QByteArray QContactBinaryReader::rawString(quint32 index) const
+{
+    if (index >= m_stringCount)
+        return QByteArray();
+    const quint32 begin = word(m_stringOffsets, index);
+    const quint32 end = word(m_stringOffsets, index + 1);
+    if (begin > end || end > m_stringsSize)
+        return QByteArray();
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_strings + begin), end - begin);
+}
+
+QContactDetail QContactBinaryReader::detail(const uchar *record) const
+{
+    QContactDetail detail(static_cast<QContactDetail::DetailType>(word(record, DetailType)));
+    const quint32 firstValue = word(record, DetailFirstValue);
+    const quint32 valueCount = word(record, DetailValueCountAndAccess) & 0xffff;
+    if (quint64(firstValue) + valueCount > m_valueCount)
+        return detail;
+
+    for (quint32 i = firstValue; i < firstValue + valueCount; ++i) {
+        const uchar *value = m_values + i * ValueRecordWords * sizeof(quint32);
+        const quint32 fieldAndKind = word(value, 0);
+        const quint32 payload = word(value, 1);
+        const int field = fieldAndKind & 0xffff;
+        switch (fieldAndKind >> 16) {
+        case BoolValue:
+            detail.setValue(field, bool(payload));
+            break;
+        case IntValue:
+            detail.setValue(field, int(payload));
+            break;
+        case StringValue: {
+            const QByteArray utf8(rawString(payload));
+            detail.setValue(field, QString::fromUtf8(utf8.constData(), utf8.size()));
+            break;
+        }
+        case ByteArrayValue:
+            detail.setValue(field, string(payload));
+            break;
+        case StringListValue:
+        case IntListValue: {
+            const QByteArray blob(rawString(payload));
+            const uchar *words = reinterpret_cast<const uchar *>(blob.constData());
+            const quint32 count = blob.size() >= int(sizeof(quint32)) ? word(words, 0) : 0;
+            if ((quint64(count) + 1) * sizeof(quint32) > quint64(blob.size()))
+                break;
+            if ((fieldAndKind >> 16) == StringListValue) {
+                QStringList strings;
+                strings.reserve(count);
+                for (quint32 j = 0; j < count; ++j) {
+                    const QByteArray utf8(rawString(word(words, j + 1)));
+                    strings.append(QString::fromUtf8(utf8.constData(), utf8.size()));
+                }
+                detail.setValue(field, strings);
+            } else {
+                QList<int> ints;
+                ints.reserve(count);
+                for (quint32 j = 0; j < count; ++j)
+                    ints.append(int(word(words, j + 1)));
+                detail.setValue(field, QVariant::fromValue(ints));
+            }
+            break;
+        }
+        case VariantValue: {
+            QDataStream in(string(payload));
+            in.setVersion(StreamVersion);
+            QVariant variant;
+            in >> variant;
+            detail.setValue(field, variant);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    const QContactDetail::AccessConstraints access(word(record, DetailValueCountAndAccess) >> 16);
+    if (access != QContactDetail::NoConstraint)
+        QContactManagerEngine::setDetailAccessConstraints(&detail, access);
+    return detail;
+}
+
+QContact QContactBinaryReader::decodeContact(int index, const QString &managerUri, const QSet<QContactDetail::DetailType> *types) const
+{
+    const uchar *record = contactRecord(index);
+    QContact contact;
+    contact.setId(QContactId(managerUri, string(word(record, ContactLocalId))));
+    const quint32 collection = word(record, ContactCollection);
+    if (collection != quint32(NoString))
+        contact.setCollectionId(QContactCollectionId(managerUri, string(collection)));
+
+    const quint32 firstDetail = word(record, ContactFirstDetail);
+    const quint32 detailCount = word(record, ContactDetailCount);
+    if (quint64(firstDetail) + detailCount > m_detailCount)
+        return contact;
+
+    // the type is always decoded, as the first detail of every contact
+    QList<QContactDetail> details;
+    details.reserve(types ? types->size() + 1 : int(detailCount));
+    for (quint32 i = firstDetail; i < firstDetail + detailCount; ++i) {
+        const uchar *detailRecord = m_details + i * DetailRecordWords * sizeof(quint32);
+        const QContactDetail::DetailType type = static_cast<QContactDetail::DetailType>(word(detailRecord, DetailType));
+        if (types && type != QContactDetail::TypeType && !types->contains(type))
+            continue;
+        details.append(detail(detailRecord));
+    }
+    if (details.isEmpty())
+        return contact;
+
+    QSharedDataPointer<QContactData> &d = QContactData::contactData(contact);
+    d->m_details = details;
+    d->invalidateTypeIndex();
+
+    // with every detail decoded, the positions of the preferred details are their indexes
+    const quint32 preferences = word(record, ContactPreferences);
+    if (!types && preferences != quint32(NoString)) {
+        const QByteArray blob(rawString(preferences));
+        const uchar *words = reinterpret_cast<const uchar *>(blob.constData());
+        const quint32 count = blob.size() >= int(sizeof(quint32)) ? word(words, 0) : 0;
+        if ((2 * quint64(count) + 1) * sizeof(quint32) <= quint64(blob.size())) {
+            for (quint32 i = 0; i < count; ++i) {
+                const int position = int(word(words, 2 * i + 2));
+                if (position >= 0 && position < details.size())
+                    d->m_preferences.insert(QString::fromUtf8(string(word(words, 2 * i + 1))), details.at(position).key());
+            }
+        }
+    }
+    return contact;
+}
+
+QT_END_NAMESPACE_CONTACTS
@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCONTACTBINARYFORMAT_P_H
+#define QCONTACTBINARYFORMAT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qset.h>
+
+#include <QtContacts/qcontact.h>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*
+ * A binary contact store which is read in place, typically from a memory mapping.  All values
+ * are little-endian and every table is 4-byte aligned:
+ *
+ *   header          magic, version, and the count and offset of each table
+ *   contact table   fixed-size records sorted by local id: the local id, the collection's local
+ *                   id, the preferences, and the range of the contact's details
+ *   detail table    fixed-size records: the type, access constraints and range of values
+ *   value table     fixed-size records: the field, the kind of value, and the value itself or
+ *                   the string holding it
+ *   string table    offsets of each (deduplicated) string, then the UTF-8 text or raw bytes
+ *
+ * A contact can be located by a binary search of the contact table, and only the details it is
+ * asked for are decoded.
+ */
+class Q_CONTACTS_EXPORT QContactBinaryWriter
+{
+public:
+    QContactBinaryWriter();
+
+    void addContact(const QContact &contact);
+    bool write(QIODevice *device) const;
+
+private:
+    quint32 addString(const QByteArray &string);
+    void addValue(int field, const QVariant &value);
+
+    struct ContactEntry
+    {
+        QByteArray localId;
+        quint32 record[5];
+    };
+
+    QList<ContactEntry> m_contacts;
+    QList<quint32> m_details;
+    QList<quint32> m_values;
+    QList<QByteArray> m_strings;
+    QHash<QByteArray, quint32> m_stringIndexes;
+    bool m_unrepresentable;     // a value count or field number doesn't fit in 16 bits
+};
+
+class Q_CONTACTS_EXPORT QContactBinaryReader
+{
+public:
+    QContactBinaryReader();
+    QContactBinaryReader(const uchar *data, qint64 size);
+
+    bool isValid() const { return m_data != 0; }
+
+    int contactCount() const { return m_contactCount; }
+    int indexOf(const QByteArray &localId) const;
+    QByteArray localId(int index) const;
+    QByteArray collectionLocalId(int index) const;
+    quint32 collectionKey(int index) const;
+
+    QContact contact(int index, const QString &managerUri) const;
+    QContact contact(int index, const QString &managerUri, const QSet<QContactDetail::DetailType> &types) const;
+
+private:
+    const uchar *contactRecord(int index) const;
+    QByteArray string(quint32 index) const;
+    QByteArray rawString(quint32 index) const;
+    QContactDetail detail(const uchar *record) const;
+    QContact decodeContact(int index, const QString &managerUri, const QSet<QContactDetail::DetailType> *types) const;
+
+    const uchar *m_data;
+    quint32 m_contactCount;
+    const uchar *m_contacts;
+    quint32 m_detailCount;
+    const uchar *m_details;
+    quint32 m_valueCount;
+    const uchar *m_values;
+    quint32 m_stringCount;
+    const uchar *m_stringOffsets;
+    const uchar *m_strings;
+    quint32 m_stringsSize;
+};
+
+QT_END_NAMESPACE_CONTACTS
+
+#endif // QCONTACTBINARYFORMAT_P_H
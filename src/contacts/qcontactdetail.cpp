@@ -68,6 +68,24 @@ QT_BEGIN_NAMESPACE_CONTACTS
 /* Initialise our static private data member */
 QAtomicInt QContactDetailPrivate::lastDetailKey(1);
 
+/* Keys are handed to each thread in blocks, so creating details doesn't contend on lastDetailKey */
+enum { DetailKeyBlockSize = 1024 };
+static thread_local int nextThreadDetailKey = 0;
+static thread_local int threadDetailKeyBlockEnd = 0;
+
+/*!
+    \internal
+    Returns a new detail key, unique within the process.
+*/
+int QContactDetailPrivate::nextDetailKey()
+{
+    if (nextThreadDetailKey == threadDetailKeyBlockEnd) {
+        nextThreadDetailKey = lastDetailKey.fetchAndAddRelaxed(DetailKeyBlockSize);
+        threadDetailKeyBlockEnd = nextThreadDetailKey + DetailKeyBlockSize;
+    }
+    return nextThreadDetailKey++;
+}
+
 /*!
   \class QContactDetail
 
@@ -387,7 +405,7 @@ int QContactDetail::key() const
  */
 void QContactDetail::resetKey()
 {
-    d->m_detailId = QContactDetailPrivate::lastDetailKey.fetchAndAddOrdered(1);
+    d->m_detailId = QContactDetailPrivate::nextDetailKey();
 }
 
 /*!
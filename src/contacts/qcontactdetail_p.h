@@ -61,13 +61,23 @@
 #include <QStringList>
 
 #include "qcontactdetail.h"
+#include "qpimdetailfieldmap_p.h"
+#include "qpimdetailpool_p.h"
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
+// The pool is only used when QTCONTACTS_DETAIL_POOL is set, as it keeps its slabs for good
+struct QContactDetailPoolTraits
+{
+    static const char *enableVariable() { return "QTCONTACTS_DETAIL_POOL"; }
+};
+typedef QPimDetailPool<QContactDetailPoolTraits> QContactDetailPool;
+
 class QContactDetailPrivate : public QSharedData
 {
 public:
     static QAtomicInt lastDetailKey;
+    static int nextDetailKey();
 
     // all details have these fields
     QList<int> m_contexts;
@@ -79,18 +89,18 @@ public:
     int m_detailId;
     int m_hasValueBitfield; // subclass types must set the hasValue bit for any field value which isn't stored in m_extraData.
 
-    // extra field data
-    QMap<int, QVariant> m_extraData;
+    // extra field data, which most details don't have, so it isn't stored inline
+    QPimDetailFieldMap<QList<QPair<int, QVariant> > > m_extraData;
 
     QContactDetailPrivate()
         : m_type(QContactDetail::TypeUndefined)
         , m_access(QContactDetail::NoConstraint)
-        , m_detailId(lastDetailKey.fetchAndAddOrdered(1))
+        , m_detailId(nextDetailKey())
         , m_hasValueBitfield(0) {}
     QContactDetailPrivate(QContactDetail::DetailType detailType)
         : m_type(detailType)
         , m_access(QContactDetail::NoConstraint)
-        , m_detailId(lastDetailKey.fetchAndAddOrdered(1))
+        , m_detailId(nextDetailKey())
         , m_hasValueBitfield(0) {}
     QContactDetailPrivate(const QContactDetailPrivate& other)
         : QSharedData(other)
@@ -103,6 +113,10 @@ public:
         , m_extraData(other.m_extraData) {}
     virtual ~QContactDetailPrivate() {}
 
+    // bulk operations create and destroy many details, so their privates come from a pool
+    static void *operator new(size_t size) { return QContactDetailPool::allocate(size); }
+    static void operator delete(void *block, size_t size) { QContactDetailPool::deallocate(block, size); }
+
     virtual QContactDetailPrivate *clone() {
         // NOTE: this one must be called for extension (non-built-in) types ONLY
         // otherwise slicing will occur on detach, leading to crashes!
@@ -252,10 +266,9 @@ public:
         if (hasValueBitfieldBitSet(FieldProvenanceBit)) {
             retn.insert(QContactDetail::FieldProvenance, QVariant::fromValue<QString>(m_provenance));
         }
-        QMap<int, QVariant>::const_iterator it = m_extraData.constBegin(), end = m_extraData.constEnd();
-        for ( ; it != end; ++it) {
-            if (it.key() <= QContactDetail::FieldMaximumUserVisible) {
-                retn.insert(it.key(), it.value());
+        for (int i = 0; i < m_extraData.size(); ++i) {
+            if (m_extraData.keyAt(i) <= QContactDetail::FieldMaximumUserVisible) {
+                retn.insert(m_extraData.keyAt(i), m_extraData.valueAt(i));
             }
         }
         return retn;
@@ -71,12 +71,16 @@ QT_BEGIN_NAMESPACE_CONTACTS
 
 // TODO: Document and remove internal once the correct signature has been determined
 /*!
-    \fn QContactId::QContactId(const QString &managerUri, const QByteArray &localId)
     \internal
 
     Constructs an ID from the supplied manager URI \a managerUri and the engine
     specific \a localId value.
 */
+QContactId::QContactId(const QString &managerUri, const QByteArray &localId)
+    : m_managerUriHandle(localId.isEmpty() ? 0 : QContactManagerData::uriHandle(managerUri)),
+      m_localId(m_managerUriHandle == 0 ? QByteArray() : localId)
+{
+}
 
 /*!
     \fn bool QContactId::operator==(const QContactId &other) const
@@ -93,7 +97,6 @@ QT_BEGIN_NAMESPACE_CONTACTS
 */
 
 /*!
-    \fn bool operator<(const QContactId &id1, const QContactId &id2)
     \relates QContactId
 
     Returns true if the contact ID \a id1 will be considered less than
@@ -107,6 +110,12 @@ QT_BEGIN_NAMESPACE_CONTACTS
 
     This operator is provided primarily to allow use of a QContactId as a key in a QMap.
 */
+bool operator<(const QContactId &id1, const QContactId &id2)
+{
+    if (id1.m_managerUriHandle == id2.m_managerUriHandle)
+        return id1.m_localId < id2.m_localId;
+    return id1.managerUri() < id2.managerUri();
+}
 
 /*!
     \fn size_t qHash(const QContactId &id)
@@ -135,12 +144,14 @@ QT_BEGIN_NAMESPACE_CONTACTS
 */
 
 /*!
-    \fn QString QContactId::managerUri() const
-
     Returns the URI of the manager which contains the contact identified by this ID.
 
     \sa localId()
 */
+QString QContactId::managerUri() const
+{
+    return QContactManagerData::uriForHandle(m_managerUriHandle);
+}
 
 /*!
     \fn QByteArray QContactId::localId() const
@@ -162,7 +173,7 @@ QString QContactId::toString() const
     if (!isNull()) {
         // Ensure the localId component has a valid string representation by hex encoding
         const QByteArray encodedLocalId(m_localId.toHex());
-        return QString::fromUtf8(QContactManagerData::buildIdData(m_managerUri, encodedLocalId));
+        return QString::fromUtf8(QContactManagerData::buildIdData(m_managerUriHandle, encodedLocalId));
     }
 
     return QString();
@@ -195,7 +206,7 @@ QContactId QContactId::fromString(const QString &idString)
 QByteArray QContactId::toByteArray() const
 {
     if (!isNull())
-        return QContactManagerData::buildIdData(m_managerUri, m_localId);
+        return QContactManagerData::buildIdData(m_managerUriHandle, m_localId);
 
     return QByteArray();
 }
@@ -51,21 +51,18 @@ class QContactManagerEngine;
 class Q_CONTACTS_EXPORT QContactId
 {
 public:
-    inline QContactId() {}
-    inline QContactId(const QString &_managerUri, const QByteArray &_localId)
-        : m_managerUri(_localId.isEmpty() ? QString() : _managerUri),
-          m_localId(m_managerUri.isEmpty() ? QByteArray() : _localId)
-    {}
+    inline QContactId() : m_managerUriHandle(0) {}
+    QContactId(const QString &managerUri, const QByteArray &localId);
     // compiler-generated dtor and copy/move ctors/assignment operators are fine!
 
     inline bool operator==(const QContactId &other) const
-    { return localId() == other.localId() && managerUri() == other.managerUri(); }
+    { return m_managerUriHandle == other.m_managerUriHandle && m_localId == other.m_localId; }
     inline bool operator!=(const QContactId &other) const
     { return !operator==(other); }
 
     inline bool isNull() const { return m_localId.isEmpty(); }
 
-    inline QString managerUri() const { return m_managerUri; }
+    QString managerUri() const;
     inline QByteArray localId() const { return m_localId; }
 
     QString toString() const;
@@ -75,12 +72,13 @@ public:
     static QContactId fromByteArray(const QByteArray &idData);
 
 private:
-    QString m_managerUri;
+    friend Q_CONTACTS_EXPORT bool operator<(const QContactId &id1, const QContactId &id2);
+
+    int m_managerUriHandle; // handle of the manager URI, which is stored once per process
     QByteArray m_localId;
 };
 
-inline bool operator<(const QContactId &id1, const QContactId &id2)
-{ return id1.managerUri() != id2.managerUri() ? id1.managerUri() < id2.managerUri() : id1.localId() < id2.localId(); }
+Q_CONTACTS_EXPORT bool operator<(const QContactId &id1, const QContactId &id2);
 
 inline size_t qHash(const QContactId &id)
 { return qHash(id.localId()); }
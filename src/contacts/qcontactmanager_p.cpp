@@ -58,6 +58,7 @@
 
 #include "qcontactinvalidbackend_p.h"
 #include "qcontactspluginsearch_p.h"
+#include "qpimmanageruriregistry_p.h"
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
@@ -537,6 +538,11 @@ QByteArray QContactManagerData::buildIdData(const QString &managerName, const QM
     return buildIdData(buildUri(managerName, params), localId);
 }
 
+namespace {
+struct QContactManagerUriRegistryTraits {};
+}
+typedef QPimManagerUriRegistry<QContactManagerUriRegistryTraits> QContactManagerUriRegistry;
+
 /*!
     Returns a cached instance of the manager URI string that matches \a managerUri.
     This instance should be preferred when constructing ID objects in order to promote
@@ -544,14 +550,35 @@ QByteArray QContactManagerData::buildIdData(const QString &managerName, const QM
 */
 QString QContactManagerData::cachedUri(const QString &managerUri)
 {
-    static QStringList managerUris;
+    return QContactManagerUriRegistry::uri(QContactManagerUriRegistry::handle(managerUri));
+}
 
-    int index = managerUris.indexOf(managerUri);
-    if (index != -1)
-        return managerUris.at(index);
+/*!
+    Returns the handle of \a managerUri in the registry of manager URIs, registering it
+    first if necessary.  Two URIs have the same handle only if they are equal, so IDs
+    store the handle and compare it instead of the URI string.  The empty URI has handle 0.
+*/
+int QContactManagerData::uriHandle(const QString &managerUri)
+{
+    return QContactManagerUriRegistry::handle(managerUri);
+}
 
-    managerUris.append(managerUri);
-    return managerUri;
+/*!
+    Returns the manager URI registered with \a handle by uriHandle().
+*/
+QString QContactManagerData::uriForHandle(int handle)
+{
+    return QContactManagerUriRegistry::uri(handle);
+}
+
+/*!
+    Returns the ID string for \a localId in the manager whose URI is registered with
+    \a uriHandle.  This is the same as buildIdData(uriForHandle(uriHandle), localId)
+    for a non-empty \a localId, but reuses the encoded URI of the registry.
+*/
+QByteArray QContactManagerData::buildIdData(int uriHandle, const QByteArray &localId)
+{
+    return QContactManagerUriRegistry::idData(uriHandle, escapeColon(localId));
 }
 
 QT_END_NAMESPACE_CONTACTS
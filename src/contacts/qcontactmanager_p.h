@@ -92,6 +92,9 @@ public:
     static QByteArray buildIdData(const QString &managerName, const QMap<QString, QString> &params, const QByteArray &localId = QByteArray());
 
     static QString cachedUri(const QString &managerUri);
+    static int uriHandle(const QString &managerUri);
+    static QString uriForHandle(int handle);
+    static QByteArray buildIdData(int uriHandle, const QByteArray &localId);
 
     void createEngine(const QString &managerName, const QMap<QString, QString> &parameters);
     static QContactManagerData* get(const QContactManager *manager);
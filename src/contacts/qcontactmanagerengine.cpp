@@ -39,9 +39,13 @@
 
 #include "qcontactmanagerengine.h"
 
+#include <QtCore/qbitarray.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qpointer.h>
+#include <QtCore/qreadwritelock.h>
 #include <QtCore/qset.h>
+#include <QtCore/qshareddata.h>
 
 #include "qcontact_p.h"
 #include "qcontactdetail_p.h"
@@ -767,6 +771,116 @@ QList<QContactDetail::DetailType> QContactManagerEngine::supportedContactDetailT
     return supportedDetails;
 }
 
+template <typename T>
+static QBitArray schemaBits(const QList<T> &types)
+{
+    int size = 1;
+    foreach (T type, types)
+        size = qMax(size, int(type) + 1);
+
+    QBitArray bits(size);
+    foreach (T type, types) {
+        if (int(type) >= 0)
+            bits.setBit(int(type));
+    }
+    return bits;
+}
+
+static inline bool schemaContains(const QBitArray &bits, int type)
+{
+    return type >= 0 && type < bits.size() && bits.testBit(type);
+}
+
+/*
+  The schema of each engine, as bits indexed by type.  It is kept beside
+  the engines, rather than in them, so that QContactManagerEngine keeps its
+  layout.  Engines validate contacts from several threads, and nearly every
+  validation finds the schema already read, so the table is guarded by a
+  read-write lock and a schema is handed out as a shared, immutable snapshot.
+ */
+struct QContactEngineSchema : public QSharedData
+{
+    QBitArray contactTypes;  // supportedContactTypes()
+    QBitArray detailTypes;   // supportedContactDetailTypes()
+};
+
+struct QContactEngineSchemaEntry
+{
+    QContactEngineSchemaEntry() : generation(0), watched(false) {}
+
+    QExplicitlySharedDataPointer<const QContactEngineSchema> schema; // null until read
+    uint generation;    // bumped by invalidateSchema()
+    bool watched;       // the entry is removed when the engine is destroyed
+};
+
+struct QContactEngineSchemaTable
+{
+    QReadWriteLock lock;
+    QHash<const QContactManagerEngine *, QContactEngineSchemaEntry> entries;
+};
+
+Q_GLOBAL_STATIC(QContactEngineSchemaTable, engineSchemaTable)
+
+/*
+  Returns the entry of \a engine, creating it if necessary.  The table's lock
+  must be held for writing.
+ */
+static QContactEngineSchemaEntry &engineSchemaEntry(QContactEngineSchemaTable *table, const QContactManagerEngine *engine)
+{
+    QContactEngineSchemaEntry &entry = table->entries[engine];
+    if (!entry.watched) {
+        // forget the schema when the engine goes away, so that a new engine at the same address reads its own
+        entry.watched = true;
+        QObject::connect(engine, &QObject::destroyed, [engine]() {
+            if (QContactEngineSchemaTable *table = engineSchemaTable()) {
+                QWriteLocker locker(&table->lock);
+                table->entries.remove(engine);
+            }
+        });
+    }
+    return entry;
+}
+
+/*
+  Returns the schema of \a engine, reading it from the engine the first time
+  and after invalidateSchema().  The engine is called without the lock held,
+  since its schema functions may themselves use other engines.  The result is
+  only recorded if invalidateSchema() has not been called meanwhile, so a
+  schema read before an invalidation can't replace the one read after it.
+ */
+static QExplicitlySharedDataPointer<const QContactEngineSchema> engineSchema(const QContactManagerEngine *engine)
+{
+    QContactEngineSchemaTable *table = engineSchemaTable();
+    if (!table) // during static destruction
+        return QExplicitlySharedDataPointer<const QContactEngineSchema>(new QContactEngineSchema);
+
+    uint generation = 0;
+    {
+        QReadLocker locker(&table->lock);
+        QHash<const QContactManagerEngine *, QContactEngineSchemaEntry>::const_iterator it = table->entries.constFind(engine);
+        if (it != table->entries.constEnd()) {
+            if (it->schema)
+                return it->schema;
+            generation = it->generation;
+        }
+    }
+
+    QContactEngineSchema *newSchema = new QContactEngineSchema;
+    newSchema->contactTypes = schemaBits(engine->supportedContactTypes());
+    newSchema->detailTypes = schemaBits(engine->supportedContactDetailTypes());
+    QExplicitlySharedDataPointer<const QContactEngineSchema> schema(newSchema);
+
+    QWriteLocker locker(&table->lock);
+    QContactEngineSchemaEntry &entry = engineSchemaEntry(table, engine);
+    if (entry.schema)
+        return entry.schema;
+    // if the schema was invalidated while it was being read, it is used for this
+    // validation only, and the next one reads it again
+    if (entry.generation == generation)
+        entry.schema = schema;
+    return schema;
+}
+
 /*!
   Checks that the given contact \a contact does not have a type which
   is not supported. It also checks if the details of the given
@@ -777,6 +891,10 @@ QList<QContactDetail::DetailType> QContactManagerEngine::supportedContactDetailT
   are observed; backend specific code must be written if you wish to
   enforce these constraints.
 
+  The types returned by supportedContactTypes() and supportedContactDetailTypes()
+  are read when the first contact is validated and then reused.  An engine whose
+  schema changes must call invalidateSchema().
+
   Returns true if the \a contact has a valid type, otherwise returns
   false.
 
@@ -785,7 +903,9 @@ QList<QContactDetail::DetailType> QContactManagerEngine::supportedContactDetailT
  */
 bool QContactManagerEngine::validateContact(const QContact &contact, QContactManager::Error *error) const
 {
-    if (!supportedContactTypes().contains(contact.type())) {
+    const QExplicitlySharedDataPointer<const QContactEngineSchema> schema = engineSchema(this);
+
+    if (!schemaContains(schema->contactTypes, contact.type())) {
         *error = QContactManager::InvalidContactTypeError;
         return false;
     }
@@ -794,11 +914,9 @@ bool QContactManagerEngine::validateContact(const QContact &contact, QContactMan
         return false;
     }
 
-    QList<QContactDetail> contactDetailList = contact.details();
-    for (int i=0; i<contactDetailList.count(); i++)
+    foreach (const QContactDetail &currentDetail, contact.detailView())
     {
-        QContactDetail currentDetail = contactDetailList.value(i);
-        if (!supportedContactDetailTypes().contains(currentDetail.type()))
+        if (!schemaContains(schema->detailTypes, currentDetail.type()))
         {
             *error = QContactManager::InvalidDetailError;
             return false;
@@ -809,6 +927,22 @@ bool QContactManagerEngine::validateContact(const QContact &contact, QContactMan
     return true;
 }
 
+/*!
+  Discards the schema recorded by validateContact(), so that the next contact
+  to be validated reads supportedContactTypes() and supportedContactDetailTypes()
+  again.  Engines whose supported types change after they have validated a
+  contact must call this function.
+ */
+void QContactManagerEngine::invalidateSchema()
+{
+    if (QContactEngineSchemaTable *table = engineSchemaTable()) {
+        QWriteLocker locker(&table->lock);
+        QContactEngineSchemaEntry &entry = engineSchemaEntry(table, this);
+        entry.schema.reset();
+        ++entry.generation;
+    }
+}
+
 /*!
   Sets the access constraints of \a detail to the supplied \a constraints.
 
@@ -1270,7 +1404,7 @@ bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QCont
                     return false;
 
                 /* See if this contact has one of these details in it */
-                const QList<QContactDetail>& details = contact.details(cdf.detailType());
+                const QContactDetailView details = contact.detailView(cdf.detailType());
 
                 if (details.count() == 0)
                     return false; /* can't match */
@@ -1282,6 +1416,7 @@ bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QCont
                 /* Now figure out what tests we are doing */
                 const bool valueTest = cdf.value().isValid();
                 const bool presenceTest = !valueTest;
+                const bool visibleField = cdf.detailField() <= QContactDetail::FieldMaximumUserVisible;
 
                 /* See if we need to test any values at all */
                 if (presenceTest) {
@@ -1289,7 +1424,7 @@ bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QCont
                         const QContactDetail& detail = details.at(j);
 
                         /* Check that the field is present and has a non-empty value */
-                        if (detail.values().contains(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
+                        if (visibleField && detail.hasValue(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
                             return true;
                     }
                     return false;
@@ -1436,7 +1571,7 @@ bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QCont
                     return false; /* we do not know which field to check */
 
                 /* See if this contact has one of these details in it */
-                const QList<QContactDetail>& details = contact.details(cdf.detailType());
+                const QContactDetailView details = contact.detailView(cdf.detailType());
 
                 if (details.count() == 0)
                     return false; /* can't match */
@@ -1447,9 +1582,10 @@ bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QCont
 
                 /* See if this is a field presence test */
                 if (!cdf.minValue().isValid() && !cdf.maxValue().isValid()) {
+                    const bool visibleField = cdf.detailField() <= QContactDetail::FieldMaximumUserVisible;
                     for(int j=0; j < details.count(); j++) {
                         const QContactDetail& detail = details.at(j);
-                        if (detail.values().contains(cdf.detailField()))
+                        if (visibleField && detail.hasValue(cdf.detailField()))
                             return true;
                     }
                     return false;
@@ -1694,8 +1830,8 @@ int QContactManagerEngine::compareContact(const QContact& a, const QContact& b,
         const QContactDetail::DetailType detailType = sortOrder.detailType();
         const int detailField = sortOrder.detailField();
 
-        const QList<QContactDetail> aDetails = a.details(detailType);
-        const QList<QContactDetail> bDetails = b.details(detailType);
+        const QContactDetailView aDetails = a.detailView(detailType);
+        const QContactDetailView bDetails = b.detailView(detailType);
         if (aDetails.isEmpty() && bDetails.isEmpty())
             continue; // use next sort criteria.
 
@@ -1936,6 +2072,50 @@ void QContactManagerEngine::updateContactFetchRequest(QContactFetchRequest* req,
     QMutexLocker ml(&rd->m_mutex);
     bool emitState = rd->m_state != newState;
     rd->m_contacts = result;
+    rd->m_newContactsIndex = 0;
+    rd->m_error = error;
+    rd->m_state = newState;
+    ml.unlock();
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    QPointer<QContactAbstractRequest> guard(req);
+#endif
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#ifdef QT_NO_THREAD
+    if (req->thread() != QThread::currentThread())
+        connectionType = Qt::BlockingQueuedConnection;
+#endif
+    QMetaObject::invokeMethod(req, "resultsAvailable", connectionType);
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+    if (emitState)
+        QMetaObject::invokeMethod(req, "stateChanged", connectionType, Q_ARG(QContactAbstractRequest::State, newState));
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+}
+
+/*!
+  Appends \a newContacts to the results of the given QContactFetchRequest \a req, and updates
+  its operation error to \a error. In addition, the state of the request will be changed to
+  \a newState.
+
+  Unlike updateContactFetchRequest(), which replaces the whole result set, this allows clients
+  to retrieve only the contacts added by this update through QContactFetchRequest::newContacts().
+  Backends delivering partial results should prefer this function.
+
+  It then causes the request to emit its resultsAvailable() signal to notify clients of the request progress.
+
+  If the new request state is different from the previous state, the stateChanged() signal will also be emitted from the request.
+ */
+void QContactManagerEngine::appendContactFetchRequestResults(QContactFetchRequest *req, const QList<QContact> &newContacts, QContactManager::Error error, QContactAbstractRequest::State newState)
+{
+    Q_ASSERT(req);
+    QContactFetchRequestPrivate* rd = static_cast<QContactFetchRequestPrivate*>(req->d_ptr);
+    QMutexLocker ml(&rd->m_mutex);
+    bool emitState = rd->m_state != newState;
+    rd->m_newContactsIndex = rd->m_contacts.size();
+    rd->m_contacts.append(newContacts);
     rd->m_error = error;
     rd->m_state = newState;
     ml.unlock();
@@ -149,6 +149,21 @@ QList<QContact> QContactFetchRequest::contacts() const
     return d->m_contacts;
 }
 
+/*! Returns the contacts which were added to the results by the latest update, that is,
+    since the previous emission of the resultsAvailable() signal.
+
+    If the backend replaced the whole result set instead of appending to it, all contacts
+    are returned, and the size of the returned list equals to the size of contacts().
+
+    \sa QContactManagerEngine::appendContactFetchRequestResults()
+*/
+QList<QContact> QContactFetchRequest::newContacts() const
+{
+    Q_D(const QContactFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_contacts.mid(d->m_newContactsIndex);
+}
+
 QT_END_NAMESPACE_CONTACTS
 
 #include "moc_qcontactfetchrequest.cpp"
@@ -70,6 +70,7 @@ public:
 
     /* Results */
     QList<QContact> contacts() const;
+    QList<QContact> newContacts() const;
 
 private:
     Q_DISABLE_COPY(QContactFetchRequest)
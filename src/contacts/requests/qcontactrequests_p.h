@@ -100,7 +100,8 @@ class QContactFetchRequestPrivate : public QContactAbstractRequestPrivate
 {
 public:
     QContactFetchRequestPrivate()
-        : QContactAbstractRequestPrivate(QContactAbstractRequest::ContactFetchRequest)
+        : QContactAbstractRequestPrivate(QContactAbstractRequest::ContactFetchRequest),
+          m_newContactsIndex(0)
     {
     }
 
@@ -125,6 +126,8 @@ public:
     QContactFetchHint m_fetchHint;
 
     QList<QContact> m_contacts;
+    // index of the first contact added by the latest results update
+    qsizetype m_newContactsIndex;
 };
 
 class QContactFetchByIdRequestPrivate : public QContactAbstractRequestPrivate
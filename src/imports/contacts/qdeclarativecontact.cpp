@@ -101,12 +101,17 @@ static T *list_property_at(QQmlListProperty<T> *property, qsizetype index)
 QDeclarativeContact::QDeclarativeContact(QObject *parent)
     :QObject(parent)
     , m_modified(false)
+    , m_detailsPending(false)
+    , m_summaryValid(false)
 {
     connect(this, SIGNAL(contactChanged()), SLOT(setModified()));
+    connect(this, SIGNAL(contactChanged()), SLOT(invalidateSummary()));
 }
 
 QDeclarativeContact::~QDeclarativeContact()
 {
+    // no need to create detail objects just to delete them
+    m_detailsPending = false;
     clearDetails();
 }
 
@@ -119,7 +124,27 @@ void QDeclarativeContact::setContact(const QContact& contact)
     m_details.clear();
     m_preferredDetails.clear();
 
-    QList<QContactDetail> details(contact.details());
+    // the detail objects are created by ensureDetails() when they are first needed,
+    // which never happens for contacts only displayed through the model roles
+    m_contact = contact;
+    m_detailsPending = true;
+
+    m_modified = false;
+    emit contactChanged();
+}
+
+/*!
+    \internal
+
+    Creates the detail objects of the contact given to setContact().
+ */
+void QDeclarativeContact::ensureDetails()
+{
+    if (!m_detailsPending)
+        return;
+    m_detailsPending = false;
+
+    QList<QContactDetail> details(m_contact.details());
     foreach (const QContactDetail &detail, details) {
         QDeclarativeContactDetail *contactDetail = QDeclarativeContactDetailFactory::createContactDetail(static_cast<QDeclarativeContactDetail::DetailType>(detail.type()));
         contactDetail->setParent(this);
@@ -128,19 +153,27 @@ void QDeclarativeContact::setContact(const QContact& contact)
         m_details.append(contactDetail);
     }
 
-    QMap<QString, QContactDetail> prefDetails(contact.preferredDetails());
+    QMap<QString, QContactDetail> prefDetails(m_contact.preferredDetails());
     QMap<QString, QContactDetail>::const_iterator  it = prefDetails.begin();
     while (it != prefDetails.end()) {
         m_preferredDetails.insert(it.key(), it.value().key());
         it++;
     }
 
-    m_modified = false;
-    emit contactChanged();
+    m_contact = QContact();
 }
 
 QContact QDeclarativeContact::contact() const
 {
+    if (m_detailsPending) {
+        if (m_contact.id() == m_id && m_contact.collectionId() == m_collectionId)
+            return m_contact;
+        QContact contact(m_contact);
+        contact.setId(m_id);
+        contact.setCollectionId(m_collectionId);
+        return contact;
+    }
+
     QContact contact;
     contact.setId(m_id);
     contact.setCollectionId(m_collectionId);
@@ -156,6 +189,28 @@ QContact QDeclarativeContact::contact() const
     return contact;
 }
 
+/*!
+    \internal
+
+    Returns the values shown by the lightweight model roles. They are cached until the contact changes.
+ */
+const QDeclarativeContact::Summary &QDeclarativeContact::summary() const
+{
+    if (!m_summaryValid) {
+        const QContact c = contact();
+        m_summary.displayLabel = c.detail(QContactDetail::TypeDisplayLabel).value(QContactDisplayLabel::FieldLabel).toString();
+        m_summary.phoneNumber = c.detail(QContactDetail::TypePhoneNumber).value(QContactPhoneNumber::FieldNumber).toString();
+        m_summary.avatarUrl = c.detail(QContactDetail::TypeAvatar).value(QContactAvatar::FieldImageUrl).toUrl();
+        m_summaryValid = true;
+    }
+    return m_summary;
+}
+
+void QDeclarativeContact::invalidateSummary()
+{
+    m_summaryValid = false;
+}
+
 /*!
     \qmlproperty bool Contact::modified
 
@@ -185,6 +240,7 @@ void QDeclarativeContact::setModified()
 */
 QDeclarativeContactType::ContactType QDeclarativeContact::type() const
 {
+    const_cast<QDeclarativeContact *>(this)->ensureDetails();
     foreach (QDeclarativeContactDetail *detail, m_details) {
         if (QDeclarativeContactDetail::Type == detail->detailType())
            return static_cast<QDeclarativeContactType *>(detail)->type();
@@ -200,6 +256,7 @@ QDeclarativeContactType::ContactType QDeclarativeContact::type() const
 
 bool QDeclarativeContact::removeDetail(QDeclarativeContactDetail* detail)
 {
+    ensureDetails();
     if (detail) {
         if (!detail->removable())
             return false;
@@ -242,6 +299,7 @@ void QDeclarativeContact::removePreferredDetail(QDeclarativeContactDetail* detai
 */
 bool QDeclarativeContact::addDetail(QDeclarativeContactDetail* detail)
 {
+    ensureDetails();
     if (!detail || m_details.contains(detail))
         return false;
 
@@ -269,6 +327,7 @@ bool QDeclarativeContact::addDetail(QDeclarativeContactDetail* detail)
  */
 bool QDeclarativeContact::setPreferredDetail(const QString& actionName, QDeclarativeContactDetail* detail)
 {
+   ensureDetails();
    if (actionName.isEmpty() || !detail || !m_details.contains(detail))
         return false;
 
@@ -291,6 +350,7 @@ bool QDeclarativeContact::setPreferredDetail(const QString& actionName, QDeclara
  */
 bool QDeclarativeContact::isPreferredDetail(const QString& actionName, QDeclarativeContactDetail* detail) const
 {
+    const_cast<QDeclarativeContact *>(this)->ensureDetails();
     if (actionName.isEmpty() || !detail || !m_details.contains(detail))
          return false;
 
@@ -312,6 +372,7 @@ bool QDeclarativeContact::isPreferredDetail(const QString& actionName, QDeclarat
  */
 QDeclarativeContactDetail* QDeclarativeContact::preferredDetail(const QString& actionName) const
 {
+    const_cast<QDeclarativeContact *>(this)->ensureDetails();
     int id = m_preferredDetails.value(actionName, -1);
     if (id == -1)
         return 0;
@@ -334,6 +395,7 @@ QDeclarativeContactDetail* QDeclarativeContact::preferredDetail(const QString& a
  */
 QVariantMap QDeclarativeContact::preferredDetails() const
 {
+    const_cast<QDeclarativeContact *>(this)->ensureDetails();
     QVariantMap result;
     QMap<QString, int>::const_iterator it = m_preferredDetails.begin();
     while (it != m_preferredDetails.end()) {
@@ -409,6 +471,7 @@ QString QDeclarativeContact::manager() const
 */
 QDeclarativeContactDetail* QDeclarativeContact::detail(int type)
 {
+    ensureDetails();
     foreach (QDeclarativeContactDetail *detail, m_details) {
         if (type == detail->detailType()) {
             return detail;
@@ -424,6 +487,7 @@ QDeclarativeContactDetail* QDeclarativeContact::detail(int type)
 */
 QVariantList QDeclarativeContact::details(int type)
 {
+    ensureDetails();
     QVariantList list;
     foreach (QDeclarativeContactDetail *detail, m_details) {
         if (type == detail->detailType()) {
@@ -440,6 +504,7 @@ QVariantList QDeclarativeContact::details(int type)
 */
 void QDeclarativeContact::clearDetails()
 {
+    ensureDetails();
     if (m_details.isEmpty())
         return;
 
@@ -834,6 +899,7 @@ void QDeclarativeContact::_q_detail_append(QQmlListProperty<QDeclarativeContactD
     QDeclarativeContact *object = qobject_cast<QDeclarativeContact *>(property->object);
     if (object)
     {
+        object->ensureDetails();
         object->m_details.append(value);
         value->connect(value, SIGNAL(valueChanged()), SIGNAL(detailChanged()), Qt::UniqueConnection);
         value->connect(value, SIGNAL(detailChanged()), object, SIGNAL(contactChanged()), Qt::UniqueConnection);
@@ -846,10 +912,12 @@ void QDeclarativeContact::_q_detail_append(QQmlListProperty<QDeclarativeContactD
 QDeclarativeContactDetail *QDeclarativeContact::_q_detail_at(QQmlListProperty<QDeclarativeContactDetail> *property, qsizetype index)
 {
     QDeclarativeContact *object = qobject_cast<QDeclarativeContact *>(property->object);
-    if (object)
+    if (object) {
+        object->ensureDetails();
         return object->m_details.at(index);
-    else
+    } else {
         return 0;
+    }
 }
 
 /*!
@@ -859,6 +927,7 @@ void QDeclarativeContact::_q_detail_clear(QQmlListProperty<QDeclarativeContactDe
 {
     QDeclarativeContact *object = qobject_cast<QDeclarativeContact *>(property->object);
     if (object) {
+        object->ensureDetails();
         foreach (QDeclarativeContactDetail *obj, object->m_details)
             delete obj;
         object->m_details.clear();
@@ -871,10 +940,12 @@ void QDeclarativeContact::_q_detail_clear(QQmlListProperty<QDeclarativeContactDe
 qsizetype QDeclarativeContact::_q_detail_count(QQmlListProperty<QDeclarativeContactDetail> *property)
 {
     QDeclarativeContact *object = qobject_cast<QDeclarativeContact *>(property->object);
-    if (object)
+    if (object) {
+        object->ensureDetails();
         return object->m_details.size();
-    else
+    } else {
         return 0;
+    }
 }
 
 QT_END_NAMESPACE
@@ -40,6 +40,8 @@
 #ifndef QDECLARATIVECONTACT_P_H
 #define QDECLARATIVECONTACT_P_H
 
+#include <QtCore/qurl.h>
+
 #include <QtQml/qqml.h>
 
 #include <QtContacts/qcontact.h>
@@ -109,6 +111,14 @@ public:
     QContact contact() const;
     bool modified() const;
 
+    // non-QML API used by the model roles, computed from the contact without creating detail objects
+    struct Summary {
+        QString displayLabel;
+        QString phoneNumber;
+        QUrl avatarUrl;
+    };
+    const Summary &summary() const;
+
     QDeclarativeContactType::ContactType type() const;
 
     QString contactId() const;
@@ -174,6 +184,11 @@ protected:
     QList<QDeclarativeContactDetail *> m_details;
     QMap<QString, int> m_preferredDetails;
 
+    // detail objects are only created from the contact set by setContact() when first accessed
+    QContact m_contact;
+    bool m_detailsPending;
+    void ensureDetails();
+
 public slots:
     void clearDetails();
     void save();
@@ -184,12 +199,14 @@ Q_SIGNALS:
 
 private slots:
     void setModified();
+    void invalidateSummary();
 
 private:
     Q_DISABLE_COPY(QDeclarativeContact)
 
     template<typename T> T* getDetail(const QDeclarativeContactDetail::DetailType &type)
     {
+        ensureDetails();
         foreach (QDeclarativeContactDetail *detail, m_details) {
             if (type == detail->detailType())
             {
@@ -208,6 +225,9 @@ private:
 
     void removePreferredDetail(QDeclarativeContactDetail *detail);
 
+    mutable Summary m_summary;
+    mutable bool m_summaryValid;
+
     // call-back functions for list property
     static void _q_detail_append(QQmlListProperty<QDeclarativeContactDetail> *property, QDeclarativeContactDetail *value);
     static QDeclarativeContactDetail *_q_detail_at(QQmlListProperty<QDeclarativeContactDetail> *property, qsizetype index);
@@ -43,11 +43,13 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qpointer.h>
+#include <QtCore/qset.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qmimedatabase.h>
 #include <QtCore/qmimetype.h>
 #include <QtCore/qtemporaryfile.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qtimer.h>
 
 #include <QtGui/qcolor.h>
 #include <QtGui/qpixmap.h>
@@ -91,8 +93,12 @@ QT_BEGIN_NAMESPACE
     or alternatively via \l contacts list property. Of the two, the model access is preferred.
     Direct list access (i.e. non-model) is not guaranteed to be in order set by \l sortOrder.
 
-    At the moment the model roles provided by ContactModel are display, decoration and \c contact.
-    Through the \c contact role can access any data provided by the Contact element.
+    At the moment the model roles provided by ContactModel are display, decoration, \c contact,
+    \c phoneNumber and \c avatarUrl. The \c phoneNumber and \c avatarUrl roles hold the first
+    phone number and the avatar image URL of the contact; delegates which only need these values
+    should prefer them over the \c contact role, since they do not require the contact details to
+    be created as QML objects. Through the \c contact role can access any data provided by the
+    Contact element.
 
     \sa RelationshipModel, Contact, {QContactManager}
 */
@@ -166,6 +172,12 @@ public:
     QStringList m_files;
 };
 
+// Number of fetched contacts inserted into the model per event loop iteration while loading progressively
+static const int INCOMING_CONTACTS_BATCH_SIZE = 200;
+
+// Number of parsed vCards the reader may hold before it waits for the model to import them
+static const int MAX_BUFFERED_IMPORT_DOCUMENTS = 200;
+
 
 class QDeclarativeContactModelPrivate
 {
@@ -178,7 +190,10 @@ public:
         m_autoUpdate(true),
         m_componentCompleted(false),
         m_progressiveLoading(true),
-        m_updatePendingFlag(QDeclarativeContactModelPrivate::NonePending)
+        m_updatePendingFlag(QDeclarativeContactModelPrivate::NonePending),
+        m_fetchedContactCount(0),
+        m_incomingContactsHead(0),
+        m_changeFetchRequest(0)
     {
     }
     ~QDeclarativeContactModelPrivate()
@@ -204,6 +219,8 @@ public:
     QVersitReader m_reader;
     QVersitWriter m_writer;
     QStringList m_importProfiles;
+    // ids of the contacts saved so far by the import in progress
+    QStringList m_importedIds;
     ContactExporterResourceHandler m_resourceHandler;
 
     QContactManager::Error m_error;
@@ -219,6 +236,21 @@ public:
     QList<QDeclarativeContactCollection*> m_collections;
     bool m_progressiveLoading;
     int m_updatePendingFlag;
+    // number of contacts already taken from the results of the pending fetch request
+    qsizetype m_fetchedContactCount;
+    // contacts received while loading progressively, waiting to be inserted into the model
+    // from m_incomingContactsHead on
+    QList<QContact> m_incomingContacts;
+    qsizetype m_incomingContactsHead;
+    QTimer m_incomingContactsTimer;
+    // backend change notifications collected during the autoUpdateInterval window,
+    // an id is only ever in one of the sets as the last notification wins
+    QSet<QContactId> m_queuedFetchIds;
+    QSet<QContactId> m_queuedRemovedIds;
+    QTimer m_queuedChangesTimer;
+    // the fetch request started for the previous window and the ids it was started for
+    QContactFetchRequest *m_changeFetchRequest;
+    QSet<QContactId> m_changeFetchIds;
 };
 
 QDeclarativeContactModel::QDeclarativeContactModel(QObject *parent) :
@@ -231,8 +263,18 @@ QDeclarativeContactModel::QDeclarativeContactModel(QObject *parent) :
     connect(this, SIGNAL(sortOrdersChanged()), SLOT(doContactUpdate()));
 
     //import vcard
+    d->m_reader.setMaxBufferedResults(MAX_BUFFERED_IMPORT_DOCUMENTS);
+    connect(&d->m_reader, SIGNAL(resultsAvailable()), this, SLOT(importAvailableDocuments()));
     connect(&d->m_reader, SIGNAL(stateChanged(QVersitReader::State)), this, SLOT(startImport(QVersitReader::State)));
     connect(&d->m_writer, SIGNAL(stateChanged(QVersitWriter::State)), this, SLOT(contactsExported(QVersitWriter::State)));
+
+    d->m_incomingContactsTimer.setSingleShot(true);
+    d->m_incomingContactsTimer.setInterval(0);
+    connect(&d->m_incomingContactsTimer, SIGNAL(timeout()), this, SLOT(processIncomingContacts()));
+
+    d->m_queuedChangesTimer.setSingleShot(true);
+    d->m_queuedChangesTimer.setInterval(0);
+    connect(&d->m_queuedChangesTimer, SIGNAL(timeout()), this, SLOT(processQueuedChanges()));
 }
 
 QDeclarativeContactModel::~QDeclarativeContactModel()
@@ -243,6 +285,8 @@ QHash<int, QByteArray> QDeclarativeContactModel::roleNames() const
 {
     QHash<int, QByteArray> roleNames = QAbstractItemModel::roleNames();
     roleNames.insert(ContactRole, "contact");
+    roleNames.insert(PhoneNumberRole, "phoneNumber");
+    roleNames.insert(AvatarUrlRole, "avatarUrl");
     return roleNames;
 }
 
@@ -306,6 +350,8 @@ void QDeclarativeContactModel::setAutoUpdate(bool autoUpdate)
     if (autoUpdate == d->m_autoUpdate)
         return;
     d->m_autoUpdate = autoUpdate;
+    if (!autoUpdate)
+        clearQueuedChanges();
     emit autoUpdateChanged();
 }
 
@@ -314,6 +360,34 @@ bool QDeclarativeContactModel::autoUpdate() const
     return d->m_autoUpdate;
 }
 
+/*!
+  \qmlproperty int ContactModel::autoUpdateInterval
+
+  This property holds the time in milliseconds during which the contacts added, changed or removed
+  in the backend are collected before the model is updated, default value is 0.
+
+  All notifications received during the interval are merged, so that only the last change of each
+  contact is applied and the added and changed contacts are fetched with a single request. With the
+  default value only the notifications received during the same event loop iteration are merged.
+  A larger value reduces the work done by the model when the backend reports many small changes,
+  for example while synchronizing an account, at the cost of a longer delay before they are shown.
+
+  \sa ContactModel::autoUpdate
+  */
+void QDeclarativeContactModel::setAutoUpdateInterval(int interval)
+{
+    interval = qMax(0, interval);
+    if (interval == d->m_queuedChangesTimer.interval())
+        return;
+    d->m_queuedChangesTimer.setInterval(interval);
+    emit autoUpdateIntervalChanged();
+}
+
+int QDeclarativeContactModel::autoUpdateInterval() const
+{
+    return d->m_queuedChangesTimer.interval();
+}
+
 void QDeclarativeContactModel::update()
 {
     if (!d->m_componentCompleted || d->m_updatePendingFlag)
@@ -375,6 +449,7 @@ void QDeclarativeContactModel::cancelUpdate()
     }
     d->m_pendingRequests.clear();;
     d->m_updatePendingFlag = QDeclarativeContactModelPrivate::NonePending;
+    clearQueuedChanges();
 }
 
 void QDeclarativeContactModel::doContactUpdate()
@@ -474,6 +549,9 @@ static QString urlToLocalFileName(const QUrl& url)
   can be seen on \a error which is defined in \l ContactModel::ImportError. \a url indicates the
   file, which was imported. \a ids contains the imported contacts ids.
 
+  Contacts are saved to the backend in batches while the file is being read, so \a ids may be
+  non-empty even if the operation failed part way through.
+
   If the operation was successful, contacts are now imported to backend. If \l ContactModel::autoUpdate
   is enabled, \l ContactModel::modelChanged will be emitted when imported contacts are also visible on
   \l ContactModel's data model.
@@ -505,6 +583,7 @@ void QDeclarativeContactModel::importContacts(const QUrl& url, const QStringList
     if (d->m_reader.state() != QVersitReader::ActiveState) {
 
         d->m_importProfiles = profiles;
+        d->m_importedIds.clear();
 
         //TODO: need to allow download vcard from network
         QFile*  file = new QFile(urlToLocalFileName(url));
@@ -721,30 +800,45 @@ QQmlListProperty<QDeclarativeContactSortOrder> QDeclarativeContactModel::sortOrd
 void QDeclarativeContactModel::startImport(QVersitReader::State state)
 {
     if (state == QVersitReader::FinishedState || state == QVersitReader::CanceledState) {
-        QVersitContactImporter importer(d->m_importProfiles);
-        importer.setResourceHandler(&d->m_resourceHandler);
-        importer.importDocuments(d->m_reader.results());
-        QList<QContact> contacts = importer.contacts();
+        importAvailableDocuments();
 
         delete d->m_reader.device();
         d->m_reader.setDevice(0);
 
-        QStringList ids;
+        QStringList ids = d->m_importedIds;
+        d->m_importedIds.clear();
+        emit importCompleted(QDeclarativeContactModel::ImportError(d->m_reader.error()), d->m_lastImportUrl, ids);
+    }
+}
 
-        if (d->m_manager) {
-            if (!d->m_manager->saveContacts(&contacts)) {
-                if (d->m_error != d->m_manager->error()) {
-                    d->m_error = d->m_manager->error();
-                    emit errorChanged();
-                }
-            } else {
-                foreach (const QContact &c, contacts) {
-                    ids << c.id().toString();
-                }
+/*!
+  \internal
+
+  Converts the vCards parsed so far by the reader into contacts and saves them, so that the reader
+  never has to hold the whole file in memory.
+ */
+void QDeclarativeContactModel::importAvailableDocuments()
+{
+    QList<QVersitDocument> documents = d->m_reader.takeResults();
+    if (documents.isEmpty())
+        return;
+
+    QVersitContactImporter importer(d->m_importProfiles);
+    importer.setResourceHandler(&d->m_resourceHandler);
+    importer.importDocuments(documents);
+    QList<QContact> contacts = importer.contacts();
+
+    if (d->m_manager) {
+        if (!d->m_manager->saveContacts(&contacts)) {
+            if (d->m_error != d->m_manager->error()) {
+                d->m_error = d->m_manager->error();
+                emit errorChanged();
+            }
+        } else {
+            foreach (const QContact &c, contacts) {
+                d->m_importedIds << c.id().toString();
             }
         }
-
-        emit importCompleted(QDeclarativeContactModel::ImportError(d->m_reader.error()), d->m_lastImportUrl, ids);
     }
 }
 
@@ -949,6 +1043,9 @@ void QDeclarativeContactModel::clearContacts()
     d->m_contactMap.clear();
     qDeleteAll(d->m_contactFetchedMap.values());
     d->m_contactFetchedMap.clear();
+    d->m_incomingContacts.clear();
+    d->m_incomingContactsHead = 0;
+    d->m_incomingContactsTimer.stop();
 }
 
 void QDeclarativeContactModel::fetchAgain()
@@ -983,6 +1080,12 @@ void QDeclarativeContactModel::fetchAgain()
     d->m_pendingContacts.clear();
     d->m_pendingRequests.clear();
     d->m_pendingRequests.append(fetchRequest);
+    d->m_fetchedContactCount = 0;
+    d->m_incomingContacts.clear();
+    d->m_incomingContactsHead = 0;
+    d->m_incomingContactsTimer.stop();
+    // the new request fetches the current state of all contacts
+    clearQueuedChanges();
 
     // if we have no contacts yet, we can display results as soon as they arrive
     // but if we are updating the model after a sort or filter change, we have to
@@ -997,34 +1100,23 @@ void QDeclarativeContactModel::requestUpdated()
 
     QContactFetchRequest* req = qobject_cast<QContactFetchRequest*>(QObject::sender());
     Q_ASSERT(req);
-    if (req) {
-        QList<QContact> contacts = req->contacts();
+    if (req && d->m_pendingRequests.contains(req)) {
+        // only handle the contacts added since the previous results.  Backends that report
+        // partial results with updateContactFetchRequest() pass the whole list each time, so
+        // newContacts() can't be relied on; results shorter than before replace the old ones.
+        const QList<QContact> results = req->contacts();
+        const bool resultsReplaced = results.size() < d->m_fetchedContactCount;
+        const QList<QContact> contacts = resultsReplaced ? results : results.mid(d->m_fetchedContactCount);
+        d->m_fetchedContactCount = results.size();
 
         // if we are starting from scratch, we can show contact results as they arrive
         if (d->m_progressiveLoading) {
-            QList<QDeclarativeContact*> dcs;
-            foreach (const QContact &c, contacts) {
-                if (d->m_contactMap.contains(c.id())) {
-                    QDeclarativeContact* dc = d->m_contactMap.value(c.id());
-                    dc->setContact(c);
-                } else {
-                    QDeclarativeContact* dc = new QDeclarativeContact(this);
-                    if (dc) {
-                        d->m_contactMap.insert(c.id(), dc);
-                        dc->setContact(c);
-                        dcs.append(dc);
-                    }
-                }
-            }
-
-            if (dcs.count() > 0) {
-                beginInsertRows(QModelIndex(), d->m_contacts.count(), d->m_contacts.count() + dcs.count() - 1);
-                // At this point we need to relay on the backend and assume that the partial results are following the fetch sorting property
-                d->m_contacts += dcs;
-                endInsertRows();
-
-                emit contactsChanged();
-            }
+            // contacts already in the model or in the queue are updated in place
+            d->m_incomingContacts << contacts;
+            if (!d->m_incomingContactsTimer.isActive())
+                d->m_incomingContactsTimer.start();
+        } else if (resultsReplaced) {
+            d->m_pendingContacts = contacts;
         } else {
             d->m_pendingContacts << contacts;
         }
@@ -1033,6 +1125,49 @@ void QDeclarativeContactModel::requestUpdated()
     }
 }
 
+/*!
+    \internal
+
+    Inserts the next batch of progressively loaded contacts into the model, and schedules
+    the following one, so that loading a large number of contacts does not block the UI.
+ */
+void QDeclarativeContactModel::processIncomingContacts()
+{
+    const qsizetype end = qMin<qsizetype>(d->m_incomingContacts.size(),
+                                          d->m_incomingContactsHead + INCOMING_CONTACTS_BATCH_SIZE);
+    QList<QDeclarativeContact*> dcs;
+    for (qsizetype i = d->m_incomingContactsHead; i < end; ++i) {
+        const QContact &c = d->m_incomingContacts.at(i);
+        QDeclarativeContact* dc = d->m_contactMap.value(c.id());
+        if (dc) {
+            dc->setContact(c);
+        } else {
+            dc = new QDeclarativeContact(this);
+            d->m_contactMap.insert(c.id(), dc);
+            dc->setContact(c);
+            dcs.append(dc);
+        }
+    }
+    // the queue is only freed once it has been drained, rather than erasing each batch
+    d->m_incomingContactsHead = end;
+    if (d->m_incomingContactsHead == d->m_incomingContacts.size()) {
+        d->m_incomingContacts.clear();
+        d->m_incomingContactsHead = 0;
+    }
+
+    if (dcs.count() > 0) {
+        beginInsertRows(QModelIndex(), d->m_contacts.count(), d->m_contacts.count() + dcs.count() - 1);
+        // At this point we need to relay on the backend and assume that the partial results are following the fetch sorting property
+        d->m_contacts += dcs;
+        endInsertRows();
+
+        emit contactsChanged();
+    }
+
+    if (!d->m_incomingContacts.isEmpty())
+        d->m_incomingContactsTimer.start();
+}
+
 void QDeclarativeContactModel::fetchRequestStateChanged(QContactAbstractRequest::State newState)
 {
     if (newState != QContactAbstractRequest::FinishedState)
@@ -1192,12 +1327,15 @@ void QDeclarativeContactModel::updateError(QContactManager::Error error)
 
 void QDeclarativeContactModel::onContactsAdded(const QList<QContactId>& ids)
 {
-    if (d->m_autoUpdate && !ids.isEmpty()) {
-        QContactFetchRequest *fetchRequest = createContactFetchRequest(ids);
-        connect(fetchRequest,SIGNAL(stateChanged(QContactAbstractRequest::State)),
-                this, SLOT(onContactsAddedFetchRequestStateChanged(QContactAbstractRequest::State)));
-        fetchRequest->start();
+    if (!d->m_autoUpdate || ids.isEmpty())
+        return;
+
+    foreach (const QContactId &id, ids) {
+        d->m_queuedRemovedIds.remove(id);
+        d->m_queuedFetchIds.insert(id);
     }
+    if (!d->m_queuedChangesTimer.isActive())
+        d->m_queuedChangesTimer.start();
 }
 
 /*!
@@ -1240,9 +1378,88 @@ void QDeclarativeContactModel::removeContacts(const QStringList &ids)
 
 void QDeclarativeContactModel::onContactsRemoved(const QList<QContactId> &ids)
 {
-    if (!d->m_autoUpdate)
+    if (!d->m_autoUpdate || ids.isEmpty())
+        return;
+
+    foreach (const QContactId &id, ids) {
+        d->m_queuedFetchIds.remove(id);
+        d->m_queuedRemovedIds.insert(id);
+        d->m_changeFetchIds.remove(id);
+    }
+    if (!d->m_queuedChangesTimer.isActive())
+        d->m_queuedChangesTimer.start();
+}
+
+void QDeclarativeContactModel::onContactsChanged(const QList<QContactId> &ids)
+{
+    onContactsAdded(ids);
+}
+
+/*!
+    \internal
+
+    Applies the backend changes collected since the previous call: removed contacts are taken out
+    of the model and the added and changed contacts are fetched with one request.
+ */
+void QDeclarativeContactModel::processQueuedChanges()
+{
+    if (!d->m_autoUpdate || !d->m_manager)
         return;
 
+    if (!d->m_queuedRemovedIds.isEmpty()) {
+        const QList<QContactId> removedIds(d->m_queuedRemovedIds.constBegin(), d->m_queuedRemovedIds.constEnd());
+        d->m_queuedRemovedIds.clear();
+        removeContactsFromModel(removedIds);
+    }
+
+    // The request of a previous window is still running. Cancelling it would keep the model
+    // from ever being updated while the backend reports changes faster than it fetches them,
+    // so the contacts stay queued and are fetched once it has finished.
+    if (d->m_queuedFetchIds.isEmpty() || d->m_changeFetchRequest)
+        return;
+
+    const QList<QContactId> ids(d->m_queuedFetchIds.constBegin(), d->m_queuedFetchIds.constEnd());
+    d->m_changeFetchIds = d->m_queuedFetchIds;
+    d->m_queuedFetchIds.clear();
+
+    d->m_changeFetchRequest = createContactFetchRequest(ids);
+    connect(d->m_changeFetchRequest, SIGNAL(stateChanged(QContactAbstractRequest::State)),
+            this, SLOT(onContactsChangedFetchRequestStateChanged(QContactAbstractRequest::State)));
+    d->m_changeFetchRequest->start();
+
+    // If any contact in the fetchedList has changed we need to update it.
+    // We need a different query because feched contacts could not be part of the model.
+    //
+    // For example: if the model contains a filter
+    QStringList pendingFetch;
+    foreach (const QContactId &id, ids) {
+        QDeclarativeContact* dc = d->m_contactFetchedMap.value(id);
+        if (dc)
+            pendingFetch << dc->contactId();
+    }
+    if (!pendingFetch.isEmpty())
+        fetchContacts(pendingFetch);
+}
+
+/*!
+    \internal
+ */
+void QDeclarativeContactModel::removeContactsFromModel(const QList<QContactId> &ids)
+{
+    // removed contacts must not be inserted by a pending progressive load either
+    if (!d->m_incomingContacts.isEmpty()) {
+        const QSet<QContactId> removedIds(ids.constBegin(), ids.constEnd());
+        QList<QContact> incomingContacts;
+        incomingContacts.reserve(d->m_incomingContacts.size() - d->m_incomingContactsHead);
+        for (qsizetype i = d->m_incomingContactsHead; i < d->m_incomingContacts.size(); ++i) {
+            const QContact &c = d->m_incomingContacts.at(i);
+            if (!removedIds.contains(c.id()))
+                incomingContacts.append(c);
+        }
+        d->m_incomingContacts = incomingContacts;
+        d->m_incomingContactsHead = 0;
+    }
+
     bool emitSignal = false;
     foreach (const QContactId &id, ids) {
         // delete the contact from fetched map if necessary
@@ -1272,29 +1489,22 @@ void QDeclarativeContactModel::onContactsRemoved(const QList<QContactId> &ids)
         emit contactsChanged();
 }
 
-void QDeclarativeContactModel::onContactsChanged(const QList<QContactId> &ids)
-{
-    if (d->m_autoUpdate && !ids.isEmpty()) {
-        QContactFetchRequest *fetchRequest = createContactFetchRequest(ids);
-        connect(fetchRequest, SIGNAL(stateChanged(QContactAbstractRequest::State)),
-                this, SLOT(onContactsChangedFetchRequestStateChanged(QContactAbstractRequest::State)));
-        fetchRequest->start();
-    }
+/*!
+    \internal
 
-    // If any contact in the fetchedList has changed we need to update it.
-    // We need a different query because feched contacts could not be part of the model.
-    //
-    // For example: if the model contains a filter
-    if (!ids.isEmpty()) {
-        QStringList pendingFetch;
-        foreach (const QContactId &id, ids) {
-            QDeclarativeContact* dc = d->m_contactFetchedMap.value(id);
-            if (dc)
-                pendingFetch << dc->contactId();
-        }
-        if (!pendingFetch.isEmpty())
-            fetchContacts(pendingFetch);
+    Drops the collected backend changes, e.g. when a full update makes them redundant.
+ */
+void QDeclarativeContactModel::clearQueuedChanges()
+{
+    d->m_queuedChangesTimer.stop();
+    d->m_queuedFetchIds.clear();
+    d->m_queuedRemovedIds.clear();
+    if (d->m_changeFetchRequest) {
+        d->m_changeFetchRequest->cancel();
+        d->m_changeFetchRequest->deleteLater();
+        d->m_changeFetchRequest = 0;
     }
+    d->m_changeFetchIds.clear();
 }
 
 QContactFetchRequest *QDeclarativeContactModel::createContactFetchRequest(const QList<QContactId> &ids)
@@ -1324,15 +1534,18 @@ QVariant QDeclarativeContactModel::data(const QModelIndex &index, int role) cons
 
     QDeclarativeContact* dc = d->m_contacts.value(index.row());
     Q_ASSERT(dc);
-    QContact c = dc->contact();
 
     switch(role) {
         case Qt::DisplayRole:
-             return c.detail(QContactDetail::TypeDisplayLabel).value(QContactDisplayLabel::FieldLabel);
+             return dc->summary().displayLabel;
         case Qt::DecorationRole:
             return QPixmap();
         case ContactRole:
             return QVariant::fromValue(dc);
+        case PhoneNumberRole:
+            return dc->summary().phoneNumber;
+        case AvatarUrlRole:
+            return dc->summary().avatarUrl;
     }
     return QVariant();
 }
@@ -1417,55 +1630,7 @@ QDeclarativeContactCollection *QDeclarativeContactModel::collection_at(QQmlListP
 /*!
     \internal
 
-    It's invoked by the fetch request from onContactsAdded().
- */
-void QDeclarativeContactModel::onContactsAddedFetchRequestStateChanged(QContactAbstractRequest::State state)
-{
-
-    if (state != QContactAbstractRequest::FinishedState)
-        return;
-    QContactFetchRequest *request = qobject_cast<QContactFetchRequest *>(sender());
-    Q_ASSERT(request);
-
-    checkError(request);
-
-    if (request->error() == QContactManager::NoError) {
-        QList<QContact> fetchedContacts(request->contacts());
-        bool contactsAdded = false;
-        foreach (const QContact &c,fetchedContacts) {
-            if (d->m_contactMap.contains(c.id())) {
-                qWarning() <<Q_FUNC_INFO <<"contact to be added already exists in the model";
-                continue;
-            }
-            QDeclarativeContact* dc = new QDeclarativeContact(this);
-            dc->setContact(c);
-            int index = contactIndex(dc);
-            beginInsertRows(QModelIndex(), index, index);
-            d->m_contacts.insert(index, dc);
-            d->m_contactMap.insert(c.id(), dc);
-            if (!contactsAdded)
-                contactsAdded = true;
-            endInsertRows();
-        }
-        if (contactsAdded)
-            emit contactsChanged();
-    }
-    request->deleteLater();
-}
-
-
-static bool contactListDoesNotContainContactWithId(const QList<QContact> &contactList, const QContactId &contactId) {
-    foreach (const QContact &contact, contactList) {
-        if (contact.id() == contactId)
-            return false;
-    }
-    return true;
-}
-
-/*!
-    \internal
-
-    It's invoked by the fetch request from onContactsChanged().
+    It's invoked by the fetch request from processQueuedChanges().
  */
 void QDeclarativeContactModel::onContactsChangedFetchRequestStateChanged(QContactAbstractRequest::State state)
 {
@@ -1475,78 +1640,75 @@ void QDeclarativeContactModel::onContactsChangedFetchRequestStateChanged(QContac
     QContactFetchRequest *request = qobject_cast<QContactFetchRequest *>(sender());
     Q_ASSERT(request);
 
+    // results of a request dropped by clearQueuedChanges() are out of date
+    if (request != d->m_changeFetchRequest) {
+        request->deleteLater();
+        return;
+    }
+    d->m_changeFetchRequest = 0;
+    const QSet<QContactId> requestedIds = d->m_changeFetchIds;
+    d->m_changeFetchIds.clear();
+
     checkError(request);
     bool contactsUpdated = false;
     if (request->error() == QContactManager::NoError || request->error() == QContactManager::DoesNotExistError) {
         QList<QContact> fetchedContacts(request->contacts());
-        QList<QContactId> requestedContactIds;
-        //read requested contacts ids from the filter
-        if (request->filter().type() == QContactFilter::IdFilter) {
-            QContactIdFilter idFilter(request->filter());
-            requestedContactIds = idFilter.ids();
-        } else {
-            QContactIntersectionFilter intersectionFilter(request->filter());
-            QContactIdFilter idFilter(intersectionFilter.filters().at(0)); // assuming that id filter is the first filter
-            requestedContactIds = idFilter.ids();
-        }
+        QSet<QContactId> fetchedContactIds;
+        foreach (const QContact &fetchedContact, fetchedContacts)
+            fetchedContactIds.insert(fetchedContact.id());
+
         //handle updated contacts which needs removal from model
         //all contacts requested but not received are removed
-        foreach (const QContactId &id, requestedContactIds) {
-            if (contactListDoesNotContainContactWithId(fetchedContacts, id)) {
-                for (int i=0;i<d->m_contacts.size();++i) {
-                    if (d->m_contacts.at(i)->contactId() == id.toString()) {
-                        beginRemoveRows(QModelIndex(), i, i);
-                        // Remove and delete contact object
-                        QDeclarativeContact* dc = d->m_contacts.takeAt(i);
-                        dc->deleteLater();
-                        d->m_contactMap.remove(id);
-                        endRemoveRows();
-                        contactsUpdated = true;
-                    }
-                }
+        foreach (const QContactId &id, requestedIds) {
+            if (fetchedContactIds.contains(id))
+                continue;
+            QDeclarativeContact *dc = d->m_contactMap.take(id);
+            if (dc) {
+                const int i = d->m_contacts.indexOf(dc);
+                beginRemoveRows(QModelIndex(), i, i);
+                // Remove and delete contact object
+                d->m_contacts.removeAt(i);
+                dc->deleteLater();
+                endRemoveRows();
+                contactsUpdated = true;
             }
         }
         foreach (const QContact &fetchedContact, fetchedContacts) {
-            QString contactIdString(fetchedContact.id().toString());
-            bool fetchedContactFound = false;
-            for (int i = 0; i < d->m_contacts.size(); ++i) {
+            // removed while the request was running
+            if (!requestedIds.contains(fetchedContact.id()))
+                continue;
+            // Added and changed contacts are fetched together, so a contact reported as added
+            // may already be in the model, e.g. when a full update fetched it meanwhile.
+            // It is then updated like a changed one.
+            QDeclarativeContact *dc = d->m_contactMap.value(fetchedContact.id());
+            if (dc) {
                 //handle updated contacts which should be updated in the model
-                if (d->m_contacts.at(i)->contactId() == contactIdString) {
-                    QDeclarativeContact* dc = d->m_contacts.at(i);
-                    dc->setContact(fetchedContact);
-
-                    // Since the contact can change the position due the sort order we need take care of it
-                    // First we need to remove it from previous position and notify the model about that
-                    beginRemoveRows(QModelIndex(), i, i);
-                    d->m_contactMap.remove(fetchedContact.id());
-                    d->m_contacts.removeAt(i);
-                    endRemoveRows();
+                dc->setContact(fetchedContact);
 
-                    // Calculate the new position
-                    int index = contactIndex(dc);
-                    // Notify the model about the new item position
-                    beginInsertRows(QModelIndex(), index, index);
-                    d->m_contacts.insert(index, dc);
-                    d->m_contactMap.insert(fetchedContact.id(),dc);
-                    if (!contactsUpdated)
-                        contactsUpdated = true;
-                    endInsertRows();
+                // Since the contact can change the position due the sort order we need take care of it
+                // First we need to remove it from previous position and notify the model about that
+                const int i = d->m_contacts.indexOf(dc);
+                beginRemoveRows(QModelIndex(), i, i);
+                d->m_contacts.removeAt(i);
+                endRemoveRows();
 
-                    fetchedContactFound = true;
-                    break;
-                }
-            }
-            //handle updated contacts which needs to be added in the model
-            if (!fetchedContactFound) {
-                QDeclarativeContact* dc = new QDeclarativeContact(this);
+                // Calculate the new position
+                int index = contactIndex(dc);
+                // Notify the model about the new item position
+                beginInsertRows(QModelIndex(), index, index);
+                d->m_contacts.insert(index, dc);
+                endInsertRows();
+            } else {
+                //handle updated contacts which needs to be added in the model
+                dc = new QDeclarativeContact(this);
                 dc->setContact(fetchedContact);
                 int index = contactIndex(dc);
                 beginInsertRows(QModelIndex(), index, index);
                 d->m_contacts.insert(index, dc);
                 d->m_contactMap.insert(fetchedContact.id(),dc);
-                contactsUpdated = true;
                 endInsertRows();
             }
+            contactsUpdated = true;
         }
     }
 
@@ -1554,6 +1716,10 @@ void QDeclarativeContactModel::onContactsChangedFetchRequestStateChanged(QContac
         emit contactsChanged();
 
     request->deleteLater();
+
+    // fetch the contacts reported while the request was running
+    if (!d->m_queuedFetchIds.isEmpty() && !d->m_queuedChangesTimer.isActive())
+        d->m_queuedChangesTimer.start();
 }
 
 int QDeclarativeContactModel::contactIndex(const QDeclarativeContact* contact)
@@ -69,6 +69,7 @@ class QDeclarativeContactModel : public QAbstractListModel, public QQmlParserSta
     Q_PROPERTY(QStringList availableManagers READ availableManagers)
     Q_PROPERTY(QString error READ error NOTIFY errorChanged)
     Q_PROPERTY(bool autoUpdate READ autoUpdate WRITE setAutoUpdate NOTIFY autoUpdateChanged)
+    Q_PROPERTY(int autoUpdateInterval READ autoUpdateInterval WRITE setAutoUpdateInterval NOTIFY autoUpdateIntervalChanged)
     Q_PROPERTY(QDeclarativeContactFilter* filter READ filter WRITE setFilter NOTIFY filterChanged)
     Q_PROPERTY(QDeclarativeContactFetchHint* fetchHint READ fetchHint WRITE setFetchHint NOTIFY fetchHintChanged)
     Q_PROPERTY(QQmlListProperty<QDeclarativeContact> contacts READ contacts NOTIFY contactsChanged)
@@ -83,7 +84,9 @@ public:
     ~QDeclarativeContactModel();
 
     enum {
-        ContactRole =  Qt::UserRole + 500
+        ContactRole =  Qt::UserRole + 500,
+        PhoneNumberRole,
+        AvatarUrlRole
     };
 
     enum ExportError {
@@ -129,6 +132,9 @@ public:
     bool autoUpdate() const;
     void setAutoUpdate(bool autoUpdate);
 
+    int autoUpdateInterval() const;
+    void setAutoUpdateInterval(int interval);
+
     QQmlListProperty<QDeclarativeContact> contacts() ;
     static void contacts_append(QQmlListProperty<QDeclarativeContact>* prop, QDeclarativeContact* contact);
     static qsizetype contacts_count(QQmlListProperty<QDeclarativeContact>* prop);
@@ -165,6 +171,7 @@ signals:
     void collectionsChanged();
     void sortOrdersChanged();
     void autoUpdateChanged();
+    void autoUpdateIntervalChanged();
     void exportCompleted(ExportError error, QUrl url);
     void importCompleted(ImportError error, QUrl url, const QStringList &ids);
     void contactsFetched(int requestId, const QVariantList &fetchedContacts);
@@ -179,6 +186,7 @@ private slots:
     void clearContacts();
     void fetchAgain();
     void requestUpdated();
+    void processIncomingContacts();
     void fetchRequestStateChanged(QContactAbstractRequest::State newState);
     void doUpdate();
     void doContactUpdate();
@@ -186,14 +194,13 @@ private slots:
     void onContactsAdded(const QList<QContactId>& ids);
     void onContactsRemoved(const QList<QContactId>& ids);
     void onContactsChanged(const QList<QContactId>& ids);
+    void processQueuedChanges();
     void startImport(QVersitReader::State state);
+    void importAvailableDocuments();
     void contactsExported(QVersitWriter::State state);
     void onFetchedContactDestroyed(QObject *obj);
 
-    // handle fetch request from onContactsAdded()
-    void onContactsAddedFetchRequestStateChanged(QContactAbstractRequest::State state);
-
-    // handle fetch request from onContactsChanged()
+    // handle fetch request from processQueuedChanges()
     void onContactsChangedFetchRequestStateChanged(QContactAbstractRequest::State state);
 
     // handle fetch request from fetchContacts()
@@ -206,6 +213,8 @@ private:
     void checkError(const QContactAbstractRequest *request);
     void updateError(QContactManager::Error error);
     int contactIndex(const QDeclarativeContact* contact);
+    void removeContactsFromModel(const QList<QContactId> &ids);
+    void clearQueuedChanges();
 
 private:
     QScopedPointer<QDeclarativeContactModelPrivate> d;
@@ -419,6 +419,40 @@ bool QDeclarativeOrganizerItem::generatedOccurrence() const
     return (m_id.isNull() && (type == QDeclarativeOrganizerItemType::EventOccurrence || type == QDeclarativeOrganizerItemType::TodoOccurrence));
 }
 
+static QString occurrenceKey(const QOrganizerItemParent &parent)
+{
+    if (parent.parentId().isNull())
+        return QString();
+    return parent.parentId().toString() + QLatin1Char('/') + parent.originalDate().toString(Qt::ISODate);
+}
+
+/*!
+    \internal
+
+    Returns the key used by the model to match this item against fetched items. Generated
+    occurrences have null ids, so they are identified by their parent id and original date.
+ */
+QString QDeclarativeOrganizerItem::itemKey() const
+{
+    if (!m_id.isNull())
+        return m_id.toString();
+    foreach (QDeclarativeOrganizerItemDetail *detail, m_details) {
+        if (detail->type() == QDeclarativeOrganizerItemDetail::Parent)
+            return occurrenceKey(detail->detail());
+    }
+    return QString();
+}
+
+/*!
+    \internal
+ */
+QString QDeclarativeOrganizerItem::itemKey(const QOrganizerItem &item)
+{
+    if (!item.id().isNull())
+        return item.id().toString();
+    return occurrenceKey(item.detail(QOrganizerItemDetail::TypeParent));
+}
+
 /*!
     \internal
  */
@@ -116,6 +116,9 @@ public:
 
     bool generatedOccurrence() const;
 
+    QString itemKey() const;
+    static QString itemKey(const QOrganizerItem &item);
+
     QDateTime itemStartTime() const;
     QDateTime itemEndTime() const;
 
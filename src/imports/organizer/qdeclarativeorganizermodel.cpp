@@ -56,6 +56,9 @@
 
 #include "qdeclarativeorganizercollection_p.h"
 
+#include <algorithm>
+#include <limits>
+
 QTORGANIZER_USE_NAMESPACE
 QTVERSITORGANIZER_USE_NAMESPACE
 
@@ -85,6 +88,108 @@ static QString urlToLocalFileName(const QUrl& url)
 
 }
 
+/*
+  Index of the model items sorted by the start of their time span, augmented with the
+  maximum span end of each implicit subtree so that the items overlapping a time period
+  can be found in O(log n + k). An item's span covers both its start and end times; an
+  invalid start time extends the span to the beginning of time, to cover the queries
+  treating items without a start time as starting before any given time. Items without
+  any valid time are not indexed. The index only narrows down the candidates, callers
+  still check the exact conditions on them.
+  */
+class QDeclarativeOrganizerItemTimeIndex
+{
+public:
+    struct Entry {
+        qint64 spanStart;
+        qint64 spanEnd;
+        QDateTime startTime;
+        QDateTime endTime;
+        int row;
+    };
+
+    void rebuild(const QList<QDeclarativeOrganizerItem *> &items)
+    {
+        m_entries.clear();
+        m_entries.reserve(items.size());
+        for (int row = 0; row < items.size(); ++row) {
+            Entry entry;
+            entry.startTime = items.at(row)->itemStartTime();
+            entry.endTime = items.at(row)->itemEndTime();
+            entry.row = row;
+            if (entry.startTime.isValid() && entry.endTime.isValid()) {
+                const qint64 start = entry.startTime.toMSecsSinceEpoch();
+                const qint64 end = entry.endTime.toMSecsSinceEpoch();
+                entry.spanStart = qMin(start, end);
+                entry.spanEnd = qMax(start, end);
+            } else if (entry.startTime.isValid()) {
+                entry.spanStart = entry.spanEnd = entry.startTime.toMSecsSinceEpoch();
+            } else if (entry.endTime.isValid()) {
+                entry.spanStart = std::numeric_limits<qint64>::min();
+                entry.spanEnd = entry.endTime.toMSecsSinceEpoch();
+            } else {
+                continue;
+            }
+            m_entries.append(entry);
+        }
+        std::sort(m_entries.begin(), m_entries.end(), entryLessThan);
+        m_maxSpanEnd.resize(m_entries.size());
+        buildMaxSpanEnd(0, m_entries.size());
+    }
+
+    // returns the entries with a span overlapping the given period, in model order
+    QList<const Entry *> overlapping(const QDateTime &start, const QDateTime &end) const
+    {
+        QList<const Entry *> result;
+        const qint64 from = start.isValid() ? start.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+        const qint64 to = end.isValid() ? end.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+        collect(0, m_entries.size(), qMin(from, to), qMax(from, to), &result);
+        std::sort(result.begin(), result.end(), rowLessThan);
+        return result;
+    }
+
+private:
+    static bool entryLessThan(const Entry &e1, const Entry &e2)
+    {
+        return e1.spanStart < e2.spanStart;
+    }
+
+    static bool rowLessThan(const Entry *e1, const Entry *e2)
+    {
+        return e1->row < e2->row;
+    }
+
+    qint64 buildMaxSpanEnd(int begin, int end)
+    {
+        if (begin >= end)
+            return std::numeric_limits<qint64>::min();
+        const int mid = begin + (end - begin) / 2;
+        const qint64 maxSpanEnd = qMax(m_entries.at(mid).spanEnd,
+                                       qMax(buildMaxSpanEnd(begin, mid), buildMaxSpanEnd(mid + 1, end)));
+        m_maxSpanEnd[mid] = maxSpanEnd;
+        return maxSpanEnd;
+    }
+
+    void collect(int begin, int end, qint64 from, qint64 to, QList<const Entry *> *result) const
+    {
+        if (begin >= end)
+            return;
+        const int mid = begin + (end - begin) / 2;
+        if (m_maxSpanEnd.at(mid) < from)
+            return;
+        collect(begin, mid, from, to, result);
+        const Entry &entry = m_entries.at(mid);
+        if (entry.spanStart > to)
+            return;
+        if (entry.spanEnd >= from)
+            result->append(&entry);
+        collect(mid + 1, end, from, to, result);
+    }
+
+    QVector<Entry> m_entries;
+    QVector<qint64> m_maxSpanEnd;
+};
+
 static const char ITEM_TO_SAVE_PROPERTY[] = {"ITEM_TO_SAVE_PROPERTY"};
 static const char MANUALLY_TRIGGERED_PROPERTY[] = {"MANUALLY_TRIGGERED"};
 
@@ -106,6 +211,7 @@ public:
         m_updatePendingFlag(QDeclarativeOrganizerModelPrivate::NonePending),
         m_componentCompleted(false),
         m_initialUpdate(false),
+        m_timeIndexDirty(true),
         m_lastRequestId(0)
     {
     }
@@ -117,6 +223,15 @@ public:
         delete m_writer;
 }
 
+    const QDeclarativeOrganizerItemTimeIndex &timeIndex()
+    {
+        if (m_timeIndexDirty) {
+            m_timeIndex.rebuild(m_items);
+            m_timeIndexDirty = false;
+        }
+        return m_timeIndex;
+    }
+
     QList<QDeclarativeOrganizerItem*> m_items;
     QHash<QString, QDeclarativeOrganizerItem *> m_itemIdHash;
     QOrganizerManager* m_manager;
@@ -127,6 +242,8 @@ public:
     QOrganizerItemFetchRequest* m_fetchRequest;
     QSet<QOrganizerItemId> m_addedItemIds;
     QMap<QOrganizerAbstractRequest*, QSet<QOrganizerItemId> > m_notifiedItems;
+    // last operation of each item reported by itemsModified() during the autoUpdateInterval window
+    QHash<QOrganizerItemId, QOrganizerManager::Operation> m_queuedItemOperations;
     QOrganizerItemOccurrenceFetchRequest* m_occurrenceFetchRequest;
     QStringList m_importProfiles;
     QVersitReader *m_reader;
@@ -139,6 +256,7 @@ public:
     QTimer m_updateItemsTimer;
     QTimer m_fetchCollectionsTimer;
     QTimer m_modelChangedTimer;
+    QTimer m_itemsModifiedTimer;
 
     QOrganizerManager::Error m_error;
 
@@ -152,6 +270,10 @@ public:
     bool m_componentCompleted;
     bool m_initialUpdate;
 
+    // rebuilt lazily on the first time period query after m_items has changed
+    QDeclarativeOrganizerItemTimeIndex m_timeIndex;
+    bool m_timeIndexDirty;
+
     QAtomicInt m_lastRequestId;
     QHash<QOrganizerAbstractRequest *, int> m_requestIdHash;
     QUrl m_lastExportUrl;
@@ -202,20 +324,29 @@ QDeclarativeOrganizerModel::QDeclarativeOrganizerModel(QObject *parent) :
     d_ptr->m_updateItemsTimer.setSingleShot(true);
     d_ptr->m_fetchCollectionsTimer.setSingleShot(true);
     d_ptr->m_modelChangedTimer.setSingleShot(true);
+    d_ptr->m_itemsModifiedTimer.setSingleShot(true);
     d_ptr->m_updateTimer.setInterval(1);
     d_ptr->m_updateItemsTimer.setInterval(1);
     d_ptr->m_fetchCollectionsTimer.setInterval(1);
     d_ptr->m_modelChangedTimer.setInterval(1);
+    d_ptr->m_itemsModifiedTimer.setInterval(0);
     connect(&d_ptr->m_updateTimer, &QTimer::timeout, this, &QDeclarativeOrganizerModel::doUpdate);
     connect(&d_ptr->m_updateItemsTimer, &QTimer::timeout, this, &QDeclarativeOrganizerModel::doUpdateItems);
     connect(&d_ptr->m_fetchCollectionsTimer, &QTimer::timeout, this, &QDeclarativeOrganizerModel::fetchCollections);
     connect(&d_ptr->m_modelChangedTimer, &QTimer::timeout, this, &QDeclarativeOrganizerModel::modelChanged);
+    connect(&d_ptr->m_itemsModifiedTimer, &QTimer::timeout, this, &QDeclarativeOrganizerModel::processQueuedItemOperations);
 
     connect(this, &QDeclarativeOrganizerModel::filterChanged, &d_ptr->m_updateItemsTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
     connect(this, &QDeclarativeOrganizerModel::fetchHintChanged, &d_ptr->m_updateItemsTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
     connect(this, &QDeclarativeOrganizerModel::sortOrdersChanged, &d_ptr->m_updateItemsTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
     connect(this, &QDeclarativeOrganizerModel::startPeriodChanged, &d_ptr->m_updateItemsTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
     connect(this, &QDeclarativeOrganizerModel::endPeriodChanged, &d_ptr->m_updateItemsTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
+    connect(this, &QAbstractItemModel::rowsMoved, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
+    connect(this, &QAbstractItemModel::dataChanged, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
+    connect(this, &QAbstractItemModel::modelReset, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
 }
 
 QDeclarativeOrganizerModel::~QDeclarativeOrganizerModel()
@@ -300,6 +431,8 @@ void QDeclarativeOrganizerModel::setAutoUpdate(bool autoUpdate)
     if (autoUpdate == d->m_autoUpdate)
         return;
     d->m_autoUpdate = autoUpdate;
+    if (!autoUpdate)
+        clearQueuedItemOperations();
     emit autoUpdateChanged();
 }
 
@@ -309,6 +442,36 @@ bool QDeclarativeOrganizerModel::autoUpdate() const
     return d->m_autoUpdate;
 }
 
+/*!
+  \qmlproperty int OrganizerModel::autoUpdateInterval
+
+  This property holds the time in milliseconds during which the items added, changed or removed
+  in the backend are collected before the model is updated, default value is 0.
+
+  All notifications received during the interval are merged, so that only the last operation on
+  each item is applied and the model is updated with a single fetch request. With the default value
+  only the notifications received during the same event loop iteration are merged. A larger value
+  reduces the work done by the model when the backend reports many small changes, for example
+  while synchronizing an account, at the cost of a longer delay before they are shown.
+
+  \sa OrganizerModel::autoUpdate
+  */
+void QDeclarativeOrganizerModel::setAutoUpdateInterval(int interval)
+{
+    Q_D(QDeclarativeOrganizerModel);
+    interval = qMax(0, interval);
+    if (interval == d->m_itemsModifiedTimer.interval())
+        return;
+    d->m_itemsModifiedTimer.setInterval(interval);
+    emit autoUpdateIntervalChanged();
+}
+
+int QDeclarativeOrganizerModel::autoUpdateInterval() const
+{
+    Q_D(const QDeclarativeOrganizerModel);
+    return d->m_itemsModifiedTimer.interval();
+}
+
 /*!
   \qmlmethod OrganizerModel::update()
 
@@ -581,6 +744,7 @@ void QDeclarativeOrganizerModel::setManager(const QString& managerName)
 
     if (d->m_manager) {
         cancelUpdate();
+        clearQueuedItemOperations();
         d->m_updatePendingFlag = QDeclarativeOrganizerModelPrivate::NonePending;
         delete d->m_manager;
     }
@@ -808,9 +972,20 @@ QDeclarativeOrganizerItem* QDeclarativeOrganizerModel::createItem(const QOrganiz
     else
         di = new QDeclarativeOrganizerItem(this);
     di->setItem(item);
+
+    // the time index must follow item changes made from QML too
+    connect(di, &QDeclarativeOrganizerItem::itemChanged, this, &QDeclarativeOrganizerModel::invalidateTimeIndex);
+    if (di->metaObject() != &QDeclarativeOrganizerItem::staticMetaObject)
+        connect(di, SIGNAL(valueChanged()), this, SLOT(invalidateTimeIndex()));
     return di;
 }
 
+void QDeclarativeOrganizerModel::invalidateTimeIndex()
+{
+    Q_D(QDeclarativeOrganizerModel);
+    d->m_timeIndexDirty = true;
+}
+
 void QDeclarativeOrganizerModel::checkError(const QOrganizerAbstractRequest *request)
 {
     Q_D(QDeclarativeOrganizerModel);
@@ -1018,9 +1193,9 @@ QList<bool> QDeclarativeOrganizerModel::containsItems(const QDateTime &start, co
     QDateTime endTime;
     bool itemStartFound;
 
-    foreach (QDeclarativeOrganizerItem *item, d->m_items) {
-        startTime = item->itemStartTime();
-        endTime = item->itemEndTime();
+    foreach (const QDeclarativeOrganizerItemTimeIndex::Entry *entry, d->timeIndex().overlapping(start, end)) {
+        startTime = entry->startTime;
+        endTime = entry->endTime;
 
         // check if item is occurring between start and end
         if (!((!startTime.isNull() && startTime >= start && startTime < end)
@@ -1081,19 +1256,19 @@ QVariantList QDeclarativeOrganizerModel::itemsByTimePeriod(const QDateTime &star
     if (start.isValid() && end.isValid()) {
         QDateTime startTime;
         QDateTime endTime;
-        foreach (QDeclarativeOrganizerItem *item, d->m_items) {
-            startTime = item->itemStartTime();
-            endTime = item->itemEndTime();
+        foreach (const QDeclarativeOrganizerItemTimeIndex::Entry *entry, d->timeIndex().overlapping(start, end)) {
+            startTime = entry->startTime;
+            endTime = entry->endTime;
             if ((startTime.isValid() && startTime <= start && endTime >= end)
                 || (startTime >= start && startTime <= end)
                 || (endTime >= start && endTime <= end)) {
-                list.append(QVariant::fromValue((QObject *)item));
+                list.append(QVariant::fromValue((QObject *)d->m_items.at(entry->row)));
             }
         }
     } else if (start.isValid()) {
-        foreach (QDeclarativeOrganizerItem *item, d->m_items) {
-            if (item->itemEndTime() >= start)
-                list.append(QVariant::fromValue((QObject *)item));
+        foreach (const QDeclarativeOrganizerItemTimeIndex::Entry *entry, d->timeIndex().overlapping(start, QDateTime())) {
+            if (entry->endTime >= start)
+                list.append(QVariant::fromValue((QObject *)d->m_items.at(entry->row)));
         }
     } else if (end.isValid()) {
         foreach (QDeclarativeOrganizerItem *item, d->m_items) {
@@ -1135,10 +1310,20 @@ QDeclarativeOrganizerItem *QDeclarativeOrganizerModel::item(const QString &itemI
 QStringList QDeclarativeOrganizerModel::itemIds(const QDateTime &start, const QDateTime &end)
 {
     Q_D(QDeclarativeOrganizerModel);
-    //TODO: quick search this
     QStringList ids;
-    if (!end.isNull()) {
+    if (!end.isNull() && !start.isNull()) {
         // both start date and end date are valid
+        foreach (const QDeclarativeOrganizerItemTimeIndex::Entry *entry, d->timeIndex().overlapping(start, end)) {
+            QDeclarativeOrganizerItem *item = d->m_items.at(entry->row);
+            if (item->generatedOccurrence())
+                continue;
+            if ( (entry->startTime >= start && entry->startTime <= end)
+                 || (entry->endTime >= start && entry->endTime <= end)
+                 || (entry->endTime > end && entry->startTime < start))
+                ids << item->itemId();
+        }
+    } else if (!end.isNull()) {
+        // only end date is valid, items without start time are included too
         foreach (QDeclarativeOrganizerItem* item, d->m_items) {
             if (item->generatedOccurrence())
                 continue;
@@ -1149,8 +1334,9 @@ QStringList QDeclarativeOrganizerModel::itemIds(const QDateTime &start, const QD
         }
     } else if (!start.isNull()) {
         // only a valid start date is valid
-        foreach (QDeclarativeOrganizerItem* item, d->m_items) {
-            if (!item->generatedOccurrence() && item->itemStartTime() >= start)
+        foreach (const QDeclarativeOrganizerItemTimeIndex::Entry *entry, d->timeIndex().overlapping(start, QDateTime())) {
+            QDeclarativeOrganizerItem *item = d->m_items.at(entry->row);
+            if (!item->generatedOccurrence() && entry->startTime >= start)
                 ids << item->itemId();
         }
     } else {
@@ -1167,6 +1353,8 @@ void QDeclarativeOrganizerModel::fetchAgain()
 {
     Q_D(QDeclarativeOrganizerModel);
     cancelUpdate();
+    // the new request fetches the current state of all items
+    clearQueuedItemOperations();
 
     d->m_fetchRequest  = new QOrganizerItemFetchRequest(this);
     d->m_fetchRequest->setManager(d->m_manager);
@@ -1212,53 +1400,98 @@ void QDeclarativeOrganizerModel::requestUpdated()
     }
 
     if (!items.isEmpty() || !d->m_items.isEmpty() || d->m_initialUpdate) {
-        // full update: first go through new items and check if they
-        // existed earlier. if they did, use the existing declarative wrapper.
-        // otherwise create new declarative item.
-        // for occurrences new declarative item is always created.
+        // first go through new items and check if they existed earlier. if they did,
+        // use the existing declarative wrapper, otherwise create new declarative item.
+        // generated occurrences have null ids, so they are matched by parent id and
+        // original date instead (see QDeclarativeOrganizerItem::itemKey()).
+        QHash<QString, QDeclarativeOrganizerItem *> oldItems;
+        oldItems.reserve(d->m_items.size());
+        foreach (QDeclarativeOrganizerItem *declarativeItem, d->m_items) {
+            const QString key = declarativeItem->itemKey();
+            if (!key.isEmpty())
+                oldItems.insert(key, declarativeItem);
+        }
+
         QList<QDeclarativeOrganizerItem *> newList;
+        QSet<QDeclarativeOrganizerItem *> reusedItems;
         QHash<QString, QDeclarativeOrganizerItem *> newItemIdHash;
-        QHash<QString, QDeclarativeOrganizerItem *>::iterator iterator;
-        QOrganizerItem item;
-        QString idString;
-        QDeclarativeOrganizerItem *declarativeItem;
+        newList.reserve(items.size());
         d->m_initialUpdate = false;
 
-        int i;
-        for (i = 0; i < items.size(); i++) {
-            item = items[i];
-            idString = item.id().toString();
-            if (item.id().isNull()) {
-                // this is occurrence
-                declarativeItem = createItem(item);
+        foreach (const QOrganizerItem &item, items) {
+            QDeclarativeOrganizerItem *declarativeItem = oldItems.take(QDeclarativeOrganizerItem::itemKey(item));
+            if (declarativeItem) {
+                declarativeItem->setItem(item);
+                reusedItems.insert(declarativeItem);
             } else {
-                iterator = d->m_itemIdHash.find(idString);
-                if (iterator != d->m_itemIdHash.end()) {
-                    declarativeItem = iterator.value();
-                    declarativeItem->setItem(item);
-                } else {
-                    declarativeItem = createItem(item);
-                }
-                newItemIdHash.insert(idString, declarativeItem);
+                declarativeItem = createItem(item);
             }
+            if (!item.id().isNull())
+                newItemIdHash.insert(declarativeItem->itemId(), declarativeItem);
             newList.append(declarativeItem);
         }
 
-        // go through old items and delete items, which are not part of the
-        // new item set. delete also all old occurrences.
-        for (i = 0; i < d->m_items.size(); i++) {
-            // FIXME: avoid unnecessary usage of item getter which copies all details...
-            if (d->m_items[i]->item().id().isNull()) {
-                d->m_items[i]->deleteLater();
+        // remove old items which are not part of the new item set, one range at a time
+        int i = d->m_items.size() - 1;
+        while (i >= 0) {
+            if (reusedItems.contains(d->m_items.at(i))) {
+                --i;
+                continue;
+            }
+            int first = i;
+            while (first > 0 && !reusedItems.contains(d->m_items.at(first - 1)))
+                --first;
+            beginRemoveRows(QModelIndex(), first, i);
+            for (int j = i; j >= first; --j)
+                d->m_items.takeAt(j)->deleteLater();
+            endRemoveRows();
+            i = first - 1;
+        }
+
+        // the remaining old items are all reused, walk the new list and insert new
+        // items and move reused ones to their new positions
+        i = 0;
+        while (i < newList.size()) {
+            if (i < d->m_items.size() && d->m_items.at(i) == newList.at(i)) {
+                ++i;
+                continue;
+            }
+            int count = 1;
+            if (!reusedItems.contains(newList.at(i))) {
+                while (i + count < newList.size() && !reusedItems.contains(newList.at(i + count)))
+                    ++count;
+                beginInsertRows(QModelIndex(), i, i + count - 1);
+                for (int j = i; j < i + count; ++j)
+                    d->m_items.insert(j, newList.at(j));
+                endInsertRows();
             } else {
-                iterator = newItemIdHash.find(d->m_items[i]->itemId());
-                if (iterator == newItemIdHash.end())
-                    d->m_items[i]->deleteLater();
+                const int from = d->m_items.indexOf(newList.at(i), i + 1);
+                while (i + count < newList.size() && from + count < d->m_items.size()
+                       && d->m_items.at(from + count) == newList.at(i + count)) {
+                    ++count;
+                }
+                beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), i);
+                for (int j = 0; j < count; ++j)
+                    d->m_items.move(from + j, i + j);
+                endMoveRows();
+            }
+            i += count;
+        }
+        Q_ASSERT(d->m_items == newList);
+
+        // reused items have been updated in place
+        i = 0;
+        while (i < d->m_items.size()) {
+            if (!reusedItems.contains(d->m_items.at(i))) {
+                ++i;
+                continue;
             }
+            int last = i;
+            while (last + 1 < d->m_items.size() && reusedItems.contains(d->m_items.at(last + 1)))
+                ++last;
+            emit dataChanged(index(i, 0), index(last, 0));
+            i = last + 1;
         }
-        beginResetModel();
-        d->m_items = newList;
-        endResetModel();
 
         d->m_itemIdHash = newItemIdHash;
         d->m_modelChangedTimer.start();
@@ -1421,22 +1654,57 @@ void QDeclarativeOrganizerModel::removeItemsFromModel(const QList<QString> &item
 void QDeclarativeOrganizerModel::onItemsModified(const QList<QPair<QOrganizerItemId, QOrganizerManager::Operation> > &itemIds)
 {
     Q_D(QDeclarativeOrganizerModel);
-    if (!d->m_autoUpdate)
+    if (!d->m_autoUpdate || itemIds.isEmpty())
+        return;
+
+    for (int i = 0; i < itemIds.size(); i++)
+        d->m_queuedItemOperations.insert(itemIds[i].first, itemIds[i].second);
+    if (!d->m_itemsModifiedTimer.isActive())
+        d->m_itemsModifiedTimer.start();
+}
+
+/*!
+    \internal
+
+    Applies the item operations collected since the previous call: removed items are taken out
+    of the model and the added and changed items are updated with one fetch request.
+ */
+void QDeclarativeOrganizerModel::processQueuedItemOperations()
+{
+    Q_D(QDeclarativeOrganizerModel);
+    if (!d->m_autoUpdate || !d->m_manager)
         return;
 
     QSet<QOrganizerItemId> addedAndChangedItems;
+    QSet<QOrganizerItemId> removedIds;
     QList<QString> removedItems;
-    for (int i = itemIds.size() - 1; i >= 0; i--) {
-        if (itemIds[i].second == QOrganizerManager::Remove) {
-            // check that item has not been added after removing it
-            if (!addedAndChangedItems.contains(itemIds[i].first))
-                removedItems.append(itemIds[i].first.toString());
+    QHash<QOrganizerItemId, QOrganizerManager::Operation>::const_iterator it = d->m_queuedItemOperations.constBegin();
+    for (; it != d->m_queuedItemOperations.constEnd(); ++it) {
+        // an item added after removing it is only checked for changes
+        if (it.value() == QOrganizerManager::Remove) {
+            removedIds.insert(it.key());
+            removedItems.append(it.key().toString());
         } else {
-            addedAndChangedItems.insert(itemIds[i].first);
+            addedAndChangedItems.insert(it.key());
         }
     }
-    if (!removedItems.isEmpty())
+    d->m_queuedItemOperations.clear();
+
+    if (!removedItems.isEmpty()) {
+        QMap<QOrganizerAbstractRequest*, QSet<QOrganizerItemId> >::iterator notified = d->m_notifiedItems.begin();
+        for (; notified != d->m_notifiedItems.end(); ++notified)
+            notified.value().subtract(removedIds);
         removeItemsFromModel(removedItems);
+    }
+
+    if (!addedAndChangedItems.isEmpty() && !d->m_notifiedItems.isEmpty()) {
+        // The request of a previous window is still running. Cancelling it would keep the
+        // model from ever being updated while the backend reports changes faster than it
+        // fetches them, so the items wait for it and are fetched once it has finished.
+        foreach (const QOrganizerItemId &id, addedAndChangedItems)
+            d->m_queuedItemOperations.insert(id, QOrganizerManager::Change);
+        return;
+    }
 
     if (!addedAndChangedItems.isEmpty()) {
         // FIXME; to be optimized with fetching only the modified items
@@ -1459,7 +1727,25 @@ void QDeclarativeOrganizerModel::onItemsModified(const QList<QPair<QOrganizerIte
 /*!
     \internal
 
-    It's invoked by the fetch request from onItemsModified().
+    Drops the collected item operations, e.g. when a full update makes them redundant.
+ */
+void QDeclarativeOrganizerModel::clearQueuedItemOperations()
+{
+    Q_D(QDeclarativeOrganizerModel);
+    d->m_itemsModifiedTimer.stop();
+    d->m_queuedItemOperations.clear();
+    QMap<QOrganizerAbstractRequest*, QSet<QOrganizerItemId> >::const_iterator notified = d->m_notifiedItems.constBegin();
+    for (; notified != d->m_notifiedItems.constEnd(); ++notified) {
+        notified.key()->cancel();
+        notified.key()->deleteLater();
+    }
+    d->m_notifiedItems.clear();
+}
+
+/*!
+    \internal
+
+    It's invoked by the fetch request from processQueuedItemOperations().
  */
 void QDeclarativeOrganizerModel::onItemsModifiedFetchRequestStateChanged(QOrganizerAbstractRequest::State state)
 {
@@ -1475,11 +1761,9 @@ void QDeclarativeOrganizerModel::onItemsModifiedFetchRequestStateChanged(QOrgani
 
     checkError(request);
 
+    // all of the notified items may have been removed meanwhile
     QSet<QOrganizerItemId> notifiedItems = d->m_notifiedItems.value(request);
-    if (notifiedItems.isEmpty())
-        return;
-
-    if (request->error() == QOrganizerManager::NoError) {
+    if (!notifiedItems.isEmpty() && request->error() == QOrganizerManager::NoError) {
         bool emitSignal = false;
         QList<QOrganizerItem> fetchedItems = request->items();
         QOrganizerItem oldItem;
@@ -1612,6 +1896,10 @@ void QDeclarativeOrganizerModel::onItemsModifiedFetchRequestStateChanged(QOrgani
     }
     d->m_notifiedItems.remove(request);
     request->deleteLater();
+
+    // fetch the items reported while the request was running
+    if (!d->m_queuedItemOperations.isEmpty() && !d->m_itemsModifiedTimer.isActive())
+        d->m_itemsModifiedTimer.start();
 }
 
 /*!
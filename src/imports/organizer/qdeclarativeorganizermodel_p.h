@@ -70,6 +70,7 @@ class QDeclarativeOrganizerModel : public QAbstractListModel, public QQmlParserS
     Q_PROPERTY(QString managerName READ managerName  NOTIFY managerChanged)
     Q_PROPERTY(QStringList availableManagers READ availableManagers)
     Q_PROPERTY(bool autoUpdate READ autoUpdate WRITE setAutoUpdate NOTIFY autoUpdateChanged)
+    Q_PROPERTY(int autoUpdateInterval READ autoUpdateInterval WRITE setAutoUpdateInterval NOTIFY autoUpdateIntervalChanged)
     Q_PROPERTY(QDateTime startPeriod READ startPeriod WRITE setStartPeriod NOTIFY startPeriodChanged)
     Q_PROPERTY(QDateTime endPeriod READ endPeriod WRITE setEndPeriod NOTIFY endPeriodChanged)
     Q_PROPERTY(QDeclarativeOrganizerItemFilter* filter READ filter WRITE setFilter NOTIFY filterChanged)
@@ -167,6 +168,9 @@ public:
     bool autoUpdate() const;
     void setAutoUpdate(bool autoUpdate);
 
+    int autoUpdateInterval() const;
+    void setAutoUpdateInterval(int interval);
+
     void setFilter(QDeclarativeOrganizerItemFilter* filter);
     void setFetchHint(QDeclarativeOrganizerItemFetchHint* fetchHint);
 
@@ -182,6 +186,7 @@ signals:
     void startPeriodChanged();
     void endPeriodChanged();
     void autoUpdateChanged();
+    void autoUpdateIntervalChanged();
     void collectionsChanged();
     void itemsFetched(int requestId, const QVariantList &fetchedItems);
     void exportCompleted(ExportError error, QUrl url);
@@ -207,11 +212,13 @@ private slots:
 
     // handle signals from organizer manager
     void onItemsModified(const QList<QPair<QOrganizerItemId, QOrganizerManager::Operation> > &itemIds);
+    void processQueuedItemOperations();
 
-    // handle fetch request from onItemsModified()
+    // handle fetch request from processQueuedItemOperations()
     void onItemsModifiedFetchRequestStateChanged(QOrganizerAbstractRequest::State state);
 
     void collectionsFetched();
+    void invalidateTimeIndex();
 
     void startImport(QVersitReader::State state);
     void itemsExported(QVersitWriter::State state);
@@ -219,6 +226,7 @@ private slots:
 
 private:
     void removeItemsFromModel(const QList<QString>& ids);
+    void clearQueuedItemOperations();
     bool itemHasRecurrence(const QOrganizerItem& oi) const;
     QDeclarativeOrganizerItem* createItem(const QOrganizerItem& item);
     void checkError(const QOrganizerAbstractRequest *request);
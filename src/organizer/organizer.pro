@@ -10,6 +10,7 @@ include(details/details.pri)
 include(items/items.pri)
 include(requests/requests.pri)
 include(filters/filters.pri)
+include(../common/common.pri)
 
 PUBLIC_HEADERS += \
     qorganizercollection.h \
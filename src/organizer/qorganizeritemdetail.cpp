@@ -51,6 +51,24 @@
 
 QT_BEGIN_NAMESPACE_ORGANIZER
 
+/* Keys are handed to each thread in blocks, so creating details doesn't contend on lastDetailKey() */
+enum { DetailKeyBlockSize = 1024 };
+static thread_local int nextThreadDetailKey = 0;
+static thread_local int threadDetailKeyBlockEnd = 0;
+
+/*!
+    \internal
+    Returns a new detail key, unique within the process.
+*/
+int QOrganizerItemDetailPrivate::nextDetailKey()
+{
+    if (nextThreadDetailKey == threadDetailKeyBlockEnd) {
+        nextThreadDetailKey = lastDetailKey().fetchAndAddRelaxed(DetailKeyBlockSize);
+        threadDetailKeyBlockEnd = nextThreadDetailKey + DetailKeyBlockSize;
+    }
+    return nextThreadDetailKey++;
+}
+
 /*!
     \class QOrganizerItemDetail
 
@@ -258,11 +276,9 @@ bool QOrganizerItemDetail::operator==(const QOrganizerItemDetail &other) const
 Q_ORGANIZER_EXPORT size_t qHash(const QOrganizerItemDetail &key)
 {
     size_t hash = QT_PREPEND_NAMESPACE(qHash)(key.d->m_detailType);
-    QMap<int, QVariant>::const_iterator it = key.d->m_values.constBegin();
-    while (it != key.d->m_values.constEnd()) {
-        hash += QT_PREPEND_NAMESPACE(qHash)(it.key()) + QT_PREPEND_NAMESPACE(qHash)(it.value().toString());
-        ++it;
-    }
+    const QOrganizerItemDetailFieldMap &values = key.d->m_values;
+    for (int i = 0; i < values.size(); ++i)
+        hash += QT_PREPEND_NAMESPACE(qHash)(values.keyAt(i)) + QT_PREPEND_NAMESPACE(qHash)(values.valueAt(i).toString());
     return hash;
 }
 
@@ -343,7 +359,7 @@ int QOrganizerItemDetail::key() const
  */
 void QOrganizerItemDetail::resetKey()
 {
-    d->m_id = QOrganizerItemDetailPrivate::lastDetailKey().fetchAndAddOrdered(1);
+    d->m_id = QOrganizerItemDetailPrivate::nextDetailKey();
 }
 
 /*!
@@ -390,7 +406,7 @@ bool QOrganizerItemDetail::removeValue(int field)
  */
 QMap<int, QVariant> QOrganizerItemDetail::values() const
 {
-    return d->m_values;
+    return d->m_values.toMap();
 }
 
 /*!
@@ -53,17 +53,31 @@
 
 #include <QtCore/qmap.h>
 #include <QtCore/qshareddata.h>
+#include <QtCore/qvarlengtharray.h>
 
 #include <QtOrganizer/qorganizeritemdetail.h>
 
+#include "qpimdetailfieldmap_p.h"
+#include "qpimdetailpool_p.h"
+
 QT_BEGIN_NAMESPACE_ORGANIZER
 
+// Details rarely have more than four fields, so those are stored without an allocation
+typedef QPimDetailFieldMap<QVarLengthArray<QPair<int, QVariant>, 4> > QOrganizerItemDetailFieldMap;
+
+// The pool is only used when QTORGANIZER_DETAIL_POOL is set, as it keeps its slabs for good
+struct QOrganizerItemDetailPoolTraits
+{
+    static const char *enableVariable() { return "QTORGANIZER_DETAIL_POOL"; }
+};
+typedef QPimDetailPool<QOrganizerItemDetailPoolTraits> QOrganizerItemDetailPool;
+
 class QOrganizerItemDetailPrivate : public QSharedData
 {
 public:
     QOrganizerItemDetailPrivate(QOrganizerItemDetail::DetailType detailType)
         : QSharedData()
-        , m_id(lastDetailKey().fetchAndAddOrdered(1))
+        , m_id(nextDetailKey())
         , m_detailType(detailType)
     {
     }
@@ -80,15 +94,20 @@ public:
     {
     }
 
+    // bulk fetches and occurrence generation create and destroy many details, so their privates come from a pool
+    static void *operator new(size_t size) { return QOrganizerItemDetailPool::allocate(size); }
+    static void operator delete(void *block, size_t size) { QOrganizerItemDetailPool::deallocate(block, size); }
+
     int m_id; // internal, unique id.
     QOrganizerItemDetail::DetailType m_detailType;
-    QMap<int, QVariant> m_values;
+    QOrganizerItemDetailFieldMap m_values;
 
     static QAtomicInt &lastDetailKey()
     {
         static QAtomicInt counter(0);
         return counter;
     }
+    static int nextDetailKey();
 };
 
 QT_END_NAMESPACE_ORGANIZER
@@ -71,12 +71,16 @@ QT_BEGIN_NAMESPACE_ORGANIZER
 
 // TODO: Document and remove internal once the correct signature has been determined
 /*!
-    \fn QOrganizerItemId::QOrganizerItemId(const QString &managerUri, const QByteArray &localId)
     \internal
 
     Constructs an ID from the supplied manager URI \a managerUri and the engine
     specific \a localId string.
 */
+QOrganizerItemId::QOrganizerItemId(const QString &managerUri, const QByteArray &localId)
+    : m_managerUriHandle(localId.isEmpty() ? 0 : QOrganizerManagerData::uriHandle(managerUri)),
+      m_localId(m_managerUriHandle == 0 ? QByteArray() : localId)
+{
+}
 
 /*!
     \fn bool QOrganizerItemId::operator==(const QOrganizerItemId &other) const
@@ -93,7 +97,6 @@ QT_BEGIN_NAMESPACE_ORGANIZER
 */
 
 /*!
-    \fn bool operator<(const QOrganizerItemId &id1, const QOrganizerItemId &id2)
     \relates QOrganizerItemId
 
     Returns true if the organizer item ID \a id1 will be considered less than
@@ -107,6 +110,12 @@ QT_BEGIN_NAMESPACE_ORGANIZER
 
     This operator is provided primarily to allow use of a QOrganizerItemId as a key in a QMap.
 */
+bool operator<(const QOrganizerItemId &id1, const QOrganizerItemId &id2)
+{
+    if (id1.m_managerUriHandle == id2.m_managerUriHandle)
+        return id1.m_localId < id2.m_localId;
+    return id1.managerUri() < id2.managerUri();
+}
 
 /*!
     \fn size_t qHash(const QOrganizerItemId &id)
@@ -135,12 +144,14 @@ QT_BEGIN_NAMESPACE_ORGANIZER
 */
 
 /*!
-    \fn QString QOrganizerItemId::managerUri() const
-
     Returns the URI of the manager which contains the organizer item identified by this ID.
 
     \sa localId()
 */
+QString QOrganizerItemId::managerUri() const
+{
+    return QOrganizerManagerData::uriForHandle(m_managerUriHandle);
+}
 
 /*!
     \fn QByteArray QOrganizerItemId::localId() const
@@ -162,7 +173,7 @@ QString QOrganizerItemId::toString() const
     if (!isNull()) {
         // Ensure the localId component has a valid string representation by hex encoding
         const QByteArray encodedLocalId(m_localId.toHex());
-        return QString::fromUtf8(QOrganizerManagerData::buildIdData(m_managerUri, encodedLocalId));
+        return QString::fromUtf8(QOrganizerManagerData::buildIdData(m_managerUriHandle, encodedLocalId));
     }
 
     return QString();
@@ -195,7 +206,7 @@ QOrganizerItemId QOrganizerItemId::fromString(const QString &idString)
 QByteArray QOrganizerItemId::toByteArray() const
 {
     if (!isNull())
-        return QOrganizerManagerData::buildIdData(m_managerUri, m_localId);
+        return QOrganizerManagerData::buildIdData(m_managerUriHandle, m_localId);
 
     return QByteArray();
 }
@@ -51,21 +51,18 @@ class QOrganizerManagerEngine;
 class Q_ORGANIZER_EXPORT QOrganizerItemId
 {
 public:
-    inline QOrganizerItemId() {}
-    inline QOrganizerItemId(const QString &_managerUri, const QByteArray &_localId)
-        : m_managerUri(_localId.isEmpty() ? QString() : _managerUri),
-          m_localId(m_managerUri.isEmpty() ? QByteArray() : _localId)
-    {}
+    inline QOrganizerItemId() : m_managerUriHandle(0) {}
+    QOrganizerItemId(const QString &managerUri, const QByteArray &localId);
     // compiler-generated dtor and copy/move ctors/assignment operators are fine!
 
     inline bool operator==(const QOrganizerItemId &other) const
-    { return localId() == other.localId() && managerUri() == other.managerUri(); }
+    { return m_managerUriHandle == other.m_managerUriHandle && m_localId == other.m_localId; }
     inline bool operator!=(const QOrganizerItemId &other) const
     { return !operator==(other); }
 
     inline bool isNull() const { return m_localId.isEmpty(); }
 
-    inline QString managerUri() const { return m_managerUri; }
+    QString managerUri() const;
     inline QByteArray localId() const { return m_localId; }
 
     QString toString() const;
@@ -75,12 +72,13 @@ public:
     static QOrganizerItemId fromByteArray(const QByteArray &idData);
 
 private:
-    QString m_managerUri;
+    friend Q_ORGANIZER_EXPORT bool operator<(const QOrganizerItemId &id1, const QOrganizerItemId &id2);
+
+    int m_managerUriHandle; // handle of the manager URI, which is stored once per process
     QByteArray m_localId;
 };
 
-inline bool operator<(const QOrganizerItemId &id1, const QOrganizerItemId &id2)
-{ return id1.managerUri() != id2.managerUri() ? id1.managerUri() < id2.managerUri() : id1.localId() < id2.localId(); }
+Q_ORGANIZER_EXPORT bool operator<(const QOrganizerItemId &id1, const QOrganizerItemId &id2);
 
 inline size_t qHash(const QOrganizerItemId &id)
 { return qHash(id.localId()); }
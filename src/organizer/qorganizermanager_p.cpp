@@ -49,6 +49,7 @@
 
 #include "qorganizeritemobserver.h"
 #include "qorganizermanagerenginefactory.h"
+#include "qpimmanageruriregistry_p.h"
 
 QT_BEGIN_NAMESPACE_ORGANIZER
 
@@ -438,6 +439,11 @@ QByteArray QOrganizerManagerData::buildIdData(const QString &managerName, const
     return buildIdData(buildUri(managerName, params), localId);
 }
 
+namespace {
+struct QOrganizerManagerUriRegistryTraits {};
+}
+typedef QPimManagerUriRegistry<QOrganizerManagerUriRegistryTraits> QOrganizerManagerUriRegistry;
+
 /*!
     Returns a cached instance of the manager URI string that matches \a managerUri.
     This instance should be preferred when constructing ID objects in order to promote
@@ -445,14 +451,35 @@ QByteArray QOrganizerManagerData::buildIdData(const QString &managerName, const
 */
 QString QOrganizerManagerData::cachedUri(const QString &managerUri)
 {
-    static QStringList managerUris;
+    return QOrganizerManagerUriRegistry::uri(QOrganizerManagerUriRegistry::handle(managerUri));
+}
 
-    int index = managerUris.indexOf(managerUri);
-    if (index != -1)
-        return managerUris.at(index);
+/*!
+    Returns the handle of \a managerUri in the registry of manager URIs, registering it
+    first if necessary.  Two URIs have the same handle only if they are equal, so IDs
+    store the handle and compare it instead of the URI string.  The empty URI has handle 0.
+*/
+int QOrganizerManagerData::uriHandle(const QString &managerUri)
+{
+    return QOrganizerManagerUriRegistry::handle(managerUri);
+}
 
-    managerUris.append(managerUri);
-    return managerUri;
+/*!
+    Returns the manager URI registered with \a handle by uriHandle().
+*/
+QString QOrganizerManagerData::uriForHandle(int handle)
+{
+    return QOrganizerManagerUriRegistry::uri(handle);
+}
+
+/*!
+    Returns the ID string for \a localId in the manager whose URI is registered with
+    \a uriHandle.  This is the same as buildIdData(uriForHandle(uriHandle), localId)
+    for a non-empty \a localId, but reuses the encoded URI of the registry.
+*/
+QByteArray QOrganizerManagerData::buildIdData(int uriHandle, const QByteArray &localId)
+{
+    return QOrganizerManagerUriRegistry::idData(uriHandle, escapeColon(localId));
 }
 
 QT_END_NAMESPACE_ORGANIZER
@@ -849,7 +849,7 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
                         const QOrganizerItemDetail& detail = details.at(j);
 
                         /* Check that the field is present and has a non-empty value */
-                        if (detail.values().contains(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
+                        if (detail.hasValue(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
                             return true;
                     }
                     return false;
@@ -913,7 +913,7 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
                 if (!cdf.minValue().isValid() && !cdf.maxValue().isValid()) {
                     for(int j=0; j < details.count(); j++) {
                         const QOrganizerItemDetail& detail = details.at(j);
-                        if (detail.values().contains(cdf.detailField()))
+                        if (detail.hasValue(cdf.detailField()))
                             return true;
                     }
                     return false;
@@ -2,7 +2,7 @@ TEMPLATE = subdirs
 
 CONFIG += ordered
 
-SUBDIRS += memory
+SUBDIRS += memory mapped
 
 #contains(mobility_modules,serviceframework): SUBDIRS += serviceactionmanager
 
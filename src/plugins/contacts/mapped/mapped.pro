@@ -0,0 +1,14 @@
+TARGET = qtcontacts_mapped
+QT = core contacts-private
+
+PLUGIN_TYPE = contacts
+PLUGIN_CLASS_NAME = QMappedContactsPlugin
+load(qt_plugin)
+
+HEADERS += \
+    qcontactmappedbackend_p.h
+
+SOURCES += \
+    qcontactmappedbackend.cpp
+
+OTHER_FILES += mapped.json
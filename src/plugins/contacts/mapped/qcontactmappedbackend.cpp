@@ -0,0 +1,408 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcontactmappedbackend_p.h"
+
+#include <QtContacts/qcontactdetailfilter.h>
+#include <QtContacts/qcontactdetailrangefilter.h>
+#include <QtContacts/qcontactintersectionfilter.h>
+#include <QtContacts/qcontactrequests.h>
+#include <QtContacts/qcontactunionfilter.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+QContactManagerEngine* QContactMappedEngineFactory::engine(const QMap<QString, QString> &parameters, QContactManager::Error *error)
+{
+    return QContactMappedEngine::createMappedEngine(parameters, error);
+}
+
+QString QContactMappedEngineFactory::managerName() const
+{
+    return QString::fromLatin1("mapped");
+}
+
+/*!
+  \class QContactMappedEngine
+
+  \inmodule QtContacts
+
+  \brief The QContactMappedEngine class provides a read-only contacts backend
+  which reads a file written by QContactBinaryWriter in place.
+
+  \internal
+
+  The file named by the "file" parameter is mapped into memory when the engine is
+  created, and contacts are decoded from the mapping as they are fetched.  Only the
+  details which a filter or sort order reads are decoded to test each contact, and
+  only the details in the fetch hint are decoded for the results, so opening and
+  searching a large store costs little more than the contacts which are returned.
+
+  The engine does not support saving or removing contacts, relationships or
+  collections.
+ */
+
+/*!
+ * Factory function for creating a new mapped backend, based on the given
+ * \a parameters.  Returns 0 and sets \a error if the file cannot be mapped or
+ * does not hold a contact store.
+ */
+QContactMappedEngine *QContactMappedEngine::createMappedEngine(const QMap<QString, QString> &parameters, QContactManager::Error *error)
+{
+    QContactMappedEngine *engine = new QContactMappedEngine(parameters.value(QStringLiteral("file")));
+    if (!engine->m_reader.isValid()) {
+        *error = engine->m_file.exists() ? QContactManager::BadArgumentError : QContactManager::DoesNotExistError;
+        delete engine;
+        return 0;
+    }
+
+    *error = QContactManager::NoError;
+    return engine;
+}
+
+QContactMappedEngine::QContactMappedEngine(const QString &fileName)
+    : m_file(fileName)
+{
+    if (!fileName.isEmpty() && m_file.open(QIODevice::ReadOnly)) {
+        if (const uchar *data = m_file.map(0, m_file.size()))
+            m_reader = QContactBinaryReader(data, m_file.size());
+    }
+}
+
+/*! Frees any memory used by this engine */
+QContactMappedEngine::~QContactMappedEngine()
+{
+}
+
+/*! \reimp */
+QString QContactMappedEngine::managerName() const
+{
+    return QStringLiteral("mapped");
+}
+
+/*! \reimp */
+QMap<QString, QString> QContactMappedEngine::managerParameters() const
+{
+    QMap<QString, QString> params;
+    params.insert(QStringLiteral("file"), m_file.fileName());
+    return params;
+}
+
+/*! \reimp
+*/
+QMap<QString, QString> QContactMappedEngine::idInterpretationParameters() const
+{
+    return managerParameters();
+}
+
+/*! \reimp */
+QContact QContactMappedEngine::contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const
+{
+    int index = indexOf(contactId);
+    if (index != -1) {
+        *error = QContactManager::NoError;
+        return decodeContact(index, fetchHint);
+    }
+
+    *error = QContactManager::DoesNotExistError;
+    return QContact();
+}
+
+/*! \reimp */
+QList<QContact> QContactMappedEngine::contacts(const QList<QContactId> &contactIds, const QContactFetchHint &fetchHint, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error) const
+{
+    QList<QContact> results;
+    results.reserve(contactIds.size());
+    *error = QContactManager::NoError;
+    for (int i = 0; i < contactIds.size(); ++i) {
+        int index = indexOf(contactIds.at(i));
+        if (index != -1) {
+            results.append(decodeContact(index, fetchHint));
+        } else {
+            results.append(QContact());
+            *error = QContactManager::DoesNotExistError;
+            if (errorMap)
+                errorMap->insert(i, QContactManager::DoesNotExistError);
+        }
+    }
+    return results;
+}
+
+/*! \reimp */
+QList<QContactId> QContactMappedEngine::contactIds(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QContactManager::Error *error) const
+{
+    /* Special case the fast case */
+    if (filter.type() == QContactFilter::DefaultFilter && sortOrders.count() == 0) {
+        *error = QContactManager::NoError;
+        QList<QContactId> ids;
+        ids.reserve(m_reader.contactCount());
+        for (int i = 0; i < m_reader.contactCount(); ++i)
+            ids.append(contactId(m_reader.localId(i)));
+        return ids;
+    }
+
+    /* The ids are read from the contact table, without decoding the matches again */
+    *error = QContactManager::NoError;
+    QList<QContactId> ids;
+    foreach (int index, matchingIndexes(filter, sortOrders, 0))
+        ids.append(contactId(m_reader.localId(index)));
+    return ids;
+}
+
+/*! \reimp */
+QList<QContact> QContactMappedEngine::contacts(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, const QContactFetchHint &fetchHint, QContactManager::Error *error) const
+{
+    *error = QContactManager::NoError;
+
+    QList<QContact> complete;
+    const QList<int> indexes(matchingIndexes(filter, sortOrders, &complete));
+    if (fetchHint.detailTypesHint().isEmpty() && complete.size() == indexes.size())
+        return complete;
+
+    /* Decode the details which were asked for */
+    QList<QContact> results;
+    results.reserve(indexes.size());
+    foreach (int index, indexes)
+        results.append(decodeContact(index, fetchHint));
+    return results;
+}
+
+/*! \reimp */
+QContactCollection QContactMappedEngine::collection(const QContactCollectionId &collectionId, QContactManager::Error *error) const
+{
+    foreach (const QContactCollection &collection, collections(error)) {
+        if (collection.id() == collectionId)
+            return collection;
+    }
+
+    *error = QContactManager::DoesNotExistError;
+    return QContactCollection();
+}
+
+/*!
+  \reimp
+
+  Collections are not stored apart from the contacts, so those returned hold only
+  the ids of the collections which contacts belong to.
+ */
+QList<QContactCollection> QContactMappedEngine::collections(QContactManager::Error *error) const
+{
+    *error = QContactManager::NoError;
+
+    QSet<quint32> seen;
+    QList<QContactCollection> collections;
+    for (int i = 0; i < m_reader.contactCount(); ++i) {
+        const QByteArray localId(m_reader.collectionLocalId(i));
+        if (localId.isEmpty() || seen.contains(m_reader.collectionKey(i)))
+            continue;
+        seen.insert(m_reader.collectionKey(i));
+
+        QContactCollection collection;
+        collection.setId(collectionId(localId));
+        collections.append(collection);
+    }
+    return collections;
+}
+
+/*! \reimp */
+bool QContactMappedEngine::startRequest(QContactAbstractRequest *req)
+{
+    QContactManager::Error operationError = QContactManager::NoError;
+
+    switch (req->type()) {
+    case QContactAbstractRequest::ContactFetchRequest:
+    {
+        QContactFetchRequest *r = static_cast<QContactFetchRequest*>(req);
+        updateRequestState(req, QContactAbstractRequest::ActiveState);
+        QList<QContact> requestedContacts = contacts(r->filter(), r->sorting(), r->fetchHint(), &operationError);
+        updateContactFetchRequest(r, requestedContacts, operationError, QContactAbstractRequest::FinishedState);
+    }
+    break;
+
+    case QContactAbstractRequest::ContactFetchByIdRequest:
+    {
+        QContactFetchByIdRequest *r = static_cast<QContactFetchByIdRequest*>(req);
+        updateRequestState(req, QContactAbstractRequest::ActiveState);
+        QMap<int, QContactManager::Error> errorMap;
+        QList<QContact> requestedContacts = contacts(r->contactIds(), r->fetchHint(), &errorMap, &operationError);
+        updateContactFetchByIdRequest(r, requestedContacts, operationError, errorMap, QContactAbstractRequest::FinishedState);
+    }
+    break;
+
+    case QContactAbstractRequest::ContactIdFetchRequest:
+    {
+        QContactIdFetchRequest *r = static_cast<QContactIdFetchRequest*>(req);
+        updateRequestState(req, QContactAbstractRequest::ActiveState);
+        QList<QContactId> requestedContactIds = contactIds(r->filter(), r->sorting(), &operationError);
+        updateContactIdFetchRequest(r, requestedContactIds, operationError, QContactAbstractRequest::FinishedState);
+    }
+    break;
+
+    case QContactAbstractRequest::CollectionFetchRequest:
+    {
+        QContactCollectionFetchRequest *r = static_cast<QContactCollectionFetchRequest*>(req);
+        updateRequestState(req, QContactAbstractRequest::ActiveState);
+        QList<QContactCollection> requestedCollections = collections(&operationError);
+        updateCollectionFetchRequest(r, requestedCollections, operationError, QContactAbstractRequest::FinishedState);
+    }
+    break;
+
+    default:
+        // the store is read-only
+        return false;
+    }
+
+    return true;
+}
+
+/*! \reimp */
+bool QContactMappedEngine::cancelRequest(QContactAbstractRequest *req)
+{
+    Q_UNUSED(req); // we can't cancel since we complete immediately
+    return false;
+}
+
+/*! \reimp */
+bool QContactMappedEngine::waitForRequestFinished(QContactAbstractRequest *req, int msecs)
+{
+    // in our implementation, we always complete any operation we start.
+    Q_UNUSED(msecs);
+    Q_UNUSED(req);
+
+    return true;
+}
+
+int QContactMappedEngine::indexOf(const QContactId &contactId) const
+{
+    if (contactId.managerUri() != managerUri())
+        return -1;
+    return m_reader.indexOf(contactId.localId());
+}
+
+QContact QContactMappedEngine::decodeContact(int index, const QContactFetchHint &fetchHint) const
+{
+    const QList<QContactDetail::DetailType> types(fetchHint.detailTypesHint());
+    if (types.isEmpty())
+        return m_reader.contact(index, managerUri());
+    return m_reader.contact(index, managerUri(), QSet<QContactDetail::DetailType>(types.constBegin(), types.constEnd()));
+}
+
+/*!
+  \internal
+
+  Returns the indexes in the reader of the contacts which match \a filter, sorted by
+  \a sortOrders.  Contacts are tested and sorted with only the details which are compared.
+  If the filter may read any detail, they are decoded in full, and those which match are
+  stored in \a complete, if given, in the same order.
+ */
+QList<int> QContactMappedEngine::matchingIndexes(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QList<QContact> *complete) const
+{
+    QSet<QContactDetail::DetailType> types;
+    const bool partial = addFilterDetailTypes(filter, &types);
+    foreach (const QContactSortOrder &sortOrder, sortOrders)
+        types.insert(sortOrder.detailType());
+
+    QList<QPair<int, QContact> > matches;
+    for (int i = 0; i < m_reader.contactCount(); ++i) {
+        const QContact c = partial ? m_reader.contact(i, managerUri(), types) : m_reader.contact(i, managerUri());
+        if (filter.type() == QContactFilter::DefaultFilter || QContactManagerEngine::testFilter(filter, c))
+            matches.append(qMakePair(i, c));
+    }
+    if (!sortOrders.isEmpty()) {
+        std::stable_sort(matches.begin(), matches.end(), [&sortOrders](const QPair<int, QContact> &a, const QPair<int, QContact> &b) {
+            return QContactManagerEngine::compareContact(a.second, b.second, sortOrders) < 0;
+        });
+    }
+
+    QList<int> indexes;
+    indexes.reserve(matches.size());
+    for (int i = 0; i < matches.size(); ++i)
+        indexes.append(matches.at(i).first);
+    if (complete && !partial) {
+        complete->reserve(matches.size());
+        for (int i = 0; i < matches.size(); ++i)
+            complete->append(matches.at(i).second);
+    }
+    return indexes;
+}
+
+/*!
+  \internal
+
+  Adds the types of the details which \a filter reads to \a types.  Returns false
+  if the filter may read any detail, so that contacts must be decoded in full.
+ */
+bool QContactMappedEngine::addFilterDetailTypes(const QContactFilter &filter, QSet<QContactDetail::DetailType> *types)
+{
+    switch (filter.type()) {
+    case QContactFilter::DefaultFilter:
+    case QContactFilter::InvalidFilter:
+    case QContactFilter::IdFilter:
+    case QContactFilter::CollectionFilter:
+        return true;
+    case QContactFilter::ContactDetailFilter:
+        types->insert(QContactDetailFilter(filter).detailType());
+        return true;
+    case QContactFilter::ContactDetailRangeFilter:
+        types->insert(QContactDetailRangeFilter(filter).detailType());
+        return true;
+    case QContactFilter::ChangeLogFilter:
+        types->insert(QContactDetail::TypeTimestamp);
+        return true;
+    case QContactFilter::IntersectionFilter:
+        foreach (const QContactFilter &f, QContactIntersectionFilter(filter).filters()) {
+            if (!addFilterDetailTypes(f, types))
+                return false;
+        }
+        return true;
+    case QContactFilter::UnionFilter:
+        foreach (const QContactFilter &f, QContactUnionFilter(filter).filters()) {
+            if (!addFilterDetailTypes(f, types))
+                return false;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+QT_END_NAMESPACE_CONTACTS
+
+#include "moc_qcontactmappedbackend_p.cpp"
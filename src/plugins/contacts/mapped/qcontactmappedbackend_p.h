@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCONTACTMAPPEDBACKEND_P_H
+#define QCONTACTMAPPEDBACKEND_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qfile.h>
+#include <QtCore/qset.h>
+
+#include <QtContacts/qcontactmanager.h>
+#include <QtContacts/qcontactmanagerengine.h>
+#include <QtContacts/qcontactmanagerenginefactory.h>
+#include <QtContacts/private/qcontactbinaryformat_p.h>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+class QContactMappedEngineFactory : public QContactManagerEngineFactory
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.qt-project.Qt.QContactManagerEngineFactoryInterface" FILE "mapped.json")
+public:
+    QContactManagerEngine* engine(const QMap<QString, QString> &parameters, QContactManager::Error *error);
+    QString managerName() const;
+};
+
+class QContactMappedEngine : public QContactManagerEngine
+{
+    Q_OBJECT
+
+public:
+    static QContactMappedEngine *createMappedEngine(const QMap<QString, QString> &parameters, QContactManager::Error *error);
+
+    ~QContactMappedEngine();
+
+    /* URI reporting */
+    QString managerName() const;
+    QMap<QString, QString> managerParameters() const;
+    QMap<QString, QString> idInterpretationParameters() const;
+
+    /*! \reimp */
+    int managerVersion() const {return 1;}
+
+    virtual QList<QContactId> contactIds(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QContactManager::Error *error) const;
+    virtual QList<QContact> contacts(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
+    virtual QList<QContact> contacts(const QList<QContactId> &contactIds, const QContactFetchHint &fetchHint, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error) const;
+    virtual QContact contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
+
+    // collections
+    QContactCollection collection(const QContactCollectionId &collectionId, QContactManager::Error *error) const;
+    QList<QContactCollection> collections(QContactManager::Error *error) const;
+
+    /* Asynchronous Request Support */
+    virtual bool startRequest(QContactAbstractRequest *req);
+    virtual bool cancelRequest(QContactAbstractRequest *req);
+    virtual bool waitForRequestFinished(QContactAbstractRequest *req, int msecs);
+
+private:
+    QContactMappedEngine(const QString &fileName);
+
+    int indexOf(const QContactId &contactId) const;
+    QContact decodeContact(int index, const QContactFetchHint &fetchHint) const;
+    QList<int> matchingIndexes(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QList<QContact> *complete) const;
+    static bool addFilterDetailTypes(const QContactFilter &filter, QSet<QContactDetail::DetailType> *types);
+
+    QFile m_file;
+    QContactBinaryReader m_reader;
+};
+
+QT_END_NAMESPACE_CONTACTS
+
+#endif // QCONTACTMAPPEDBACKEND_P_H
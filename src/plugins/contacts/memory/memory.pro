@@ -6,9 +6,11 @@ PLUGIN_CLASS_NAME = QMemoryContactsPlugin
 load(qt_plugin)
 
 HEADERS += \
-    qcontactmemorybackend_p.h
+    qcontactmemorybackend_p.h \
+    qcontactmemoryjournal_p.h
 
 SOURCES += \
-    qcontactmemorybackend.cpp
+    qcontactmemorybackend.cpp \
+    qcontactmemoryjournal.cpp
 
 OTHER_FILES += memory.json
@@ -52,6 +52,9 @@
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
+// number of contacts delivered by each resultsAvailable() of a fetch request
+static const int ContactFetchBatchSize = 100;
+
 QContactManagerEngine* QContactMemoryEngineFactory::engine(const QMap<QString, QString> &parameters, QContactManager::Error *error)
 {
     Q_UNUSED(error);
@@ -81,7 +84,11 @@ QString QContactMemoryEngineFactory::managerName() const
   identified by the "id" parameter from the given parameters if it exists, or a new,
   anonymous store if it does not.
 
-  Data stored in this engine is only available in the current process.
+  Data stored in this engine is only available in the current process, unless the
+  "journal" parameter names a file in which to keep it.  The data is then loaded from
+  that file when the store is first created, and every change is appended to it; the
+  file is compacted into a snapshot of the store from time to time.  The journal is
+  not part of the manager URI, so stores reopened with another "id" keep their data.
 
   This engine supports sharing, so an internal reference count is increased
   whenever a manager uses this backend, and is decreased when the manager
@@ -111,13 +118,68 @@ QContactMemoryEngine* QContactMemoryEngine::createMemoryEngine(const QMap<QStrin
     QContactMemoryEngineData *data = engineDatas.value(idValue);
     if (data) {
         data->m_refCount.ref();
-    } else {
-        data = new QContactMemoryEngineData();
-        data->m_id = idValue;
-        data->m_anonymous = anonymous;
-        engineDatas.insert(idValue, data);
+        return new QContactMemoryEngine(data);
     }
-    return new QContactMemoryEngine(data);
+
+    data = new QContactMemoryEngineData();
+    data->m_id = idValue;
+    data->m_anonymous = anonymous;
+    engineDatas.insert(idValue, data);
+
+    QContactMemoryEngine *engine = new QContactMemoryEngine(data);
+    const QString journal = parameters.value(QStringLiteral("journal"));
+    if (!journal.isEmpty())
+        engine->openJournal(journal);
+    return engine;
+}
+
+/*!
+ * Loads the store kept in the journal file \a path, and keeps any further changes in it.
+ * If the file cannot be read, the store is left empty and nothing is written to the file.
+ */
+void QContactMemoryEngine::openJournal(const QString &path)
+{
+    QContactMemoryJournal *journal = new QContactMemoryJournal(path, d->m_managerUri);
+    QContactMemoryJournal::State state;
+    if (!journal->load(&state)) {
+        qWarning("Cannot load contacts journal %s; changes will not be kept", qPrintable(path));
+        delete journal;
+        return;
+    }
+
+    restoreJournalState(state);
+    d->m_journal = journal;
+}
+
+/*!
+ * Replaces the (empty) data of this store with the given \a state.
+ */
+void QContactMemoryEngine::restoreJournalState(const QContactMemoryJournal::State &state)
+{
+    d->m_nextContactId = qMax(d->m_nextContactId, state.nextContactId);
+
+    foreach (const QContactCollection &collection, state.collections)
+        d->m_idToCollectionHash.insert(collection.id(), collection);
+
+    foreach (const QContact &contact, state.contacts) {
+        d->appendContact(contact);
+        d->m_contactsInCollections.insert(contact.collectionId(), contact.id());
+    }
+
+    d->m_relationships = state.relationships;
+    foreach (const QContactRelationship &relationship, state.relationships) {
+        d->m_orderedRelationships[relationship.first()].append(relationship);
+        d->m_orderedRelationships[relationship.second()].append(relationship);
+    }
+    for (QMap<QContactId, QList<QContactRelationship> >::const_iterator it = d->m_orderedRelationships.constBegin();
+         it != d->m_orderedRelationships.constEnd(); ++it) {
+        const int index = d->contactIndex(it.key());
+        if (index != -1)
+            QContactManagerEngine::setContactRelationships(&d->m_contacts[index], it.value());
+    }
+
+    if (d->m_contactIndexes.contains(state.selfContactId))
+        d->m_selfContactId = state.selfContactId;
 }
 
 /*!
@@ -178,10 +240,12 @@ QMap<QString, QString> QContactMemoryEngine::idInterpretationParameters() const
 /*! \reimp */
 bool QContactMemoryEngine::setSelfContactId(const QContactId &contactId, QContactManager::Error *error)
 {
-    if (contactId.isNull() || d->m_contactIds.contains(contactId)) {
+    if (contactId.isNull() || d->m_contactIndexes.contains(contactId)) {
         *error = QContactManager::NoError;
         QContactId oldId = d->m_selfContactId;
         d->m_selfContactId = contactId;
+        if (d->m_journal)
+            d->m_journal->selfContactIdChanged(contactId);
 
         QContactChangeSet changeSet;
         changeSet.setOldAndNewSelfContactId(QPair<QContactId, QContactId>(oldId, contactId));
@@ -206,7 +270,7 @@ QContactId QContactMemoryEngine::selfContactId(QContactManager::Error *error) co
 QContact QContactMemoryEngine::contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const
 {
     Q_UNUSED(fetchHint); // no optimizations are possible in the memory backend; ignore the fetch hint.
-    int index = d->m_contactIds.indexOf(contactId);
+    int index = d->contactIndex(contactId);
     if (index != -1) {
         // found the contact successfully.
         *error = QContactManager::NoError;
@@ -264,7 +328,12 @@ QList<QContact> QContactMemoryEngine::contacts(const QContactFilter &filter, con
 */
 bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &changeSet, QContactManager::Error *error)
 {
-    return saveContact(theContact, changeSet, error, QList<QContactDetail::DetailType>());
+    QList<QContactId> changedContactIds;
+    const bool saved = saveContact(theContact, changeSet, error, QList<QContactDetail::DetailType>(),
+                                   QDateTime::currentDateTime(), &changedContactIds);
+    if (!changedContactIds.isEmpty())
+        changeSet.insertChangedContacts(changedContactIds, QList<QContactDetail::DetailType>());
+    return saved;
 }
 
 /*! \reimp */
@@ -276,10 +345,13 @@ bool QContactMemoryEngine::saveContacts(QList<QContact> *contacts, QMap<int, QCo
 /*! Removes the contact identified by the given \a contactId, storing any error to \a error and
     filling the \a changeSet with ids of changed contacts and relationships as required.
     Returns true if the operation was successful otherwise false.
+
+    The contact's slot is only freed by QContactMemoryEngineData::compactContacts(), which the
+    caller must call once it has removed all of the contacts of the operation.
 */
 bool QContactMemoryEngine::removeContact(const QContactId &contactId, QContactChangeSet &changeSet, QContactManager::Error *error)
 {
-    int index = d->m_contactIds.indexOf(contactId);
+    int index = d->contactIndex(contactId);
 
     if (index == -1) {
         *error = QContactManager::DoesNotExistError;
@@ -299,8 +371,9 @@ bool QContactMemoryEngine::removeContact(const QContactId &contactId, QContactCh
     removeRelationships(allRelationships, 0, error);
 
     // having cleaned up the relationships, remove the contact from the lists.
-    d->m_contacts.removeAt(index);
-    d->m_contactIds.removeAt(index);
+    d->removeContactAt(index);
+    if (d->m_journal)
+        d->m_journal->contactRemoved(contactId);
     *error = QContactManager::NoError;
 
     // and if it was the self contact, reset the self contact id
@@ -332,6 +405,7 @@ bool QContactMemoryEngine::removeContacts(const QList<QContactId> &contactIds, Q
                 errorMap->insert(i, operationError);
         }
     }
+    d->compactContacts();
 
     *error = operationError;
     d->emitSharedSignals(&changeSet);
@@ -382,7 +456,7 @@ bool QContactMemoryEngine::saveRelationship(QContactRelationship *relationship,
     // Attempt to validate the relationship.
     // first, check that the source contact exists and is in this manager.
     QString myUri = managerUri();
-    int firstContactIndex = d->m_contactIds.indexOf(relationship->first());
+    int firstContactIndex = d->contactIndex(relationship->first());
     if ((!relationship->first().managerUri().isEmpty() && relationship->first().managerUri() != myUri)
             ||firstContactIndex == -1) {
         *error = QContactManager::InvalidRelationshipError;
@@ -391,7 +465,7 @@ bool QContactMemoryEngine::saveRelationship(QContactRelationship *relationship,
 
     // second, check that the second contact exists (if it's local); we cannot check other managers' contacts.
     QContactId dest = relationship->second();
-    int secondContactIndex = d->m_contactIds.indexOf(dest);
+    int secondContactIndex = d->contactIndex(dest);
 
     if (dest.managerUri().isEmpty() || dest.managerUri() == myUri) {
         // this entry in the destination list is supposedly stored in this manager.
@@ -436,6 +510,8 @@ bool QContactMemoryEngine::saveRelationship(QContactRelationship *relationship,
 
     // finally, insert into our list of all relationships, and return.
     d->m_relationships.append(*relationship);
+    if (d->m_journal)
+        d->m_journal->relationshipSaved(*relationship);
     return true;
 }
 
@@ -475,6 +551,8 @@ bool QContactMemoryEngine::removeRelationship(const QContactRelationship &relati
         *error = QContactManager::DoesNotExistError;
         return false;
     }
+    if (d->m_journal)
+        d->m_journal->relationshipRemoved(relationship);
 
     // if that worked, then we need to remove it from the two locations in our map, also.
     QList<QContactRelationship> firstRelationships = d->m_orderedRelationships.value(relationship.first());
@@ -485,8 +563,8 @@ bool QContactMemoryEngine::removeRelationship(const QContactRelationship &relati
     d->m_orderedRelationships.insert(relationship.second(), secondRelationships);
 
     // Update the contacts as well
-    int firstContactIndex = d->m_contactIds.indexOf(relationship.first());
-    int secondContactIndex = relationship.second().managerUri() == managerUri() ? d->m_contactIds.indexOf(relationship.second()) : -1;
+    int firstContactIndex = d->contactIndex(relationship.first());
+    int secondContactIndex = relationship.second().managerUri() == managerUri() ? d->contactIndex(relationship.second()) : -1;
     if (firstContactIndex != -1)
         QContactMemoryEngine::setContactRelationships(&d->m_contacts[firstContactIndex], firstRelationships);
     if (secondContactIndex != -1)
@@ -573,6 +651,8 @@ bool QContactMemoryEngine::saveCollection(QContactCollection *collection, QConta
     }
 
     d->m_idToCollectionHash.insert(collectionId, *collection);
+    if (d->m_journal)
+        d->m_journal->collectionSaved(*collection);
     d->emitSharedSignals(&cs);
     *error = QContactManager::NoError;
     return true;
@@ -601,6 +681,8 @@ bool QContactMemoryEngine::removeCollection(const QContactCollectionId &collecti
         // now remove the collection from our lists.
         d->m_idToCollectionHash.remove(collectionId);
         d->m_contactsInCollections.remove(collectionId);
+        if (d->m_journal)
+            d->m_journal->collectionRemoved(collectionId);
         QContactCollectionChangeSet cs;
         cs.insertRemovedCollection(collectionId);
         d->emitSharedSignals(&cs);
@@ -666,11 +748,21 @@ void QContactMemoryEngine::performAsynchronousOperation(QContactAbstractRequest
             QContactManager::Error operationError = QContactManager::NoError;
             QList<QContact> requestedContacts = contacts(filter, sorting, fetchHint, &operationError);
 
-            // update the request with the results.
-            if (!requestedContacts.isEmpty() || operationError != QContactManager::NoError)
-                updateContactFetchRequest(r, requestedContacts, operationError, QContactAbstractRequest::FinishedState);
-            else
-                updateRequestState(currentRequest, QContactAbstractRequest::FinishedState);
+            // update the request with the results, in batches so that clients can handle each
+            // batch as it arrives.  The first batch replaces any results of an earlier run.
+            if (requestedContacts.size() <= ContactFetchBatchSize) {
+                if (!requestedContacts.isEmpty() || operationError != QContactManager::NoError)
+                    updateContactFetchRequest(r, requestedContacts, operationError, QContactAbstractRequest::FinishedState);
+                else
+                    updateRequestState(currentRequest, QContactAbstractRequest::FinishedState);
+            } else {
+                updateContactFetchRequest(r, requestedContacts.mid(0, ContactFetchBatchSize), operationError, QContactAbstractRequest::ActiveState);
+                for (int i = ContactFetchBatchSize; i < requestedContacts.size(); i += ContactFetchBatchSize) {
+                    const bool last = i + ContactFetchBatchSize >= requestedContacts.size();
+                    appendContactFetchRequestResults(r, requestedContacts.mid(i, ContactFetchBatchSize), operationError,
+                                                     last ? QContactAbstractRequest::FinishedState : QContactAbstractRequest::ActiveState);
+                }
+            }
         }
         break;
 
@@ -764,6 +856,7 @@ void QContactMemoryEngine::performAsynchronousOperation(QContactAbstractRequest
                     operationError = tempError;
                 }
             }
+            d->compactContacts();
 
             if (!errorMap.isEmpty() || operationError != QContactManager::NoError)
                 updateContactRemoveRequest(r, operationError, errorMap, QContactAbstractRequest::FinishedState);
@@ -984,12 +1077,18 @@ bool QContactMemoryEngine::saveContacts(QList<QContact> *contacts, QMap<int, QCo
         return false;
     }
 
+    // every contact in the batch is stamped with the same time, and the change set is
+    // signalled once.  current shares its data with the caller's contact, so it is
+    // copied only when it is first modified, and then stored in both places.  The ids
+    // of the changed contacts are added to the change set together, as it keeps them sorted.
     QContactChangeSet changeSet;
+    QList<QContactId> changedContactIds;
+    const QDateTime now = QDateTime::currentDateTime();
     QContact current;
     QContactManager::Error operationError = QContactManager::NoError;
     for (int i = 0; i < contacts->count(); i++) {
         current = contacts->at(i);
-        if (!saveContact(&current, changeSet, error, mask)) {
+        if (!saveContact(&current, changeSet, error, mask, now, &changedContactIds)) {
             operationError = *error;
             if (errorMap)
                 errorMap->insert(i, operationError);
@@ -998,14 +1097,24 @@ bool QContactMemoryEngine::saveContacts(QList<QContact> *contacts, QMap<int, QCo
         }
     }
 
+    if (!changedContactIds.isEmpty())
+        changeSet.insertChangedContacts(changedContactIds, mask);
     *error = operationError;
     d->emitSharedSignals(&changeSet);
     // return false if some error occurred
     return (*error == QContactManager::NoError);
 }
 
+/*!
+  \internal
+
+  Saves \a theContact, or the details of the types in \a mask if it is not empty, with \a now as
+  its modification time.  A new contact is added to \a changeSet, while the id of an existing
+  one is appended to \a changedContactIds for the caller to add to \a changeSet.
+ */
 bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &changeSet,
-                                       QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask)
+                                       QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask,
+                                       const QDateTime &now, QList<QContactId> *changedContactIds)
 {
     // ensure that the contact's details conform to their definitions
     if (!validateContact(*theContact, error)) {
@@ -1020,31 +1129,30 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
     }
 
     // check to see if this contact already exists
-    int index = d->m_contactIds.indexOf(id);
+    int index = d->contactIndex(id);
     if (index != -1) {
         /* We also need to check that there are no modified create only details */
-        QContact oldContact = d->m_contacts.at(index);
+        const QContact &oldContact = d->m_contacts.at(index);
 
         if (oldContact.type() != theContact->type()) {
             *error = QContactManager::AlreadyExistsError;
             return false;
         }
 
-        // check if this is partial save
-        if (!mask.isEmpty()) {
-            QContact tempContact = oldContact;
-            partiallySyncDetails(&tempContact, *theContact, mask);
-            *theContact = tempContact;
-        }
+        // Looks ok, so continue.  A partial save syncs the masked details straight into the
+        // stored contact, which the saved contact then shares.
+        QContact &storedContact = d->m_contacts[index];
+        if (mask.isEmpty())
+            storedContact = *theContact;
+        else
+            partiallySyncDetails(&storedContact, *theContact, mask);
 
-        QContactTimestamp ts = theContact->detail(QContactTimestamp::Type);
-        ts.setLastModified(QDateTime::currentDateTime());
+        QContactTimestamp ts = storedContact.detail(QContactTimestamp::Type);
+        ts.setLastModified(now);
         QContactManagerEngine::setDetailAccessConstraints(&ts, QContactDetail::ReadOnly | QContactDetail::Irremovable);
-        theContact->saveDetail(&ts, QContact::ReplaceAccessConstraints);
-
-        // Looks ok, so continue
-        d->m_contacts.replace(index, *theContact);
-        changeSet.insertChangedContact(theContact->id(), mask);
+        storedContact.saveDetail(&ts, QContact::ReplaceAccessConstraints);
+        *theContact = storedContact;
+        changedContactIds->append(theContact->id());
     } else {
         // id does not exist; if not zero, fail.
         QContactId newId;
@@ -1077,8 +1185,8 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
 
         /* New contact */
         QContactTimestamp ts = theContact->detail(QContactTimestamp::Type);
-        ts.setLastModified(QDateTime::currentDateTime());
-        ts.setCreated(ts.lastModified());
+        ts.setLastModified(now);
+        ts.setCreated(now);
         setDetailAccessConstraints(&ts, QContactDetail::ReadOnly | QContactDetail::Irremovable);
         theContact->saveDetail(&ts, QContact::ReplaceAccessConstraints);
 
@@ -1088,13 +1196,14 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
         theContact->setId(newContactId);
 
         // finally, add the contact to our internal lists and return
-        d->m_contacts.append(*theContact);                   // add contact to list
-        d->m_contactIds.append(theContact->id());  // track the contact id.
+        d->appendContact(*theContact);                       // add contact to the lists
         d->m_contactsInCollections.insert(collectionId, newContactId); // link contact to collection
 
         changeSet.insertAddedContact(theContact->id());
     }
 
+    if (d->m_journal)
+        d->m_journal->contactSaved(*theContact);
     *error = QContactManager::NoError;     // successful.
     return true;
 }
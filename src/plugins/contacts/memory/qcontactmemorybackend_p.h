@@ -52,12 +52,16 @@
 // We mean it.
 //
 
+#include <QtCore/qdatetime.h>
+
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactmanager.h>
 #include <QtContacts/qcontactmanagerengine.h>
 #include <QtContacts/qcontactchangeset.h>
 #include <QtContacts/qcontactmanagerenginefactory.h>
 
+#include "qcontactmemoryjournal_p.h"
+
 QT_BEGIN_NAMESPACE_CONTACTS
 
 class QContactMemoryEngine;
@@ -80,6 +84,8 @@ public:
         , m_selfContactId()
         , m_nextContactId(1)
         , m_anonymous(false)
+        , m_journal(0)
+        , m_firstRemovedIndex(-1)
     {
     }
 
@@ -88,12 +94,15 @@ public:
         m_refCount(QAtomicInt(1)),
         m_selfContactId(other.m_selfContactId),
         m_nextContactId(other.m_nextContactId),
-        m_anonymous(other.m_anonymous)
+        m_anonymous(other.m_anonymous),
+        m_journal(0),
+        m_firstRemovedIndex(-1)
     {
     }
 
     ~QContactMemoryEngineData()
     {
+        delete m_journal;
     }
 
     static QContactMemoryEngineData *data(QContactMemoryEngine *engine);
@@ -106,22 +115,89 @@ public:
     QMultiHash<QContactCollectionId, QContactId> m_contactsInCollections; // hash of contacts for each collection
     QHash<QContactCollectionId, QContactCollection> m_idToCollectionHash; // hash of id to the collection identified by that id
     QList<QContactId> m_contactIds;           // list of contact Id's
+    QHash<QContactId, int> m_contactIndexes;  // index of each contact in m_contacts and m_contactIds
     QList<QContactRelationship> m_relationships;   // list of contact relationships
     QMap<QContactId, QList<QContactRelationship> > m_orderedRelationships; // map of ordered lists of contact relationships
     QList<QString> m_definitionIds;                // list of definition types (id's)
     quint32 m_nextContactId;
     bool m_anonymous;                              // Is this backend ever shared?
     QString m_managerUri;                        // for faster lookup.
+    QContactMemoryJournal *m_journal;              // persists the data, if the "journal" parameter was given
+    int m_firstRemovedIndex;                       // first empty slot left by removeContactAt(), or -1
+
+    int contactIndex(const QContactId &contactId) const
+    {
+        return m_contactIndexes.value(contactId, -1);
+    }
+
+    void appendContact(const QContact &contact)
+    {
+        Q_ASSERT(m_firstRemovedIndex < 0);
+        m_contactIndexes.insert(contact.id(), m_contacts.size());
+        m_contacts.append(contact);
+        m_contactIds.append(contact.id());
+    }
+
+    // Leaves an empty slot, so that the indexes of the other contacts stay valid until
+    // compactContacts() is called at the end of the operation.
+    void removeContactAt(int index)
+    {
+        m_contactIndexes.remove(m_contactIds.at(index));
+        m_contacts[index] = QContact();
+        m_contactIds[index] = QContactId();
+        if (m_firstRemovedIndex < 0 || index < m_firstRemovedIndex)
+            m_firstRemovedIndex = index;
+    }
+
+    void compactContacts()
+    {
+        if (m_firstRemovedIndex < 0)
+            return;
+        int to = m_firstRemovedIndex;
+        for (int from = to; from < m_contactIds.size(); ++from) {
+            if (m_contactIds.at(from).isNull())
+                continue;
+            if (from != to) {
+                m_contacts[to] = m_contacts.at(from);
+                m_contactIds[to] = m_contactIds.at(from);
+            }
+            m_contactIndexes[m_contactIds.at(to)] = to;
+            ++to;
+        }
+        m_contacts.erase(m_contacts.begin() + to, m_contacts.end());
+        m_contactIds.erase(m_contactIds.begin() + to, m_contactIds.end());
+        m_firstRemovedIndex = -1;
+    }
+
+    QContactMemoryJournal::State journalState() const
+    {
+        Q_ASSERT(m_firstRemovedIndex < 0);
+        QContactMemoryJournal::State state;
+        state.nextContactId = m_nextContactId;
+        state.selfContactId = m_selfContactId;
+        state.collections = m_idToCollectionHash.values();
+        state.contacts = m_contacts;
+        state.relationships = m_relationships;
+        return state;
+    }
 
+    // an operation's changes are all journaled by the time its signals are emitted
+    void compactJournalIfDue()
+    {
+        if (m_journal && m_journal->isCompactionDue())
+            m_journal->compact(journalState());
+    }
 
     void emitSharedSignals(QContactChangeSet *cs)
     {
+        compactJournalIfDue();
         foreach(QContactManagerEngine* engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
 
     void emitSharedSignals(QContactCollectionChangeSet *cs)
     {
+        compactJournalIfDue();
         foreach (QContactManagerEngine *engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
@@ -210,11 +286,14 @@ protected:
 private:
     /* For partial save */
     bool saveContacts(QList<QContact> *contacts, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask);
-    bool saveContact(QContact *theContact, QContactChangeSet &changeSet, QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask);
+    bool saveContact(QContact *theContact, QContactChangeSet &changeSet, QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask, const QDateTime &now, QList<QContactId> *changedContactIds);
     void partiallySyncDetails(QContact *to, const QContact &from, const QList<QContactDetail::DetailType> &mask);
 
     void performAsynchronousOperation(QContactAbstractRequest *request);
 
+    void openJournal(const QString &path);
+    void restoreJournalState(const QContactMemoryJournal::State &state);
+
     QContactMemoryEngineData *d;
     static QMap<QString, QContactMemoryEngineData*> engineDatas;
 
@@ -0,0 +1,563 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcontactmemoryjournal_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qthread.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+namespace {
+
+enum {
+    JournalMagic = 0x514a524e,          // "QJRN"
+    SnapshotMagic = 0x51534e50,         // "QSNP"
+    FormatVersion = 1,
+    HeaderSize = 6,                     // magic and version
+    MinimumCompactionSize = 256 * 1024  // smaller journals are replayed quickly enough
+};
+
+const QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+QString snapshotFileName(const QString &path)
+{
+    return path + QStringLiteral(".snapshot");
+}
+
+// The journal being compacted into a new snapshot, or left over from a failed compaction
+QString compactingFileName(const QString &path)
+{
+    return path + QStringLiteral(".compacting");
+}
+
+}
+
+/*!
+    \class QContactMemoryJournal
+    \internal
+
+    The snapshot and journal of a QContactMemoryEngine store.
+*/
+
+/*!
+    Constructs a journal kept in the file \a path.  The snapshot is kept next to it, as is the
+    journal being compacted while a snapshot is written.  Ids read back are given the manager
+    URI \a managerUri.
+*/
+QContactMemoryJournal::QContactMemoryJournal(const QString &path, const QString &managerUri)
+    : m_path(path)
+    , m_managerUri(managerUri)
+    , m_snapshotSize(0)
+    , m_compaction(0)
+{
+}
+
+QContactMemoryJournal::~QContactMemoryJournal()
+{
+    waitForCompaction();
+}
+
+/*!
+    Reads the snapshot and replays the journal into \a state, then opens the journal for the
+    changes to come.  Returns false if the files exist but cannot be read.
+*/
+bool QContactMemoryJournal::load(State *state)
+{
+    *state = State();
+
+    QFile snapshot(snapshotFileName(m_path));
+    if (snapshot.exists()) {
+        if (!snapshot.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream in(&snapshot);
+        in.setVersion(StreamVersion);
+        quint32 magic = 0;
+        quint16 version = 0;
+        in >> magic >> version;
+        if (magic != quint32(SnapshotMagic) || version != FormatVersion || !readSnapshot(in, state))
+            return false;
+        m_snapshotSize.storeRelaxed(snapshot.size());
+    }
+
+    if (!readJournal(compactingFileName(m_path), state, false))
+        return false;
+    if (!readJournal(m_path, state, true))
+        return false;
+    return openJournal();
+}
+
+/*!
+    Records that \a contact was saved, as it is now stored.
+*/
+void QContactMemoryJournal::contactSaved(const QContact &contact)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SaveContact);
+    writeContact(out, contact);
+    append(record);
+}
+
+/*!
+    Records that the contact identified by \a contactId was removed.
+*/
+void QContactMemoryJournal::contactRemoved(const QContactId &contactId)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(RemoveContact) << contactId.localId();
+    append(record);
+}
+
+/*!
+    Records that \a relationship was saved.
+*/
+void QContactMemoryJournal::relationshipSaved(const QContactRelationship &relationship)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SaveRelationship);
+    writeRelationship(out, relationship);
+    append(record);
+}
+
+/*!
+    Records that \a relationship was removed.
+*/
+void QContactMemoryJournal::relationshipRemoved(const QContactRelationship &relationship)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(RemoveRelationship);
+    writeRelationship(out, relationship);
+    append(record);
+}
+
+/*!
+    Records that \a collection was saved.
+*/
+void QContactMemoryJournal::collectionSaved(const QContactCollection &collection)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SaveCollection) << collection;
+    append(record);
+}
+
+/*!
+    Records that the collection identified by \a collectionId was removed.  The contacts it
+    contained are recorded as removed separately.
+*/
+void QContactMemoryJournal::collectionRemoved(const QContactCollectionId &collectionId)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(RemoveCollection) << collectionId.localId();
+    append(record);
+}
+
+/*!
+    Records that the self contact is now the one identified by \a contactId.
+*/
+void QContactMemoryJournal::selfContactIdChanged(const QContactId &contactId)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SetSelfContactId) << contactId.localId();
+    append(record);
+}
+
+/*!
+    Returns true if the journal has grown large enough to be compacted, and no compaction is
+    running already.
+*/
+bool QContactMemoryJournal::isCompactionDue() const
+{
+    if (!m_journal.isOpen() || (m_compaction && !m_compaction->isFinished()))
+        return false;
+    return m_journal.size() > qMax<qint64>(m_snapshotSize.loadRelaxed(), MinimumCompactionSize);
+}
+
+/*!
+    Starts a new journal, and writes \a state, which must include every change journaled so far,
+    as the new snapshot on a background thread.
+*/
+void QContactMemoryJournal::compact(const State &state)
+{
+    waitForCompaction();
+
+    // Move the current journal aside; it is replayed after the old snapshot until the new one
+    // has been written.  If an earlier compaction failed, its journal is still there and this
+    // one's records are added to it.
+    m_journal.close();
+    const QString compacting(compactingFileName(m_path));
+    if (QFile::exists(compacting)) {
+        QFile target(compacting);
+        if (!target.open(QIODevice::Append) || !m_journal.open(QIODevice::ReadOnly)) {
+            qWarning("Cannot compact contacts journal %s", qPrintable(m_path));
+            openJournal();
+            return;
+        }
+        m_journal.seek(HeaderSize);
+        target.write(m_journal.readAll());
+        m_journal.close();
+        target.close();
+        QFile::remove(m_path);
+    } else if (!QFile::rename(m_path, compacting)) {
+        qWarning("Cannot compact contacts journal %s", qPrintable(m_path));
+        openJournal();
+        return;
+    }
+    openJournal();
+
+    m_compaction = QThread::create([this, state] {
+        const QString fileName(snapshotFileName(m_path));
+        QSaveFile snapshot(fileName);
+        if (snapshot.open(QIODevice::WriteOnly)) {
+            QDataStream out(&snapshot);
+            out.setVersion(StreamVersion);
+            out << quint32(SnapshotMagic) << quint16(FormatVersion);
+            writeSnapshot(out, state);
+            if (out.status() == QDataStream::Ok && snapshot.commit()) {
+                m_snapshotSize.storeRelaxed(QFileInfo(fileName).size());
+                QFile::remove(compactingFileName(m_path));
+                return;
+            }
+        }
+        qWarning("Cannot write contacts snapshot %s", qPrintable(fileName));
+    });
+    m_compaction->start();
+}
+
+/*!
+    Blocks until the snapshot being written by compact(), if any, is complete.
+*/
+void QContactMemoryJournal::waitForCompaction()
+{
+    if (m_compaction) {
+        m_compaction->wait();
+        delete m_compaction;
+        m_compaction = 0;
+    }
+}
+
+void QContactMemoryJournal::append(const QByteArray &record)
+{
+    if (!m_journal.isOpen())
+        return;
+
+    QDataStream out(&m_journal);
+    out.setVersion(StreamVersion);
+    out << record;
+    m_journal.flush();
+}
+
+bool QContactMemoryJournal::openJournal()
+{
+    m_journal.setFileName(m_path);
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+
+    if (m_journal.size() == 0) {
+        QDataStream out(&m_journal);
+        out.setVersion(StreamVersion);
+        out << quint32(JournalMagic) << quint16(FormatVersion);
+        m_journal.flush();
+    }
+    return true;
+}
+
+/*
+    Replays the records of the journal \a fileName into \a state.  A process which exits while
+    appending leaves a partial record at the end; it is ignored, and removed from the file if
+    \a truncateTornRecord is true, so that later records can follow the complete ones.
+*/
+bool QContactMemoryJournal::readJournal(const QString &fileName, State *state, bool truncateTornRecord)
+{
+    QFile file(fileName);
+    if (!file.exists())
+        return true;
+    if (!file.open(truncateTornRecord ? QIODevice::ReadWrite : QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok) {
+        // not even the header was written
+        if (truncateTornRecord)
+            file.resize(0);
+        return true;
+    }
+    if (magic != quint32(JournalMagic) || version != FormatVersion)
+        return false;
+
+    // Contacts are looked up by id for each record; removed ones leave a null contact behind,
+    // so that the others keep their order.
+    QHash<QContactId, int> contactIndexes;
+    for (int i = 0; i < state->contacts.size(); ++i)
+        contactIndexes.insert(state->contacts.at(i).id(), i);
+
+    qint64 end = file.pos();
+    while (!in.atEnd()) {
+        QByteArray record;
+        in >> record;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        QDataStream recordIn(record);
+        recordIn.setVersion(StreamVersion);
+        quint8 operation = 0;
+        recordIn >> operation;
+        switch (operation) {
+        case SaveContact: {
+            QContact contact;
+            if (!readContact(recordIn, &contact))
+                return false;
+            const QHash<QContactId, int>::const_iterator it = contactIndexes.constFind(contact.id());
+            if (it != contactIndexes.constEnd()) {
+                state->contacts[it.value()] = contact;
+            } else {
+                contactIndexes.insert(contact.id(), state->contacts.size());
+                state->contacts.append(contact);
+            }
+            const QByteArray localId(contact.id().localId());
+            if (localId.size() == int(sizeof(quint32))) {
+                quint32 value;
+                memcpy(&value, localId.constData(), sizeof(quint32));
+                state->nextContactId = qMax(state->nextContactId, value + 1);
+            }
+            break;
+        }
+        case RemoveContact: {
+            QByteArray localId;
+            recordIn >> localId;
+            const QContactId contactId(m_managerUri, localId);
+            const QHash<QContactId, int>::iterator it = contactIndexes.find(contactId);
+            if (it != contactIndexes.end()) {
+                state->contacts[it.value()] = QContact();
+                contactIndexes.erase(it);
+            }
+            if (state->selfContactId == contactId)
+                state->selfContactId = QContactId();
+            break;
+        }
+        case SaveRelationship: {
+            QContactRelationship relationship;
+            if (!readRelationship(recordIn, &relationship))
+                return false;
+            if (!state->relationships.contains(relationship))
+                state->relationships.append(relationship);
+            break;
+        }
+        case RemoveRelationship: {
+            QContactRelationship relationship;
+            if (!readRelationship(recordIn, &relationship))
+                return false;
+            state->relationships.removeOne(relationship);
+            break;
+        }
+        case SaveCollection: {
+            QContactCollection collection;
+            if (!readCollection(recordIn, &collection))
+                return false;
+            bool replaced = false;
+            for (int i = 0; i < state->collections.size() && !replaced; ++i) {
+                if (state->collections.at(i).id() == collection.id()) {
+                    state->collections[i] = collection;
+                    replaced = true;
+                }
+            }
+            if (!replaced)
+                state->collections.append(collection);
+            break;
+        }
+        case RemoveCollection: {
+            QByteArray localId;
+            recordIn >> localId;
+            const QContactCollectionId collectionId(m_managerUri, localId);
+            for (int i = 0; i < state->collections.size(); ++i) {
+                if (state->collections.at(i).id() == collectionId) {
+                    state->collections.removeAt(i);
+                    break;
+                }
+            }
+            break;
+        }
+        case SetSelfContactId: {
+            QByteArray localId;
+            recordIn >> localId;
+            state->selfContactId = QContactId(m_managerUri, localId);
+            break;
+        }
+        default:
+            return false;
+        }
+        if (recordIn.status() != QDataStream::Ok)
+            return false;
+
+        end = file.pos();
+    }
+
+    if (truncateTornRecord && end < file.size())
+        file.resize(end);
+
+    QList<QContact> contacts;
+    contacts.reserve(contactIndexes.size());
+    foreach (const QContact &contact, state->contacts) {
+        if (!contact.id().isNull())
+            contacts.append(contact);
+    }
+    state->contacts = contacts;
+    return true;
+}
+
+void QContactMemoryJournal::writeContact(QDataStream &out, const QContact &contact) const
+{
+    // the contact stream doesn't include the collection
+    out << contact << contact.collectionId().localId();
+}
+
+bool QContactMemoryJournal::readContact(QDataStream &in, QContact *contact) const
+{
+    QByteArray collectionLocalId;
+    in >> *contact >> collectionLocalId;
+    contact->setId(QContactId(m_managerUri, contact->id().localId()));
+    contact->setCollectionId(QContactCollectionId(m_managerUri, collectionLocalId));
+    return in.status() == QDataStream::Ok && !contact->id().isNull();
+}
+
+void QContactMemoryJournal::writeRelationship(QDataStream &out, const QContactRelationship &relationship) const
+{
+    // the second contact may belong to another manager, whose ids keep their URI
+    const QContactId second(relationship.second());
+    const bool secondIsLocal = second.managerUri() == m_managerUri;
+    out << relationship.relationshipType() << relationship.first().localId()
+        << secondIsLocal << (secondIsLocal ? second.localId() : second.toByteArray());
+}
+
+bool QContactMemoryJournal::readRelationship(QDataStream &in, QContactRelationship *relationship) const
+{
+    QString type;
+    QByteArray first;
+    bool secondIsLocal = false;
+    QByteArray second;
+    in >> type >> first >> secondIsLocal >> second;
+    relationship->setRelationshipType(type);
+    relationship->setFirst(QContactId(m_managerUri, first));
+    relationship->setSecond(secondIsLocal ? QContactId(m_managerUri, second) : QContactId::fromByteArray(second));
+    return in.status() == QDataStream::Ok;
+}
+
+bool QContactMemoryJournal::readCollection(QDataStream &in, QContactCollection *collection) const
+{
+    in >> *collection;
+    collection->setId(QContactCollectionId(m_managerUri, collection->id().localId()));
+    return in.status() == QDataStream::Ok && !collection->id().isNull();
+}
+
+void QContactMemoryJournal::writeSnapshot(QDataStream &out, const State &state) const
+{
+    out << state.nextContactId << state.selfContactId.localId();
+
+    out << quint32(state.collections.size());
+    foreach (const QContactCollection &collection, state.collections)
+        out << collection;
+
+    out << quint32(state.contacts.size());
+    foreach (const QContact &contact, state.contacts)
+        writeContact(out, contact);
+
+    out << quint32(state.relationships.size());
+    foreach (const QContactRelationship &relationship, state.relationships)
+        writeRelationship(out, relationship);
+}
+
+bool QContactMemoryJournal::readSnapshot(QDataStream &in, State *state) const
+{
+    QByteArray selfLocalId;
+    in >> state->nextContactId >> selfLocalId;
+    state->selfContactId = QContactId(m_managerUri, selfLocalId);
+
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QContactCollection collection;
+        if (!readCollection(in, &collection))
+            return false;
+        state->collections.append(collection);
+    }
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QContact contact;
+        if (!readContact(in, &contact))
+            return false;
+        state->contacts.append(contact);
+    }
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QContactRelationship relationship;
+        if (!readRelationship(in, &relationship))
+            return false;
+        state->relationships.append(relationship);
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+QT_END_NAMESPACE_CONTACTS
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCONTACTMEMORYJOURNAL_P_H
+#define QCONTACTMEMORYJOURNAL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qlist.h>
+
+#include <QtContacts/qcontact.h>
+#include <QtContacts/qcontactcollection.h>
+#include <QtContacts/qcontactrelationship.h>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+class QThread;
+QT_END_NAMESPACE
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*
+ * Keeps the data of a memory engine on disk: a snapshot of the whole store, and a journal of the
+ * changes made since the snapshot was written.  Ids are stored without their manager URI and are
+ * given the URI of the loading engine, so anonymous stores can be reopened too.
+ *
+ * Once the journal has grown as large as the snapshot, compact() writes a new snapshot on a
+ * background thread while further changes go to a fresh journal.
+ */
+class QContactMemoryJournal
+{
+public:
+    struct State
+    {
+        State() : nextContactId(1) {}
+
+        quint32 nextContactId;
+        QContactId selfContactId;
+        QList<QContactCollection> collections;
+        QList<QContact> contacts;
+        QList<QContactRelationship> relationships;
+    };
+
+    QContactMemoryJournal(const QString &path, const QString &managerUri);
+    ~QContactMemoryJournal();
+
+    bool load(State *state);
+
+    void contactSaved(const QContact &contact);
+    void contactRemoved(const QContactId &contactId);
+    void relationshipSaved(const QContactRelationship &relationship);
+    void relationshipRemoved(const QContactRelationship &relationship);
+    void collectionSaved(const QContactCollection &collection);
+    void collectionRemoved(const QContactCollectionId &collectionId);
+    void selfContactIdChanged(const QContactId &contactId);
+
+    bool isCompactionDue() const;
+    void compact(const State &state);
+    void waitForCompaction();
+
+private:
+    enum Operation {
+        SaveContact = 1,
+        RemoveContact,
+        SaveRelationship,
+        RemoveRelationship,
+        SaveCollection,
+        RemoveCollection,
+        SetSelfContactId
+    };
+
+    void append(const QByteArray &record);
+    bool openJournal();
+    bool readJournal(const QString &fileName, State *state, bool truncateTornRecord);
+
+    void writeContact(QDataStream &out, const QContact &contact) const;
+    bool readContact(QDataStream &in, QContact *contact) const;
+    void writeRelationship(QDataStream &out, const QContactRelationship &relationship) const;
+    bool readRelationship(QDataStream &in, QContactRelationship *relationship) const;
+    bool readCollection(QDataStream &in, QContactCollection *collection) const;
+    void writeSnapshot(QDataStream &out, const State &state) const;
+    bool readSnapshot(QDataStream &in, State *state) const;
+
+    QString m_path;
+    QString m_managerUri;
+    QFile m_journal;
+    QAtomicInteger<qint64> m_snapshotSize;
+    QThread *m_compaction;
+};
+
+QT_END_NAMESPACE_CONTACTS
+
+#endif // QCONTACTMEMORYJOURNAL_P_H
@@ -6,9 +6,11 @@ PLUGIN_CLASS_NAME = QMemoryOrganizerPlugin
 load(qt_plugin)
 
 HEADERS += \
-    qorganizeritemmemorybackend_p.h
+    qorganizeritemmemorybackend_p.h \
+    qorganizeritemmemoryjournal_p.h
 
 SOURCES += \
-    qorganizeritemmemorybackend.cpp
+    qorganizeritemmemorybackend.cpp \
+    qorganizeritemmemoryjournal.cpp
 
 OTHER_FILES += memory.json
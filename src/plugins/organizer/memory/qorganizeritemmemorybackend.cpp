@@ -79,7 +79,11 @@ QString QOrganizerItemMemoryFactory::managerName() const
   identified by the "id" parameter from the given parameters if it exists, or a new,
   anonymous store if it does not.
 
-  Data stored in this engine is only available in the current process.
+  Data stored in this engine is only available in the current process, unless the
+  "journal" parameter names a file in which to keep it.  The data is then loaded from
+  that file when the store is first created, and every change is appended to it; the
+  file is compacted into a snapshot of the store from time to time.  The snapshot is
+  memory-mapped on loading, and its items are only decoded when first accessed.
 
   This engine supports sharing, so an internal reference count is increased
   whenever a manager uses this backend, and is decreased when the manager
@@ -94,11 +98,107 @@ Q_GLOBAL_STATIC(EngineDatas, theEngineDatas);
 QOrganizerItemMemoryEngineData::QOrganizerItemMemoryEngineData()
     : QSharedData(),
     m_nextOrganizerItemId(1),
-    m_nextOrganizerCollectionId(2)
+    m_nextOrganizerCollectionId(2),
+    m_journal(0)
 {
 
 }
 
+/*!
+ * Returns the item identified by \a itemId, decoding it if it was loaded from the journal
+ * and has not been accessed yet, or an empty item if there is no such item.
+ */
+QOrganizerItem QOrganizerItemMemoryEngineData::item(const QOrganizerItemId &itemId)
+{
+    QHash<QOrganizerItemId, QOrganizerItem>::const_iterator it = m_idToItemHash.constFind(itemId);
+    if (it != m_idToItemHash.constEnd())
+        return it.value();
+
+    QHash<QOrganizerItemId, QByteArray>::iterator encoded = m_encodedItems.find(itemId);
+    if (encoded == m_encodedItems.end())
+        return QOrganizerItem();
+
+    const QOrganizerItem item(decodeItem(itemId, encoded.value()));
+    m_encodedItems.erase(encoded);
+    return item;
+}
+
+/*!
+ * Decodes every item loaded from the journal which has not been accessed yet, before all of
+ * the items are iterated over.
+ */
+void QOrganizerItemMemoryEngineData::decodeItems()
+{
+    if (m_encodedItems.isEmpty())
+        return;
+
+    for (QHash<QOrganizerItemId, QByteArray>::const_iterator it = m_encodedItems.constBegin(); it != m_encodedItems.constEnd(); ++it)
+        decodeItem(it.key(), it.value());
+    m_encodedItems.clear();
+}
+
+/*!
+ * Decodes the \a data of the item identified by \a itemId and stores the item.  An item which
+ * cannot be decoded is reported and dropped from the store, along with its index entries, and
+ * an empty item is returned.  It is left out of the next snapshot.
+ */
+QOrganizerItem QOrganizerItemMemoryEngineData::decodeItem(const QOrganizerItemId &itemId, const QByteArray &data)
+{
+    QOrganizerItem item;
+    if (m_journal->decodeItem(data, &item)) {
+        m_idToItemHash.insert(itemId, item);
+        return item;
+    }
+
+    qWarning("Dropping organizer item %s, which is corrupt in the journal", qPrintable(itemId.toString()));
+    for (QMultiHash<QOrganizerCollectionId, QOrganizerItemId>::iterator it = m_itemsInCollectionsHash.begin(); it != m_itemsInCollectionsHash.end(); ) {
+        if (it.value() == itemId)
+            it = m_itemsInCollectionsHash.erase(it);
+        else
+            ++it;
+    }
+    for (QMultiHash<QOrganizerItemId, QOrganizerItemId>::iterator it = m_parentIdToChildIdHash.begin(); it != m_parentIdToChildIdHash.end(); ) {
+        if (it.value() == itemId)
+            it = m_parentIdToChildIdHash.erase(it);
+        else
+            ++it;
+    }
+    return QOrganizerItem();
+}
+
+/*!
+ * Removes the item identified by \a itemId, whether it has been decoded or not.
+ */
+void QOrganizerItemMemoryEngineData::removeItem(const QOrganizerItemId &itemId)
+{
+    m_idToItemHash.remove(itemId);
+    m_encodedItems.remove(itemId);
+    if (m_journal)
+        m_journal->itemRemoved(itemId);
+}
+
+/*!
+ * Writes a new snapshot of the journal once it has grown large enough.  Items still encoded
+ * are written as they are.
+ */
+void QOrganizerItemMemoryEngineData::compactJournalIfDue()
+{
+    if (!m_journal || !m_journal->isCompactionDue())
+        return;
+
+    QOrganizerItemMemoryJournal::State state;
+    state.nextItemId = m_nextOrganizerItemId;
+    state.nextCollectionId = m_nextOrganizerCollectionId;
+    state.collections = m_idToCollectionHash.values();
+    state.items = m_idToItemHash.values();
+    for (QHash<QOrganizerItemId, QByteArray>::const_iterator it = m_encodedItems.constBegin(); it != m_encodedItems.constEnd(); ++it) {
+        QOrganizerItemMemoryJournal::EncodedItem item;
+        item.data = it.value();
+        state.encodedItems.insert(it.key(), item);
+    }
+    m_journal->compact(state);
+}
+
 /*!
  * Factory function for creating a new in-memory backend, based
  * on the given \a parameters.
@@ -112,16 +212,64 @@ QOrganizerItemMemoryEngine* QOrganizerItemMemoryEngine::createMemoryEngine(const
 
     EngineDatas &engineDatas = *theEngineDatas();
     QOrganizerItemMemoryEngineData* data = engineDatas.value(idValue);
-    if (!data) {
-        data = new QOrganizerItemMemoryEngineData();
-        // no store given?  new, anonymous store.
-        if (!idValue.isEmpty()) {
-            data->m_id = idValue;
-            engineDatas.insert(idValue, data);
-        }
+    if (data) {
+        data->ref.ref();
+        return new QOrganizerItemMemoryEngine(data);
+    }
+
+    data = new QOrganizerItemMemoryEngineData();
+    // no store given?  new, anonymous store.
+    if (!idValue.isEmpty()) {
+        data->m_id = idValue;
+        engineDatas.insert(idValue, data);
     }
     data->ref.ref();
-    return new QOrganizerItemMemoryEngine(data);
+
+    QOrganizerItemMemoryEngine *engine = new QOrganizerItemMemoryEngine(data);
+    const QString journal = parameters.value(QStringLiteral("journal"));
+    if (!journal.isEmpty())
+        engine->openJournal(journal);
+    return engine;
+}
+
+/*!
+ * Loads the store kept in the journal file \a path, and keeps any further changes in it.
+ * If the file cannot be read, the store is left empty and nothing is written to the file.
+ */
+void QOrganizerItemMemoryEngine::openJournal(const QString &path)
+{
+    QOrganizerItemMemoryJournal *journal = new QOrganizerItemMemoryJournal(path, d->m_managerUri);
+    QOrganizerItemMemoryJournal::State state;
+    if (!journal->load(&state)) {
+        qWarning("Cannot load organizer journal %s; changes will not be kept", qPrintable(path));
+        delete journal;
+        return;
+    }
+
+    d->m_journal = journal;
+    restoreJournalState(state);
+}
+
+/*!
+ * Replaces the (empty) data of this store with the given \a state.  Its items are indexed
+ * but left encoded.
+ */
+void QOrganizerItemMemoryEngine::restoreJournalState(const QOrganizerItemMemoryJournal::State &state)
+{
+    d->m_nextOrganizerItemId = qMax(d->m_nextOrganizerItemId, state.nextItemId);
+    d->m_nextOrganizerCollectionId = qMax(d->m_nextOrganizerCollectionId, state.nextCollectionId);
+
+    foreach (const QOrganizerCollection &collection, state.collections)
+        d->m_idToCollectionHash.insert(collection.id(), collection);
+
+    d->m_encodedItems.reserve(state.encodedItems.size());
+    for (QHash<QOrganizerItemId, QOrganizerItemMemoryJournal::EncodedItem>::const_iterator it = state.encodedItems.constBegin();
+         it != state.encodedItems.constEnd(); ++it) {
+        d->m_encodedItems.insert(it.key(), it.value().data);
+        d->m_itemsInCollectionsHash.insert(it.value().collectionId, it.key());
+        if (!it.value().parentId.isNull())
+            d->m_parentIdToChildIdHash.insert(it.value().parentId, it.key());
+    }
 }
 
 /*!
@@ -206,7 +354,7 @@ QList<QOrganizerItemId> QOrganizerItemMemoryEngine::itemIds(const QOrganizerItem
                                                             QOrganizerManager::Error *error)
 {
     if (startDateTime.isNull() && endDateTime.isNull() && filter.type() == QOrganizerItemFilter::DefaultFilter && sortOrders.count() == 0)
-        return d->m_idToItemHash.keys();
+        return d->m_idToItemHash.keys() + d->m_encodedItems.keys();
     else
         return QOrganizerManager::extractIds(itemsForExport(startDateTime, endDateTime, filter, sortOrders, QOrganizerItemFetchHint(), error));
 }
@@ -255,6 +403,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
 
     if (includeExceptions) {
         // first, retrieve all persisted instances (exceptions) which occur between the specified datetimes.
+        d->decodeItems();
         foreach (const QOrganizerItem& item, d->m_idToItemHash) {
             if (item.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId) == parentItem.id()) {
                 QDateTime lowerBound;
@@ -448,7 +597,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::itemsForExport(const QList<QOr
 
 QOrganizerItem QOrganizerItemMemoryEngine::item(const QOrganizerItemId& organizeritemId) const
 {
-    return d->m_idToItemHash.value(organizeritemId);
+    return d->item(organizeritemId);
 }
 
 QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItems(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, const QOrganizerItemFetchHint& fetchHint, QOrganizerManager::Error* error, bool forExport) const
@@ -460,6 +609,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItems(const QDateTime&
     QSet<QOrganizerItemId> parentsAdded;
     bool isDefFilter = (filter.type() == QOrganizerItemFilter::DefaultFilter);
 
+    d->decodeItems();
     foreach(const QOrganizerItem& c, d->m_idToItemHash) {
         if (itemHasReccurence(c)) {
             addItemRecurrences(sorted, c, startDate, endDate, filter, sortOrders, forExport, &parentsAdded);
@@ -526,10 +676,9 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
 
     // check to see if this organizer item already exists
     QOrganizerItemId theOrganizerItemId = theOrganizerItem->id();
-    QHash<QOrganizerItemId, QOrganizerItem>::const_iterator hashIterator = d->m_idToItemHash.find(theOrganizerItemId);
-    if (hashIterator != d->m_idToItemHash.constEnd()) {
+    if (d->containsItem(theOrganizerItemId)) {
         /* We also need to check that there are no modified create only details */
-        QOrganizerItem oldOrganizerItem = hashIterator.value();
+        QOrganizerItem oldOrganizerItem = d->item(theOrganizerItemId);
 
         if (oldOrganizerItem.type() != theOrganizerItem->type()) {
             *error = QOrganizerManager::AlreadyExistsError;
@@ -554,7 +703,10 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
             return false;
         }
         // Looks ok, so continue
+        theOrganizerItem->setCollectionId(targetCollectionId);
         d->m_idToItemHash.insert(theOrganizerItemId, *theOrganizerItem); // replacement insert.
+        if (d->m_journal)
+            d->m_journal->itemSaved(*theOrganizerItem);
         changeSet.insertChangedItem(theOrganizerItemId, detailMask);
 
         // cross-check if stored exception occurrences are still valid
@@ -575,7 +727,7 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
                     QList<QOrganizerItem> occurrences = internalItemOccurrences(*theOrganizerItem, QDateTime(), QDateTime(), -1, false, false, &exceptionDates, &occurrenceError);
                     foreach (const QOrganizerItemId &occurrenceId, occurrenceIds) {
                         // remove all occurrence ids from the list which have valid exception date
-                        QOrganizerItemParent parentDetail = d->m_idToItemHash.value(occurrenceId).detail(QOrganizerItemDetail::TypeParent);
+                        QOrganizerItemParent parentDetail = d->item(occurrenceId).detail(QOrganizerItemDetail::TypeParent);
                         if (!parentDetail.isEmpty() && exceptionDates.contains(parentDetail.originalDate()))
                             occurrenceIds.removeOne(occurrenceId);
                     }
@@ -642,6 +794,8 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
                 recurrence.setExceptionDates(currentExceptionDates);
                 parentItem.saveDetail(&recurrence);
                 d->m_idToItemHash.insert(parentId, parentItem); // replacement insert
+                if (d->m_journal)
+                    d->m_journal->itemSaved(parentItem);
                 changeSet.insertChangedItem(parentId, detailMask); // is this correct?  it's an exception, so change parent?
             }
         }
@@ -662,6 +816,8 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
             d->m_parentIdToChildIdHash.insert(parentId, theOrganizerItemId);
         }
         d->m_itemsInCollectionsHash.insert(targetCollectionId, theOrganizerItemId);
+        if (d->m_journal)
+            d->m_journal->itemSaved(*theOrganizerItem);
         changeSet.insertAddedItem(theOrganizerItemId);
     }
 
@@ -699,6 +855,7 @@ bool QOrganizerItemMemoryEngine::fixOccurrenceReferences(QOrganizerItem* theItem
             } else {
                 // guid set but not parentId
                 // find an item with the given guid
+                d->decodeItems();
                 foreach (const QOrganizerItem& item, d->m_idToItemHash) {
                     if (item.guid() == guid) {
                         parentId = item.id();
@@ -912,14 +1069,13 @@ bool QOrganizerItemMemoryEngine::saveItems(QList<QOrganizerItem> *items, const Q
 */
 bool QOrganizerItemMemoryEngine::removeItem(const QOrganizerItemId& organizeritemId, QOrganizerItemChangeSet& changeSet, QOrganizerManager::Error* error)
 {
-    QHash<QOrganizerItemId, QOrganizerItem>::const_iterator hashIterator = d->m_idToItemHash.find(organizeritemId);
-    if (hashIterator == d->m_idToItemHash.constEnd()) {
+    if (!d->containsItem(organizeritemId)) {
         *error = QOrganizerManager::DoesNotExistError;
         return false;
     }
 
     // if it is a child item, remove itself from the children hash
-    QOrganizerItem thisItem = hashIterator.value();
+    QOrganizerItem thisItem = d->item(organizeritemId);
     QOrganizerItemParent parentDetail = thisItem.detail(QOrganizerItemDetail::TypeParent);
     if (!parentDetail.parentId().isNull()) {
         d->m_parentIdToChildIdHash.remove(parentDetail.parentId(), organizeritemId);
@@ -929,13 +1085,13 @@ bool QOrganizerItemMemoryEngine::removeItem(const QOrganizerItemId& organizerite
     QList<QOrganizerItemId> childrenIds = d->m_parentIdToChildIdHash.values(organizeritemId);
     foreach (const QOrganizerItemId& childId, childrenIds) {
         // remove the child occurrence from our lists.
-        d->m_idToItemHash.remove(childId);
+        d->removeItem(childId);
         d->m_itemsInCollectionsHash.remove(d->m_itemsInCollectionsHash.key(childId), childId);
         changeSet.insertRemovedItem(childId);
     }
 
     // remove the organizer item from the lists.
-    d->m_idToItemHash.remove(organizeritemId);
+    d->removeItem(organizeritemId);
     d->m_parentIdToChildIdHash.remove(organizeritemId);
     d->m_itemsInCollectionsHash.remove(d->m_itemsInCollectionsHash.key(organizeritemId), organizeritemId);
     *error = QOrganizerManager::NoError;
@@ -956,18 +1112,19 @@ bool QOrganizerItemMemoryEngine::removeOccurrence(const QOrganizerItem &organize
         return false;
     }
 
-    QHash<QOrganizerItemId, QOrganizerItem>::const_iterator hashIterator = d->m_idToItemHash.find(parentDetail.parentId());
-    if (hashIterator == d->m_idToItemHash.constEnd()) {
+    if (!d->containsItem(parentDetail.parentId())) {
         *error = QOrganizerManager::InvalidOccurrenceError;
         return false;
     } else {
-        QOrganizerItem parentItem = hashIterator.value();
+        QOrganizerItem parentItem = d->item(parentDetail.parentId());
         QOrganizerItemRecurrence recurrenceDetail = parentItem.detail(QOrganizerItemDetail::TypeRecurrence);
         QSet<QDate> exceptionDates = recurrenceDetail.exceptionDates();
         exceptionDates.insert(parentDetail.originalDate());
         recurrenceDetail.setExceptionDates(exceptionDates);
         parentItem.saveDetail(&recurrenceDetail);
         d->m_idToItemHash.insert(parentDetail.parentId(), parentItem);
+        if (d->m_journal)
+            d->m_journal->itemSaved(parentItem);
         changeSet.insertChangedItem(parentDetail.parentId(), QList<QOrganizerItemDetail::DetailType>());
     }
     *error = QOrganizerManager::NoError;
@@ -1100,6 +1257,8 @@ bool QOrganizerItemMemoryEngine::saveCollection(QOrganizerCollection* collection
     }
 
     d->m_idToCollectionHash.insert(collectionId, *collection);
+    if (d->m_journal)
+        d->m_journal->collectionSaved(*collection);
     d->emitSharedSignals(&cs);
     *error = QOrganizerManager::NoError;
     return true;
@@ -1128,6 +1287,8 @@ bool QOrganizerItemMemoryEngine::removeCollection(const QOrganizerCollectionId&
         // now remove the collection from our lists.
         d->m_idToCollectionHash.remove(collectionId);
         d->m_itemsInCollectionsHash.remove(collectionId);
+        if (d->m_journal)
+            d->m_journal->collectionRemoved(collectionId);
         QOrganizerCollectionChangeSet cs;
         cs.insertRemovedCollection(collectionId);
         d->emitSharedSignals(&cs);
@@ -1278,7 +1439,7 @@ void QOrganizerItemMemoryEngine::performAsynchronousOperation(QOrganizerAbstract
         QList<QOrganizerItem> requestedOrganizerItems;
 
         for (int i = 0; i < r->ids().size(); i++) {
-            QOrganizerItem item = d->m_idToItemHash.value(r->ids().at(i), QOrganizerItem());
+            QOrganizerItem item = d->item(r->ids().at(i));
             requestedOrganizerItems.append(item);
             if (item.isEmpty())
                 errorMap.insert(i, QOrganizerManager::DoesNotExistError);
@@ -57,6 +57,8 @@
 #include <QtOrganizer/qorganizeritemchangeset.h>
 #include <QtOrganizer/qorganizerrecurrencerule.h>
 
+#include "qorganizeritemmemoryjournal_p.h"
+
 QT_BEGIN_NAMESPACE_ORGANIZER
 
 class QOrganizerItemMemoryFactory : public QOrganizerManagerEngineFactory
@@ -80,6 +82,7 @@ public:
     QOrganizerItemMemoryEngineData();
     ~QOrganizerItemMemoryEngineData()
     {
+        delete m_journal;
     }
 
     QString m_id;                                  // the id parameter value
@@ -91,14 +94,29 @@ public:
     quint32 m_nextOrganizerItemId; // the localId() portion of a QOrganizerItemId
     quint32 m_nextOrganizerCollectionId; // the localId() portion of a QOrganizerCollectionId
     QString m_managerUri;                        // for faster lookup.
+    QHash<QOrganizerItemId, QByteArray> m_encodedItems; // items loaded from the journal, not accessed yet
+    QOrganizerItemMemoryJournal *m_journal;        // persists the data, if the "journal" parameter was given
+
+    bool containsItem(const QOrganizerItemId &itemId) const
+    {
+        return m_idToItemHash.contains(itemId) || m_encodedItems.contains(itemId);
+    }
+    QOrganizerItem item(const QOrganizerItemId &itemId);
+    void decodeItems();
+    QOrganizerItem decodeItem(const QOrganizerItemId &itemId, const QByteArray &data);
+    void removeItem(const QOrganizerItemId &itemId);
+
+    void compactJournalIfDue();
 
     void emitSharedSignals(QOrganizerCollectionChangeSet *cs)
     {
+        compactJournalIfDue();
         foreach (QOrganizerManagerEngine *engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
     void emitSharedSignals(QOrganizerItemChangeSet* cs)
     {
+        compactJournalIfDue();
         foreach(QOrganizerManagerEngine* engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
@@ -218,6 +236,9 @@ private:
 
     void performAsynchronousOperation(QOrganizerAbstractRequest* request);
 
+    void openJournal(const QString &path);
+    void restoreJournalState(const QOrganizerItemMemoryJournal::State &state);
+
     QOrganizerItemMemoryEngineData* d;
 };
 
@@ -0,0 +1,784 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qorganizeritemmemoryjournal_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthread.h>
+
+#include <QtOrganizer/qorganizeritemdetails.h>
+#include <QtOrganizer/qorganizerrecurrencerule.h>
+
+#include <algorithm>
+#include <functional>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+namespace {
+
+enum {
+    JournalMagic = 0x514f4a52,          // "QOJR"
+    SnapshotMagic = 0x514f534e,         // "QOSN"
+    FormatVersion = 1,
+    HeaderSize = 6,                     // magic and version
+    MinimumCompactionSize = 256 * 1024  // smaller journals are replayed quickly enough
+};
+
+const QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+// Snapshots are numbered, as the engine keeps the one it loaded mapped (see compact())
+QString snapshotFileName(const QString &path, quint32 generation)
+{
+    return path + QStringLiteral(".snapshot.") + QString::number(generation);
+}
+
+// Returns the generations of the snapshots kept next to the journal \a path, newest first
+QList<quint32> snapshotGenerations(const QString &path)
+{
+    const QFileInfo info(path);
+    const QString prefix(info.fileName() + QStringLiteral(".snapshot."));
+    QList<quint32> generations;
+    foreach (const QString &name, info.dir().entryList(QStringList(prefix + QLatin1Char('*')), QDir::Files)) {
+        // skips the temporary files of unfinished snapshots, whose names have a suffix
+        bool ok = false;
+        const quint32 generation = name.mid(prefix.size()).toUInt(&ok);
+        if (ok && generation > 0)
+            generations.append(generation);
+    }
+    std::sort(generations.begin(), generations.end(), std::greater<quint32>());
+    return generations;
+}
+
+// Removes the snapshots of the journal \a path older than the newest, and returns its generation
+quint32 removeOldSnapshots(const QString &path)
+{
+    const QList<quint32> generations(snapshotGenerations(path));
+    for (int i = 1; i < generations.size(); ++i)
+        QFile::remove(snapshotFileName(path, generations.at(i)));
+    return generations.isEmpty() ? 0 : generations.first();
+}
+
+// The journal being compacted into a new snapshot, or left over from a failed compaction
+QString compactingFileName(const QString &path)
+{
+    return path + QStringLiteral(".compacting");
+}
+
+// Reads a QByteArray as written by QDataStream, without copying it out of the buffer
+bool readRawByteArray(const uchar **pos, const uchar *end, QByteArray *bytes)
+{
+    if (end - *pos < qptrdiff(sizeof(quint32)))
+        return false;
+    const quint32 size = qFromBigEndian<quint32>(*pos);
+    *pos += sizeof(quint32);
+    if (size == 0xffffffff) {
+        *bytes = QByteArray();
+        return true;
+    }
+    if (quint64(end - *pos) < size)
+        return false;
+    *bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(*pos), size);
+    *pos += size;
+    return true;
+}
+
+quint32 localIdValue(const QByteArray &localId)
+{
+    quint32 value = 0;
+    if (localId.size() == int(sizeof(quint32)))
+        memcpy(&value, localId.constData(), sizeof(quint32));
+    return value;
+}
+
+template <typename T>
+void writeIntSet(QDataStream &out, const QSet<T> &values)
+{
+    out << quint32(values.size());
+    foreach (T value, values)
+        out << qint32(value);
+}
+
+template <typename T>
+QSet<T> readIntSet(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QSet<T> values;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 value = 0;
+        in >> value;
+        values.insert(static_cast<T>(value));
+    }
+    return values;
+}
+
+}
+
+/*!
+    \class QOrganizerItemMemoryJournal
+    \internal
+
+    The snapshot and journal of a QOrganizerItemMemoryEngine store.
+*/
+
+/*!
+    Constructs a journal of organizer items kept in the file \a path.  The numbered snapshots
+    are kept next to it, as is the journal being compacted while a snapshot is written.  Item
+    and collection ids read back, including the parent ids of occurrences, are given the manager
+    URI \a managerUri.
+*/
+QOrganizerItemMemoryJournal::QOrganizerItemMemoryJournal(const QString &path, const QString &managerUri)
+    : m_path(path)
+    , m_managerUri(managerUri)
+    , m_snapshotGeneration(0)
+    , m_latestGeneration(0)
+    , m_snapshotSize(0)
+    , m_compaction(0)
+{
+}
+
+/*!
+    Unmaps the loaded snapshot, and removes it if a later compaction has replaced it.  Items
+    handed out encoded by load() must not be decoded afterwards.
+*/
+QOrganizerItemMemoryJournal::~QOrganizerItemMemoryJournal()
+{
+    waitForCompaction();
+    if (m_snapshot.isOpen()) {
+        m_snapshot.close();
+        removeOldSnapshots(m_path);
+    }
+}
+
+/*!
+    Maps the newest snapshot and replays the journal into \a state, then opens the journal for
+    the changes to come.  Older snapshots, left behind by an engine which compacted the journal
+    while it had one mapped, are removed.  The items are left encoded; the data of those in the
+    snapshot stays valid for the lifetime of the journal.  Returns false if the files exist but
+    cannot be read.
+*/
+bool QOrganizerItemMemoryJournal::load(State *state)
+{
+    *state = State();
+
+    m_snapshotGeneration = removeOldSnapshots(m_path);
+    m_latestGeneration = m_snapshotGeneration;
+    if (m_snapshotGeneration && !mapSnapshot(state))
+        return false;
+    if (!readJournal(compactingFileName(m_path), state, false))
+        return false;
+    if (!readJournal(m_path, state, true))
+        return false;
+    return openJournal();
+}
+
+/*!
+    Decodes the item encoded in \a data, which was handed out by load(), into \a item.  Returns
+    false if the data is truncated or corrupt, in which case \a item is incomplete.
+*/
+bool QOrganizerItemMemoryJournal::decodeItem(const QByteArray &data, QOrganizerItem *item) const
+{
+    QDataStream in(data);
+    in.setVersion(StreamVersion);
+    QByteArray localId;
+    QByteArray collectionLocalId;
+    QByteArray parentLocalId;
+    quint32 detailCount = 0;
+    in >> localId >> collectionLocalId >> parentLocalId >> detailCount;
+    if (in.status() != QDataStream::Ok || localId.isEmpty())
+        return false;
+
+    *item = QOrganizerItem();
+    item->setId(QOrganizerItemId(m_managerUri, localId));
+    item->setCollectionId(QOrganizerCollectionId(m_managerUri, collectionLocalId));
+    for (quint32 i = 0; i < detailCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 type = 0;
+        quint32 fieldCount = 0;
+        in >> type >> fieldCount;
+        QOrganizerItemDetail detail(static_cast<QOrganizerItemDetail::DetailType>(type));
+        for (quint32 j = 0; j < fieldCount && in.status() == QDataStream::Ok; ++j) {
+            quint32 field = 0;
+            in >> field;
+            detail.setValue(field, readValue(in));
+        }
+        item->saveDetail(&detail);
+    }
+    return in.status() == QDataStream::Ok && in.atEnd();
+}
+
+/*!
+    Records that \a item was saved, as it is now stored.
+*/
+void QOrganizerItemMemoryJournal::itemSaved(const QOrganizerItem &item)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SaveItem) << encodeItem(item);
+    append(record);
+}
+
+/*!
+    Records that the item identified by \a itemId was removed.  The occurrences of a removed item
+    are recorded as removed separately.
+*/
+void QOrganizerItemMemoryJournal::itemRemoved(const QOrganizerItemId &itemId)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(RemoveItem) << itemId.localId();
+    append(record);
+}
+
+/*!
+    Records that \a collection was saved.
+*/
+void QOrganizerItemMemoryJournal::collectionSaved(const QOrganizerCollection &collection)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(SaveCollection) << collection;
+    append(record);
+}
+
+/*!
+    Records that the collection identified by \a collectionId was removed.  The items it
+    contained are recorded as removed separately.
+*/
+void QOrganizerItemMemoryJournal::collectionRemoved(const QOrganizerCollectionId &collectionId)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << quint8(RemoveCollection) << collectionId.localId();
+    append(record);
+}
+
+/*!
+    Returns true if the journal has grown large enough to be compacted, and no compaction is
+    running already.
+*/
+bool QOrganizerItemMemoryJournal::isCompactionDue() const
+{
+    if (!m_journal.isOpen() || (m_compaction && !m_compaction->isFinished()))
+        return false;
+    return m_journal.size() > qMax<qint64>(m_snapshotSize.loadRelaxed(), MinimumCompactionSize);
+}
+
+/*!
+    Starts a new journal, and writes \a state, which must include every change journaled so far,
+    as the next snapshot on a background thread.  Items still encoded are copied as they are,
+    so those in the mapped snapshot are not decoded.
+*/
+void QOrganizerItemMemoryJournal::compact(const State &state)
+{
+    waitForCompaction();
+
+    // Records journaled while the snapshot is written go to a fresh journal; the ones before
+    // it are kept in the compacting file until the snapshot holds them.  If an earlier
+    // compaction failed, this one's records are appended to that file.
+    m_journal.close();
+    const QString compacting(compactingFileName(m_path));
+    if (QFile::exists(compacting)) {
+        QFile target(compacting);
+        if (!target.open(QIODevice::Append) || !m_journal.open(QIODevice::ReadOnly)) {
+            qWarning("Cannot compact organizer journal %s", qPrintable(m_path));
+            openJournal();
+            return;
+        }
+        m_journal.seek(HeaderSize);
+        target.write(m_journal.readAll());
+        m_journal.close();
+        target.close();
+        QFile::remove(m_path);
+    } else if (!QFile::rename(m_path, compacting)) {
+        qWarning("Cannot compact organizer journal %s", qPrintable(m_path));
+        openJournal();
+        return;
+    }
+    openJournal();
+
+    // The engine still decodes items out of the mapped snapshot, which cannot be replaced while
+    // it is mapped on all platforms.  So each snapshot gets a new file; the mapped one is
+    // removed when the journal is destroyed, and any in between as soon as they are superseded.
+    const quint32 generation = ++m_latestGeneration;
+    const quint32 mappedGeneration = m_snapshotGeneration;
+    m_compaction = QThread::create([this, state, generation, mappedGeneration] {
+        const QString fileName(snapshotFileName(m_path, generation));
+        QSaveFile snapshot(fileName);
+        if (snapshot.open(QIODevice::WriteOnly)) {
+            QDataStream out(&snapshot);
+            out.setVersion(StreamVersion);
+            out << quint32(SnapshotMagic) << quint16(FormatVersion);
+            writeSnapshot(out, state);
+            if (out.status() == QDataStream::Ok && snapshot.commit()) {
+                m_snapshotSize.storeRelaxed(QFileInfo(fileName).size());
+                QFile::remove(compactingFileName(m_path));
+                foreach (quint32 older, snapshotGenerations(m_path)) {
+                    if (older < generation && older != mappedGeneration)
+                        QFile::remove(snapshotFileName(m_path, older));
+                }
+                return;
+            }
+        }
+        qWarning("Cannot write organizer snapshot %s", qPrintable(fileName));
+    });
+    m_compaction->start();
+}
+
+/*!
+    Blocks until the snapshot being written by compact(), if any, is complete.
+*/
+void QOrganizerItemMemoryJournal::waitForCompaction()
+{
+    if (m_compaction) {
+        m_compaction->wait();
+        delete m_compaction;
+        m_compaction = 0;
+    }
+}
+
+void QOrganizerItemMemoryJournal::append(const QByteArray &record)
+{
+    if (!m_journal.isOpen())
+        return;
+
+    QDataStream out(&m_journal);
+    out.setVersion(StreamVersion);
+    out << record;
+    m_journal.flush();
+}
+
+bool QOrganizerItemMemoryJournal::openJournal()
+{
+    m_journal.setFileName(m_path);
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+
+    if (m_journal.size() == 0) {
+        QDataStream out(&m_journal);
+        out.setVersion(StreamVersion);
+        out << quint32(JournalMagic) << quint16(FormatVersion);
+        m_journal.flush();
+    }
+    return true;
+}
+
+/*
+    Reads the collections of the snapshot, and maps the file to hand out its items without
+    decoding or copying them.  Only the few bytes of each item which the engine needs for its
+    indexes are read here.
+*/
+bool QOrganizerItemMemoryJournal::mapSnapshot(State *state)
+{
+    m_snapshot.setFileName(snapshotFileName(m_path, m_snapshotGeneration));
+    if (!m_snapshot.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&m_snapshot);
+    in.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != quint32(SnapshotMagic) || version != FormatVersion)
+        return false;
+
+    quint32 count = 0;
+    in >> state->nextItemId >> state->nextCollectionId >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QOrganizerCollection collection;
+        if (!readCollection(in, &collection))
+            return false;
+        state->collections.append(collection);
+    }
+    in >> count;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    const qint64 itemsOffset = m_snapshot.pos();
+    const qint64 size = m_snapshot.size();
+    const uchar *map = m_snapshot.map(0, size);
+    if (!map)
+        return false;
+
+    const uchar *pos = map + itemsOffset;
+    const uchar *end = map + size;
+    state->encodedItems.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        QOrganizerItemId itemId;
+        EncodedItem item;
+        if (!readRawByteArray(&pos, end, &item.data) || !readItemHeader(item.data, &itemId, &item))
+            return false;
+        state->encodedItems.insert(itemId, item);
+    }
+
+    m_snapshotSize.storeRelaxed(size);
+    return true;
+}
+
+/*
+    Replays the records of the journal \a fileName into \a state.  A process which exits while
+    appending leaves a partial record at the end; it is ignored, and removed from the file if
+    \a truncateTornRecord is true, so that later records can follow the complete ones.
+*/
+bool QOrganizerItemMemoryJournal::readJournal(const QString &fileName, State *state, bool truncateTornRecord)
+{
+    QFile file(fileName);
+    if (!file.exists())
+        return true;
+    if (!file.open(truncateTornRecord ? QIODevice::ReadWrite : QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok) {
+        // not even the header was written
+        if (truncateTornRecord)
+            file.resize(0);
+        return true;
+    }
+    if (magic != quint32(JournalMagic) || version != FormatVersion)
+        return false;
+
+    qint64 end = file.pos();
+    while (!in.atEnd()) {
+        QByteArray record;
+        in >> record;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        QDataStream recordIn(record);
+        recordIn.setVersion(StreamVersion);
+        quint8 operation = 0;
+        recordIn >> operation;
+        switch (operation) {
+        case SaveItem: {
+            QOrganizerItemId itemId;
+            EncodedItem item;
+            recordIn >> item.data;
+            if (!readItemHeader(item.data, &itemId, &item))
+                return false;
+            state->encodedItems.insert(itemId, item);
+            state->nextItemId = qMax(state->nextItemId, localIdValue(itemId.localId()) + 1);
+            break;
+        }
+        case RemoveItem: {
+            QByteArray localId;
+            recordIn >> localId;
+            state->encodedItems.remove(QOrganizerItemId(m_managerUri, localId));
+            break;
+        }
+        case SaveCollection: {
+            QOrganizerCollection collection;
+            if (!readCollection(recordIn, &collection))
+                return false;
+            bool replaced = false;
+            for (int i = 0; i < state->collections.size() && !replaced; ++i) {
+                if (state->collections.at(i).id() == collection.id()) {
+                    state->collections[i] = collection;
+                    replaced = true;
+                }
+            }
+            if (!replaced)
+                state->collections.append(collection);
+            state->nextCollectionId = qMax(state->nextCollectionId, localIdValue(collection.id().localId()) + 1);
+            break;
+        }
+        case RemoveCollection: {
+            QByteArray localId;
+            recordIn >> localId;
+            const QOrganizerCollectionId collectionId(m_managerUri, localId);
+            for (int i = 0; i < state->collections.size(); ++i) {
+                if (state->collections.at(i).id() == collectionId) {
+                    state->collections.removeAt(i);
+                    break;
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        if (recordIn.status() != QDataStream::Ok)
+            return false;
+
+        end = file.pos();
+    }
+
+    if (truncateTornRecord && end < file.size())
+        file.resize(end);
+    return true;
+}
+
+/*
+    Items are encoded as their local id, the local ids of their collection and parent item (which
+    are all the engine needs to index an item without decoding it), and their details, each as a
+    list of field numbers and tagged values.
+*/
+QByteArray QOrganizerItemMemoryJournal::encodeItem(const QOrganizerItem &item) const
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+
+    const QOrganizerItemId parentId(item.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId));
+    const QList<QOrganizerItemDetail> details(item.details());
+    out << item.id().localId() << item.collectionId().localId() << parentId.localId()
+        << quint32(details.size());
+    foreach (const QOrganizerItemDetail &detail, details) {
+        const QMap<int, QVariant> values(detail.values());
+        out << quint32(detail.type()) << quint32(values.size());
+        for (QMap<int, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+            out << quint32(it.key());
+            writeValue(out, it.value());
+        }
+    }
+    return data;
+}
+
+bool QOrganizerItemMemoryJournal::readItemHeader(const QByteArray &data, QOrganizerItemId *itemId, EncodedItem *item) const
+{
+    const uchar *pos = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = pos + data.size();
+    QByteArray localId;
+    QByteArray collectionLocalId;
+    QByteArray parentLocalId;
+    if (!readRawByteArray(&pos, end, &localId)
+            || !readRawByteArray(&pos, end, &collectionLocalId)
+            || !readRawByteArray(&pos, end, &parentLocalId)
+            || localId.isEmpty()) {
+        return false;
+    }
+
+    // the raw byte arrays point into data, which may not outlive this call
+    *itemId = QOrganizerItemId(m_managerUri, QByteArray(localId.constData(), localId.size()));
+    item->collectionId = QOrganizerCollectionId(m_managerUri, QByteArray(collectionLocalId.constData(), collectionLocalId.size()));
+    item->parentId = QOrganizerItemId(m_managerUri, QByteArray(parentLocalId.constData(), parentLocalId.size()));
+    return true;
+}
+
+void QOrganizerItemMemoryJournal::writeValue(QDataStream &out, const QVariant &value) const
+{
+    const int type = value.userType();
+    if (type == QMetaType::QString) {
+        out << quint8(StringValue) << value.toString();
+    } else if (type == QMetaType::Int) {
+        out << quint8(IntValue) << qint32(value.toInt());
+    } else if (type == QMetaType::QDateTime) {
+        out << quint8(DateTimeValue) << value.toDateTime();
+    } else if (type == qMetaTypeId<QOrganizerItemId>()) {
+        // the parent of an occurrence is in this manager, but other ids keep their URI
+        const QOrganizerItemId itemId(value.value<QOrganizerItemId>());
+        const bool isLocal = itemId.managerUri() == m_managerUri;
+        out << quint8(ItemIdValue) << isLocal << (isLocal ? itemId.localId() : itemId.toByteArray());
+    } else if (type == qMetaTypeId<QSet<QDate> >()) {
+        const QSet<QDate> dates(value.value<QSet<QDate> >());
+        out << quint8(DateSetValue) << quint32(dates.size());
+        foreach (const QDate &date, dates)
+            out << qint64(date.toJulianDay());
+    } else if (type == qMetaTypeId<QSet<QOrganizerRecurrenceRule> >()) {
+        const QSet<QOrganizerRecurrenceRule> rules(value.value<QSet<QOrganizerRecurrenceRule> >());
+        out << quint8(RecurrenceRuleSetValue) << quint32(rules.size());
+        foreach (const QOrganizerRecurrenceRule &rule, rules)
+            writeRecurrenceRule(out, rule);
+    } else {
+        out << quint8(VariantValue) << value;
+    }
+}
+
+QVariant QOrganizerItemMemoryJournal::readValue(QDataStream &in) const
+{
+    quint8 tag = 0;
+    in >> tag;
+    switch (tag) {
+    case StringValue: {
+        QString string;
+        in >> string;
+        return string;
+    }
+    case IntValue: {
+        qint32 value = 0;
+        in >> value;
+        return int(value);
+    }
+    case DateTimeValue: {
+        QDateTime dateTime;
+        in >> dateTime;
+        return dateTime;
+    }
+    case ItemIdValue: {
+        bool isLocal = false;
+        QByteArray id;
+        in >> isLocal >> id;
+        return QVariant::fromValue(isLocal ? QOrganizerItemId(m_managerUri, id) : QOrganizerItemId::fromByteArray(id));
+    }
+    case DateSetValue: {
+        quint32 count = 0;
+        in >> count;
+        QSet<QDate> dates;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            qint64 julianDay = 0;
+            in >> julianDay;
+            dates.insert(QDate::fromJulianDay(julianDay));
+        }
+        return QVariant::fromValue(dates);
+    }
+    case RecurrenceRuleSetValue: {
+        quint32 count = 0;
+        in >> count;
+        QSet<QOrganizerRecurrenceRule> rules;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+            rules.insert(readRecurrenceRule(in));
+        return QVariant::fromValue(rules);
+    }
+    case VariantValue: {
+        QVariant value;
+        in >> value;
+        return value;
+    }
+    default:
+        in.setStatus(QDataStream::ReadCorruptData);
+        return QVariant();
+    }
+}
+
+void QOrganizerItemMemoryJournal::writeRecurrenceRule(QDataStream &out, const QOrganizerRecurrenceRule &rule) const
+{
+    out << quint8(rule.frequency()) << qint32(rule.interval()) << quint8(rule.firstDayOfWeek())
+        << quint8(rule.limitType());
+    if (rule.limitType() == QOrganizerRecurrenceRule::CountLimit)
+        out << qint32(rule.limitCount());
+    else if (rule.limitType() == QOrganizerRecurrenceRule::DateLimit)
+        out << qint64(rule.limitDate().toJulianDay());
+
+    // days of the week and months fit in bit masks
+    quint8 daysOfWeek = 0;
+    foreach (Qt::DayOfWeek day, rule.daysOfWeek())
+        daysOfWeek |= 1 << day;
+    quint16 monthsOfYear = 0;
+    foreach (QOrganizerRecurrenceRule::Month month, rule.monthsOfYear())
+        monthsOfYear |= 1 << month;
+    out << daysOfWeek << monthsOfYear;
+
+    writeIntSet(out, rule.daysOfMonth());
+    writeIntSet(out, rule.daysOfYear());
+    writeIntSet(out, rule.weeksOfYear());
+    writeIntSet(out, rule.positions());
+}
+
+QOrganizerRecurrenceRule QOrganizerItemMemoryJournal::readRecurrenceRule(QDataStream &in) const
+{
+    quint8 frequency = 0;
+    qint32 interval = 1;
+    quint8 firstDayOfWeek = Qt::Monday;
+    quint8 limitType = QOrganizerRecurrenceRule::NoLimit;
+    in >> frequency >> interval >> firstDayOfWeek >> limitType;
+
+    QOrganizerRecurrenceRule rule;
+    rule.setFrequency(static_cast<QOrganizerRecurrenceRule::Frequency>(frequency));
+    rule.setInterval(interval);
+    rule.setFirstDayOfWeek(static_cast<Qt::DayOfWeek>(firstDayOfWeek));
+    if (limitType == QOrganizerRecurrenceRule::CountLimit) {
+        qint32 limitCount = 0;
+        in >> limitCount;
+        rule.setLimit(limitCount);
+    } else if (limitType == QOrganizerRecurrenceRule::DateLimit) {
+        qint64 julianDay = 0;
+        in >> julianDay;
+        rule.setLimit(QDate::fromJulianDay(julianDay));
+    }
+
+    quint8 daysOfWeek = 0;
+    quint16 monthsOfYear = 0;
+    in >> daysOfWeek >> monthsOfYear;
+    QSet<Qt::DayOfWeek> days;
+    for (int day = Qt::Monday; day <= Qt::Sunday; ++day) {
+        if (daysOfWeek & (1 << day))
+            days.insert(static_cast<Qt::DayOfWeek>(day));
+    }
+    rule.setDaysOfWeek(days);
+    QSet<QOrganizerRecurrenceRule::Month> months;
+    for (int month = QOrganizerRecurrenceRule::January; month <= QOrganizerRecurrenceRule::December; ++month) {
+        if (monthsOfYear & (1 << month))
+            months.insert(static_cast<QOrganizerRecurrenceRule::Month>(month));
+    }
+    rule.setMonthsOfYear(months);
+
+    rule.setDaysOfMonth(readIntSet<int>(in));
+    rule.setDaysOfYear(readIntSet<int>(in));
+    rule.setWeeksOfYear(readIntSet<int>(in));
+    rule.setPositions(readIntSet<int>(in));
+    return rule;
+}
+
+bool QOrganizerItemMemoryJournal::readCollection(QDataStream &in, QOrganizerCollection *collection) const
+{
+    in >> *collection;
+    collection->setId(QOrganizerCollectionId(m_managerUri, collection->id().localId()));
+    return in.status() == QDataStream::Ok && !collection->id().isNull();
+}
+
+void QOrganizerItemMemoryJournal::writeSnapshot(QDataStream &out, const State &state) const
+{
+    out << state.nextItemId << state.nextCollectionId;
+
+    out << quint32(state.collections.size());
+    foreach (const QOrganizerCollection &collection, state.collections)
+        out << collection;
+
+    out << quint32(state.items.size() + state.encodedItems.size());
+    foreach (const QOrganizerItem &item, state.items)
+        out << encodeItem(item);
+    foreach (const EncodedItem &item, state.encodedItems)
+        out << item.data;
+}
+
+QT_END_NAMESPACE_ORGANIZER
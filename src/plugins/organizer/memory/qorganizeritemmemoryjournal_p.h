@@ -0,0 +1,162 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QORGANIZERITEMMEMORYJOURNAL_P_H
+#define QORGANIZERITEMMEMORYJOURNAL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+
+#include <QtOrganizer/qorganizercollection.h>
+#include <QtOrganizer/qorganizeritem.h>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+class QThread;
+QT_END_NAMESPACE
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+class QOrganizerRecurrenceRule;
+
+/*
+ * Keeps the collections and the stored items of an organizer memory engine on disk, as a
+ * snapshot and a journal of the changes made since.  Only items which were saved are kept:
+ * the generated occurrences of a recurring item are computed again from its recurrence rules
+ * and exception dates, while exception occurrences are kept as items referring to their parent.
+ *
+ * Items are kept in a compact binary encoding which starts with the ids the engine indexes
+ * items by, their collection and parent, so the snapshot can be memory-mapped and its items
+ * handed out still encoded, to be decoded by decodeItem() when first accessed.  Ids are stored
+ * without their manager URI and are given the URI of the loading engine.
+ */
+class QOrganizerItemMemoryJournal
+{
+public:
+    struct EncodedItem
+    {
+        QOrganizerCollectionId collectionId;
+        QOrganizerItemId parentId;      // for occurrences
+        QByteArray data;
+    };
+
+    struct State
+    {
+        State() : nextItemId(1), nextCollectionId(2) {}
+
+        quint32 nextItemId;
+        quint32 nextCollectionId;
+        QList<QOrganizerCollection> collections;
+        QList<QOrganizerItem> items;
+        QHash<QOrganizerItemId, EncodedItem> encodedItems;
+    };
+
+    QOrganizerItemMemoryJournal(const QString &path, const QString &managerUri);
+    ~QOrganizerItemMemoryJournal();
+
+    bool load(State *state);
+    bool decodeItem(const QByteArray &data, QOrganizerItem *item) const;
+
+    void itemSaved(const QOrganizerItem &item);
+    void itemRemoved(const QOrganizerItemId &itemId);
+    void collectionSaved(const QOrganizerCollection &collection);
+    void collectionRemoved(const QOrganizerCollectionId &collectionId);
+
+    bool isCompactionDue() const;
+    void compact(const State &state);
+    void waitForCompaction();
+
+private:
+    enum Operation {
+        SaveItem = 1,
+        RemoveItem,
+        SaveCollection,
+        RemoveCollection
+    };
+
+    enum ValueTag {
+        VariantValue = 0,
+        StringValue,
+        IntValue,
+        DateTimeValue,
+        ItemIdValue,
+        DateSetValue,
+        RecurrenceRuleSetValue
+    };
+
+    void append(const QByteArray &record);
+    bool openJournal();
+    bool readJournal(const QString &fileName, State *state, bool truncateTornRecord);
+    bool mapSnapshot(State *state);
+
+    QByteArray encodeItem(const QOrganizerItem &item) const;
+    bool readItemHeader(const QByteArray &data, QOrganizerItemId *itemId, EncodedItem *item) const;
+    void writeValue(QDataStream &out, const QVariant &value) const;
+    QVariant readValue(QDataStream &in) const;
+    void writeRecurrenceRule(QDataStream &out, const QOrganizerRecurrenceRule &rule) const;
+    QOrganizerRecurrenceRule readRecurrenceRule(QDataStream &in) const;
+    bool readCollection(QDataStream &in, QOrganizerCollection *collection) const;
+    void writeSnapshot(QDataStream &out, const State &state) const;
+
+    QString m_path;
+    QString m_managerUri;
+    QFile m_snapshot;                   // mapped while the engine holds items encoded in it
+    quint32 m_snapshotGeneration;       // of the mapped snapshot, or 0 if there is none
+    quint32 m_latestGeneration;         // of the last snapshot written or loaded
+    QFile m_journal;
+    QAtomicInteger<qint64> m_snapshotSize;
+    QThread *m_compaction;
+};
+
+QT_END_NAMESPACE_ORGANIZER
+
+#endif // QORGANIZERITEMMEMORYJOURNAL_P_H
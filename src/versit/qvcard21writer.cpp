@@ -45,6 +45,7 @@
 
 #include <QTextCodec>
 
+#include "qversitencoding_p.h"
 #include "qversitproperty.h"
 
 #include <algorithm>
@@ -56,21 +57,6 @@ QVCard21Writer::QVCard21Writer(QVersitDocument::VersitType type) : QVersitDocume
 {
 }
 
-QTextEncoder* QVCard21Writer::utf8Encoder()
-{
-    static QTextEncoder* encoder = 0;
-    if (encoder == 0) {
-        // prevent output of byte order mark for UTF-8 encoding
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        encoder = QTextCodec::codecForName("UTF-8")->makeEncoder();
-        encoder->fromUnicode(QString());
-#else
-        encoder = QTextCodec::codecForName("UTF-8")->makeEncoder(QStringConverterBase::Flag::Default);
-#endif
-    }
-    return encoder;
-}
-
 /*! Destroys a writer. */
 QVCard21Writer::~QVCard21Writer()
 {
@@ -130,9 +116,9 @@ void QVCard21Writer::encodeVersitProperty(const QVersitProperty& property)
     } else if (variant.metaType().id() == QMetaType::QByteArray) {
         parameters.replace(QStringLiteral("ENCODING"), QStringLiteral("BASE64"));
         if (mCodecIsAsciiCompatible) // optimize by not converting to unicode
-            renderedBytes = variant.toByteArray().toBase64();
+            renderedBytes = VersitEncoding::toBase64(variant.toByteArray());
         else
-            renderedValue = QLatin1String(variant.toByteArray().toBase64().data());
+            renderedValue = QLatin1String(VersitEncoding::toBase64(variant.toByteArray()).data());
     }
 
     // Encode parameters
@@ -189,7 +175,7 @@ void QVCard21Writer::encodeVersitValue(QMultiHash<QString,QString>& parameters,
             // if codec is ASCII and there is a character > U+007F in value, encode it as UTF-8
             || (mCodecIsAscii && containsNonAscii(value))) {
         parameters.replace(QStringLiteral("CHARSET"), QStringLiteral("UTF-8"));
-        value = QString::fromLatin1(utf8Encoder()->fromUnicode(value));
+        value = QString::fromLatin1(value.toUtf8());
     }
 
     // Quoted-Printable encode the value and add Quoted-Printable parameter, if necessary
@@ -261,18 +247,7 @@ bool QVCard21Writer::containsNonAscii(const QString& str)
  */
 bool QVCard21Writer::quotedPrintableEncode(QString& text)
 {
-    bool encoded = false;
-    for (int i=0; i<text.length(); i++) {
-        QChar current = text.at(i);
-        if (shouldBeQuotedPrintableEncoded(current)) {
-            QString encodedStr(QString::fromLatin1("=%1").
-                               arg(current.unicode(), 2, 16, QLatin1Char('0')).toUpper());
-            text.replace(i, 1, encodedStr);
-            i += 2;
-            encoded = true;
-        }
-    }
-    return encoded;
+    return VersitEncoding::encodeQuotedPrintable(&text);
 }
 
 
@@ -40,12 +40,12 @@
 #include "qvcard30writer_p.h"
 
 #include <QtCore/qbuffer.h>
-#include <QtCore/qregularexpression.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qurl.h>
 
 #include <QTextCodec>
 
+#include "qversitencoding_p.h"
 #include "qversitproperty.h"
 #include "qversitutils_p.h"
 
@@ -132,9 +132,9 @@ void QVCard30Writer::encodeVersitProperty(const QVersitProperty& property)
         }
     } else if (variant.metaType().id() == QMetaType::QByteArray) {
         if (mCodecIsAsciiCompatible) // optimize by not converting to unicode
-            renderedBytes = variant.toByteArray().toBase64();
+            renderedBytes = VersitEncoding::toBase64(variant.toByteArray());
         else
-            renderedValue = QLatin1String(variant.toByteArray().toBase64().data());
+            renderedValue = QLatin1String(VersitEncoding::toBase64(variant.toByteArray()).data());
     }
 
     if (renderedBytes.isEmpty())
@@ -177,17 +177,47 @@ void QVCard30Writer::encodeParameters(const QMultiHash<QString,QString>& paramet
  */
 void QVCard30Writer::backSlashEscape(QString* text)
 {
-    static const QString m1(QStringLiteral("([;,\\\\])"));
-    static const QString r1(QStringLiteral("\\\\1"));
-    static const QString m2(QStringLiteral("\r\n|\r|\n"));
-    static const QString r2(QStringLiteral("\\n"));
     /* replaces ; with \;
                 , with \,
                 \ with \\
+       and any CRLF, CR or LF with \n
      */
-    text->replace(QRegularExpression(m1), r1);
-    // replaces any CRLFs with \n
-    text->replace(QRegularExpression(m2), r2);
+    const QChar* const begin = text->constData();
+    const QChar* const end = begin + text->length();
+    const QChar* src = begin;
+    // Most values have nothing to escape, so look for the first special character before copying
+    for (; src < end; ++src) {
+        const ushort c = src->unicode();
+        if (c <= '\\' && (c == ';' || c == ',' || c == '\\' || c == '\r' || c == '\n'))
+            break;
+    }
+    if (src == end)
+        return;
+
+    QString escaped;
+    escaped.reserve(2 * text->length());
+    escaped.append(begin, src - begin);
+    for (; src < end; ++src) {
+        const QChar c = *src;
+        switch (c.unicode()) {
+        case ';':
+        case ',':
+        case '\\':
+            escaped.append(QLatin1Char('\\'));
+            escaped.append(c);
+            break;
+        case '\r':
+            if (src + 1 < end && src[1] == QLatin1Char('\n'))
+                ++src;
+            Q_FALLTHROUGH();
+        case '\n':
+            escaped.append(QLatin1String("\\n"));
+            break;
+        default:
+            escaped.append(c);
+        }
+    }
+    *text = escaped;
 }
 
 QT_END_NAMESPACE_VERSIT
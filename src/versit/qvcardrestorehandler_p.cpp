@@ -44,6 +44,7 @@
 #include <QtCore/qurl.h>
 
 #include "qversitproperty.h"
+#include "qversitproperty_p.h"
 
 /*
     When these conditions are satisfied, QStringLiteral is implemented by
@@ -133,9 +134,9 @@ bool QVCardRestoreHandler::propertyProcessed(
     if (property.name() == PropertyName) {
         if (property.groups().size() != 1)
             return false;
-        QMultiHash<QString, QString> parameters = property.parameters();
-        QContactDetail::DetailType detailType = QContactDetail::DetailType(parameters.value(DetailTypeParameter).toUInt());
-        QString fieldName = parameters.value(FieldParameter);
+        const QVersitPropertyPrivate* propertyData = QVersitPropertyPrivate::get(property);
+        QContactDetail::DetailType detailType = QContactDetail::DetailType(propertyData->parameterValue(DetailTypeParameter).toUInt());
+        QString fieldName = propertyData->parameterValue(FieldParameter);
         // Find a detail previously seen with the same definitionName, which was generated from
         // a property from the same group
         QContactDetail detail(detailType);
@@ -170,31 +171,32 @@ bool QVCardRestoreHandler::propertyProcessed(
 QVariant QVCardRestoreHandler::deserializeValue(const QVersitProperty& property)
 {
     // Import the field
-    if (property.parameters().contains(DatatypeParameter, DatatypeParameterVariant)) {
+    const QVersitPropertyPrivate* propertyData = QVersitPropertyPrivate::get(property);
+    if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterVariant)) {
         // The value was stored as a QVariant serialized in a QByteArray
         QDataStream stream(property.variantValue().toByteArray());
         QVariant value;
         stream >> value;
         return value;
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterDate)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterDate)) {
         // The value was a QDate serialized as a string
         return QDate::fromString(property.value(), Qt::ISODate);
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterTime)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterTime)) {
         // The value was a QTime serialized as a string
         return QTime::fromString(property.value(), Qt::ISODate);
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterDateTime)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterDateTime)) {
         // The value was a QDateTime serialized as a string
         return QDateTime::fromString(property.value(), Qt::ISODate);
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterBool)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterBool)) {
         // The value was a bool serialized as a string
         return property.value().toInt() != 0;
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterInt)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterInt)) {
         // The value was an int serialized as a string
         return property.value().toInt();
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterUInt)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterUInt)) {
         // The value was a uint serialized as a string
         return property.value().toUInt();
-    } else if (property.parameters().contains(DatatypeParameter, DatatypeParameterUrl)) {
+    } else if (propertyData->hasParameter(DatatypeParameter, DatatypeParameterUrl)) {
         // The value was a QUrl serialized as a string
         return QUrl(property.value());
     } else {
@@ -0,0 +1,212 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qversitatoms_p.h"
+
+#include <QtCore/qhash.h>
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+// In the same order as QVersitAtoms::Atom, starting from the first atom after Unknown
+static const char* const atomNames[] = {
+    // vCard properties
+    "ADR",
+    "AGENT",
+    "BDAY",
+    "BEGIN",
+    "CATEGORIES",
+    "CLASS",
+    "EMAIL",
+    "END",
+    "FN",
+    "GEO",
+    "IMPP",
+    "KEY",
+    "LABEL",
+    "LOGO",
+    "MAILER",
+    "N",
+    "NICKNAME",
+    "NOTE",
+    "ORG",
+    "PHOTO",
+    "PRODID",
+    "REV",
+    "ROLE",
+    "SORT-STRING",
+    "SOUND",
+    "SOURCE",
+    "TEL",
+    "TITLE",
+    "TZ",
+    "UID",
+    "URL",
+    "VERSION",
+    "X-ABUID",
+    "X-AIM",
+    "X-ANNIVERSARY",
+    "X-ASSISTANT",
+    "X-ASSISTANT-TEL",
+    "X-CHILDREN",
+    "X-EDS-QTCONTACTS",
+    "X-EPOCSECONDNAME",
+    "X-EVOLUTION-ANNIVERSARY",
+    "X-EVOLUTION-SPOUSE",
+    "X-FOLKS-FAVOURITE",
+    "X-GADUGADU",
+    "X-GENDER",
+    "X-ICQ",
+    "X-IMPP",
+    "X-JABBER",
+    "X-KADDRESSBOOK-X-ANNIVERSARY",
+    "X-KADDRESSBOOK-X-IMADDRESS",
+    "X-KADDRESSBOOK-X-SPOUSENAME",
+    "X-MS-CARDPICTURE",
+    "X-MS-IMADDRESS",
+    "X-MSN",
+    "X-NICKNAME",
+    "X-QQ",
+    "X-QTPROJECT-EXTENDED-DETAIL",
+    "X-QTPROJECT-FAVORITE",
+    "X-QTPROJECT-VERSION",
+    "X-SIP",
+    "X-SKYPE",
+    "X-SKYPE-USERNAME",
+    "X-SPOUSE",
+    "X-SYNCEVO-QTCONTACTS",
+    "X-YAHOO",
+    // iCalendar properties
+    "CREATED",
+    "DESCRIPTION",
+    "DTEND",
+    "DTSTAMP",
+    "DTSTART",
+    "DUE",
+    "LAST-MODIFIED",
+    "LOCATION",
+    "PRIORITY",
+    "RRULE",
+    "STATUS",
+    "SUMMARY",
+    // Parameter names
+    "CHARSET",
+    "ENCODING",
+    "LANGUAGE",
+    "TYPE",
+    "VALUE",
+    // Common parameter values
+    "B",
+    "BASE64",
+    "CELL",
+    "FAX",
+    "HOME",
+    "INTERNET",
+    "PREF",
+    "QUOTED-PRINTABLE",
+    "UTF-8",
+    "VOICE",
+    "WORK",
+};
+
+Q_STATIC_ASSERT(sizeof(atomNames) / sizeof(atomNames[0]) == QVersitAtoms::AtomCount - 1);
+
+namespace {
+
+struct AtomTable
+{
+    AtomTable()
+    {
+        names.reserve(QVersitAtoms::AtomCount);
+        names.append(QString());
+        for (int i = 1; i < QVersitAtoms::AtomCount; i++) {
+            const QString name = QString::fromLatin1(atomNames[i - 1]);
+            names.append(name);
+            atoms.insert(name, static_cast<QVersitAtoms::Atom>(i));
+        }
+    }
+
+    QList<QString> names;
+    QHash<QString, QVersitAtoms::Atom> atoms;
+};
+
+}
+
+// Built on first use; never modified afterwards, so it can be read from any thread
+Q_GLOBAL_STATIC(AtomTable, atomTable)
+
+/*!
+ * \internal
+ * Returns the atom for \a name, or Unknown if it isn't in the table.  The comparison is
+ * case-sensitive, so property and parameter names should be upper-cased first.
+ */
+QVersitAtoms::Atom QVersitAtoms::atom(const QString& name)
+{
+    return atomTable()->atoms.value(name, Unknown);
+}
+
+/*!
+ * \internal
+ * Returns the shared string for \a atom.
+ */
+QString QVersitAtoms::name(Atom atom)
+{
+    return atomTable()->names.at(atom);
+}
+
+/*!
+ * \internal
+ * Returns the shared copy of \a name if it is in the table, so that the caller can drop its own
+ * copy, and \a name itself otherwise.  If \a atom is not null, it is set to the atom for \a name.
+ */
+QString QVersitAtoms::intern(const QString& name, Atom* atom)
+{
+    const AtomTable* table = atomTable();
+    QHash<QString, Atom>::const_iterator it = table->atoms.constFind(name);
+    if (it == table->atoms.constEnd()) {
+        if (atom)
+            *atom = Unknown;
+        return name;
+    }
+    if (atom)
+        *atom = it.value();
+    return table->names.at(it.value());
+}
+
+QT_END_NAMESPACE_VERSIT
@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QVERSITATOMS_P_H
+#define QVERSITATOMS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qstring.h>
+
+#include <QtVersit/qversitglobal.h>
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+/*
+ * A table of the property names, parameter names and parameter values that occur in nearly every
+ * vCard and iCalendar document.  Each has a small integer (its atom) and a single shared QString,
+ * so that storing one costs no allocation and comparing one is an integer comparison.
+ */
+class QVersitAtoms
+{
+public:
+    enum Atom {
+        Unknown = 0,
+        // vCard properties
+        Adr = 1,
+        Agent,
+        Bday,
+        Begin,
+        Categories,
+        Class,
+        Email,
+        End,
+        Fn,
+        Geo,
+        Impp,
+        Key,
+        Label,
+        Logo,
+        Mailer,
+        N,
+        Nickname,
+        Note,
+        Org,
+        Photo,
+        ProdId,
+        Rev,
+        Role,
+        SortString,
+        Sound,
+        Source,
+        Tel,
+        Title,
+        Tz,
+        Uid,
+        Url,
+        Version,
+        XAbUid,
+        XAim,
+        XAnniversary,
+        XAssistant,
+        XAssistantTel,
+        XChildren,
+        XEdsQtContacts,
+        XEpocSecondName,
+        XEvolutionAnniversary,
+        XEvolutionSpouse,
+        XFolksFavourite,
+        XGaduGadu,
+        XGender,
+        XIcq,
+        XImpp,
+        XJabber,
+        XKAddressBookXAnniversary,
+        XKAddressBookXImAddress,
+        XKAddressBookXSpouseName,
+        XMsCardPicture,
+        XMsImAddress,
+        XMsn,
+        XNickname,
+        XQq,
+        XQtProjectExtendedDetail,
+        XQtProjectFavorite,
+        XQtProjectVersion,
+        XSip,
+        XSkype,
+        XSkypeUsername,
+        XSpouse,
+        XSyncEvoQtContacts,
+        XYahoo,
+        // iCalendar properties
+        Created,
+        Description,
+        DtEnd,
+        DtStamp,
+        DtStart,
+        Due,
+        LastModified,
+        Location,
+        Priority,
+        RRule,
+        Status,
+        Summary,
+        // Parameter names
+        Charset,
+        Encoding,
+        Language,
+        Type,
+        Value,
+        // Common parameter values
+        B,
+        Base64,
+        Cell,
+        Fax,
+        Home,
+        Internet,
+        Pref,
+        QuotedPrintable,
+        Utf8,
+        Voice,
+        Work,
+        AtomCount
+    };
+
+    static Atom atom(const QString& name);
+    static QString name(Atom atom);
+    static QString intern(const QString& name, Atom* atom = 0);
+};
+
+QT_END_NAMESPACE_VERSIT
+
+#endif // QVERSITATOMS_P_H
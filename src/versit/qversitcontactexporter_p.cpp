@@ -115,7 +115,7 @@ void QVersitContactExporterPrivate::exportContact(
     const QContact& contact,
     QVersitDocument& document)
 {
-    QList<QContactDetail> allDetails = contact.details();
+    const QContactDetailView allDetails = contact.detailView();
     foreach (const QContactDetail& detail, allDetails) {
         if (mDetailHandler
             && mDetailHandler->preProcessDetail(contact, detail, &document))
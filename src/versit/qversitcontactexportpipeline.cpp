@@ -0,0 +1,347 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qversitcontactexportpipeline.h"
+#include "qversitcontactexportpipeline_p.h"
+
+#include <QtCore/qiodevice.h>
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+/*!
+  \class QVersitContactExportPipeline
+  \brief The QVersitContactExportPipeline class writes the contacts in a contact manager to a
+  stream as vCards.
+  \ingroup versit
+  \inmodule QtVersit
+
+  Exporting with QContactManager::contacts(), QVersitContactExporter and QVersitWriter one after
+  the other holds every contact, every document and (when writing to a buffer) all of the output in
+  memory at once, and converts and encodes the contacts on a single thread.
+  QVersitContactExportPipeline instead fetches the contacts in batches of batchSize(), converts and
+  encodes the batches concurrently on up to maxThreadCount() threads, and writes the encoded batches
+  to device() in order as they become ready.  Only a few batches are in flight at any time, so the
+  memory used is proportional to the batch size rather than to the number of contacts.
+
+  The contact manager is created from managerUri() on the pipeline's own thread.  batchFinished()
+  is emitted as each batch is written, and can be used to report progress and per-contact errors.
+
+  \sa QVersitContactExporter, QVersitWriter, QVersitContactImportPipeline
+ */
+
+/*!
+ * \enum QVersitContactExportPipeline::Error
+ * This enum specifies an error that occurred during the most recent export:
+ * \value NoError The most recent export was successful
+ * \value IOError The export could not be started or completed because of a problem with the device
+ * \value NotReadyError The export could not be started because there is an export in progress
+ * \value FetchError Some of the contacts could not be fetched from the manager
+ * \value ExportError Some of the contacts could not be converted to documents
+ */
+
+/*!
+ * \enum QVersitContactExportPipeline::State
+ * Enumerates the various states that a pipeline may be in at any given time
+ * \value InactiveState Export not yet started
+ * \value ActiveState Export started, not yet finished
+ * \value CanceledState Export is finished due to cancellation
+ * \value FinishedState Export successfully completed
+ */
+
+/*!
+ * \fn QVersitContactExportPipeline::stateChanged(QVersitContactExportPipeline::State state)
+ * The signal is emitted by the pipeline when its state has changed (eg. when it has finished
+ * writing the contacts).
+ * \a state is the new state of the pipeline.
+ */
+
+/*!
+ * \fn QVersitContactExportPipeline::batchFinished(int firstContactIndex, const QMap<int, QVersitContactExporter::Error>& exportErrors)
+ * The signal is emitted from the pipeline's thread when a batch of contacts has been written.
+ * \a firstContactIndex is the position of the first contact of the batch among the contacts
+ * matching filter().  \a exportErrors is the error map of the QVersitContactExporter that
+ * converted the batch.
+ */
+
+/*! Constructs a new pipeline with the given \a parent. */
+QVersitContactExportPipeline::QVersitContactExportPipeline(QObject* parent)
+    : QObject(parent), d(new QVersitContactExportPipelinePrivate)
+{
+    d->init(this);
+}
+
+/*!
+ * Frees the memory used by the pipeline.  An export in progress is canceled and waited for.
+ */
+QVersitContactExportPipeline::~QVersitContactExportPipeline()
+{
+    cancel();
+    d->wait();
+    delete d;
+}
+
+/*!
+ * Sets the device to write the vCards to to \a device.  Does not take ownership of the device.
+ */
+void QVersitContactExportPipeline::setDevice(QIODevice* device)
+{
+    d->mDevice = device;
+}
+
+/*!
+ * Returns the device the vCards are written to.
+ */
+QIODevice* QVersitContactExportPipeline::device() const
+{
+    return d->mDevice;
+}
+
+/*!
+ * Sets the URI of the manager the contacts are fetched from to \a managerUri.
+ *
+ * \sa QContactManager::fromUri()
+ */
+void QVersitContactExportPipeline::setManagerUri(const QString& managerUri)
+{
+    d->mManagerUri = managerUri;
+}
+
+/*!
+ * Returns the URI of the manager the contacts are fetched from.
+ */
+QString QVersitContactExportPipeline::managerUri() const
+{
+    return d->mManagerUri;
+}
+
+/*!
+ * Sets the filter that selects which contacts are exported to \a filter.  By default, every
+ * contact in the manager is exported.
+ */
+void QVersitContactExportPipeline::setFilter(const QContactFilter& filter)
+{
+    d->mFilter = filter;
+}
+
+/*!
+ * Returns the filter that selects which contacts are exported.
+ */
+QContactFilter QVersitContactExportPipeline::filter() const
+{
+    return d->mFilter;
+}
+
+/*!
+ * Sets the \a profiles used to convert the contacts to documents.
+ *
+ * \sa QVersitContactExporter::QVersitContactExporter()
+ */
+void QVersitContactExportPipeline::setProfiles(const QStringList& profiles)
+{
+    d->mProfiles = profiles;
+}
+
+/*!
+ * Returns the profiles used to convert the contacts to documents.
+ */
+QStringList QVersitContactExportPipeline::profiles() const
+{
+    return d->mProfiles;
+}
+
+/*!
+ * Sets the format the contacts are written in to \a type.  The default is
+ * QVersitDocument::VCard30Type.
+ */
+void QVersitContactExportPipeline::setVersitType(QVersitDocument::VersitType type)
+{
+    d->mVersitType = type;
+}
+
+/*!
+ * Returns the format the contacts are written in.
+ */
+QVersitDocument::VersitType QVersitContactExportPipeline::versitType() const
+{
+    return d->mVersitType;
+}
+
+/*!
+ * Sets the default codec for the pipeline to use for writing the output to \a codec.
+ *
+ * \sa QVersitWriter::setDefaultCodec()
+ */
+void QVersitContactExportPipeline::setDefaultCodec(QTextCodec* codec)
+{
+    d->mDefaultCodec = codec;
+}
+
+/*!
+ * Returns the codec the pipeline uses for writing the output, or null if the standard codec for
+ * versitType() is used.
+ */
+QTextCodec* QVersitContactExportPipeline::defaultCodec() const
+{
+    return d->mDefaultCodec;
+}
+
+/*!
+ * Sets the number of contacts fetched, converted and written together to \a size.  The default is
+ * 100.
+ */
+void QVersitContactExportPipeline::setBatchSize(int size)
+{
+    d->mBatchSize = qMax(1, size);
+}
+
+/*!
+ * Returns the number of contacts fetched, converted and written together.
+ */
+int QVersitContactExportPipeline::batchSize() const
+{
+    return d->mBatchSize;
+}
+
+/*!
+ * Sets the maximum number of threads used to convert and encode the contacts to \a count.  The
+ * default is QThread::idealThreadCount().
+ */
+void QVersitContactExportPipeline::setMaxThreadCount(int count)
+{
+    d->mMaxThreadCount = qMax(1, count);
+}
+
+/*!
+ * Returns the maximum number of threads used to convert and encode the contacts.
+ */
+int QVersitContactExportPipeline::maxThreadCount() const
+{
+    return d->mMaxThreadCount;
+}
+
+/*!
+ * Returns the state of the pipeline.
+ */
+QVersitContactExportPipeline::State QVersitContactExportPipeline::state() const
+{
+    return d->state();
+}
+
+/*!
+ * Returns the first error encountered by the most recent export.
+ */
+QVersitContactExportPipeline::Error QVersitContactExportPipeline::error() const
+{
+    return d->error();
+}
+
+/*!
+ * Returns the number of contacts written so far by the most recent export.
+ */
+int QVersitContactExportPipeline::writtenContactCount() const
+{
+    QMutexLocker locker(&d->mMutex);
+    return d->mWrittenContactCount;
+}
+
+/*!
+ * Starts exporting asynchronously.
+ * Returns false if the device has not been set or opened, or if there is another export already
+ * in progress.  Signal \l stateChanged() is emitted with parameter FinishedState when the export
+ * has finished.
+ *
+ * The device must be already open.  The client is responsible for closing it when finished.
+ */
+bool QVersitContactExportPipeline::start()
+{
+    if (d->state() == ActiveState || d->isRunning()) {
+        QMutexLocker locker(&d->mMutex);
+        d->mError = NotReadyError;
+        return false;
+    }
+    if (!d->mDevice || !d->mDevice->isWritable()) {
+        QMutexLocker locker(&d->mMutex);
+        d->mError = IOError;
+        return false;
+    }
+
+    d->mMutex.lock();
+    d->mError = NoError;
+    d->mIsCanceling = false;
+    d->mWrittenContactCount = 0;
+    d->mMutex.unlock();
+
+    d->setState(ActiveState);
+    d->start();
+    return true;
+}
+
+/*!
+ * Attempts to asynchronously cancel the export.  Batches that have already been written are not
+ * removed from the device.
+ */
+void QVersitContactExportPipeline::cancel()
+{
+    d->setCanceling(true);
+}
+
+/*!
+ * If the state is ActiveState, blocks until the export has finished or \a msec milliseconds
+ * has elapsed, returning true if it successfully finishes or is cancelled by the user.
+ * If \a msec is negative or zero, the function blocks until the export has finished, regardless
+ * of how long it takes.
+ * If the state is FinishedState, returns true immediately.
+ * Otherwise, returns false immediately.
+ */
+bool QVersitContactExportPipeline::waitForFinished(int msec)
+{
+    State state = d->state();
+    if (state != InactiveState) {
+        if (msec <= 0)
+            return d->wait(ULONG_MAX);
+        else
+            return d->wait(msec);
+    } else {
+        return false;
+    }
+}
+
+QT_END_NAMESPACE_VERSIT
+
+#include "moc_qversitcontactexportpipeline.cpp"
@@ -0,0 +1,130 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QVERSITCONTACTEXPORTPIPELINE_H
+#define QVERSITCONTACTEXPORTPIPELINE_H
+
+#include <QtCore/qmap.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstringlist.h>
+
+#include <QtContacts/qcontactfilter.h>
+
+#include <QtVersit/qversitcontactexporter.h>
+#include <QtVersit/qversitdocument.h>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+QT_FORWARD_DECLARE_CLASS(QTextCodec)
+
+QTCONTACTS_USE_NAMESPACE
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+class QVersitContactExportPipelinePrivate;
+
+class Q_VERSIT_EXPORT QVersitContactExportPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    enum Error {
+        NoError = 0,
+        IOError,
+        NotReadyError,
+        FetchError,
+        ExportError
+    };
+
+    enum State {
+        InactiveState = 0,
+        ActiveState,
+        CanceledState,
+        FinishedState
+    };
+
+    explicit QVersitContactExportPipeline(QObject* parent = nullptr);
+    ~QVersitContactExportPipeline();
+
+    void setDevice(QIODevice* device);
+    QIODevice* device() const;
+
+    void setManagerUri(const QString& managerUri);
+    QString managerUri() const;
+
+    void setFilter(const QContactFilter& filter);
+    QContactFilter filter() const;
+
+    void setProfiles(const QStringList& profiles);
+    QStringList profiles() const;
+
+    void setVersitType(QVersitDocument::VersitType type);
+    QVersitDocument::VersitType versitType() const;
+
+    void setDefaultCodec(QTextCodec* codec);
+    QTextCodec* defaultCodec() const;
+
+    void setBatchSize(int size);
+    int batchSize() const;
+
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const;
+
+    State state() const;
+    Error error() const;
+    int writtenContactCount() const;
+
+public Q_SLOTS:
+    bool start();
+    void cancel();
+public:
+    Q_INVOKABLE bool waitForFinished(int msec = -1);
+
+Q_SIGNALS:
+    void stateChanged(QVersitContactExportPipeline::State state);
+    void batchFinished(int firstContactIndex,
+                       const QMap<int, QVersitContactExporter::Error>& exportErrors);
+
+private: // data
+    QVersitContactExportPipelinePrivate* d;
+};
+
+QT_END_NAMESPACE_VERSIT
+
+Q_DECLARE_METATYPE(QTVERSIT_PREPEND_NAMESPACE(QVersitContactExportPipeline::State))
+
+#endif // QVERSITCONTACTEXPORTPIPELINE_H
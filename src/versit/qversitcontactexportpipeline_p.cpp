@@ -0,0 +1,276 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qversitcontactexportpipeline_p.h"
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+
+#include <QtContacts/qcontactmanager.h>
+
+#include "qversitwriter_p.h"
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+/*!
+ * \internal
+ * Converts one batch of contacts to documents and encodes them.  The task is picked up by
+ * QVersitContactExportPipelinePrivate::run() once isFinished() is true; \a finished is signalled
+ * (with \a mutex held) when that happens.
+ */
+class ContactExportTask : public QRunnable
+{
+public:
+    ContactExportTask(QVersitContactExporter* exporter, const QList<QContact>& contacts,
+                      int firstContactIndex, QVersitDocument::VersitType type, QTextCodec* codec,
+                      QMutex* mutex, QWaitCondition* finished)
+        : mExporter(exporter), mContacts(contacts), mFirstContactIndex(firstContactIndex),
+          mContactCount(contacts.size()), mType(type), mCodec(codec), mMutex(mutex),
+          mFinished(finished), mOk(true), mIsFinished(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        mExporter->exportContacts(mContacts, mType);
+        mContacts.clear();
+
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        bool ok = true;
+        foreach (const QVersitDocument& document, mExporter->documents()) {
+            if (!QVersitWriterPrivate::encodeDocument(&buffer, document, mType, mCodec)) {
+                ok = false;
+                break;
+            }
+        }
+        buffer.close();
+
+        QMutexLocker locker(mMutex);
+        mBytes = bytes;
+        mOk = ok;
+        mIsFinished = true;
+        mFinished->wakeAll();
+    }
+
+    // Must be called with the mutex held
+    bool isFinished() const { return mIsFinished; }
+
+    // Valid once isFinished() is true
+    bool isOk() const { return mOk; }
+    const QByteArray& bytes() const { return mBytes; }
+    QMap<int, QVersitContactExporter::Error> errorMap() const { return mExporter->errorMap(); }
+
+    QVersitContactExporter* exporter() const { return mExporter; }
+    int firstContactIndex() const { return mFirstContactIndex; }
+    int contactCount() const { return mContactCount; }
+
+private:
+    QVersitContactExporter* mExporter;
+    QList<QContact> mContacts;
+    int mFirstContactIndex;
+    int mContactCount;
+    QVersitDocument::VersitType mType;
+    QTextCodec* mCodec;
+    QMutex* mMutex;
+    QWaitCondition* mFinished;
+    QByteArray mBytes;
+    bool mOk;
+    bool mIsFinished;
+};
+
+/*! Construct a pipeline. */
+QVersitContactExportPipelinePrivate::QVersitContactExportPipelinePrivate()
+    : mDevice(0),
+    mVersitType(QVersitDocument::VCard30Type),
+    mDefaultCodec(0),
+    mBatchSize(100),
+    mMaxThreadCount(QThread::idealThreadCount()),
+    mState(QVersitContactExportPipeline::InactiveState),
+    mError(QVersitContactExportPipeline::NoError),
+    mIsCanceling(false),
+    mWrittenContactCount(0)
+{
+}
+
+void QVersitContactExportPipelinePrivate::init(QVersitContactExportPipeline* pipeline)
+{
+    qRegisterMetaType<QVersitContactExportPipeline::State>("QVersitContactExportPipeline::State");
+    connect(this, &QVersitContactExportPipelinePrivate::stateChanged,
+            pipeline, &QVersitContactExportPipeline::stateChanged, Qt::DirectConnection);
+    connect(this, &QVersitContactExportPipelinePrivate::batchFinished,
+            pipeline, &QVersitContactExportPipeline::batchFinished, Qt::DirectConnection);
+}
+
+/*!
+ * Inherited from QThread, called by QThread when the thread has been started.
+ *
+ * Fetches the contacts from the manager a batch at a time and hands each batch to a thread pool,
+ * where it is converted and encoded into a byte buffer.  The buffers are written to the device in
+ * the order of the batches as they become ready.  At most two batches per pool thread are in
+ * flight, which bounds the memory used however many contacts are exported.  The manager is created
+ * on this thread so that it is only ever used from here.
+ */
+void QVersitContactExportPipelinePrivate::run()
+{
+    QContactManager* manager = QContactManager::fromUri(mManagerUri);
+    const QList<QContactId> ids = manager->contactIds(mFilter);
+    if (manager->error() != QContactManager::NoError)
+        setError(QVersitContactExportPipeline::FetchError);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(mMaxThreadCount);
+    const int maxPendingTasks = 2 * mMaxThreadCount;
+    QQueue<ContactExportTask*> tasks; // In output order
+    QList<QVersitContactExporter*> idleExporters;
+    QList<QVersitContactExporter*> exporters;
+    int nextIndex = 0;
+
+    while (!isCanceling() && (nextIndex < ids.size() || !tasks.isEmpty())) {
+        // Keep the pool busy
+        while (nextIndex < ids.size() && tasks.size() < maxPendingTasks) {
+            const QList<QContactId> batchIds = ids.mid(nextIndex, mBatchSize);
+            QMap<int, QContactManager::Error> fetchErrors;
+            const QList<QContact> contacts = manager->contacts(batchIds, QContactFetchHint(),
+                                                               &fetchErrors);
+            // Contacts removed since the ids were fetched come back empty and are reported by the
+            // exporter
+            if (!fetchErrors.isEmpty())
+                setError(QVersitContactExportPipeline::FetchError);
+
+            if (idleExporters.isEmpty()) {
+                exporters.append(new QVersitContactExporter(mProfiles));
+                idleExporters.append(exporters.last());
+            }
+            ContactExportTask* task = new ContactExportTask(
+                        idleExporters.takeLast(), contacts, nextIndex, mVersitType,
+                        mDefaultCodec, &mMutex, &mBatchEncoded);
+            tasks.enqueue(task);
+            pool.start(task);
+            nextIndex += batchIds.size();
+        }
+
+        ContactExportTask* task = tasks.head();
+        mMutex.lock();
+        while (!task->isFinished())
+            mBatchEncoded.wait(&mMutex);
+        mMutex.unlock();
+        tasks.dequeue();
+
+        const QMap<int, QVersitContactExporter::Error> exportErrors = task->errorMap();
+        if (!exportErrors.isEmpty())
+            setError(QVersitContactExportPipeline::ExportError);
+        const bool written = task->isOk()
+                && mDevice->write(task->bytes()) == task->bytes().size();
+        const int firstContactIndex = task->firstContactIndex();
+        const int contactCount = task->contactCount() - exportErrors.size();
+        idleExporters.append(task->exporter());
+        delete task;
+        if (!written) {
+            setError(QVersitContactExportPipeline::IOError);
+            break;
+        }
+
+        mMutex.lock();
+        mWrittenContactCount += contactCount;
+        mMutex.unlock();
+        emit batchFinished(firstContactIndex, exportErrors);
+    }
+
+    pool.waitForDone();
+    qDeleteAll(tasks);
+    qDeleteAll(exporters);
+    delete manager;
+
+    if (isCanceling())
+        setState(QVersitContactExportPipeline::CanceledState);
+    else
+        setState(QVersitContactExportPipeline::FinishedState);
+}
+
+void QVersitContactExportPipelinePrivate::setState(QVersitContactExportPipeline::State state)
+{
+    mMutex.lock();
+    mState = state;
+    mMutex.unlock();
+    emit stateChanged(state);
+}
+
+QVersitContactExportPipeline::State QVersitContactExportPipelinePrivate::state() const
+{
+    QMutexLocker locker(&mMutex);
+    return mState;
+}
+
+/*!
+ * \internal
+ * Records \a error unless an earlier error has already been recorded for this run.
+ */
+void QVersitContactExportPipelinePrivate::setError(QVersitContactExportPipeline::Error error)
+{
+    QMutexLocker locker(&mMutex);
+    if (mError == QVersitContactExportPipeline::NoError)
+        mError = error;
+}
+
+QVersitContactExportPipeline::Error QVersitContactExportPipelinePrivate::error() const
+{
+    QMutexLocker locker(&mMutex);
+    return mError;
+}
+
+void QVersitContactExportPipelinePrivate::setCanceling(bool canceling)
+{
+    QMutexLocker locker(&mMutex);
+    mIsCanceling = canceling;
+}
+
+bool QVersitContactExportPipelinePrivate::isCanceling() const
+{
+    QMutexLocker locker(&mMutex);
+    return mIsCanceling;
+}
+
+QT_END_NAMESPACE_VERSIT
+
+#include "moc_qversitcontactexportpipeline_p.cpp"
@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QVERSITCONTACTEXPORTPIPELINE_P_H
+#define QVERSITCONTACTEXPORTPIPELINE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <QtVersit/qversitcontactexportpipeline.h>
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+class QVersitContactExportPipelinePrivate : public QThread
+{
+    Q_OBJECT
+
+public:
+    QVersitContactExportPipelinePrivate();
+    void init(QVersitContactExportPipeline* pipeline);
+
+    // mutexed getters and setters.
+    void setState(QVersitContactExportPipeline::State state);
+    QVersitContactExportPipeline::State state() const;
+    void setError(QVersitContactExportPipeline::Error error);
+    QVersitContactExportPipeline::Error error() const;
+    void setCanceling(bool canceling);
+    bool isCanceling() const;
+
+protected: // From QThread
+    void run() override;
+
+signals:
+    void stateChanged(QVersitContactExportPipeline::State state);
+    void batchFinished(int firstContactIndex,
+                       const QMap<int, QVersitContactExporter::Error>& exportErrors);
+
+// Data
+public:
+    QIODevice* mDevice;
+    QString mManagerUri;
+    QContactFilter mFilter;
+    QStringList mProfiles;
+    QVersitDocument::VersitType mVersitType;
+    QTextCodec* mDefaultCodec;
+    int mBatchSize;
+    int mMaxThreadCount;
+
+    QVersitContactExportPipeline::State mState;
+    QVersitContactExportPipeline::Error mError;
+    bool mIsCanceling;
+    int mWrittenContactCount;
+    mutable QMutex mMutex;
+    QWaitCondition mBatchEncoded;
+};
+
+QT_END_NAMESPACE_VERSIT
+
+#endif // QVERSITCONTACTEXPORTPIPELINE_P_H
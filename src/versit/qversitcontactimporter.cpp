@@ -242,10 +242,13 @@ QVersitContactImporter::~QVersitContactImporter()
  */
 bool QVersitContactImporter::importDocuments(const QList<QVersitDocument>& documents)
 {
-    int documentIndex = 0;
-    int contactIndex = 0;
     d->mContacts.clear();
     d->mErrors.clear();
+    if (documents.size() > 1 && d->canImportInParallel())
+        return d->importDocumentsInParallel(documents);
+
+    int documentIndex = 0;
+    int contactIndex = 0;
     bool ok = true;
     foreach (const QVersitDocument& document, documents) {
         QContact contact;
@@ -263,6 +266,51 @@ bool QVersitContactImporter::importDocuments(const QList<QVersitDocument>& docum
     return ok;
 }
 
+/*!
+ * Sets the maximum number of threads importDocuments() uses to \a count.  If \a count is greater
+ * than one, the documents are split into contiguous ranges which are converted concurrently.
+ * contacts() and errorMap() hold exactly what a single-threaded import would produce.  The default
+ * is one.
+ *
+ * Each thread uses its own instances of the handlers loaded from \l{Qt Versit Plugins}{plugins}.
+ * A property handler or resource handler set by the client is shared by all of the threads, so
+ * when one is set the import only runs concurrently if setHandlersThreadSafe() has been called.
+ * Otherwise, the documents are converted on the calling thread.
+ *
+ * \sa setHandlersThreadSafe()
+ */
+void QVersitContactImporter::setMaxThreadCount(int count)
+{
+    d->mMaxThreadCount = qMax(1, count);
+}
+
+/*!
+ * Returns the maximum number of threads importDocuments() uses.
+ */
+int QVersitContactImporter::maxThreadCount() const
+{
+    return d->mMaxThreadCount;
+}
+
+/*!
+ * Declares whether the property handler and resource handler set on this importer may be called
+ * from several threads at once, according to \a threadSafe.  The default is false.
+ *
+ * \sa setMaxThreadCount()
+ */
+void QVersitContactImporter::setHandlersThreadSafe(bool threadSafe)
+{
+    d->mHandlersThreadSafe = threadSafe;
+}
+
+/*!
+ * Returns true if the client's handlers have been declared thread-safe.
+ */
+bool QVersitContactImporter::handlersThreadSafe() const
+{
+    return d->mHandlersThreadSafe;
+}
+
 /*!
  * Returns the contacts imported in the most recent call to importDocuments().
  *
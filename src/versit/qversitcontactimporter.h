@@ -108,6 +108,11 @@ public:
     void setResourceHandler(QVersitResourceHandler* handler);
     QVersitResourceHandler* resourceHandler() const;
 
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const;
+    void setHandlersThreadSafe(bool threadSafe);
+    bool handlersThreadSafe() const;
+
     /* deprecated */
     QMap<int, Error> errors() const;
     void setPropertyHandler(QVersitContactImporterPropertyHandler* handler);
@@ -39,14 +39,19 @@
 
 #include "qversitcontactimporter_p.h"
 
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+
 #include <QtContacts/qcontactdetails.h>
 
+#include "qversitatoms_p.h"
 #include "qversitcontacthandler.h"
 #include "qversitcontactpluginloader_p.h"
 #include "qversitcontactsdefs_p.h"
 #include "qversitdocument.h"
 #include "qversitpluginsearch_p.h"
 #include "qversitproperty.h"
+#include "qversitproperty_p.h"
 #include "qversitutils_p.h"
 
 QTCONTACTS_USE_NAMESPACE
@@ -57,11 +62,14 @@ QT_BEGIN_NAMESPACE_VERSIT
  * Constructor.
  */
 QVersitContactImporterPrivate::QVersitContactImporterPrivate(const QStringList& profiles) :
+    mProfiles(profiles),
     mPropertyHandler(NULL),
     mPropertyHandler2(NULL),
     mPropertyHandlerVersion(0),
     mDefaultResourceHandler(new QVersitDefaultResourceHandler),
-    mResourceHandler(mDefaultResourceHandler)
+    mResourceHandler(mDefaultResourceHandler),
+    mMaxThreadCount(1),
+    mHandlersThreadSafe(false)
 {
     // Contact detail mappings
     int versitPropertyCount =
@@ -76,6 +84,14 @@ QVersitContactImporterPrivate::QVersitContactImporterPrivate(const QStringList&
             versitContactDetailMappings[i].detailField;
         mDetailMappings.insert(versitPropertyName,contactDetail);
     }
+    // ... and the same, indexed by atom for the well-known property names
+    mAtomDetailMappings.resize(QVersitAtoms::AtomCount);
+    QHash<QString, QPair<QContactDetail::DetailType, int> >::const_iterator mapping;
+    for (mapping = mDetailMappings.constBegin(); mapping != mDetailMappings.constEnd(); ++mapping) {
+        QVersitAtoms::Atom atom = QVersitAtoms::atom(mapping.key());
+        if (atom != QVersitAtoms::Unknown)
+            mAtomDetailMappings[atom] = mapping.value();
+    }
 
     // Context mappings
     int contextCount = sizeof(versitContextMappings)/sizeof(VersitContextMapping);
@@ -116,27 +132,21 @@ bool QVersitContactImporterPrivate::importContact(
         const QVersitDocument& document, int contactIndex, QContact* contact,
         QVersitContactImporter::Error* error)
 {
-    if (document.componentType() != QStringLiteral("VCARD")
-        && document.type() != QVersitDocument::VCard21Type
-        && document.type() != QVersitDocument::VCard30Type) {
-        *error = QVersitContactImporter::InvalidDocumentError;
+    if (!isImportable(document, error))
         return false;
-    }
     const QList<QVersitProperty> properties = document.properties();
-    if (properties.size() == 0) {
-        *error = QVersitContactImporter::EmptyDocumentError;
-        return false;
-    }
 
     // First, do the properties with PREF set so they appear first in the contact details
     foreach (const QVersitProperty& property, properties) {
-        QStringList typeParameters = property.parameters().values(QStringLiteral("TYPE"));
+        QStringList typeParameters = QVersitPropertyPrivate::get(property)->parameterValues(
+                    QVersitAtoms::name(QVersitAtoms::Type));
         if (typeParameters.contains(QStringLiteral("PREF"), Qt::CaseInsensitive))
             importProperty(document, property, contactIndex, contact);
     }
     // ... then, do the rest of the properties.
     foreach (const QVersitProperty& property, properties) {
-        QStringList typeParameters = property.parameters().values(QStringLiteral("TYPE"));
+        QStringList typeParameters = QVersitPropertyPrivate::get(property)->parameterValues(
+                    QVersitAtoms::name(QVersitAtoms::Type));
         if (!typeParameters.contains(QStringLiteral("PREF"), Qt::CaseInsensitive))
             importProperty(document, property, contactIndex, contact);
     }
@@ -156,6 +166,157 @@ bool QVersitContactImporterPrivate::importContact(
     return true;
 }
 
+/*!
+ * Returns true if \a document can be converted to a contact.  Otherwise, sets \a error to the
+ * reason it can't be and returns false.  This only looks at the document's type and whether it
+ * has any properties, so the outcome of an import can be known before it is done.
+ */
+bool QVersitContactImporterPrivate::isImportable(const QVersitDocument& document,
+                                                 QVersitContactImporter::Error* error)
+{
+    if (document.componentType() != QStringLiteral("VCARD")
+        && document.type() != QVersitDocument::VCard21Type
+        && document.type() != QVersitDocument::VCard30Type) {
+        *error = QVersitContactImporter::InvalidDocumentError;
+        return false;
+    }
+    if (document.properties().isEmpty()) {
+        *error = QVersitContactImporter::EmptyDocumentError;
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Returns true if documents can be converted on more than one thread.  The importer's own
+ * conversion and the plugin handlers are safe, because each thread gets an importer with
+ * handlers of its own; a client-supplied property or resource handler is shared between the
+ * threads, so it is only used concurrently if the client has declared it thread-safe.
+ */
+bool QVersitContactImporterPrivate::canImportInParallel() const
+{
+    if (mMaxThreadCount <= 1)
+        return false;
+    if (mHandlersThreadSafe)
+        return true;
+    return mPropertyHandler == NULL
+        && mPropertyHandler2 == NULL
+        && mResourceHandler == mDefaultResourceHandler;
+}
+
+/*!
+ * \internal
+ * Converts a contiguous range of documents with an importer of its own, so that the plugin
+ * handlers (which keep per-document state) see the documents of the range in order.
+ */
+class ContactImportTask : public QRunnable
+{
+public:
+    ContactImportTask(QVersitContactImporterPrivate* importer,
+                      const QList<QVersitDocument>& documents, const QList<int>& contactIndices,
+                      int begin, int end)
+        : mImporter(importer), mDocuments(documents), mContactIndices(contactIndices),
+          mBegin(begin), mEnd(end)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        for (int i = mBegin; i < mEnd; i++) {
+            int contactIndex = mContactIndices.at(i);
+            if (contactIndex < 0)
+                continue;
+            QContact contact;
+            QVersitContactImporter::Error error;
+            mImporter->importContact(mDocuments.at(i), contactIndex, &contact, &error);
+            mContacts.append(contact);
+        }
+    }
+
+    // Valid once the task has run
+    const QList<QContact>& contacts() const { return mContacts; }
+
+private:
+    QVersitContactImporterPrivate* mImporter;
+    const QList<QVersitDocument> mDocuments;
+    const QList<int> mContactIndices;
+    int mBegin;
+    int mEnd;
+    QList<QContact> mContacts;
+};
+
+/*!
+ * Converts \a documents on up to mMaxThreadCount threads, filling in mContacts and mErrors exactly
+ * as a serial import would.  Which documents fail (and so the index every contact will have) is
+ * worked out up front, then the documents are split into one contiguous range per thread.  The
+ * first range is converted by this importer, the rest by temporary importers that share the
+ * client's handlers.  Returns true if every document was converted.
+ */
+bool QVersitContactImporterPrivate::importDocumentsInParallel(const QList<QVersitDocument>& documents)
+{
+    QList<int> contactIndices;
+    contactIndices.reserve(documents.size());
+    int contactCount = 0;
+    for (int i = 0; i < documents.size(); i++) {
+        QVersitContactImporter::Error error;
+        if (isImportable(documents.at(i), &error)) {
+            contactIndices.append(contactCount++);
+        } else {
+            contactIndices.append(-1);
+            mErrors.insert(i, error);
+        }
+    }
+
+    const int taskCount = qMax(1, qMin(mMaxThreadCount, contactCount));
+    QList<QVersitContactImporterPrivate*> importers;
+    QList<ContactImportTask*> tasks;
+    for (int t = 0; t < taskCount; t++) {
+        QVersitContactImporterPrivate* importer = this;
+        if (t > 0) {
+            importer = new QVersitContactImporterPrivate(mProfiles);
+            importer->mPropertyHandler = mPropertyHandler;
+            importer->mPropertyHandler2 = mPropertyHandler2;
+            importer->mPropertyHandlerVersion = mPropertyHandlerVersion;
+            if (mResourceHandler != mDefaultResourceHandler)
+                importer->mResourceHandler = mResourceHandler;
+            importers.append(importer);
+        }
+        int begin = documents.size() * t / taskCount;
+        int end = documents.size() * (t + 1) / taskCount;
+        tasks.append(new ContactImportTask(importer, documents, contactIndices, begin, end));
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(taskCount - 1);
+    for (int t = 1; t < taskCount; t++)
+        pool.start(tasks.at(t));
+    tasks.first()->run();
+    pool.waitForDone();
+
+    mContacts.reserve(contactCount);
+    foreach (ContactImportTask* task, tasks) {
+        mContacts.append(task->contacts());
+        delete task;
+    }
+    qDeleteAll(importers);
+
+    return mErrors.isEmpty();
+}
+
+/*!
+ * Returns the detail type and field that \a property maps to in versitContactDetailMappings, or
+ * TypeUndefined if there is no simple mapping.
+ */
+QPair<QContactDetail::DetailType, int> QVersitContactImporterPrivate::detailMapping(
+        const QVersitProperty& property) const
+{
+    QVersitAtoms::Atom atom = QVersitPropertyPrivate::get(property)->mNameAtom;
+    if (atom != QVersitAtoms::Unknown)
+        return mAtomDetailMappings.at(atom);
+    return mDetailMappings.value(property.name());
+}
+
 void QVersitContactImporterPrivate::importProperty(
         const QVersitDocument& document, const QVersitProperty& property, int contactIndex,
         QContact* contact)
@@ -165,8 +326,7 @@ void QVersitContactImporterPrivate::importProperty(
         && mPropertyHandler->preProcessProperty(document, property, contactIndex, contact))
         return;
 
-    QPair<QContactDetail::DetailType, int> detailDefinition =
-        mDetailMappings.value(property.name());
+    QPair<QContactDetail::DetailType, int> detailDefinition = detailMapping(property);
     QContactDetail::DetailType detailType = detailDefinition.first;
 
     QList<QContactDetail> updatedDetails;
@@ -403,8 +563,7 @@ bool QVersitContactImporterPrivate::createOrganization(
     QList<QContactDetail>* updatedDetails)
 {
     QContactOrganization organization;
-    QPair<QContactDetail::DetailType, int> detailTypeAndFieldName =
-        mDetailMappings.value(property.name());
+    QPair<QContactDetail::DetailType, int> detailTypeAndFieldName = detailMapping(property);
     int fieldName = detailTypeAndFieldName.second;
     QList<QContactOrganization> organizations = contact->details<QContactOrganization>();
     foreach(const QContactOrganization& current, organizations) {
@@ -934,8 +1093,7 @@ bool QVersitContactImporterPrivate::createNameValueDetail(
     QString value(property.value());
     if (value.isEmpty())
         return false;
-    QPair<QContactDetail::DetailType, int> nameAndValueType =
-        mDetailMappings.value(property.name());
+    QPair<QContactDetail::DetailType, int> nameAndValueType = detailMapping(property);
     if (nameAndValueType.first == QContactDetail::TypeUndefined)
         return false;
 
@@ -952,7 +1110,8 @@ bool QVersitContactImporterPrivate::createNameValueDetail(
 QList<int> QVersitContactImporterPrivate::extractContexts(
     const QVersitProperty& property) const
 {
-    QStringList types = property.parameters().values(QStringLiteral("TYPE"));
+    QStringList types = QVersitPropertyPrivate::get(property)->parameterValues(
+                QVersitAtoms::name(QVersitAtoms::Type));
     QList<int> contexts;
     foreach (const QString& type, types) {
         QString value = type.toUpper();
@@ -968,7 +1127,8 @@ QList<int> QVersitContactImporterPrivate::extractContexts(
 QStringList QVersitContactImporterPrivate::extractSubTypes(
     const QVersitProperty& property) const
 {
-    QStringList types = property.parameters().values(QStringLiteral("TYPE"));
+    QStringList types = QVersitPropertyPrivate::get(property)->parameterValues(
+                QVersitAtoms::name(QVersitAtoms::Type));
     QStringList subTypes;
     foreach (const QString& type, types) {
         QString subType = type.toUpper();
@@ -1032,7 +1192,8 @@ bool QVersitContactImporterPrivate::saveDataFromProperty(const QVersitProperty &
                                                             QByteArray *data) const
 {
     bool found = false;
-    const QString valueParam = property.parameters().value(QStringLiteral("VALUE")).toUpper();
+    const QString valueParam = QVersitPropertyPrivate::get(property)->parameterValue(
+                QVersitAtoms::name(QVersitAtoms::Value)).toUpper();
     QVariant variant(property.variantValue());
     if (variant.metaType().id() == QMetaType::QString
         || valueParam == QStringLiteral("URL")
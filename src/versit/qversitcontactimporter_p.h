@@ -56,6 +56,7 @@
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qpair.h>
+#include <QtCore/qstringlist.h>
 
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactdetail.h>
@@ -83,9 +84,13 @@ public:
 
     bool importContact(const QVersitDocument& versitDocument, int contactIndex,
                        QContact* contact, QVersitContactImporter::Error* error);
+    bool importDocumentsInParallel(const QList<QVersitDocument>& documents);
+    bool canImportInParallel() const;
+    static bool isImportable(const QVersitDocument& document, QVersitContactImporter::Error* error);
 
 private:
     void importProperty(const QVersitDocument& document, const QVersitProperty& property, int contactIndex, QContact* contact);
+    QPair<QContactDetail::DetailType, int> detailMapping(const QVersitProperty& property) const;
     bool createName(const QVersitProperty& property, QContact* contact, QList<QContactDetail>* updatedDetails);
     bool createPhone(const QVersitProperty& property, QContact* contact, QList<QContactDetail>* updatedDetails);
     bool createAddress(const QVersitProperty& property, QContact* contact, QList<QContactDetail>* updatedDetails);
@@ -117,6 +122,7 @@ private:
     void saveDetailWithContext(QList<QContactDetail>* updatedDetails, QContactDetail detail, const QList<int>& contexts);
 
 public: // Data
+    QStringList mProfiles;
     QList<QContact> mContacts;
     QMap<int, QVersitContactImporter::Error> mErrors;
     QVersitContactImporterPropertyHandler* mPropertyHandler;
@@ -126,8 +132,11 @@ public: // Data
     QVersitDefaultResourceHandler* mDefaultResourceHandler;
     QVersitResourceHandler* mResourceHandler;
     QVCardRestoreHandler mRestoreHandler;
+    int mMaxThreadCount;
+    bool mHandlersThreadSafe;
 
     QHash<QString, QPair<QContactDetail::DetailType, int> > mDetailMappings;
+    QList<QPair<QContactDetail::DetailType, int> > mAtomDetailMappings; // Indexed by QVersitAtoms::Atom
     QMultiHash<QString, QPair<QContactDetail::DetailType, int> > mSubTypeMappings;
     QHash< int ,QString> mContextMappings;
 };
@@ -0,0 +1,286 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qversitcontactimportpipeline.h"
+#include "qversitcontactimportpipeline_p.h"
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+/*!
+  \class QVersitContactImportPipeline
+  \brief The QVersitContactImportPipeline class reads vCards from a stream and saves them as
+  contacts in a contact manager.
+  \ingroup versit
+  \inmodule QtVersit
+
+  Importing with QVersitReader, QVersitContactImporter and QContactManager::saveContacts() one
+  after the other holds every document and every contact in memory at once.
+  QVersitContactImportPipeline instead runs the three steps concurrently, each on its own thread,
+  and passes the data between them in batches of batchSize() documents.  Only a few batches are
+  in flight at any time, so the memory used is proportional to the batch size rather than to the
+  size of the input.
+
+  The contact manager is created from managerUri() on the saving thread.  batchFinished() is
+  emitted as each batch is saved, and can be used to report progress and per-contact errors.
+
+  \sa QVersitReader, QVersitContactImporter
+ */
+
+/*!
+ * \enum QVersitContactImportPipeline::Error
+ * This enum specifies an error that occurred during the most recent import:
+ * \value NoError The most recent import was successful
+ * \value IOError The import could not be started because of a problem with the device
+ * \value NotReadyError The import could not be started because there is an import in progress
+ * \value ParseError Some of the input was malformed
+ * \value ImportError Some of the documents could not be converted to contacts
+ * \value SaveError Some of the contacts could not be saved
+ */
+
+/*!
+ * \enum QVersitContactImportPipeline::State
+ * Enumerates the various states that a pipeline may be in at any given time
+ * \value InactiveState Import not yet started
+ * \value ActiveState Import started, not yet finished
+ * \value CanceledState Import is finished due to cancellation
+ * \value FinishedState Import successfully completed
+ */
+
+/*!
+ * \fn QVersitContactImportPipeline::stateChanged(QVersitContactImportPipeline::State state)
+ * The signal is emitted by the pipeline when its state has changed (eg. when it has finished
+ * saving the contacts).
+ * \a state is the new state of the pipeline.
+ */
+
+/*!
+ * \fn QVersitContactImportPipeline::batchFinished(int firstDocumentIndex, const QList<QContactId>& savedIds, const QMap<int, QVersitContactImporter::Error>& importErrors, const QMap<int, QContactManager::Error>& saveErrors)
+ * The signal is emitted from the saving thread when a batch of documents has been processed.
+ * \a firstDocumentIndex is the position in the input of the first document in the batch.
+ * \a savedIds are the ids of the contacts that were saved.  \a importErrors maps the position
+ * of each document in the batch that could not be converted to the reason.  \a saveErrors maps
+ * the position of each converted contact that could not be saved to the reason.
+ */
+
+/*! Constructs a new pipeline with the given \a parent. */
+QVersitContactImportPipeline::QVersitContactImportPipeline(QObject* parent)
+    : QObject(parent), d(new QVersitContactImportPipelinePrivate)
+{
+    d->init(this);
+}
+
+/*!
+ * Frees the memory used by the pipeline.  An import in progress is canceled and waited for.
+ */
+QVersitContactImportPipeline::~QVersitContactImportPipeline()
+{
+    cancel();
+    d->mSaver.wait();
+    d->mConverter.wait();
+    delete d;
+}
+
+/*!
+ * Sets the device to read the vCards from to \a device.  Does not take ownership of the device.
+ */
+void QVersitContactImportPipeline::setDevice(QIODevice* device)
+{
+    d->mReader.setDevice(device);
+}
+
+/*!
+ * Returns the device the vCards are read from.
+ */
+QIODevice* QVersitContactImportPipeline::device() const
+{
+    return d->mReader.device();
+}
+
+/*!
+ * Sets the URI of the manager the contacts are saved to to \a managerUri.
+ *
+ * \sa QContactManager::fromUri()
+ */
+void QVersitContactImportPipeline::setManagerUri(const QString& managerUri)
+{
+    d->mManagerUri = managerUri;
+}
+
+/*!
+ * Returns the URI of the manager the contacts are saved to.
+ */
+QString QVersitContactImportPipeline::managerUri() const
+{
+    return d->mManagerUri;
+}
+
+/*!
+ * Sets the \a profiles used to convert the documents to contacts.
+ *
+ * \sa QVersitContactImporter::QVersitContactImporter()
+ */
+void QVersitContactImportPipeline::setProfiles(const QStringList& profiles)
+{
+    d->mProfiles = profiles;
+}
+
+/*!
+ * Returns the profiles used to convert the documents to contacts.
+ */
+QStringList QVersitContactImportPipeline::profiles() const
+{
+    return d->mProfiles;
+}
+
+/*!
+ * Sets the number of documents converted and saved together to \a size.  The default is 100.
+ */
+void QVersitContactImportPipeline::setBatchSize(int size)
+{
+    d->mBatchSize = qMax(1, size);
+}
+
+/*!
+ * Returns the number of documents converted and saved together.
+ */
+int QVersitContactImportPipeline::batchSize() const
+{
+    return d->mBatchSize;
+}
+
+/*!
+ * Returns the state of the pipeline.
+ */
+QVersitContactImportPipeline::State QVersitContactImportPipeline::state() const
+{
+    return d->state();
+}
+
+/*!
+ * Returns the first error encountered by the most recent import.
+ */
+QVersitContactImportPipeline::Error QVersitContactImportPipeline::error() const
+{
+    return d->error();
+}
+
+/*!
+ * Returns the number of contacts saved so far by the most recent import.
+ */
+int QVersitContactImportPipeline::savedContactCount() const
+{
+    QMutexLocker locker(&d->mMutex);
+    return d->mSavedContactCount;
+}
+
+/*!
+ * Starts importing asynchronously.
+ * Returns false if the device has not been set or opened, or if there is another import already
+ * in progress.  Signal \l stateChanged() is emitted with parameter FinishedState when the import
+ * has finished.
+ *
+ * The device must be already open.  The client is responsible for closing it when finished.
+ */
+bool QVersitContactImportPipeline::start()
+{
+    if (d->state() == ActiveState || d->mConverter.isRunning() || d->mSaver.isRunning()) {
+        QMutexLocker locker(&d->mMutex);
+        d->mError = NotReadyError;
+        return false;
+    }
+
+    d->mMutex.lock();
+    d->mError = NoError;
+    d->mIsCanceling = false;
+    d->mIsConversionFinished = false;
+    d->mSavedContactCount = 0;
+    d->mBatches.clear();
+    d->mMutex.unlock();
+
+    d->mReader.setMaxBufferedResults(d->mBatchSize);
+    if (!d->mReader.startReading()) {
+        QMutexLocker locker(&d->mMutex);
+        d->mError = d->mReader.error() == QVersitReader::IOError ? IOError : NotReadyError;
+        return false;
+    }
+    d->setState(ActiveState);
+    d->mConverter.start();
+    d->mSaver.start();
+    return true;
+}
+
+/*!
+ * Attempts to asynchronously cancel the import.  Contacts that have already been saved are not
+ * removed.
+ */
+void QVersitContactImportPipeline::cancel()
+{
+    d->mReader.cancel();
+    QMutexLocker locker(&d->mMutex);
+    d->mIsCanceling = true;
+    d->mReaderProgressed.wakeAll();
+    d->mBatchQueued.wakeAll();
+    d->mBatchTaken.wakeAll();
+}
+
+/*!
+ * If the state is ActiveState, blocks until the import has finished or \a msec milliseconds
+ * has elapsed, returning true if it successfully finishes or is cancelled by the user.
+ * If \a msec is negative or zero, the function blocks until the import has finished, regardless
+ * of how long it takes.
+ * If the state is FinishedState, returns true immediately.
+ * Otherwise, returns false immediately.
+ */
+bool QVersitContactImportPipeline::waitForFinished(int msec)
+{
+    State state = d->state();
+    if (state != InactiveState) {
+        if (msec <= 0)
+            return d->mSaver.wait(ULONG_MAX);
+        else
+            return d->mSaver.wait(msec);
+    } else {
+        return false;
+    }
+}
+
+QT_END_NAMESPACE_VERSIT
+
+#include "moc_qversitcontactimportpipeline.cpp"
@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QVERSITCONTACTIMPORTPIPELINE_H
+#define QVERSITCONTACTIMPORTPIPELINE_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstringlist.h>
+
+#include <QtContacts/qcontactid.h>
+#include <QtContacts/qcontactmanager.h>
+
+#include <QtVersit/qversitcontactimporter.h>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+QTCONTACTS_USE_NAMESPACE
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+class QVersitContactImportPipelinePrivate;
+
+class Q_VERSIT_EXPORT QVersitContactImportPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    enum Error {
+        NoError = 0,
+        IOError,
+        NotReadyError,
+        ParseError,
+        ImportError,
+        SaveError
+    };
+
+    enum State {
+        InactiveState = 0,
+        ActiveState,
+        CanceledState,
+        FinishedState
+    };
+
+    explicit QVersitContactImportPipeline(QObject* parent = nullptr);
+    ~QVersitContactImportPipeline();
+
+    void setDevice(QIODevice* device);
+    QIODevice* device() const;
+
+    void setManagerUri(const QString& managerUri);
+    QString managerUri() const;
+
+    void setProfiles(const QStringList& profiles);
+    QStringList profiles() const;
+
+    void setBatchSize(int size);
+    int batchSize() const;
+
+    State state() const;
+    Error error() const;
+    int savedContactCount() const;
+
+public Q_SLOTS:
+    bool start();
+    void cancel();
+public:
+    Q_INVOKABLE bool waitForFinished(int msec = -1);
+
+Q_SIGNALS:
+    void stateChanged(QVersitContactImportPipeline::State state);
+    void batchFinished(int firstDocumentIndex,
+                       const QList<QContactId>& savedIds,
+                       const QMap<int, QVersitContactImporter::Error>& importErrors,
+                       const QMap<int, QContactManager::Error>& saveErrors);
+
+private: // data
+    QVersitContactImportPipelinePrivate* d;
+};
+
+QT_END_NAMESPACE_VERSIT
+
+Q_DECLARE_METATYPE(QTVERSIT_PREPEND_NAMESPACE(QVersitContactImportPipeline::State))
+
+#endif // QVERSITCONTACTIMPORTPIPELINE_H
@@ -0,0 +1,259 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qversitcontactimportpipeline_p.h"
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+// The number of converted batches that may wait for the saver.  Together with the reader's buffer
+// of one batch of documents, this bounds how much of the input is in memory at once.
+static const int MAX_QUEUED_BATCHES = 2;
+
+void QVersitContactImportPipelineStage::run()
+{
+    (mPipeline->*mFunction)();
+}
+
+/*! Construct a pipeline. */
+QVersitContactImportPipelinePrivate::QVersitContactImportPipelinePrivate()
+    : mConverter(this, &QVersitContactImportPipelinePrivate::convert),
+    mSaver(this, &QVersitContactImportPipelinePrivate::save),
+    mBatchSize(100),
+    mState(QVersitContactImportPipeline::InactiveState),
+    mError(QVersitContactImportPipeline::NoError),
+    mIsCanceling(false),
+    mIsConversionFinished(false),
+    mSavedContactCount(0),
+    mReaderProgress(0)
+{
+}
+
+void QVersitContactImportPipelinePrivate::init(QVersitContactImportPipeline* pipeline)
+{
+    qRegisterMetaType<QVersitContactImportPipeline::State>("QVersitContactImportPipeline::State");
+    connect(this, &QVersitContactImportPipelinePrivate::stateChanged,
+            pipeline, &QVersitContactImportPipeline::stateChanged, Qt::DirectConnection);
+    connect(this, &QVersitContactImportPipelinePrivate::batchFinished,
+            pipeline, &QVersitContactImportPipeline::batchFinished, Qt::DirectConnection);
+
+    // The converter sleeps until the reader has something for it
+    connect(&mReader, &QVersitReader::resultsAvailable,
+            this, &QVersitContactImportPipelinePrivate::readerProgressed, Qt::DirectConnection);
+    connect(&mReader, &QVersitReader::stateChanged,
+            this, &QVersitContactImportPipelinePrivate::readerProgressed, Qt::DirectConnection);
+}
+
+void QVersitContactImportPipelinePrivate::readerProgressed()
+{
+    QMutexLocker locker(&mMutex);
+    mReaderProgress++;
+    mReaderProgressed.wakeAll();
+}
+
+/*!
+ * \internal
+ * The second stage of the pipeline.  Takes documents from the reader as they are parsed, converts
+ * them to contacts a batch at a time and queues the batches for save().
+ */
+void QVersitContactImportPipelinePrivate::convert()
+{
+    QVersitContactImporter importer(mProfiles);
+    QList<QVersitDocument> documents;
+    int firstDocumentIndex = 0;
+    bool canceled = false;
+
+    while (!canceled) {
+        mMutex.lock();
+        const int progress = mReaderProgress;
+        canceled = mIsCanceling;
+        mMutex.unlock();
+        if (canceled)
+            break;
+
+        // Check the state first so that the documents read just before the reader finished are
+        // picked up by takeResults()
+        const bool readerFinished = mReader.state() != QVersitReader::ActiveState;
+        documents += mReader.takeResults();
+
+        while (documents.size() >= mBatchSize || (readerFinished && !documents.isEmpty())) {
+            const QList<QVersitDocument> batchDocuments = documents.mid(0, mBatchSize);
+            documents.erase(documents.begin(), documents.begin() + batchDocuments.size());
+
+            QVersitContactImportBatch batch;
+            batch.firstDocumentIndex = firstDocumentIndex;
+            importer.importDocuments(batchDocuments);
+            batch.contacts = importer.contacts();
+            batch.importErrors = importer.errorMap();
+            firstDocumentIndex += batchDocuments.size();
+            if (!enqueueBatch(batch)) {
+                canceled = true;
+                break;
+            }
+        }
+        if (readerFinished)
+            break;
+
+        mMutex.lock();
+        while (mReaderProgress == progress && !mIsCanceling)
+            mReaderProgressed.wait(&mMutex);
+        mMutex.unlock();
+    }
+
+    QMutexLocker locker(&mMutex);
+    mIsConversionFinished = true;
+    mBatchQueued.wakeAll();
+}
+
+/*!
+ * \internal
+ * Adds \a batch to the queue for save(), waiting while the queue is full.  Returns false if the
+ * pipeline was canceled in the meantime.
+ */
+bool QVersitContactImportPipelinePrivate::enqueueBatch(const QVersitContactImportBatch& batch)
+{
+    QMutexLocker locker(&mMutex);
+    while (mBatches.size() >= MAX_QUEUED_BATCHES && !mIsCanceling)
+        mBatchTaken.wait(&mMutex);
+    if (mIsCanceling)
+        return false;
+    mBatches.enqueue(batch);
+    mBatchQueued.wakeAll();
+    return true;
+}
+
+/*!
+ * \internal
+ * The last stage of the pipeline.  Saves each batch queued by convert() and reports it with
+ * batchFinished().  The manager is created on this thread so that it is only ever used from here.
+ * When everything has been saved, this sets the final state of the pipeline.
+ */
+void QVersitContactImportPipelinePrivate::save()
+{
+    QContactManager* manager = QContactManager::fromUri(mManagerUri);
+
+    while (true) {
+        mMutex.lock();
+        while (mBatches.isEmpty() && !mIsConversionFinished && !mIsCanceling)
+            mBatchQueued.wait(&mMutex);
+        if (mIsCanceling || mBatches.isEmpty()) {
+            mMutex.unlock();
+            break;
+        }
+        QVersitContactImportBatch batch = mBatches.dequeue();
+        mBatchTaken.wakeAll();
+        mMutex.unlock();
+
+        if (!batch.importErrors.isEmpty())
+            setError(QVersitContactImportPipeline::ImportError);
+
+        QList<QContactId> savedIds;
+        QMap<int, QContactManager::Error> saveErrors;
+        if (!batch.contacts.isEmpty()) {
+            if (!manager->saveContacts(&batch.contacts, &saveErrors)) {
+                setError(QVersitContactImportPipeline::SaveError);
+                // Some engines fail a whole batch without saying which contacts were at fault
+                if (saveErrors.isEmpty()) {
+                    for (int i = 0; i < batch.contacts.size(); i++)
+                        saveErrors.insert(i, manager->error());
+                }
+            }
+            for (int i = 0; i < batch.contacts.size(); i++) {
+                if (!saveErrors.contains(i))
+                    savedIds.append(batch.contacts.at(i).id());
+            }
+        }
+
+        mMutex.lock();
+        mSavedContactCount += savedIds.size();
+        mMutex.unlock();
+        emit batchFinished(batch.firstDocumentIndex, savedIds, batch.importErrors, saveErrors);
+    }
+    delete manager;
+
+    mConverter.wait();
+    mReader.waitForFinished();
+    if (mReader.error() == QVersitReader::ParseError)
+        setError(QVersitContactImportPipeline::ParseError);
+    if (isCanceling())
+        setState(QVersitContactImportPipeline::CanceledState);
+    else
+        setState(QVersitContactImportPipeline::FinishedState);
+}
+
+void QVersitContactImportPipelinePrivate::setState(QVersitContactImportPipeline::State state)
+{
+    mMutex.lock();
+    mState = state;
+    mMutex.unlock();
+    emit stateChanged(state);
+}
+
+QVersitContactImportPipeline::State QVersitContactImportPipelinePrivate::state() const
+{
+    QMutexLocker locker(&mMutex);
+    return mState;
+}
+
+/*!
+ * \internal
+ * Records \a error unless an earlier error has already been recorded for this run.
+ */
+void QVersitContactImportPipelinePrivate::setError(QVersitContactImportPipeline::Error error)
+{
+    QMutexLocker locker(&mMutex);
+    if (mError == QVersitContactImportPipeline::NoError)
+        mError = error;
+}
+
+QVersitContactImportPipeline::Error QVersitContactImportPipelinePrivate::error() const
+{
+    QMutexLocker locker(&mMutex);
+    return mError;
+}
+
+bool QVersitContactImportPipelinePrivate::isCanceling() const
+{
+    QMutexLocker locker(&mMutex);
+    return mIsCanceling;
+}
+
+QT_END_NAMESPACE_VERSIT
+
+#include "moc_qversitcontactimportpipeline_p.cpp"
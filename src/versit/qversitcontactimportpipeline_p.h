@@ -0,0 +1,156 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QVERSITCONTACTIMPORTPIPELINE_P_H
+#define QVERSITCONTACTIMPORTPIPELINE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <QtContacts/qcontact.h>
+
+#include <QtVersit/qversitcontactimportpipeline.h>
+#include <QtVersit/qversitreader.h>
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+class QVersitContactImportPipelinePrivate;
+
+/*
+ * Runs one stage of the pipeline on its own thread.
+ */
+class QVersitContactImportPipelineStage : public QThread
+{
+public:
+    typedef void (QVersitContactImportPipelinePrivate::*Function)();
+
+    QVersitContactImportPipelineStage(QVersitContactImportPipelinePrivate* pipeline,
+                                      Function function)
+        : mPipeline(pipeline), mFunction(function) {}
+
+protected: // From QThread
+    void run() override;
+
+private:
+    QVersitContactImportPipelinePrivate* mPipeline;
+    Function mFunction;
+};
+
+/*
+ * A batch of contacts converted from consecutive documents, waiting to be saved.
+ */
+struct QVersitContactImportBatch
+{
+    int firstDocumentIndex;
+    QList<QContact> contacts;
+    QMap<int, QVersitContactImporter::Error> importErrors;
+};
+
+class QVersitContactImportPipelinePrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    QVersitContactImportPipelinePrivate();
+    void init(QVersitContactImportPipeline* pipeline);
+
+    void convert();
+    void save();
+
+    // mutexed getters and setters.
+    void setState(QVersitContactImportPipeline::State state);
+    QVersitContactImportPipeline::State state() const;
+    void setError(QVersitContactImportPipeline::Error error);
+    QVersitContactImportPipeline::Error error() const;
+    bool isCanceling() const;
+
+signals:
+    void stateChanged(QVersitContactImportPipeline::State state);
+    void batchFinished(int firstDocumentIndex,
+                       const QList<QContactId>& savedIds,
+                       const QMap<int, QVersitContactImporter::Error>& importErrors,
+                       const QMap<int, QContactManager::Error>& saveErrors);
+
+private slots:
+    void readerProgressed();
+
+private:
+    bool enqueueBatch(const QVersitContactImportBatch& batch);
+
+// Data
+public:
+    QVersitReader mReader;
+    QVersitContactImportPipelineStage mConverter;
+    QVersitContactImportPipelineStage mSaver;
+    QString mManagerUri;
+    QStringList mProfiles;
+    int mBatchSize;
+
+    QVersitContactImportPipeline::State mState;
+    QVersitContactImportPipeline::Error mError;
+    bool mIsCanceling;
+    bool mIsConversionFinished;
+    int mSavedContactCount;
+    // Bumped whenever the reader has more documents or has stopped, so the converter can't miss it
+    int mReaderProgress;
+    QQueue<QVersitContactImportBatch> mBatches; // Converted but not yet saved
+    mutable QMutex mMutex;
+    QWaitCondition mReaderProgressed;
+    QWaitCondition mBatchQueued;
+    QWaitCondition mBatchTaken;
+};
+
+QT_END_NAMESPACE_VERSIT
+
+#endif // QVERSITCONTACTIMPORTPIPELINE_P_H
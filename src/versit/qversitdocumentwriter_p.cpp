@@ -42,6 +42,8 @@
 #include <QtCore/qiodevice.h>
 #include <QtCore/qbytearray.h>
 
+#include <string.h>
+
 #include <QTextCodec>
 
 #include "qversitutils_p.h"
@@ -50,6 +52,74 @@ QT_BEGIN_NAMESPACE_VERSIT
 
 #define MAX_LINE_LENGTH 76
 
+/*!
+ * \internal
+ * Encodes the UTF-16 text from \a begin to \a end as UTF-8 into \a dst, which must have room for
+ * three bytes per code unit, and returns the end of the output.  Runs of ASCII are copied four
+ * code units at a time.  An unpaired surrogate is written as U+FFFD, as QTextCodec does.
+ */
+static char* encodeUtf8(const QChar* begin, const QChar* end, char* dst)
+{
+    const QChar* src = begin;
+    while (src < end) {
+        // Fast path: four ASCII code units at once
+        while (end - src >= 4) {
+            quint64 units;
+            memcpy(&units, src, sizeof(units));
+            if (units & Q_UINT64_C(0xff80ff80ff80ff80))
+                break;
+            dst[0] = char(src[0].unicode());
+            dst[1] = char(src[1].unicode());
+            dst[2] = char(src[2].unicode());
+            dst[3] = char(src[3].unicode());
+            src += 4;
+            dst += 4;
+        }
+        if (src == end)
+            break;
+
+        uint u = src->unicode();
+        src++;
+        if (u < 0x80) {
+            *dst++ = char(u);
+        } else if (u < 0x800) {
+            *dst++ = char(0xc0 | (u >> 6));
+            *dst++ = char(0x80 | (u & 0x3f));
+        } else {
+            if (QChar::isSurrogate(u)) {
+                if (QChar::isHighSurrogate(u) && src < end && src->isLowSurrogate()) {
+                    u = QChar::surrogateToUcs4(ushort(u), src->unicode());
+                    src++;
+                    // Four bytes for a pair of code units, so the output still fits
+                    *dst++ = char(0xf0 | (u >> 18));
+                    *dst++ = char(0x80 | ((u >> 12) & 0x3f));
+                    *dst++ = char(0x80 | ((u >> 6) & 0x3f));
+                    *dst++ = char(0x80 | (u & 0x3f));
+                    continue;
+                }
+                u = QChar::ReplacementCharacter;
+            }
+            *dst++ = char(0xe0 | (u >> 12));
+            *dst++ = char(0x80 | ((u >> 6) & 0x3f));
+            *dst++ = char(0x80 | (u & 0x3f));
+        }
+    }
+    return dst;
+}
+
+/*!
+ * \internal
+ * Returns where a line holding the text from \a begin up to (but not including) \a end should be
+ * cut, moving the cut back by one if it would separate the two halves of a surrogate pair.
+ */
+static inline int foldPoint(const QString& value, int begin, int end)
+{
+    if (end > begin && end < value.length()
+            && value.at(end - 1).isHighSurrogate() && value.at(end).isLowSurrogate())
+        return end - 1;
+    return end;
+}
+
 /*!
   \class QVersitDocumentWriter
   \internal
@@ -68,6 +138,8 @@ QVersitDocumentWriter::QVersitDocumentWriter(QVersitDocument::VersitType type)
     mDevice(0),
     mCodec(0),
     mCodecIsAscii(false),
+    mCodecIsAsciiCompatible(true),
+    mCodecIsUtf8(false),
     mEncoder(0),
     mSuccessful(true),
     mCurrentLineLength(0)
@@ -102,6 +174,8 @@ void QVersitDocumentWriter::setCodec(QTextCodec *codec)
     // the same as in ASCII.  For ASCII compatible codecs, we can do some optimizations.
     mCodecIsAsciiCompatible = !(mCodec->name().startsWith("UTF-16")
                              || mCodec->name().startsWith("UTF-32"));
+    // UTF-8 is what almost every export uses, so it is encoded directly rather than by mEncoder
+    mCodecIsUtf8 = mCodec->name() == "UTF-8";
 }
 
 /*!
@@ -224,6 +298,11 @@ void QVersitDocumentWriter::writeBytes(const QByteArray &value)
   */
 void QVersitDocumentWriter::writeString(const QString &value)
 {
+    if (mCodecIsUtf8) {
+        writeStringUtf8(value);
+        return;
+    }
+
     int spaceRemaining = MAX_LINE_LENGTH - mCurrentLineLength;
     int charsWritten = 0;
     QString crlfSpace(QStringLiteral("\r\n "));
@@ -253,6 +332,11 @@ void QVersitDocumentWriter::writeString(const QString &value)
   */
 void QVersitDocumentWriter::writeStringQp(const QString &value)
 {
+    if (mCodecIsUtf8) {
+        writeStringQpUtf8(value);
+        return;
+    }
+
     int spaceRemaining = MAX_LINE_LENGTH - mCurrentLineLength - 1;
                                              // minus 1 for the equals required at the end
     int charsWritten = 0;
@@ -279,6 +363,85 @@ void QVersitDocumentWriter::writeStringQp(const QString &value)
     mCurrentLineLength += value.length() - charsWritten;
 }
 
+/*!
+ * \internal
+ * The UTF-8 version of writeString().  The whole of \a value, including any folds, is encoded into
+ * a single buffer that is big enough from the start and written to the device in one go.  Lines
+ * are folded after the same number of characters as writeString(), except that a surrogate pair
+ * is never split.
+ */
+void QVersitDocumentWriter::writeStringUtf8(const QString& value)
+{
+    const int length = value.length();
+    // Every line after the first holds at least MAX_LINE_LENGTH - 2 characters
+    const int maxFolds = length / (MAX_LINE_LENGTH - 2) + 2;
+    QByteArray encoded;
+    encoded.resize(3 * length + 3 * maxFolds);
+    char* const begin = encoded.data();
+    char* dst = begin;
+    const QChar* src = value.constData();
+
+    int spaceRemaining = MAX_LINE_LENGTH - mCurrentLineLength;
+    int charsWritten = 0;
+    while (spaceRemaining < length - charsWritten) {
+        const int lineEnd = foldPoint(value, charsWritten, charsWritten + spaceRemaining);
+        dst = encodeUtf8(src + charsWritten, src + lineEnd, dst);
+        *dst++ = '\r';
+        *dst++ = '\n';
+        *dst++ = ' ';
+        charsWritten = lineEnd;
+        spaceRemaining = MAX_LINE_LENGTH - 1; // minus 1 for the space at the front.
+        mCurrentLineLength = 1;
+    }
+    dst = encodeUtf8(src + charsWritten, src + length, dst);
+    mCurrentLineLength += length - charsWritten;
+
+    if (mDevice->write(begin, dst - begin) < 0)
+        mSuccessful = false;
+}
+
+/*!
+ * \internal
+ * The UTF-8 version of writeStringQp(), which encodes \a value into a single buffer the same way
+ * writeStringUtf8() does.
+ */
+void QVersitDocumentWriter::writeStringQpUtf8(const QString& value)
+{
+    const int length = value.length();
+    // Every line after the first holds at least MAX_LINE_LENGTH - 4 characters
+    const int maxFolds = length / (MAX_LINE_LENGTH - 4) + 2;
+    QByteArray encoded;
+    encoded.resize(3 * length + 3 * maxFolds);
+    char* const begin = encoded.data();
+    char* dst = begin;
+    const QChar* src = value.constData();
+
+    int spaceRemaining = MAX_LINE_LENGTH - mCurrentLineLength - 1;
+                                             // minus 1 for the equals required at the end
+    int charsWritten = 0;
+    while (spaceRemaining < length - charsWritten) {
+        // Don't split an =XX escape sequence
+        if (value.at(charsWritten + spaceRemaining - 2) == QLatin1Char('=')) {
+            spaceRemaining -= 2;
+        } else if (value.at(charsWritten + spaceRemaining - 1) == QLatin1Char('=')) {
+            spaceRemaining -= 1;
+        }
+        const int lineEnd = foldPoint(value, charsWritten, charsWritten + spaceRemaining);
+        dst = encodeUtf8(src + charsWritten, src + lineEnd, dst);
+        *dst++ = '=';
+        *dst++ = '\r';
+        *dst++ = '\n';
+        charsWritten = lineEnd;
+        spaceRemaining = MAX_LINE_LENGTH - 1; // minus 1 for the equals required at the end
+        mCurrentLineLength = 0;
+    }
+    dst = encodeUtf8(src + charsWritten, src + length, dst);
+    mCurrentLineLength += length - charsWritten;
+
+    if (mDevice->write(begin, dst - begin) < 0)
+        mSuccessful = false;
+}
+
 /*!
   Writes a CRLF to the device.  By using this function, rather than writeString("\\r\\n"), you will
   allow the writer to know where a line starts, for folding purposes.
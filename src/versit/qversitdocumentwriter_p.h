@@ -85,12 +85,17 @@ public:
     void writeStringQp(const QString& value);
     void writeCrlf();
 
+private:
+    void writeStringUtf8(const QString& value);
+    void writeStringQpUtf8(const QString& value);
+
 protected:
     QVersitDocument::VersitType mType;
     QIODevice* mDevice;
     QTextCodec* mCodec;
     bool mCodecIsAscii;
     bool mCodecIsAsciiCompatible;
+    bool mCodecIsUtf8;
     QTextEncoder* mEncoder;
     bool mSuccessful;
     int mCurrentLineLength;
@@ -0,0 +1,496 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtVersit module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qversitencoding_p.h"
+
+#include <QtCore/qstring.h>
+
+#include <string.h>
+
+#if defined(Q_PROCESSOR_X86) && defined(Q_CC_GNU)
+#  include <immintrin.h>
+#  define VERSIT_HAVE_SSSE3
+#  define VERSIT_FUNCTION_TARGET_SSSE3 __attribute__((target("ssse3")))
+#  define VERSIT_FUNCTION_TARGET_SSE2 __attribute__((target("sse2")))
+#endif
+
+QT_BEGIN_NAMESPACE_VERSIT
+
+/*!
+  \class VersitEncoding
+  \internal
+  \brief The VersitEncoding class holds the base64 and quoted-printable codecs used for versit
+  property values.
+
+  PHOTO, LOGO and SOUND values make up most of the bytes of a typical vCard, so these are written
+  to work on blocks of 16 bytes with SSSE3 where the CPU supports it, which is checked at run time.
+  The quoted-printable codecs use the same check to scan for the characters they have to handle
+  16 bytes, or 8 UTF-16 code units, at a time.  Everywhere else, and for the ends of the input, a
+  scalar version is used.  Both produce exactly the same output as the functions they replace.
+ */
+
+bool VersitEncoding::m_simdEnabled = true;
+
+static const char base64Alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Maps each byte to its base64 value, or -1 if it isn't in the alphabet
+static const signed char base64Values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/*!
+ * \internal
+ * Encodes the \a length bytes at \a src as base64 into \a dst, which must have room for the
+ * output, and returns the end of the output.  Only whole groups of three
+ * bytes are encoded; the number of bytes consumed is returned in \a consumed.
+ */
+static char* encodeBase64Scalar(const uchar* src, qsizetype length, char* dst, qsizetype* consumed)
+{
+    qsizetype i = 0;
+    for (; i + 3 <= length; i += 3) {
+        const uint triple = (uint(src[i]) << 16) | (uint(src[i + 1]) << 8) | src[i + 2];
+        *dst++ = base64Alphabet[(triple >> 18) & 0x3f];
+        *dst++ = base64Alphabet[(triple >> 12) & 0x3f];
+        *dst++ = base64Alphabet[(triple >> 6) & 0x3f];
+        *dst++ = base64Alphabet[triple & 0x3f];
+    }
+    *consumed = i;
+    return dst;
+}
+
+typedef bool (*Base64DecodeBlock)(const uchar* src, uchar* dst);
+
+/*!
+ * \internal
+ * Decodes base64 text the way QByteArray::fromBase64() does: characters outside the alphabet
+ * (including padding and line breaks) are skipped and incomplete trailing bits are dropped.
+ * \a dst must have room for three bytes per four input characters.  \a simdBlock, if not null,
+ * is offered each aligned run of 16 input characters; it returns false if it can't decode it.
+ */
+static uchar* decodeBase64(const uchar* src, qsizetype length, uchar* dst,
+                           Base64DecodeBlock simdBlock)
+{
+    uint buffer = 0;
+    int bits = 0;
+    qsizetype i = 0;
+    while (i < length) {
+        // Between groups, try to decode 16 characters (12 bytes) in one go
+        if (bits == 0 && simdBlock && length - i >= 16 && simdBlock(src + i, dst)) {
+            i += 16;
+            dst += 12;
+            continue;
+        }
+        const int value = base64Values[src[i++]];
+        if (value < 0)
+            continue;
+        buffer = (buffer << 6) | uint(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *dst++ = uchar(buffer >> bits);
+            buffer &= (1u << bits) - 1;
+        }
+    }
+    return dst;
+}
+
+#if defined(VERSIT_HAVE_SSSE3)
+/*!
+ * \internal
+ * Encodes 12 bytes at \a src (16 must be readable) to 16 characters at \a dst.
+ */
+VERSIT_FUNCTION_TARGET_SSSE3
+static void encodeBase64BlockSsse3(const uchar* src, char* dst)
+{
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    // Spread each group of three bytes over a 32-bit lane: [b1 b0 b2 b1]
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    // Move each 6-bit index to its own byte
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // Map the indices to the alphabet by adding an offset chosen by range:
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+    const __m128i out = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), out);
+}
+
+/*!
+ * \internal
+ * Decodes 16 characters at \a src to 12 bytes at \a dst.  Returns false, without writing
+ * anything, if any of the characters isn't in the alphabet.
+ */
+VERSIT_FUNCTION_TARGET_SSSE3
+static bool decodeBase64BlockSsse3(const uchar* src, uchar* dst)
+{
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    // Bytes of 0x80 and above compare as negative, so they fall outside every range
+    const __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+                                          _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+    const __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+                                          _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+    const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                                          _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+    const __m128i isPlus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+    const __m128i isSlash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(_mm_or_si128(isUpper, isLower),
+                                       _mm_or_si128(isDigit, _mm_or_si128(isPlus, isSlash)));
+    if (_mm_movemask_epi8(valid) != 0xffff)
+        return false;
+
+    __m128i values = _mm_and_si128(isUpper, _mm_sub_epi8(in, _mm_set1_epi8('A')));
+    values = _mm_or_si128(values, _mm_and_si128(isLower, _mm_sub_epi8(in, _mm_set1_epi8('a' - 26))));
+    values = _mm_or_si128(values, _mm_and_si128(isDigit, _mm_add_epi8(in, _mm_set1_epi8(52 - '0'))));
+    values = _mm_or_si128(values, _mm_and_si128(isPlus, _mm_set1_epi8(62)));
+    values = _mm_or_si128(values, _mm_and_si128(isSlash, _mm_set1_epi8(63)));
+
+    // Join each four 6-bit values into 24 bits, then pick out the three bytes of each lane
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i out = _mm_shuffle_epi8(
+                lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    uchar block[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(block), out);
+    memcpy(dst, block, 12);
+    return true;
+}
+#endif
+
+static bool isHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int hexValue(char c)
+{
+    if (c <= '9')
+        return c - '0';
+    return (c | 0x20) - 'a' + 10;
+}
+
+typedef const char* (*FindEquals)(const char* src, const char* end);
+
+/*!
+ * \internal
+ * Returns the position of the first '=' in \a src up to \a end, or \a end if there is none.
+ */
+static const char* findEqualsScalar(const char* src, const char* end)
+{
+    const void* found = memchr(src, '=', end - src);
+    return found ? static_cast<const char*>(found) : end;
+}
+
+#if defined(VERSIT_HAVE_SSSE3)
+VERSIT_FUNCTION_TARGET_SSE2
+static const char* findEqualsSse2(const char* src, const char* end)
+{
+    const __m128i equals = _mm_set1_epi8('=');
+    for (; end - src >= 16; src += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, equals));
+        if (mask)
+            return src + __builtin_ctz(mask);
+    }
+    return findEqualsScalar(src, end);
+}
+#endif
+
+/*!
+ * \internal
+ * Decodes the quoted-printable text from \a src to \a end into \a dst, which may be the same as
+ * \a src, and returns the end of the output.  \a findEquals finds the next escape.
+ */
+static char* decodeQuotedPrintableBytes(const char* src, const char* end, char* dst,
+                                        FindEquals findEquals)
+{
+    while (src < end) {
+        const char* equals = findEquals(src, end);
+        if (dst != src)
+            memmove(dst, src, equals - src);
+        dst += equals - src;
+        src = equals;
+        if (src == end)
+            break;
+
+        if (end - src > 2) {
+            if (isHexDigit(src[1]) && isHexDigit(src[2])) {
+                *dst++ = char((hexValue(src[1]) << 4) | hexValue(src[2]));
+                src += 3;
+                continue;
+            } else if (src[1] == '\r' && src[2] == '\n') {
+                // Newlines can still be found here if they are encoded in a non-default charset.
+                src += 3;
+                continue;
+            }
+        }
+        *dst++ = *src++;
+    }
+    return dst;
+}
+
+/*!
+ * \internal
+ * Returns true if \a c has to be escaped in quoted-printable text (RFC 1521), as
+ * QVCard21Writer::shouldBeQuotedPrintableEncoded() decides.  Characters above U+00FF are left
+ * alone; they are only written to devices whose codec can represent them.
+ */
+static inline bool needsQuotedPrintableEscape(ushort c)
+{
+    return c < 32
+            || c == '!' || c == '"' || c == '#' || c == '$'
+            || c == '=' || c == '@' || c == '[' || c == '\\'
+            || c == ']' || c == '^' || c == '`'
+            || (c > 122 && c < 256);
+}
+
+typedef const QChar* (*FindQuotedPrintableEscape)(const QChar* src, const QChar* end);
+
+/*!
+ * \internal
+ * Returns the position of the first character from \a src up to \a end that has to be escaped,
+ * or \a end if there is none.
+ */
+static const QChar* findQuotedPrintableEscapeScalar(const QChar* src, const QChar* end)
+{
+    for (; src < end; ++src) {
+        if (needsQuotedPrintableEscape(src->unicode()))
+            break;
+    }
+    return src;
+}
+
+#if defined(VERSIT_HAVE_SSSE3)
+VERSIT_FUNCTION_TARGET_SSE2
+static const QChar* findQuotedPrintableEscapeSse2(const QChar* src, const QChar* end)
+{
+    // Each test is an unsigned "c - low <= high - low", done as a saturating subtraction
+    const __m128i zero = _mm_setzero_si128();
+    for (; end - src >= 8; src += 8) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i control = _mm_cmpeq_epi16(_mm_subs_epu16(c, _mm_set1_epi16(31)), zero);
+        const __m128i punctuation = _mm_cmpeq_epi16(
+                    _mm_subs_epu16(_mm_sub_epi16(c, _mm_set1_epi16('!')), _mm_set1_epi16(3)), zero);
+        const __m128i brackets = _mm_cmpeq_epi16(
+                    _mm_subs_epu16(_mm_sub_epi16(c, _mm_set1_epi16('[')), _mm_set1_epi16(3)), zero);
+        const __m128i latin1 = _mm_cmpeq_epi16(
+                    _mm_subs_epu16(_mm_sub_epi16(c, _mm_set1_epi16(123)), _mm_set1_epi16(255 - 123)), zero);
+        const __m128i singles = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi16(c, _mm_set1_epi16('=')),
+                                 _mm_cmpeq_epi16(c, _mm_set1_epi16('@'))),
+                    _mm_cmpeq_epi16(c, _mm_set1_epi16('`')));
+        const __m128i escape = _mm_or_si128(_mm_or_si128(control, punctuation),
+                                            _mm_or_si128(_mm_or_si128(brackets, latin1), singles));
+        const int mask = _mm_movemask_epi8(escape);
+        if (mask)
+            return src + __builtin_ctz(mask) / 2;
+    }
+    return findQuotedPrintableEscapeScalar(src, end);
+}
+#endif
+
+#if defined(VERSIT_HAVE_SSSE3)
+static bool cpuHasSsse3()
+{
+    static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+    return hasSsse3;
+}
+#endif
+
+/*!
+ * Returns true if the vectorized codecs are used.  This is the case if the CPU supports them and
+ * they haven't been turned off with setSimdEnabled().
+ */
+bool VersitEncoding::isSimdEnabled()
+{
+#if defined(VERSIT_HAVE_SSSE3)
+    return m_simdEnabled && cpuHasSsse3();
+#else
+    return false;
+#endif
+}
+
+/*!
+ * Turns the vectorized codecs on or off according to \a enabled, so that the scalar versions can
+ * be tested and compared against.  This must not be called while anything is being encoded or
+ * decoded.
+ */
+void VersitEncoding::setSimdEnabled(bool enabled)
+{
+    m_simdEnabled = enabled;
+}
+
+/*!
+ * Returns \a data encoded as base64 with padding, as QByteArray::toBase64() does.
+ */
+QByteArray VersitEncoding::toBase64(const QByteArray& data)
+{
+    const qsizetype length = data.size();
+    QByteArray text;
+    text.resize((length + 2) / 3 * 4);
+    const uchar* src = reinterpret_cast<const uchar*>(data.constData());
+    char* dst = text.data();
+    qsizetype i = 0;
+#if defined(VERSIT_HAVE_SSSE3)
+    if (isSimdEnabled()) {
+        // Each block consumes 12 bytes but loads 16
+        for (; length - i >= 16; i += 12, dst += 16)
+            encodeBase64BlockSsse3(src + i, dst);
+    }
+#endif
+    qsizetype consumed;
+    dst = encodeBase64Scalar(src + i, length - i, dst, &consumed);
+    i += consumed;
+
+    if (length - i == 1) {
+        const uint triple = uint(src[i]) << 16;
+        *dst++ = base64Alphabet[(triple >> 18) & 0x3f];
+        *dst++ = base64Alphabet[(triple >> 12) & 0x3f];
+        *dst++ = '=';
+        *dst++ = '=';
+    } else if (length - i == 2) {
+        const uint triple = (uint(src[i]) << 16) | (uint(src[i + 1]) << 8);
+        *dst++ = base64Alphabet[(triple >> 18) & 0x3f];
+        *dst++ = base64Alphabet[(triple >> 12) & 0x3f];
+        *dst++ = base64Alphabet[(triple >> 6) & 0x3f];
+        *dst++ = '=';
+    }
+    return text;
+}
+
+/*!
+ * Returns the bytes encoded as base64 in \a text, as QByteArray::fromBase64() does.  Characters
+ * that aren't part of the base64 alphabet, such as padding and whitespace, are ignored.
+ */
+QByteArray VersitEncoding::fromBase64(const QByteArray& text)
+{
+    QByteArray data;
+    data.resize(text.size() * 3 / 4 + 1);
+    Base64DecodeBlock simdBlock = 0;
+#if defined(VERSIT_HAVE_SSSE3)
+    if (isSimdEnabled())
+        simdBlock = decodeBase64BlockSsse3;
+#endif
+    uchar* begin = reinterpret_cast<uchar*>(data.data());
+    uchar* end = decodeBase64(reinterpret_cast<const uchar*>(text.constData()), text.size(),
+                              begin, simdBlock);
+    data.truncate(end - begin);
+    return data;
+}
+
+/*!
+ * Decodes the quoted-printable (RFC 1521) escapes and soft line breaks in \a text, in place.
+ */
+void VersitEncoding::decodeQuotedPrintable(QByteArray* text)
+{
+    if (text->isEmpty())
+        return;
+    char* begin = text->data();
+    FindEquals findEquals = findEqualsScalar;
+#if defined(VERSIT_HAVE_SSSE3)
+    if (isSimdEnabled())
+        findEquals = findEqualsSse2;
+#endif
+    char* end = decodeQuotedPrintableBytes(begin, begin + text->size(), begin, findEquals);
+    text->truncate(end - begin);
+}
+
+/*!
+ * Escapes the characters of \a text that quoted-printable (RFC 1521) requires to be escaped, in
+ * place, as "=XX".  Returns true if anything was escaped.
+ */
+bool VersitEncoding::encodeQuotedPrintable(QString* text)
+{
+    FindQuotedPrintableEscape findEscape = findQuotedPrintableEscapeScalar;
+#if defined(VERSIT_HAVE_SSSE3)
+    if (isSimdEnabled())
+        findEscape = findQuotedPrintableEscapeSse2;
+#endif
+
+    const QChar* const begin = text->constData();
+    const QChar* const end = begin + text->length();
+    const QChar* src = findEscape(begin, end);
+    // Most values have nothing to escape, so don't copy them
+    if (src == end)
+        return false;
+
+    static const char hexDigits[] = "0123456789ABCDEF";
+    QString encoded;
+    encoded.reserve(text->length() + 2 * (end - src) + 2);
+    encoded.append(begin, src - begin);
+    while (src < end) {
+        const ushort c = src->unicode();
+        const QChar escape[3] = { QLatin1Char('='), QLatin1Char(hexDigits[c >> 4]),
+                                  QLatin1Char(hexDigits[c & 0xf]) };
+        encoded.append(escape, 3);
+        ++src;
+        const QChar* next = findEscape(src, end);
+        encoded.append(src, next - src);
+        src = next;
+    }
+    *text = encoded;
+    return true;
+}
+
+QT_END_NAMESPACE_VERSIT
@@ -47,6 +47,8 @@
 
 #include <QTextCodec>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE_VERSIT
 
 /*!
@@ -136,9 +138,11 @@ bool QVersitProperty::operator==(const QVersitProperty& other) const
 {
     bool equal = d->mGroups == other.d->mGroups &&
             d->mName == other.d->mName &&
-            ((d->mParameters.isEmpty() && other.d->mParameters.isEmpty()) // QTBUG-87575
-                || (d->mParameters == other.d->mParameters)) &&
-            d->mValueType == other.d->mValueType;
+            d->mValueType == other.d->mValueType &&
+            d->mParameters.size() == other.d->mParameters.size() &&
+            // The order in which parameters were inserted doesn't matter
+            std::is_permutation(d->mParameters.constBegin(), d->mParameters.constEnd(),
+                                other.d->mParameters.constBegin());
     if (!equal)
         return false;
 
@@ -163,15 +167,70 @@ size_t qHash(const QVersitProperty &key)
     foreach (const QString& group, key.groups()) {
         hash += QT_PREPEND_NAMESPACE(qHash)(group);
     }
-    QMultiHash<QString,QString>::const_iterator it = key.parameters().constBegin();
-    QMultiHash<QString,QString>::const_iterator end = key.parameters().constEnd();
-    while (it != end) {
-        hash += QT_PREPEND_NAMESPACE(qHash)(it.key()) + QT_PREPEND_NAMESPACE(qHash)(it.value());
-        ++it;
+    const QVersitPropertyPrivate* d = QVersitPropertyPrivate::get(key);
+    for (int i = 0; i < d->mParameters.size(); i++) {
+        hash += QT_PREPEND_NAMESPACE(qHash)(d->mParameters.at(i).mName)
+                + QT_PREPEND_NAMESPACE(qHash)(d->mParameters.at(i).mValue);
     }
     return hash;
 }
 
+/*!
+ * \internal
+ * Returns the values of the parameters called \a name, which must be upper-case, in the same
+ * order as QMultiHash::values() on parameters() would (ie. the most recently inserted first).
+ * Unlike parameters(), this doesn't build a hash.
+ */
+QStringList QVersitPropertyPrivate::parameterValues(const QString& name) const
+{
+    QStringList values;
+    for (int i = mParameters.size() - 1; i >= 0; i--) {
+        if (mParameters.at(i).mName == name)
+            values.append(mParameters.at(i).mValue);
+    }
+    return values;
+}
+
+/*!
+ * \internal
+ * Returns the most recently inserted value of the parameter called \a name, which must be
+ * upper-case, or a null string if there is none.
+ */
+QString QVersitPropertyPrivate::parameterValue(const QString& name) const
+{
+    for (int i = mParameters.size() - 1; i >= 0; i--) {
+        if (mParameters.at(i).mName == name)
+            return mParameters.at(i).mValue;
+    }
+    return QString();
+}
+
+/*!
+ * \internal
+ * Returns true if there is a parameter called \a name, which must be upper-case.
+ */
+bool QVersitPropertyPrivate::hasParameter(const QString& name) const
+{
+    for (int i = 0; i < mParameters.size(); i++) {
+        if (mParameters.at(i).mName == name)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * Returns true if there is a parameter called \a name, which must be upper-case, with \a value.
+ */
+bool QVersitPropertyPrivate::hasParameter(const QString& name, const QString& value) const
+{
+    for (int i = 0; i < mParameters.size(); i++) {
+        if (mParameters.at(i).mName == name && mParameters.at(i).mValue == value)
+            return true;
+    }
+    return false;
+}
+
 #ifndef QT_NO_DEBUG_STREAM
 QDebug operator<<(QDebug dbg, const QVersitProperty& property)
 {
@@ -221,7 +280,7 @@ QStringList QVersitProperty::groups() const
  */
 void QVersitProperty::setName(const QString& name)
 {
-    d->mName = name.toUpper();
+    d->mName = QVersitAtoms::intern(name.toUpper(), &d->mNameAtom);
 }
 
 /*!
@@ -258,7 +317,10 @@ void QVersitProperty::setParameters(const QMultiHash<QString,QString>& parameter
  */
 void QVersitProperty::insertParameter(const QString& name, const QString& value)
 {
-    d->mParameters.insert(name.toUpper(), value);
+    QVersitParameter parameter;
+    parameter.mName = QVersitAtoms::intern(name.toUpper());
+    parameter.mValue = QVersitAtoms::intern(value);
+    d->mParameters.append(parameter);
 }
 
 /*!
@@ -268,7 +330,12 @@ void QVersitProperty::insertParameter(const QString& name, const QString& value)
  */
 void QVersitProperty::removeParameter(const QString& name, const QString& value)
 {
-    d->mParameters.remove(name.toUpper(), value);
+    const QString upperName = name.toUpper();
+    for (int i = d->mParameters.size() - 1; i >= 0; i--) {
+        const QVersitParameter& parameter = d->mParameters.at(i);
+        if (parameter.mName == upperName && parameter.mValue == value)
+            d->mParameters.remove(i);
+    }
 }
 
 /*!
@@ -278,7 +345,11 @@ void QVersitProperty::removeParameter(const QString& name, const QString& value)
  */
 void QVersitProperty::removeParameters(const QString& name)
 {
-    d->mParameters.remove(name.toUpper());
+    const QString upperName = name.toUpper();
+    for (int i = d->mParameters.size() - 1; i >= 0; i--) {
+        if (d->mParameters.at(i).mName == upperName)
+            d->mParameters.remove(i);
+    }
 }
 
 /*!
@@ -287,7 +358,10 @@ void QVersitProperty::removeParameters(const QString& name)
  */
 QMultiHash<QString,QString> QVersitProperty::parameters() const
 {
-    return d->mParameters;
+    QMultiHash<QString,QString> parameters;
+    for (int i = 0; i < d->mParameters.size(); i++)
+        parameters.insert(d->mParameters.at(i).mName, d->mParameters.at(i).mValue);
+    return parameters;
 }
 
 /*!
@@ -321,9 +395,9 @@ QVariant QVersitProperty::variantValue() const
 QString QVersitProperty::value() const
 {
     if (d->mValue.metaType().id() == QMetaType::QByteArray) {
-        if (d->mParameters.contains(QStringLiteral("CHARSET"))) {
+        if (d->hasParameter(QStringLiteral("CHARSET"))) {
             QTextCodec* codec = QTextCodec::codecForName(
-                    d->mParameters.value(QStringLiteral("CHARSET")).toLatin1());
+                    d->parameterValue(QStringLiteral("CHARSET")).toLatin1());
             if (codec != NULL) {
                 return codec->toUnicode(d->mValue.toByteArray());
             }
@@ -368,6 +442,7 @@ void QVersitProperty::clear()
 {
     d->mGroups.clear();
     d->mName.clear();
+    d->mNameAtom = QVersitAtoms::Unknown;
     d->mValue.clear();
     d->mParameters.clear();
     d->mValueType = QVersitProperty::PlainType;
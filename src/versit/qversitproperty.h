@@ -98,6 +98,7 @@ public:
     void clear();
 
 private:
+    friend class QVersitPropertyPrivate;
 
     QSharedDataPointer<QVersitPropertyPrivate> d;
 };
@@ -55,15 +55,30 @@
 #include <QtCore/qshareddata.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qvariant.h>
+#include <QtCore/qvarlengtharray.h>
 
 #include <QtVersit/qversitproperty.h>
 
+#include "qversitatoms_p.h"
+
 QT_BEGIN_NAMESPACE_VERSIT
 
+struct QVersitParameter
+{
+    QString mName;
+    QString mValue;
+
+    bool operator==(const QVersitParameter& other) const
+    {
+        return mName == other.mName && mValue == other.mValue;
+    }
+};
+
 class QVersitPropertyPrivate : public QSharedData
 {
 public:
-    QVersitPropertyPrivate() : QSharedData(), mValueType(QVersitProperty::PlainType)
+    QVersitPropertyPrivate()
+        : QSharedData(), mNameAtom(QVersitAtoms::Unknown), mValueType(QVersitProperty::PlainType)
     {
     }
 
@@ -71,6 +86,7 @@ public:
         : QSharedData(other),
         mGroups(other.mGroups),
         mName(other.mName),
+        mNameAtom(other.mNameAtom),
         mParameters(other.mParameters),
         mValue(other.mValue),
         mValueType(other.mValueType)
@@ -79,9 +95,22 @@ public:
 
     ~QVersitPropertyPrivate() {}
 
+    static const QVersitPropertyPrivate* get(const QVersitProperty& property)
+    {
+        return property.d.constData();
+    }
+
+    QStringList parameterValues(const QString& name) const;
+    QString parameterValue(const QString& name) const;
+    bool hasParameter(const QString& name) const;
+    bool hasParameter(const QString& name, const QString& value) const;
+
     QStringList mGroups;
     QString mName;
-    QMultiHash<QString,QString> mParameters;
+    QVersitAtoms::Atom mNameAtom; // Unknown if mName isn't a well-known name
+    // In insertion order.  Most properties have no more than a couple of parameters, so they are
+    // stored inline; the names (and common values) are interned by QVersitAtoms.
+    QVarLengthArray<QVersitParameter, 2> mParameters;
     QVariant mValue;
     QVersitProperty::ValueType mValueType;
 };
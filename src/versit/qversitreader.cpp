@@ -61,6 +61,10 @@ QT_BEGIN_NAMESPACE_VERSIT
   waitForFinished() function can be used to make a blocking
   read.
 
+  Large inputs can be processed as a stream by calling takeResults() whenever
+  resultsAvailable() is emitted.  Together with setMaxBufferedResults(), this keeps
+  the number of documents held in memory bounded.
+
   \sa QVersitDocument
  */
 
@@ -194,6 +198,55 @@ QTextCodec* QVersitReader::defaultCodec() const
     return d->mDefaultCodec;
 }
 
+/*!
+ * Sets the maximum number of threads the reader uses to parse the input to \a count.  If \a count
+ * is greater than one, the input is split at the boundaries of its top-level documents and the
+ * documents are parsed concurrently.  The documents are still returned by results() in the order
+ * they appear in the input.  The default is one, where all parsing happens on a single thread.
+ *
+ * This has no effect on a read that is already in progress.
+ */
+void QVersitReader::setMaxThreadCount(int count)
+{
+    d->mMaxThreadCount = qMax(1, count);
+}
+
+/*!
+ * Returns the maximum number of threads the reader uses to parse the input.
+ */
+int QVersitReader::maxThreadCount() const
+{
+    return d->mMaxThreadCount;
+}
+
+/*!
+ * Sets the maximum number of parsed documents the reader holds on to to \a count.  When that many
+ * documents are waiting to be collected, the reader pauses until the client calls takeResults()
+ * or cancel(), so the memory used stays constant however large the input is.  A \a count of zero,
+ * the default, means no limit.
+ *
+ * When a limit is set, the client must collect the documents with takeResults() as
+ * resultsAvailable() is emitted; waitForFinished() will not return otherwise.
+ *
+ * \sa takeResults()
+ */
+void QVersitReader::setMaxBufferedResults(int count)
+{
+    QMutexLocker locker(&d->mMutex);
+    d->mMaxBufferedResults = qMax(0, count);
+    d->mResultsTaken.wakeAll();
+}
+
+/*!
+ * Returns the maximum number of parsed documents the reader holds on to, or zero if there is no
+ * limit.
+ */
+int QVersitReader::maxBufferedResults() const
+{
+    QMutexLocker locker(&d->mMutex);
+    return d->mMaxBufferedResults;
+}
+
 /*!
  * Returns the state of the reader.
  */
@@ -276,6 +329,18 @@ QList<QVersitDocument> QVersitReader::results() const
     return d->mVersitDocuments;
 }
 
+/*!
+ * Returns the documents that have been read since the last call to takeResults() and removes them
+ * from the reader, so that they are not returned by results() again.  This can be called while
+ * the reader is active to process the input as a stream.
+ *
+ * \sa setMaxBufferedResults()
+ */
+QList<QVersitDocument> QVersitReader::takeResults()
+{
+    return d->takeResults();
+}
+
 QT_END_NAMESPACE_VERSIT
 
 #include "moc_qversitreader.cpp"
@@ -87,8 +87,15 @@ public:
     void setDefaultCodec(QTextCodec* codec);
     QTextCodec* defaultCodec() const;
 
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const;
+
+    void setMaxBufferedResults(int count);
+    int maxBufferedResults() const;
+
     // output:
     QList<QVersitDocument> results() const;
+    QList<QVersitDocument> takeResults();
 
     State state() const;
     Error error() const;
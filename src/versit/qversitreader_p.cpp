@@ -41,10 +41,19 @@
 
 #include <QtCore/qregularexpression.h>
 #include <QtCore/qbuffer.h>
+#include <QtCore/qfiledevice.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qvariant.h>
 
 #include <QTextCodec>
 
+#include <limits>
+
+#include "qversitatoms_p.h"
+#include "qversitencoding_p.h"
+#include "qversitproperty_p.h"
 #include "qversitutils_p.h"
 
 QT_BEGIN_NAMESPACE_VERSIT
@@ -52,9 +61,30 @@ QT_BEGIN_NAMESPACE_VERSIT
 // Some big enough value for nested versit documents to prevent infinite recursion
 #define MAX_VERSIT_DOCUMENT_NESTING_DEPTH 20
 
+static inline QVersitAtoms::Atom nameAtom(const QVersitProperty& property)
+{
+    return QVersitPropertyPrivate::get(property)->mNameAtom;
+}
+
 QHash<QPair<QVersitDocument::VersitType,QString>, QVersitProperty::ValueType>*
     QVersitReaderPrivate::mValueTypeMap = 0;
 
+/*!
+  Encodes the delimiters with \a codec.  A null \a codec leaves them empty.
+  \internal
+  */
+VersitDelimiters::VersitDelimiters(QTextCodec* codec)
+    : codec(codec)
+{
+    if (!codec)
+        return;
+    semicolon = VersitUtils::encode(';', codec);
+    colon = VersitUtils::encode(':', codec);
+    backslash = VersitUtils::encode('\\', codec);
+    equals = VersitUtils::encode('=', codec);
+    agentBegin = VersitUtils::encode(QByteArray(":BEGIN:VCARD"), codec);
+}
+
 /*!
   \class LineReader
   \brief The LineReader class is a wrapper around a QIODevice that allows line-by-line reading.
@@ -65,11 +95,16 @@ QHash<QPair<QVersitDocument::VersitType,QString>, QVersitProperty::ValueType>*
 
   The isCodecCertain constructor parameter/getter can be used by the client to indicate whether
   the codec supplied is known for sure, or if it was a guess.
+
+  If the device is a local file and the codec is byte based, the rest of the file is memory mapped
+  instead and lines are returned as slices of the mapping; a line is only copied if it has to be
+  unfolded.
  */
 
 /*!
   Constructs a LineReader that reads from the given \a device using the given \a codec.
   If the \a codec is null, it is guessed at by sniffing the first few bytes of the input.
+  If \a device is a file, it is memory mapped when possible.
   */
 LineReader::LineReader(QIODevice* device, QTextCodec *codec)
     : mDevice(device),
@@ -77,8 +112,13 @@ LineReader::LineReader(QIODevice* device, QTextCodec *codec)
     mIsCodecUtf8Compatible(false),
     mChunkSize(10000), // Read 10kB at a time
     mOdometer(0),
-    mSearchFrom(0)
+    mSearchFrom(0),
+    mUnfoldedEnd(0),
+    mDocumentNestingLevel(0),
+    mMapping(0),
+    mMappedPos(0)
 {
+    const qint64 start = mDevice->pos();
     if (!mCodec) {
         static QTextCodec* utf16be = QTextCodec::codecForName("UTF-16BE");
         static QTextCodec* utf16le = QTextCodec::codecForName("UTF-16LE");
@@ -114,10 +154,13 @@ LineReader::LineReader(QIODevice* device, QTextCodec *codec)
                 mIsCodecUtf8Compatible = true;
             }
         }
-        mBuffer = LByteArray(firstSixBytes, 0, 0);
+        // The sniffed bytes are normalized together with the first chunk read from the device
+        mHeldBackBytes = firstSixBytes;
     } else {
         mIsCodecCertain = true;
     }
+    initDelimiters();
+    mapDevice(start);
 }
 
 /*!
@@ -131,9 +174,63 @@ LineReader::LineReader(QIODevice* device, QTextCodec *codec, int chunkSize)
     mIsCodecCertain(true),
     mChunkSize(chunkSize),
     mOdometer(0),
-    mSearchFrom(0)
+    mSearchFrom(0),
+    mUnfoldedEnd(0),
+    mDocumentNestingLevel(0),
+    mMapping(0),
+    mMappedPos(0)
 {
     Q_ASSERT(mCodec != NULL);
+    initDelimiters();
+}
+
+/*!
+  Constructs a LineReader that reads from the given \a device using the given \a codec, which has
+  already been established by another LineReader.  \a isCodecCertain and
+  \a isCodecUtf8Compatible carry over what that reader learnt about the codec.  This is used to
+  parse a document that has been split out of the input on a worker thread.
+  */
+LineReader::LineReader(QIODevice* device, QTextCodec *codec, bool isCodecCertain,
+                       bool isCodecUtf8Compatible)
+    : mDevice(device),
+    mCodec(codec),
+    mIsCodecCertain(isCodecCertain),
+    mIsCodecUtf8Compatible(isCodecUtf8Compatible),
+    mChunkSize(10000),
+    mOdometer(0),
+    mSearchFrom(0),
+    mUnfoldedEnd(0),
+    mDocumentNestingLevel(0),
+    mMapping(0),
+    mMappedPos(0)
+{
+    Q_ASSERT(mCodec != NULL);
+    initDelimiters();
+}
+
+LineReader::~LineReader()
+{
+    if (mMapping)
+        static_cast<QFileDevice*>(mDevice)->unmap(mMapping);
+}
+
+/*!
+  Encodes the delimiters the reader and the property parser look for with the reader's codec, so
+  that it doesn't have to be done for every line.
+  */
+void LineReader::initDelimiters()
+{
+    mDelimiters = VersitDelimiters(mCodec);
+    mNl = VersitUtils::encode('\n', mCodec);
+    mCr = VersitUtils::encode('\r', mCodec);
+    mCrlf = VersitUtils::encode("\r\n", mCodec);
+    mSpace = VersitUtils::encode(' ', mCodec);
+    mTab = VersitUtils::encode('\t', mCodec);
+    mEquals = mDelimiters.equals;
+    mColon = mDelimiters.colon;
+    mEndVCard = VersitUtils::encode(QByteArray("END:VCARD"), mCodec);
+    mEndVCardNl = VersitUtils::encode(QByteArray("END:VCARD\n"), mCodec);
+    mEndVCardBeginVCard = VersitUtils::encode(QByteArray("END:VCARDBEGIN:VCARD"), mCodec);
 }
 
 /*!
@@ -155,12 +252,12 @@ LineReader::LineReader(QIODevice* device, QTextCodec *codec, int chunkSize)
   */
 LByteArray LineReader::readLine()
 {
-    QByteArray colon(VersitUtils::encode(':', mCodec));
-    QByteArray equals(VersitUtils::encode('=', mCodec));
     if (!mPushedLines.isEmpty()) {
         LByteArray retval(mPushedLines.pop());
         return retval;
     }
+    if (mMapping)
+        return readMappedLine();
     readOneLine(&mBuffer);
     // Hack: read the next line and see if it's a continuation of this line
     while (true) {
@@ -173,11 +270,12 @@ LByteArray LineReader::readLine()
         // LByteArray copies the QByteArray, which is implicitly shared
         LByteArray prevLine(mBuffer.mData, prevStart, prevEnd);
         if (mBuffer.isEmpty()
-                || mBuffer.contains(colon)
-                || prevLine.endsWith(equals)) {
+                || mBuffer.contains(mColon)
+                || prevLine.endsWith(mEquals)) {
             // Normal, the next line is empty, or a new property, or it's been wrapped using
-            // QUOTED-PRINTABLE.  Rewind it back one line so it gets read next time round.
-            mBuffer.setBounds(prevStart, prevEnd);
+            // QUOTED-PRINTABLE.  Rewind it back one line so it gets read next time round.  If the
+            // empty line was '=NLNL', tryReadLine has dropped the '=' and the line ends sooner.
+            mBuffer.setBounds(prevStart, qMin(prevEnd, mBuffer.mStart));
             break;
         } else {
             // Some silly vCard generator has probably wrapped a line without prepending a space
@@ -193,18 +291,160 @@ LByteArray LineReader::readLine()
     return mBuffer;
 }
 
+/*!
+  Memory maps the rest of the device, starting at \a offset, if it is a file and the codec encodes
+  the delimiters as single bytes.  Bytes that have already been read from the device are
+  discarded, as the mapping covers them.  If the file can't be mapped, the device is read from in
+  chunks as usual.
+  */
+void LineReader::mapDevice(qint64 offset)
+{
+    QFileDevice* file = qobject_cast<QFileDevice*>(mDevice);
+    if (!file || file->isSequential() || mCr.length() != 1)
+        return;
+    const qint64 size = file->size() - offset;
+    if (size <= 0 || size > std::numeric_limits<int>::max())
+        return;
+    mMapping = file->map(offset, size);
+    if (!mMapping)
+        return;
+    mMappedData = QByteArray::fromRawData(reinterpret_cast<const char*>(mMapping), size);
+    mMappedPos = 0;
+    mHeldBackBytes.clear();
+    file->seek(offset + size);
+}
+
+/*!
+  Returns true if the lines are read from a memory mapping of the device rather than from the
+  device itself.
+  */
+bool LineReader::isMemoryMapped() const
+{
+    return mMapping != 0;
+}
+
+/*!
+  The memory mapped counterpart of readLine(), including its workaround for lines wrapped without
+  a leading space.  Joining such lines is the only case besides unfolding that copies a line.
+  */
+LByteArray LineReader::readMappedLine()
+{
+    LByteArray line = readOneMappedLine();
+    while (true) {
+        const int prevPos = mMappedPos;
+        LByteArray nextLine = readOneMappedLine();
+        if (nextLine.isEmpty()) {
+            // As in readLine(), a blank line following this one is consumed, and so is an '='
+            // ending this one ('=NLNL').
+            if (mappedNewlineLength(mMappedPos) > 0 && line.endsWith(mEquals))
+                line.mEnd -= mEquals.length();
+            break;
+        } else if (nextLine.contains(mColon) || line.endsWith(mEquals)) {
+            // A new property, or wrapped using QUOTED-PRINTABLE.  Rewind so it gets read next time.
+            mMappedPos = prevPos;
+            break;
+        }
+        line = LByteArray(line.toByteArray() + nextLine.toByteArray());
+    }
+    mOdometer += line.size();
+    return line;
+}
+
+/*!
+  Returns the next line of the mapping, recognizing \r\n, \r and \n as newlines and unfolding
+  lines that continue with a space or a tab.  An empty line is returned for a blank line.  On
+  return, mMappedPos is left at the newline that ended the line.
+  */
+LByteArray LineReader::readOneMappedLine()
+{
+    const int nlLength = mappedNewlineLength(mMappedPos);
+    if (nlLength > 0) {
+        // Skip the newline that ended the previous line
+        mMappedPos += nlLength;
+        if (mappedNewlineLength(mMappedPos) > 0)
+            return LByteArray();
+    }
+
+    const char* data = mMappedData.constData();
+    const int size = mMappedData.size();
+    const char space = mSpace.at(0);
+    const char tab = mTab.at(0);
+    const int start = mMappedPos;
+    int segmentStart = start;
+    QByteArray unfolded; // Only used if the line is folded
+    int pos = start;
+    forever {
+        pos = indexOfMappedNewline(pos);
+        const int next = pos + mappedNewlineLength(pos);
+        if (next == pos || next >= size || (data[next] != space && data[next] != tab))
+            break;
+        // Folded: drop the newline and the whitespace after it
+        unfolded.append(data + segmentStart, pos - segmentStart);
+        segmentStart = next + 1;
+        pos = segmentStart;
+    }
+    mMappedPos = pos;
+
+    if (segmentStart != start) {
+        unfolded.append(data + segmentStart, pos - segmentStart);
+        return LByteArray(unfolded);
+    }
+
+    // Hack: concatenated malformed vCards can produce a line like END:VCARDBEGIN:VCARD.  Return
+    // END:VCARD plus a newline, as readOneLine() does, and start the next line at BEGIN:VCARD.
+    if (pos - start == mEndVCardBeginVCard.length()
+            && memcmp(data + start, mEndVCardBeginVCard.constData(), pos - start) == 0) {
+        mMappedPos = start + mEndVCard.length();
+        return LByteArray(mEndVCardNl);
+    }
+
+    if (start == 0 && pos == size) {
+        // A slice of all of mMappedData would share it rather than copy it, and could then
+        // outlive the mapping.
+        return LByteArray(QByteArray(data, size));
+    }
+    return LByteArray(mMappedData, start, pos);
+}
+
+/*!
+  Returns the position of the first \r or \n in the mapping at or after \a from, or the size of
+  the mapping if there is none.
+  */
+int LineReader::indexOfMappedNewline(int from) const
+{
+    const char* data = mMappedData.constData();
+    const int size = mMappedData.size();
+    const void* nl = memchr(data + from, mNl.at(0), size - from);
+    const int end = nl ? static_cast<const char*>(nl) - data : size;
+    const void* cr = memchr(data + from, mCr.at(0), end - from);
+    return cr ? static_cast<const char*>(cr) - data : end;
+}
+
+/*!
+  Returns the length of the newline (\r\n, \r or \n) at \a pos in the mapping, or 0 if there
+  isn't one.
+  */
+int LineReader::mappedNewlineLength(int pos) const
+{
+    if (pos >= mMappedData.size())
+        return 0;
+    const char c = mMappedData.at(pos);
+    if (c == mNl.at(0))
+        return 1;
+    if (c != mCr.at(0))
+        return 0;
+    return pos + 1 < mMappedData.size() && mMappedData.at(pos + 1) == mNl.at(0) ? 2 : 1;
+}
+
 /*!
   Attempts to read a line and updates \a cursor to contain the line.  This performes basic
   line unwrapping as per the vCard specification (eg. if a line begins with a space, it is a
   continuation of the next line)
   */
 void LineReader::readOneLine(LByteArray* cursor) {
-    QByteArray cr(VersitUtils::encode('\r', mCodec));
-    QByteArray lf(VersitUtils::encode('\n', mCodec));
-    QByteArray crlf(VersitUtils::encode("\r\n", mCodec));
-
     cursor->mStart = cursor->mEnd;
     mSearchFrom = cursor->mStart;
+    mUnfoldedEnd = mSearchFrom;
 
     // First, look for a newline in the already-existing buffer.  If found, return the line.
     if (tryReadLine(cursor, false)) {
@@ -215,25 +455,9 @@ void LineReader::readOneLine(LByteArray* cursor) {
     while (!mDevice->atEnd()) {
         QByteArray temp = mDevice->read(mChunkSize);
         if (!temp.isEmpty()) {
-            cursor->mData.append(temp);
-
-            // Sanitise CRLF before proceeding to handle mixed line endings.
-            // Convert the other two possible newline representations to '\n'.
-            cursor->mData.replace(crlf, lf);
-            if (cursor->mData.endsWith(cr)) {
-                // Corner case: line ends with \r - could also be \r\n after the
-                // next read, so do not replace the last occurrence (yet)
-                // So restore it for now.
-                cursor->mData.replace(cr, lf);
-                cursor->mData.truncate(cursor->mData.length() - lf.length());
-                cursor->mData.append(cr);
-            } else {
-                cursor->mData.replace(cr, lf);
-            }
-
+            appendNormalized(&cursor->mData, temp);
             if (tryReadLine(cursor, false))
                 return;
-
         } else {
             mDevice->waitForReadyRead(500);
         }
@@ -241,14 +465,98 @@ void LineReader::readOneLine(LByteArray* cursor) {
 
     // We've reached the end of the stream.  Find a newline from the buffer (or return what's left).
     // But first, strip the last occurrence of \r - if present - left from before.
-    if (cursor->mData.endsWith(cr))
-        cursor->mData.truncate(cursor->mData.length() - cr.length());
+    if (!mHeldBackBytes.isEmpty()) {
+        if (mHeldBackBytes.endsWith(mCr))
+            mHeldBackBytes.chop(mCr.length());
+        cursor->mData.append(mHeldBackBytes);
+        mHeldBackBytes.clear();
+    }
 
     tryReadLine(cursor, true);
 
     return;
 }
 
+/*!
+  Appends \a bytes read from the device to \a data, converting the \r\n and \r newline sequences to
+  \n to handle mixed line endings.  Only the new bytes are scanned: a trailing \r, which could still
+  turn out to be part of a \r\n after the next read, and an incomplete trailing code unit are held
+  back until more bytes have been read.
+  */
+void LineReader::appendNormalized(QByteArray* data, const QByteArray& bytes)
+{
+    QByteArray input(bytes);
+    if (!mHeldBackBytes.isEmpty()) {
+        input.prepend(mHeldBackBytes);
+        mHeldBackBytes.clear();
+    }
+
+    const int unitSize = mCr.length();
+    const int incomplete = input.size() % unitSize;
+    if (incomplete > 0) {
+        mHeldBackBytes = input.right(incomplete);
+        input.chop(incomplete);
+    }
+
+    if (unitSize == 1) {
+        // Single pass for byte based codecs
+        const char cr = mCr.at(0);
+        const char nl = mNl.at(0);
+        const char* pos = input.constData();
+        const char* end = pos + input.size();
+        while (pos < end) {
+            const char* crPos = static_cast<const char*>(memchr(pos, cr, end - pos));
+            if (!crPos) {
+                data->append(pos, end - pos);
+                break;
+            }
+            data->append(pos, crPos - pos);
+            if (crPos + 1 == end) {
+                mHeldBackBytes.prepend(mCr);
+            } else if (crPos[1] != nl) {
+                data->append(nl);
+            }
+            pos = crPos + 1;
+        }
+    } else {
+        input.replace(mCrlf, mNl);
+        if (input.endsWith(mCr)) {
+            input.chop(mCr.length());
+            mHeldBackBytes.prepend(mCr);
+        }
+        input.replace(mCr, mNl);
+        data->append(input);
+    }
+}
+
+/*!
+  Returns the position of the first newline in \a data at or after \a from, or -1 if there is none.
+  */
+int LineReader::indexOfNewline(const QByteArray& data, int from) const
+{
+    if (mNl.length() == 1) {
+        if (from >= data.size())
+            return -1;
+        const char* start = data.constData();
+        const void* pos = memchr(start + from, mNl.at(0), data.size() - from);
+        return pos ? static_cast<const char*>(pos) - start : -1;
+    }
+    return data.indexOf(mNl, from);
+}
+
+/*!
+  Marks the bytes of \a data between mSearchFrom and \a to as scanned.  If a fold has been removed
+  from the current line, they are moved down to directly follow the unfolded part of the line, so
+  that every byte is moved at most once per line no matter how many times the line is folded.
+  */
+void LineReader::moveScannedBytes(QByteArray* data, int to)
+{
+    if (mUnfoldedEnd != mSearchFrom && to > mSearchFrom)
+        memmove(data->data() + mUnfoldedEnd, data->constData() + mSearchFrom, to - mSearchFrom);
+    mUnfoldedEnd += to - mSearchFrom;
+    mSearchFrom = to;
+}
+
 /*!
   Push a line onto the front of the line reader so it will be returned on the next call to readLine().
   If multiple lines are pushed onto a line reader, they are read back in first-in-last-out order
@@ -273,7 +581,10 @@ int LineReader::odometer() const
  */
 bool LineReader::atEnd() const
 {
-    return mPushedLines.isEmpty() && mDevice->atEnd() && mBuffer.mEnd == mBuffer.mData.size();
+    if (mMapping)
+        return mPushedLines.isEmpty() && mMappedPos >= mMappedData.size();
+    return mPushedLines.isEmpty() && mDevice->atEnd() && mHeldBackBytes.isEmpty()
+            && mBuffer.mEnd == mBuffer.mData.size();
 }
 
 /*!
@@ -284,6 +595,14 @@ QTextCodec* LineReader::codec() const
     return mCodec;
 }
 
+/*!
+  Returns the delimiters the property parser looks for, encoded with the reader's codec.
+  */
+const VersitDelimiters& LineReader::delimiters() const
+{
+    return mDelimiters;
+}
+
 /*!
   Returns true if the line reader has been told for sure what the codec is, or if a byte-order-mark
   has told us for sure what the codec is.
@@ -302,6 +621,19 @@ void LineReader::setCodecUtf8Incompatible() {
     mIsCodecUtf8Compatible = false;
 }
 
+/*!
+  Returns how deeply nested the document currently being parsed from this reader is.
+ */
+int LineReader::documentNestingLevel() const
+{
+    return mDocumentNestingLevel;
+}
+
+void LineReader::setDocumentNestingLevel(int level)
+{
+    mDocumentNestingLevel = level;
+}
+
 /*!
  * Get the next line of input from the device to parse.  Also performs unfolding by removing
  * sequences of newline-space from the retrieved line.  Skips over any newlines at the start of the
@@ -316,72 +648,67 @@ void LineReader::setCodecUtf8Incompatible() {
  */
 bool LineReader::tryReadLine(LByteArray *cursor, bool atEnd)
 {
-    int nlPos = -1;
-    int doubleNlCheck = -1;
-
-    QByteArray nl(VersitUtils::encode('\n', mCodec));
-    QByteArray tab(VersitUtils::encode('\t', mCodec));
-    QByteArray space(VersitUtils::encode(' ', mCodec));
-    QByteArray equals(VersitUtils::encode('=', mCodec));
-
-    int nlLength = nl.length();
-    int spaceLength = space.length();
-    int equalsLength = equals.length();
+    QByteArray& data = cursor->mData;
+    const int nlLength = mNl.length();
+    const int spaceLength = mSpace.length();
+    const int equalsLength = mEquals.length();
 
     forever {
-        nlPos = cursor->mData.indexOf(nl, mSearchFrom);
-        doubleNlCheck = cursor->mData.indexOf(nl, mSearchFrom + nlLength);
-        if ((nlPos == cursor->mStart) && (doubleNlCheck != nlPos + nlLength)) {
+        int nlPos = indexOfNewline(data, mSearchFrom);
+        if (nlPos == cursor->mStart
+                && !QVersitReaderPrivate::containsAt(data, mNl, nlPos + nlLength)) {
             // Single newline at start of line - ignore and set mStart to directly after it.
             cursor->mStart += nlLength;
             mSearchFrom = cursor->mStart;
+            mUnfoldedEnd = mSearchFrom;
             continue;
-        } else if ((nlPos == cursor->mStart) && (doubleNlCheck == nlPos + nlLength)) {
+        } else if (nlPos == cursor->mStart) {
             // Found '=NLNL' - we choose to see this as badly formed,
             // but clearly marks the end of the versit property.
-            cursor->mData.remove(nlPos, nlLength);
-            cursor->mEnd = nlPos;
-            if (QVersitReaderPrivate::containsAt(cursor->mData, equals, nlPos - equalsLength) ) {
-                cursor->mData.remove(nlPos - 1, 1);
+            data.remove(nlPos, nlLength);
+            if (QVersitReaderPrivate::containsAt(data, mEquals, nlPos - equalsLength) ) {
+                // Drop the '=' ending the previous line.  The empty line starts where it was, so
+                // that readLine() can end the previous line there too.
+                data.remove(nlPos - equalsLength, equalsLength);
+                nlPos -= equalsLength;
+                cursor->mStart = nlPos;
             }
+            cursor->mEnd = nlPos;
             return true;
         } else if (nlPos > cursor->mStart) {
             // Found the first occurrence of newline in the current buffer.
-            if (QVersitReaderPrivate::containsAt(cursor->mData, space, nlPos + nlLength)
-                || QVersitReaderPrivate::containsAt(cursor->mData, tab, nlPos + nlLength)) {
-                // If it's followed by whitespace, collapse it.
-                cursor->mData.remove(nlPos, nlLength + spaceLength);
-                mSearchFrom = nlPos;
+            if (QVersitReaderPrivate::containsAt(data, mSpace, nlPos + nlLength)
+                || QVersitReaderPrivate::containsAt(data, mTab, nlPos + nlLength)) {
+                // If it's followed by whitespace, collapse it by skipping over both.
+                moveScannedBytes(&data, nlPos);
+                mSearchFrom = nlPos + nlLength + spaceLength;
                 continue;
-            } else if (!atEnd && nlPos + nlLength + spaceLength >= cursor->mData.size()) {
+            } else if (!atEnd && nlPos + nlLength + spaceLength >= data.size()) {
                 // If our newline is at the end of the current buffer but there's more to read,
                 // it's possible that a space could be hiding on the next read from the device.
                 // Just pretend we didn't see the newline and pick it up the next time round.
-                mSearchFrom = nlPos;
+                moveScannedBytes(&data, nlPos);
                 return false;
             } else {
-                // Found the newline.
+                // Found the newline.  Close the gap left by the removed folds, if any.
+                moveScannedBytes(&data, nlPos);
+                if (mUnfoldedEnd != mSearchFrom) {
+                    data.remove(mUnfoldedEnd, mSearchFrom - mUnfoldedEnd);
+                    nlPos = mUnfoldedEnd;
+                    mSearchFrom = nlPos;
+                }
+
                 // Hack: if malformed vCard files (having no NL or NLNL ending) are
                 // concatenated, we can get a malformed line in the document which looks like:
                 // END:VCARDBEGIN:VCARD
                 // In that situation, we should actually insert the newline sequence manually,
                 // and return mEnd after the END:VCARD + NL position.
-                QByteArray ev(VersitUtils::encode(QByteArray("END:VCARD"), mCodec));
-                QByteArray evbv(VersitUtils::encode(QByteArray("END:VCARDBEGIN:VCARD"), mCodec));
-                QByteArray evnl(VersitUtils::encode(QByteArray("END:VCARD\n"), mCodec));
-
-                QByteArray possiblyMalformedLine = cursor->mData.mid(cursor->mStart, nlPos-cursor->mStart);
-                int pmlEnd = possiblyMalformedLine.size() - 1;
-                while (true) {
-                    if (QVersitReaderPrivate::containsAt(possiblyMalformedLine, nl, pmlEnd - nlLength))
-                        possiblyMalformedLine.chop(nlLength);
-                    else
-                        break;
-                }
-                if (possiblyMalformedLine == evbv) {
+                const int lineLength = nlPos - cursor->mStart;
+                if (lineLength == mEndVCardBeginVCard.length()
+                        && QVersitReaderPrivate::containsAt(data, mEndVCardBeginVCard, cursor->mStart)) {
                     // fix up the malformed line, return the end cursor after it.
-                    cursor->mData.replace(cursor->mStart, ev.length(), evnl);
-                    cursor->mEnd = cursor->mStart + evnl.length();
+                    data.replace(cursor->mStart, mEndVCard.length(), mEndVCardNl);
+                    cursor->mEnd = cursor->mStart + mEndVCardNl.length();
                 } else {
                     // A well-formed line.
                     cursor->mEnd = nlPos;
@@ -392,10 +719,17 @@ bool LineReader::tryReadLine(LByteArray *cursor, bool atEnd)
         }
         if (nlPos == -1) {
             // No newline found.
-            cursor->mEnd = cursor->mData.size();
-            // Next time, continue searching from here.
-            // The largest newline will have a size of 4 bytes, so we should backtrack 4 bytes
-            mSearchFrom = qMax(mSearchFrom, cursor->mEnd - 4);
+            if (atEnd) {
+                // The rest of the buffer is the last line
+                moveScannedBytes(&data, data.size());
+                data.truncate(mUnfoldedEnd);
+                mSearchFrom = mUnfoldedEnd;
+            } else {
+                // Next time, continue searching from here.
+                // The largest newline will have a size of 4 bytes, so we should backtrack 4 bytes
+                moveScannedBytes(&data, qMax(mSearchFrom, data.size() - 4));
+            }
+            cursor->mEnd = data.size();
             return false;
         }
     }
@@ -414,8 +748,9 @@ void QVersitReaderPrivate::init(QVersitReader* reader)
 /*! Construct a reader. */
 QVersitReaderPrivate::QVersitReaderPrivate()
     : mIoDevice(0),
-    mDocumentNestingLevel(0),
     mDefaultCodec(0),
+    mMaxThreadCount(1),
+    mMaxBufferedResults(0),
     mState(QVersitReader::InactiveState),
     mError(QVersitReader::NoError),
     mIsCanceling(false)
@@ -533,6 +868,62 @@ QVersitReaderPrivate::valueTypeMap() {
     return mValueTypeMap;
 }
 
+/*
+ * Parses a single document that QVersitReaderPrivate::readInParallel() has split out of the input.
+ * The result is picked up by readInParallel() once isFinished() is true; \a finished is signalled
+ * (with \a mutex held) when that happens.
+ */
+class DocumentParseTask : public QRunnable
+{
+public:
+    DocumentParseTask(QVersitReaderPrivate* reader, const QList<QByteArray>& lines,
+                      QTextCodec* codec, bool isCodecCertain, bool isCodecUtf8Compatible,
+                      QMutex* mutex, QWaitCondition* finished)
+        : mReader(reader), mLines(lines), mCodec(codec), mIsCodecCertain(isCodecCertain),
+          mIsCodecUtf8Compatible(isCodecUtf8Compatible), mMutex(mutex), mFinished(finished),
+          mOk(false), mIsFinished(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        QBuffer noMoreInput;
+        noMoreInput.open(QIODevice::ReadOnly);
+        LineReader lineReader(&noMoreInput, mCodec, mIsCodecCertain, mIsCodecUtf8Compatible);
+        for (int i = mLines.size() - 1; i >= 0; i--)
+            lineReader.pushLine(mLines.at(i));
+        mLines.clear();
+        bool ok = mReader->parseVersitDocument(&lineReader, &mDocument);
+
+        QMutexLocker locker(mMutex);
+        mOk = ok;
+        mIsCodecUtf8Compatible = lineReader.isCodecUtf8Compatible();
+        mIsFinished = true;
+        mFinished->wakeAll();
+    }
+
+    // Must be called with the mutex held
+    bool isFinished() const { return mIsFinished; }
+
+    // Valid once isFinished() is true
+    bool isOk() const { return mOk; }
+    bool isCodecUtf8Compatible() const { return mIsCodecUtf8Compatible; }
+    const QVersitDocument& document() const { return mDocument; }
+
+private:
+    QVersitReaderPrivate* mReader;
+    QList<QByteArray> mLines;
+    QTextCodec* mCodec;
+    bool mIsCodecCertain;
+    bool mIsCodecUtf8Compatible;
+    QMutex* mMutex;
+    QWaitCondition* mFinished;
+    QVersitDocument mDocument;
+    bool mOk;
+    bool mIsFinished;
+};
+
 /*!
  * Inherited from QThread, called by QThread when the thread has been started.
  */
@@ -553,33 +944,182 @@ void QVersitReaderPrivate::read()
     bool canceled = false;
 
     LineReader lineReader(mIoDevice, mDefaultCodec);
-    while(!lineReader.atEnd()) {
+    if (mMaxThreadCount > 1) {
+        canceled = !readInParallel(&lineReader);
+    } else {
+        while(!lineReader.atEnd()) {
+            if (isCanceling()) {
+                canceled = true;
+                break;
+            }
+            QVersitDocument document;
+            int oldPos = lineReader.odometer();
+            bool ok = parseVersitDocument(&lineReader, &document);
+
+            if (ok) {
+                if (document.isEmpty())
+                    break;
+                else
+                    appendResult(document);
+            } else {
+                setError(QVersitReader::ParseError);
+                if (lineReader.odometer() == oldPos)
+                    break;
+            }
+        };
+    }
+    if (canceled)
+        setState(QVersitReader::CanceledState);
+    else
+        setState(QVersitReader::FinishedState);
+}
+
+/*!
+ * \internal
+ * Parses the documents from \a lineReader on a pool of mMaxThreadCount threads.  This thread
+ * splits the input into top-level documents and hands each to a worker; the parsed documents are
+ * collected in input order so that results() and resultsAvailable() behave as for a sequential
+ * read.  Returns false if the read was canceled.
+ */
+bool QVersitReaderPrivate::readInParallel(LineReader* lineReader)
+{
+    // Build the shared table now rather than have the workers race to do it
+    valueTypeMap();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(mMaxThreadCount);
+    QMutex taskMutex;
+    QWaitCondition taskFinished;
+    QQueue<DocumentParseTask*> tasks; // In input order
+    // Bound how far the splitter runs ahead so the whole input is never held in memory at once
+    const int maxPendingTasks = 4 * mMaxThreadCount;
+    bool isCodecUtf8Compatible = lineReader->isCodecUtf8Compatible();
+    bool inputFinished = false;
+    bool canceled = false;
+
+    while (true) {
         if (isCanceling()) {
             canceled = true;
             break;
         }
-        QVersitDocument document;
-        int oldPos = lineReader.odometer();
-        bool ok = parseVersitDocument(&lineReader, &document);
-
-        if (ok) {
-            if (document.isEmpty())
+        while (!inputFinished && tasks.size() < maxPendingTasks) {
+            QList<QByteArray> lines;
+            readNextDocumentLines(lineReader, &lines);
+            if (lines.isEmpty()) {
+                inputFinished = true;
                 break;
-            else {
-                QMutexLocker locker(&mMutex);
-                mVersitDocuments.append(document);
-                emit resultsAvailable();
             }
-        } else {
+            DocumentParseTask* task = new DocumentParseTask(this, lines, lineReader->codec(),
+                    lineReader->isCodecCertain(), isCodecUtf8Compatible, &taskMutex, &taskFinished);
+            tasks.enqueue(task);
+            pool.start(task);
+        }
+        if (tasks.isEmpty())
+            break;
+
+        DocumentParseTask* task = tasks.head();
+        taskMutex.lock();
+        while (!task->isFinished())
+            taskFinished.wait(&taskMutex);
+        taskMutex.unlock();
+        tasks.dequeue();
+
+        // Once a value has shown that the input isn't UTF-8, documents split out after this
+        // one are decoded with that knowledge, as they would be by a sequential read.
+        if (!task->isCodecUtf8Compatible())
+            isCodecUtf8Compatible = false;
+        if (!task->isOk()) {
             setError(QVersitReader::ParseError);
-            if (lineReader.odometer() == oldPos)
-                break;
+        } else if (!task->document().isEmpty()) {
+            appendResult(task->document());
         }
-    };
-    if (canceled)
-        setState(QVersitReader::CanceledState);
-    else
-        setState(QVersitReader::FinishedState);
+        delete task;
+    }
+
+    pool.clear();
+    pool.waitForDone();
+    qDeleteAll(tasks);
+    return !canceled;
+}
+
+/*!
+ * \internal
+ * Reads the lines of the next top-level document from \a lineReader into \a lines, skipping any
+ * blank lines before it.  Only the property name at the start of each line is looked at to find
+ * where the document ends; the lines are parsed properly later by a DocumentParseTask.  A line at
+ * the top level which doesn't begin a document is returned on its own so that it fails to parse,
+ * as it would in a sequential read.  \a lines is left empty at the end of the input.
+ */
+void QVersitReaderPrivate::readNextDocumentLines(LineReader* lineReader,
+                                                 QList<QByteArray>* lines)
+{
+    const QByteArray& equals = lineReader->delimiters().equals;
+    // vCard 2.1 allows a nested document to start on the same line as "AGENT:"
+    const QByteArray& agentBegin = lineReader->delimiters().agentBegin;
+    int depth = 0;
+    bool inQuotedPrintable = false;
+
+    while (!lineReader->atEnd()) {
+        QByteArray line = lineReader->readLine().toByteArray();
+        if (lines->isEmpty() && line.trimmed().isEmpty())
+            continue;
+        lines->append(line);
+
+        if (inQuotedPrintable) {
+            // A soft line break in a quoted-printable value; see unencode()
+            inQuotedPrintable = line.endsWith(equals);
+            continue;
+        }
+
+        // 32 bytes is enough for "BEGIN:" in any of the codecs we detect
+        const QString start = codec->toUnicode(line.constData(), qMin(line.size(), 32));
+        if (start.startsWith(QStringLiteral("BEGIN:"), Qt::CaseInsensitive)) {
+            depth++;
+        } else if (start.startsWith(QStringLiteral("END:"), Qt::CaseInsensitive)) {
+            depth--;
+        } else if (line.endsWith(agentBegin)) {
+            depth++;
+        } else if (line.endsWith(equals)) {
+            const QString text = codec->toUnicode(line);
+            inQuotedPrintable = text.left(text.indexOf(QLatin1Char(':')))
+                    .contains(QStringLiteral("QUOTED-PRINTABLE"), Qt::CaseInsensitive);
+        }
+
+        if (depth <= 0)
+            break;
+    }
+}
+
+/*!
+ * \internal
+ * Adds \a document to the results and emits resultsAvailable().  If mMaxBufferedResults documents
+ * are already waiting to be taken, this blocks until the client calls takeResults() or cancels the
+ * read.
+ */
+void QVersitReaderPrivate::appendResult(const QVersitDocument& document)
+{
+    mMutex.lock();
+    while (mMaxBufferedResults > 0 && mVersitDocuments.size() >= mMaxBufferedResults
+            && !mIsCanceling) {
+        mResultsTaken.wait(&mMutex);
+    }
+    mVersitDocuments.append(document);
+    mMutex.unlock();
+    emit resultsAvailable();
+}
+
+/*!
+ * \internal
+ * Removes and returns the documents that have been read so far, unblocking the reader thread if
+ * it was waiting for room in the buffer.
+ */
+QList<QVersitDocument> QVersitReaderPrivate::takeResults()
+{
+    QMutexLocker locker(&mMutex);
+    QList<QVersitDocument> results;
+    results.swap(mVersitDocuments);
+    mResultsTaken.wakeAll();
+    return results;
 }
 
 void QVersitReaderPrivate::setState(QVersitReader::State state)
@@ -612,6 +1152,8 @@ void QVersitReaderPrivate::setCanceling(bool canceling)
 {
     QMutexLocker locker(&mMutex);
     mIsCanceling = canceling;
+    if (canceling)
+        mResultsTaken.wakeAll();
 }
 
 bool QVersitReaderPrivate::isCanceling()
@@ -625,7 +1167,7 @@ bool QVersitReaderPrivate::isCanceling()
  */
 bool QVersitReaderPrivate::parseVersitDocument(LineReader* lineReader, QVersitDocument* document)
 {
-    if (mDocumentNestingLevel >= MAX_VERSIT_DOCUMENT_NESTING_DEPTH)
+    if (lineReader->documentNestingLevel() >= MAX_VERSIT_DOCUMENT_NESTING_DEPTH)
         return false; // To prevent infinite recursion
 
     // If we don't know what type it is, just assume it's a vCard 3.0
@@ -645,7 +1187,7 @@ bool QVersitReaderPrivate::parseVersitDocument(LineReader* lineReader, QVersitDo
         // A blank document (or end of file) was found.
         document->clear();
         return true;
-    } else if (property.name() == QStringLiteral("BEGIN")) {
+    } else if (nameAtom(property) == QVersitAtoms::Begin) {
         if (propertyValue == QStringLiteral("VCARD")) {
             document->setComponentType(propertyValue);
         } else if (propertyValue == QStringLiteral("VCALENDAR")) {
@@ -668,7 +1210,8 @@ bool QVersitReaderPrivate::parseVersitDocument(LineReader* lineReader, QVersitDo
 /*! Parse the rest of a versit document after finding a BEGIN line */
 bool QVersitReaderPrivate::parseVersitDocumentBody(LineReader* lineReader, QVersitDocument* document)
 {
-    mDocumentNestingLevel++;
+    const int nestingLevel = lineReader->documentNestingLevel();
+    lineReader->setDocumentNestingLevel(nestingLevel + 1);
     bool parsingOk = true;
     while (true) {
         /* Grab it */
@@ -678,7 +1221,7 @@ bool QVersitReaderPrivate::parseVersitDocumentBody(LineReader* lineReader, QVers
             property = parseNextVersitProperty(document->type(), lineReader);
         }
 
-        if (property.name() == QStringLiteral("BEGIN")) {
+        if (nameAtom(property) == QVersitAtoms::Begin) {
             // Nested Versit document
             QVersitDocument subDocument;
             subDocument.setType(document->type()); // the nested document inherits the parent's type
@@ -686,13 +1229,13 @@ bool QVersitReaderPrivate::parseVersitDocumentBody(LineReader* lineReader, QVers
             if (!parseVersitDocumentBody(lineReader, &subDocument))
                 break;
             document->addSubDocument(subDocument);
-        } else if (property.name() == QStringLiteral("VERSION")) {
+        } else if (nameAtom(property) == QVersitAtoms::Version) {
             // A version property
             if (!setVersionFromProperty(document, property)) {
                 parsingOk = false;
                 break;
             }
-        } else if (property.name() == QStringLiteral("END")) {
+        } else if (nameAtom(property) == QVersitAtoms::End) {
             // End of document
             break;
         } else if (property.name().isEmpty()) {
@@ -706,7 +1249,7 @@ bool QVersitReaderPrivate::parseVersitDocumentBody(LineReader* lineReader, QVers
     }
     if (!parsingOk)
         document->clear();
-    mDocumentNestingLevel--;
+    lineReader->setDocumentNestingLevel(nestingLevel);
 
     return parsingOk;
 }
@@ -724,7 +1267,7 @@ QVersitProperty QVersitReaderPrivate::parseNextVersitProperty(
 
     // Otherwise, do stuff.
     QPair<QStringList,QString> groupsAndName =
-            extractPropertyGroupsAndName(&line, lineReader->codec());
+            extractPropertyGroupsAndName(&line, lineReader->delimiters());
 
     QVersitProperty property;
     property.setGroups(groupsAndName.first);
@@ -732,8 +1275,10 @@ QVersitProperty QVersitReaderPrivate::parseNextVersitProperty(
     // set the propertyValueType
     QPair<QVersitDocument::VersitType, QString> key =
         qMakePair(versitType, property.name());
-    if (valueTypeMap()->contains(key))
-        property.setValueType(valueTypeMap()->value(key));
+    // Every name in valueTypeMap() is a well-known one, so there's no need to hash any others
+    if (nameAtom(property) != QVersitAtoms::Unknown) {
+        property.setValueType(valueTypeMap()->value(key, QVersitProperty::PlainType));
+    }
 
     if (versitType == QVersitDocument::VCard21Type)
         parseVCard21Property(&line, &property, lineReader);
@@ -751,7 +1296,7 @@ QVersitProperty QVersitReaderPrivate::parseNextVersitProperty(
 void QVersitReaderPrivate::parseVCard21Property(LByteArray* line, QVersitProperty* property,
                                                 LineReader* lineReader)
 {
-    property->setParameters(extractVCard21PropertyParams(line, lineReader->codec()));
+    property->setParameters(extractVCard21PropertyParams(line, lineReader->delimiters()));
 
     QByteArray value = line->toByteArray();
     if (property->valueType() == QVersitProperty::VersitDocumentType) {
@@ -791,7 +1336,7 @@ void QVersitReaderPrivate::parseVCard30Property(QVersitDocument::VersitType vers
                                                 LByteArray* line, QVersitProperty* property,
                                                 LineReader* lineReader)
 {
-    property->setParameters(extractVCard30PropertyParams(line, lineReader->codec()));
+    property->setParameters(extractVCard30PropertyParams(line, lineReader->delimiters()));
 
     QByteArray value = line->toByteArray();
 
@@ -806,6 +1351,7 @@ void QVersitReaderPrivate::parseVCard30Property(QVersitDocument::VersitType vers
         subDocumentData.open(QIODevice::ReadOnly);
         subDocumentData.seek(0);
         LineReader subDocumentLineReader(&subDocumentData, codec);
+        subDocumentLineReader.setDocumentNestingLevel(lineReader->documentNestingLevel());
 
         // Recursive call!
         QVersitDocument subDocument(versitType);
@@ -875,8 +1421,10 @@ bool QVersitReaderPrivate::unencode(QByteArray* value,
                                     QVersitProperty* property,
                                     LineReader* lineReader) const
 {
-    QStringList encodingParameters = property->parameters().values(QStringLiteral("ENCODING"));
-    QStringList typeParameters = property->parameters().values(QStringLiteral("TYPE"));
+    const QVersitPropertyPrivate* propertyData = QVersitPropertyPrivate::get(*property);
+    QStringList encodingParameters =
+            propertyData->parameterValues(QVersitAtoms::name(QVersitAtoms::Encoding));
+    QStringList typeParameters = propertyData->parameterValues(QVersitAtoms::name(QVersitAtoms::Type));
     if (encodingParameters.contains(QStringLiteral("QUOTED-PRINTABLE"), Qt::CaseInsensitive)) {
         // At this point, we need to accumulate bytes until we hit a real line break (no = before
         // it) value already contains everything up to the character before the newline
@@ -893,7 +1441,7 @@ bool QVersitReaderPrivate::unencode(QByteArray* value,
         || encodingParameters.contains(QStringLiteral("B"), Qt::CaseInsensitive)
         || typeParameters.contains(QStringLiteral("BASE64"), Qt::CaseInsensitive)
         || typeParameters.contains(QStringLiteral("B"), Qt::CaseInsensitive)) {
-        *value = QByteArray::fromBase64(*value);
+        *value = VersitEncoding::fromBase64(*value);
         // Remove the encoding parameter as the value is now decoded
         property->removeParameters(QStringLiteral("ENCODING"));
         return true;
@@ -911,11 +1459,12 @@ QString QVersitReaderPrivate::decodeCharset(const QByteArray& value,
                                             LineReader* lineReader,
                                             QTextCodec** codec) const
 {
-    static const QString charset(QStringLiteral("CHARSET"));
+    const QString charset = QVersitAtoms::name(QVersitAtoms::Charset);
 
     *codec = NULL;
-    if (property->parameters().contains(charset)) {
-        QString charsetValue = *property->parameters().find(charset);
+    const QVersitPropertyPrivate* propertyData = QVersitPropertyPrivate::get(*property);
+    if (propertyData->hasParameter(charset)) {
+        QString charsetValue = propertyData->parameterValue(charset);
         property->removeParameters(charset);
         *codec = QTextCodec::codecForName(charsetValue.toLatin1());
     } else if (!lineReader->isCodecCertain()
@@ -942,43 +1491,21 @@ QString QVersitReaderPrivate::decodeCharset(const QByteArray& value,
  */
 void QVersitReaderPrivate::decodeQuotedPrintable(QByteArray* text) const
 {
-    for (int i=0; i < text->length(); i++) {
-        char current = text->at(i);
-        if (current == '=' && i+2 < text->length()) {
-            char next = text->at(i+1);
-            char nextAfterNext = text->at(i+2);
-            if (((next >= 'a' && next <= 'f') ||
-                 (next >= 'A' && next <= 'F') ||
-                 (next >= '0' && next <= '9')) &&
-                ((nextAfterNext >= 'a' && nextAfterNext <= 'f') ||
-                 (nextAfterNext >= 'A' && nextAfterNext <= 'F') ||
-                 (nextAfterNext >= '0' && nextAfterNext <= '9'))) {
-                bool ok;
-                char decodedChar(text->mid(i+1, 2).toInt(&ok,16));
-                if (ok) {
-                    (*text)[i] = decodedChar;
-                    text->remove(i+1, 2);
-                }
-            } else if (next == '\r' && nextAfterNext == '\n') {
-                // Newlines can still be found here if they are encoded in a non-default charset.
-                text->remove(i, 3);
-            }
-        }
-    }
+    VersitEncoding::decodeQuotedPrintable(text);
 }
 
 /*!
- * Extracts the groups and the name of the property using \a codec to determine the delimiters
+ * Extracts the groups and the name of the property using \a delimiters
  *
  * On entry, \a line should contain a whole line
  * On exit, \a line will be updated to remove the groups and name
  */
 QPair<QStringList,QString>QVersitReaderPrivate::extractPropertyGroupsAndName(
-        LByteArray* line, QTextCodec *codec) const
+        LByteArray* line, const VersitDelimiters& delimiters) const
 {
-    const QByteArray semicolon = VersitUtils::encode(';', codec);
-    const QByteArray colon = VersitUtils::encode(':', codec);
-    const QByteArray backslash = VersitUtils::encode('\\', codec);
+    const QByteArray& semicolon = delimiters.semicolon;
+    const QByteArray& colon = delimiters.colon;
+    const QByteArray& backslash = delimiters.backslash;
     QPair<QStringList,QString> groupsAndName;
     int length = 0;
 
@@ -991,7 +1518,7 @@ QPair<QStringList,QString>QVersitReaderPrivate::extractPropertyGroupsAndName(
         }
     }
     if (length > 0) {
-        QString trimmedGroupsAndName = codec->toUnicode(line->left(length)).trimmed();
+        QString trimmedGroupsAndName = delimiters.codec->toUnicode(line->left(length)).trimmed();
         QStringList parts = trimmedGroupsAndName.split(QLatin1Char('.'));
         if (parts.count() > 1) {
             groupsAndName.second = parts.takeLast();
@@ -1006,21 +1533,21 @@ QPair<QStringList,QString>QVersitReaderPrivate::extractPropertyGroupsAndName(
 }
 
 /*!
- * Extracts the property parameters as a QMultiHash using \a codec to determine the delimiters.
+ * Extracts the property parameters as a QMultiHash using \a delimiters.
  * The parameters without names are added as "TYPE" parameters.
  *
  * On entry \a line should contain the line sans the group and name
  * On exit, line will be updated to have the parameters removed.
  */
 QMultiHash<QString,QString> QVersitReaderPrivate::extractVCard21PropertyParams(
-        LByteArray* line, QTextCodec *codec) const
+        LByteArray* line, const VersitDelimiters& delimiters) const
 {
     QMultiHash<QString,QString> result;
-    QList<QByteArray> paramList = extractParams(line, codec);
+    QList<QByteArray> paramList = extractParams(line, delimiters);
     while (!paramList.isEmpty()) {
         QByteArray param = paramList.takeLast();
-        QString name = paramName(param, codec);
-        QString value = paramValue(param, codec);
+        QString name = paramName(param, delimiters);
+        QString value = paramValue(param, delimiters);
         result.insert(name,value);
     }
 
@@ -1028,22 +1555,22 @@ QMultiHash<QString,QString> QVersitReaderPrivate::extractVCard21PropertyParams(
 }
 
 /*!
- * Extracts the property parameters as a QMultiHash using \a codec to determine the delimiters.
+ * Extracts the property parameters as a QMultiHash using \a delimiters.
  * The parameters without names are added as "TYPE" parameters.
  *
  * On entry \a line should contain the line sans the group and name
  * On exit, line will be updated to have the parameters removed.
  */
 QMultiHash<QString,QString> QVersitReaderPrivate::extractVCard30PropertyParams(
-        LByteArray* line, QTextCodec *codec) const
+        LByteArray* line, const VersitDelimiters& delimiters) const
 {
     QMultiHash<QString,QString> result;
-    QList<QByteArray> paramList = extractParams(line, codec);
+    QList<QByteArray> paramList = extractParams(line, delimiters);
     while (!paramList.isEmpty()) {
         QByteArray param = paramList.takeLast();
-        QString name(paramName(param, codec));
+        QString name(paramName(param, delimiters));
         removeBackSlashEscaping(&name);
-        QString values = paramValue(param, codec);
+        QString values = paramValue(param, delimiters);
         QStringList valueList = splitValue(values, QLatin1Char(','), Qt::SkipEmptyParts, true);
         foreach (QString value, valueList) {
             removeBackSlashEscaping(&value);
@@ -1055,22 +1582,22 @@ QMultiHash<QString,QString> QVersitReaderPrivate::extractVCard30PropertyParams(
 
 
 /*!
- * Extracts the parameters as delimited by semicolons using \a codec to determine the delimiters.
+ * Extracts the parameters as delimited by semicolons using \a delimiters.
  *
  * On entry \a line should contain the content line sans the group and name
  * On exit, \a line will be updated to only have the value remain
  */
-QList<QByteArray> QVersitReaderPrivate::extractParams(LByteArray* line, QTextCodec *codec) const
+QList<QByteArray> QVersitReaderPrivate::extractParams(LByteArray* line,
+                                                       const VersitDelimiters& delimiters) const
 {
-    const QByteArray colon = VersitUtils::encode(':', codec);
-    const QByteArray semicolon = VersitUtils::encode(';', codec);
+    const QByteArray& colon = delimiters.colon;
     QList<QByteArray> params;
 
     /* find the end of the name&params */
     int colonIndex = line->indexOf(colon);
     if (colonIndex > 0) {
         QByteArray nameAndParamsString = line->left(colonIndex);
-        params = extractParts(nameAndParamsString, semicolon, codec);
+        params = extractParts(nameAndParamsString, delimiters.semicolon, delimiters);
 
         /* Update line */
         line->chopLeft(colonIndex + colon.length());
@@ -1084,16 +1611,17 @@ QList<QByteArray> QVersitReaderPrivate::extractParams(LByteArray* line, QTextCod
 
 /*!
  * Extracts the parts separated by separator discarding the separators escaped with a backslash
- * encoded with \a codec
+ * from \a delimiters
  */
 QList<QByteArray> QVersitReaderPrivate::extractParts(
-        const QByteArray& text, const QByteArray& separator, QTextCodec* codec) const
+        const QByteArray& text, const QByteArray& separator,
+        const VersitDelimiters& delimiters) const
 {
     QList<QByteArray> parts;
     int partStartIndex = 0;
     int textLength = text.length();
     int separatorLength = separator.length();
-    const QByteArray backslash = VersitUtils::encode('\\', codec);
+    const QByteArray& backslash = delimiters.backslash;
     int backslashLength = backslash.length();
 
     for (int i=0; i < textLength-separatorLength+1; i++) {
@@ -1128,36 +1656,37 @@ QByteArray QVersitReaderPrivate::extractPart(
 }
 
 /*!
- * Extracts the name of the parameter using \a codec to determine the delimiters.
+ * Extracts the name of the parameter using \a delimiters.
  * No name is interpreted as an implicit "TYPE".
  */
-QString QVersitReaderPrivate::paramName(const QByteArray& parameter, QTextCodec* codec) const
+QString QVersitReaderPrivate::paramName(const QByteArray& parameter,
+                                        const VersitDelimiters& delimiters) const
 {
      if (parameter.trimmed().length() == 0)
          return QString();
-     const QByteArray equals = VersitUtils::encode('=', codec);
-     int equalsIndex = parameter.indexOf(equals);
+     int equalsIndex = parameter.indexOf(delimiters.equals);
      if (equalsIndex > 0) {
-         return codec->toUnicode(parameter.left(equalsIndex)).trimmed();
+         return delimiters.codec->toUnicode(parameter.left(equalsIndex)).trimmed();
      }
 
      return QStringLiteral("TYPE");
 }
 
 /*!
- * Extracts the value of the parameter using \a codec to determine the delimiters
+ * Extracts the value of the parameter using \a delimiters
  */
-QString QVersitReaderPrivate::paramValue(const QByteArray& parameter, QTextCodec* codec) const
+QString QVersitReaderPrivate::paramValue(const QByteArray& parameter,
+                                         const VersitDelimiters& delimiters) const
 {
     QByteArray value(parameter);
-    const QByteArray equals = VersitUtils::encode('=', codec);
+    const QByteArray& equals = delimiters.equals;
     int equalsIndex = parameter.indexOf(equals);
     if (equalsIndex > 0) {
         int valueLength = parameter.length() - (equalsIndex + equals.length());
         value = parameter.right(valueLength).trimmed();
     }
 
-    return codec->toUnicode(value);
+    return delimiters.codec->toUnicode(value);
 }
 
 /*
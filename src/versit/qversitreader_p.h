@@ -61,6 +61,7 @@
 #include <QtCore/qscopedpointer.h>
 #include <QtCore/qstack.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
 
 #include <QtVersit/qversitreader.h>
 #include <QtVersit/qversitdocument.h>
@@ -159,23 +160,55 @@ private:
     friend class LineReader;
 };
 
+/*
+ * The delimiters the property parser looks for, encoded once with a codec so that they don't have
+ * to be encoded for every property.
+ */
+struct Q_VERSIT_EXPORT VersitDelimiters
+{
+    VersitDelimiters(QTextCodec* codec = 0);
+
+    QTextCodec* codec;
+    QByteArray semicolon;
+    QByteArray colon;
+    QByteArray backslash;
+    QByteArray equals;
+    QByteArray agentBegin; // ":BEGIN:VCARD"
+};
+
 class Q_VERSIT_EXPORT LineReader
 {
 public:
     LineReader(QIODevice* device, QTextCodec* codec);
     LineReader(QIODevice* device);
     LineReader(QIODevice* device, QTextCodec* codec, int chunkSize);
+    LineReader(QIODevice* device, QTextCodec* codec, bool isCodecCertain,
+               bool isCodecUtf8Compatible);
+    ~LineReader();
     void init();
     void pushLine(const QByteArray& line);
     int odometer() const;
     bool atEnd() const;
     QTextCodec* codec() const;
+    const VersitDelimiters& delimiters() const;
     bool isCodecCertain() const;
     bool isCodecUtf8Compatible() const;
     void setCodecUtf8Incompatible();
+    int documentNestingLevel() const;
+    void setDocumentNestingLevel(int level);
     LByteArray readLine();
+    bool isMemoryMapped() const;
 
 private:
+    void initDelimiters();
+    void mapDevice(qint64 offset);
+    LByteArray readMappedLine();
+    LByteArray readOneMappedLine();
+    int indexOfMappedNewline(int from) const;
+    int mappedNewlineLength(int pos) const;
+    void appendNormalized(QByteArray* data, const QByteArray& bytes);
+    int indexOfNewline(const QByteArray& data, int from) const;
+    void moveScannedBytes(QByteArray* data, int to);
     void readOneLine(LByteArray* cursor);
     bool tryReadLine(LByteArray* cursor, bool atEnd);
 
@@ -188,6 +221,26 @@ private:
     LByteArray mBuffer;
     int mOdometer;
     int mSearchFrom;
+    int mUnfoldedEnd; // End of the unfolded part of the current line, <= mSearchFrom
+    QByteArray mHeldBackBytes; // Read from the device but not yet newline-normalized
+    int mDocumentNestingLevel; // Depth in parsing nested Versit documents
+
+    // Delimiters encoded with mCodec
+    VersitDelimiters mDelimiters;
+    QByteArray mNl;
+    QByteArray mCr;
+    QByteArray mCrlf;
+    QByteArray mSpace;
+    QByteArray mTab;
+    QByteArray mEquals;
+    QByteArray mColon;
+    QByteArray mEndVCard;
+    QByteArray mEndVCardNl;
+    QByteArray mEndVCardBeginVCard;
+
+    uchar* mMapping; // Non-null when reading a file through a memory mapping
+    QByteArray mMappedData; // Wraps mMapping without copying it
+    int mMappedPos; // Where the next line starts in mMappedData
 };
 
 class Q_VERSIT_EXPORT QVersitReaderPrivate : public QThread
@@ -211,6 +264,10 @@ protected: // From QThread
 
 public: // New functions
     void read();
+    bool readInParallel(LineReader* lineReader);
+    void readNextDocumentLines(LineReader* lineReader, QList<QByteArray>* lines);
+    void appendResult(const QVersitDocument& document);
+    QList<QVersitDocument> takeResults();
 
     // mutexed getters and setters.
     void setState(QVersitReader::State);
@@ -257,20 +314,20 @@ public: // New functions
 
 
     /* These functions operate on a cursor describing a single line */
-    QPair<QStringList,QString> extractPropertyGroupsAndName(LByteArray* line, QTextCodec* codec)
-            const;
-    QMultiHash<QString,QString> extractVCard21PropertyParams(LByteArray* line, QTextCodec* codec)
-            const;
-    QMultiHash<QString,QString> extractVCard30PropertyParams(LByteArray* line, QTextCodec* codec)
-            const;
+    QPair<QStringList,QString> extractPropertyGroupsAndName(
+            LByteArray* line, const VersitDelimiters& delimiters) const;
+    QMultiHash<QString,QString> extractVCard21PropertyParams(
+            LByteArray* line, const VersitDelimiters& delimiters) const;
+    QMultiHash<QString,QString> extractVCard30PropertyParams(
+            LByteArray* line, const VersitDelimiters& delimiters) const;
 
     // "Private" functions
-    QList<QByteArray> extractParams(LByteArray* line, QTextCodec *codec) const;
+    QList<QByteArray> extractParams(LByteArray* line, const VersitDelimiters& delimiters) const;
     QList<QByteArray> extractParts(const QByteArray& text, const QByteArray& separator,
-                                   QTextCodec *codec) const;
+                                   const VersitDelimiters& delimiters) const;
     QByteArray extractPart(const QByteArray& text, int startPosition, int length=-1) const;
-    QString paramName(const QByteArray& parameter, QTextCodec* codec) const;
-    QString paramValue(const QByteArray& parameter, QTextCodec* codec) const;
+    QString paramName(const QByteArray& parameter, const VersitDelimiters& delimiters) const;
+    QString paramValue(const QByteArray& parameter, const VersitDelimiters& delimiters) const;
     template <class T> static bool containsAt(const T& text, const QByteArray& ba, int index);
     bool splitStructuredValue(QVersitProperty* property,
                               bool hasEscapedBackslashes) const;
@@ -285,12 +342,14 @@ public:
     QPointer<QIODevice> mIoDevice;
     QScopedPointer<QBuffer> mInputBytes; // Holds the data set by setData()
     QList<QVersitDocument> mVersitDocuments;
-    int mDocumentNestingLevel; // Depth in parsing nested Versit documents
     QTextCodec* mDefaultCodec;
+    int mMaxThreadCount; // Documents are parsed on a thread pool if this is more than 1
+    int mMaxBufferedResults; // 0 for no limit
     QVersitReader::State mState;
     QVersitReader::Error mError;
     bool mIsCanceling;
     mutable QMutex mMutex;
+    QWaitCondition mResultsTaken; // Woken when room is made in mVersitDocuments
 
 private:
     /* key is the document type and property name, value is the type of property it is.
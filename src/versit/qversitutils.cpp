@@ -62,8 +62,11 @@ QBasicMutex VersitUtils::m_staticLock;
  */
 QByteArray VersitUtils::encode(char ch, QTextCodec* codec)
 {
-    changeCodec(codec);
-    return m_encodingMap[(int)ch];
+    // Copy the entry while holding the lock so that a concurrent reader or writer using a
+    // different codec cannot rebuild the table underneath us.
+    QMutexLocker readWriterLocker(&VersitUtils::m_staticLock);
+    updateCaches(codec);
+    return m_encodingMap[(uchar)ch];
 }
 
 /*!
@@ -89,7 +92,14 @@ QList<QByteArrayMatcher>* VersitUtils::newlineList(QTextCodec* codec)
  */
 void VersitUtils::changeCodec(QTextCodec* codec) {
     QMutexLocker readWriterLocker(&VersitUtils::m_staticLock);
+    updateCaches(codec);
+}
 
+/*!
+ * \internal
+ * Rebuilds the cached tables for \a codec.  The caller must hold m_staticLock.
+ */
+void VersitUtils::updateCaches(QTextCodec* codec) {
     if (VersitUtils::m_newlineList != 0 && codec == VersitUtils::m_previousCodec)
         return;
 
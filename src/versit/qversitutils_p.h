@@ -81,6 +81,8 @@ public:
     static bool convertFromJson(const QString &json, QVariant *data);
 
 private:
+    static void updateCaches(QTextCodec* codec);
+
     // These are caches for performance:
     // The previous codec that encode(char, QTextCodec) was called with
     static QTextCodec* m_previousCodec;
@@ -94,19 +94,7 @@ void QVersitWriterPrivate::write()
         if (type == QVersitDocument::InvalidType)
             type = document.type();
 
-        QScopedPointer<QVersitDocumentWriter> writer(writerForType(type, document));
-        QTextCodec* codec = mDefaultCodec;
-        if (codec == NULL) {
-            if (type == QVersitDocument::VCard21Type) {
-                codec = QTextCodec::codecForName("ISO-8859-1");
-                writer->setAsciiCodec();
-            } else {
-                codec = QTextCodec::codecForName("UTF-8");
-            }
-        }
-        writer->setCodec(codec);
-        writer->setDevice(mIoDevice);
-        if (!writer->encodeVersitDocument(document)) {
+        if (!encodeDocument(mIoDevice, document, type, mDefaultCodec)) {
             setError(QVersitWriter::IOError);
             break;
         }
@@ -151,6 +139,32 @@ QVersitWriter::Error QVersitWriterPrivate::error() const
     return mError;
 }
 
+/*!
+ * Encodes \a document in the format given by \a type and writes it to \a device.  The text is
+ * encoded with \a defaultCodec, or with the standard codec for the format if that is null.
+ * Returns false if the document could not be written.
+ *
+ * This does not touch the state of any writer, so it can be used from any thread.
+ */
+bool QVersitWriterPrivate::encodeDocument(QIODevice* device, const QVersitDocument& document,
+                                          QVersitDocument::VersitType type,
+                                          QTextCodec* defaultCodec)
+{
+    QScopedPointer<QVersitDocumentWriter> writer(writerForType(type, document));
+    QTextCodec* codec = defaultCodec;
+    if (codec == NULL) {
+        if (type == QVersitDocument::VCard21Type) {
+            codec = QTextCodec::codecForName("ISO-8859-1");
+            writer->setAsciiCodec();
+        } else {
+            codec = QTextCodec::codecForName("UTF-8");
+        }
+    }
+    writer->setCodec(codec);
+    writer->setDevice(device);
+    return writer->encodeVersitDocument(document);
+}
+
 /*!
  * Returns a QVersitDocumentWriter that can encode a QVersitDocument of type \a type.
  * The caller is responsible for deleting the object.
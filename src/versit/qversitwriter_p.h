@@ -89,6 +89,8 @@ public:
 
     void run() override;
 
+    static bool encodeDocument(QIODevice* device, const QVersitDocument& document,
+                               QVersitDocument::VersitType type, QTextCodec* defaultCodec);
     static QVersitDocumentWriter* writerForType(QVersitDocument::VersitType type, const QVersitDocument& document);
 
     QIODevice* mIoDevice;
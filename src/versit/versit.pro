@@ -14,11 +14,14 @@ PUBLIC_HEADERS += \
     qversitreader.h \
     qversitwriter.h \
     qversitcontactexporter.h \
+    qversitcontactexportpipeline.h \
     qversitcontactimporter.h \
+    qversitcontactimportpipeline.h \
     qversitcontacthandler.h \
     qversitresourcehandler.h
 
 PRIVATE_HEADERS += \
+    qversitatoms_p.h \
     qversitdocument_p.h \
     qversitdocumentwriter_p.h \
     qversitproperty_p.h \
@@ -28,14 +31,18 @@ PRIVATE_HEADERS += \
     qvcard30writer_p.h \
     qvcardrestorehandler_p.h \
     qversitcontactexporter_p.h \
+    qversitcontactexportpipeline_p.h \
     qversitcontactimporter_p.h \
+    qversitcontactimportpipeline_p.h \
     qversitdefs_p.h \
     qversitcontactsdefs_p.h \
     qversitcontactpluginloader_p.h \
+    qversitencoding_p.h \
     qversitutils_p.h \
     qversitpluginsearch_p.h
 
 SOURCES += \
+    qversitatoms_p.cpp \
     qversitdocument.cpp \
     qversitdocument_p.cpp \
     qversitdocumentwriter_p.cpp \
@@ -49,11 +56,16 @@ SOURCES += \
     qvcardrestorehandler_p.cpp \
     qversitcontactexporter.cpp \
     qversitcontactexporter_p.cpp \
+    qversitcontactexportpipeline.cpp \
+    qversitcontactexportpipeline_p.cpp \
     qversitcontactimporter.cpp \
     qversitcontactimporter_p.cpp \
+    qversitcontactimportpipeline.cpp \
+    qversitcontactimportpipeline_p.cpp \
     qversitresourcehandler.cpp \
     qversitcontacthandler.cpp \
     qversitcontactpluginloader_p.cpp \
+    qversitencoding.cpp \
     qversitutils.cpp
 
 HEADERS += $$PUBLIC_HEADERS $$PRIVATE_HEADERS
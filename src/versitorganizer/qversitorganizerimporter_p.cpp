@@ -409,8 +409,9 @@ int QVersitOrganizerImporterPrivate::triggerToSecondsBeforeStart(const QVersitPr
     //The default value type for TRIGGER property is DURATION.
     bool encodedAsDuration = true;
 
-    if (!triggerProperty.parameters().isEmpty()) {
-        const QString triggerValue = triggerProperty.parameters().value(QStringLiteral("VALUE")).toUpper();
+    const QMultiHash<QString, QString> parameters = triggerProperty.parameters();
+    if (!parameters.isEmpty()) {
+        const QString triggerValue = parameters.value(QStringLiteral("VALUE")).toUpper();
         if (triggerValue == QStringLiteral("DATE-TIME"))
             encodedAsDuration = false;
         else if ( (!triggerValue.isEmpty()) &&
@@ -420,7 +421,7 @@ int QVersitOrganizerImporterPrivate::triggerToSecondsBeforeStart(const QVersitPr
     }
 
     if (encodedAsDuration) {
-        const QString related = triggerProperty.parameters().value(QStringLiteral("RELATED")).toUpper();
+        const QString related = parameters.value(QStringLiteral("RELATED")).toUpper();
         result = Duration::parseDuration(triggerProperty.value()).toSeconds();
         switch (item.type()) {
         case QOrganizerItemType::TypeTodo:
@@ -670,8 +671,7 @@ QDateTime QVersitOrganizerImporterPrivate::parseDateTime(const QVersitProperty&
             *hasTime = true;
         QDateTime datetime(parseDateTime(property.value()));
         if (datetime.isValid() && datetime.timeSpec() == Qt::LocalTime) {
-            QMultiHash<QString, QString> params = property.parameters();
-            QString tzid = params.value(QStringLiteral("TZID"));
+            QString tzid = parameters.value(QStringLiteral("TZID"));
             if (!tzid.isEmpty()) {
                 if (tzid.at(0) == QLatin1Char('/') && mTimeZoneHandler)
                     datetime = mTimeZoneHandler->convertTimeZoneToUtc(datetime, tzid);
@@ -1,6 +1,6 @@
 %modules = ( # path to module name map
-    "QtContacts" => "$basedir/src/contacts",
-    "QtOrganizer" => "$basedir/src/organizer",
+    "QtContacts" => "$basedir/src/contacts;$basedir/src/common",
+    "QtOrganizer" => "$basedir/src/organizer;$basedir/src/common",
     "QtVersit" => "$basedir/src/versit",
     "QtVersitOrganizer" => "$basedir/src/versitorganizer",
 );
@@ -4,10 +4,12 @@ TEMPLATE = subdirs
 SUBDIRS += \
     qcontact \
     qcontactasync \
+    qcontactbinaryformat \
     qcontactcollection \
     qcontactdetail \
     qcontactdetails \
     qcontactfilter \
+    qcontactmemusage \
     qcontactsortorder \
 #TODO: re-enable the manager plugins test
 #when it has been adapted to new Qt plugin mechanism
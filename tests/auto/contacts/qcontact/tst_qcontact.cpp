@@ -49,6 +49,7 @@ public:
 
 private slots:
     void details();
+    void detailView();
     void preferences();
     void relationships();
     void type();
@@ -56,6 +57,7 @@ private slots:
     void emptiness();
     void idComparison();
     void idHash();
+    void idManagerUri();
     void hash();
     void datastream();
     void traits();
@@ -403,6 +405,89 @@ void tst_QContact::details()
     QVERIFY(c3.removeDetail(&five, QContact::IgnoreAccessConstraints));
 }
 
+void tst_QContact::detailView()
+{
+    QContact c;
+    QContactDetailView view = c.detailView(QContactPhoneNumber::Type);
+    QVERIFY(view.isEmpty());
+    QVERIFY(view.begin() == view.end());
+    QCOMPARE(c.detailView().count(), 1);
+    QCOMPARE(c.detailView().first().type(), QContactType::Type);
+
+    // Interleave the types so each type's details are scattered through the contact
+    QContactPhoneNumber p1, p2, p3;
+    p1.setNumber("1");
+    p2.setNumber("2");
+    p3.setNumber("3");
+    QContactEmailAddress e1, e2;
+    e1.setEmailAddress("one@example.com");
+    e2.setEmailAddress("two@example.com");
+    QContactDetail unknown1(static_cast<QContactDetail::DetailType>(123456));
+    unknown1.setValue(1, QStringLiteral("first"));
+    QContactDetail unknown2(static_cast<QContactDetail::DetailType>(123457));
+    unknown2.setValue(1, QStringLiteral("other"));
+    QContactDetail unknown3(static_cast<QContactDetail::DetailType>(123456));
+    unknown3.setValue(1, QStringLiteral("second"));
+    QVERIFY(c.saveDetail(&p1));
+    QVERIFY(c.saveDetail(&unknown1));
+    QVERIFY(c.saveDetail(&e1));
+    QVERIFY(c.saveDetail(&p2));
+    QVERIFY(c.saveDetail(&unknown2));
+    QVERIFY(c.saveDetail(&e2));
+    QVERIFY(c.saveDetail(&unknown3));
+    QVERIFY(c.saveDetail(&p3));
+
+    view = c.detailView(QContactPhoneNumber::Type);
+    QCOMPARE(view.count(), 3);
+    QCOMPARE(QContactPhoneNumber(view.at(0)).number(), QStringLiteral("1"));
+    QCOMPARE(QContactPhoneNumber(view.at(1)).number(), QStringLiteral("2"));
+    QCOMPARE(QContactPhoneNumber(view.at(2)).number(), QStringLiteral("3"));
+    QCOMPARE(view.toList(), c.details(QContactPhoneNumber::Type));
+    QCOMPARE(c.detailView<QContactEmailAddress>().toList(), c.details(QContactEmailAddress::Type));
+    QCOMPARE(c.detail<QContactEmailAddress>().emailAddress(), QStringLiteral("one@example.com"));
+
+    QStringList values;
+    foreach (const QContactDetail& detail, c.detailView(static_cast<QContactDetail::DetailType>(123456)))
+        values << detail.value(1).toString();
+    QCOMPARE(values, QStringList() << QStringLiteral("first") << QStringLiteral("second"));
+    QCOMPARE(c.detail(static_cast<QContactDetail::DetailType>(123457)).value(1).toString(), QStringLiteral("other"));
+    QVERIFY(c.detailView(static_cast<QContactDetail::DetailType>(-1)).isEmpty());
+
+    // The untyped view covers every detail in order
+    view = c.detailView();
+    QCOMPARE(view.toList(), c.details());
+
+    // Updating and removing details keeps the views in step
+    p2.setNumber("22");
+    QVERIFY(c.saveDetail(&p2));
+    QCOMPARE(c.details<QContactPhoneNumber>().at(1).number(), QStringLiteral("22"));
+    QVERIFY(c.removeDetail(&p1));
+    QVERIFY(c.removeDetail(&unknown1));
+    view = c.detailView(QContactPhoneNumber::Type);
+    QCOMPARE(view.count(), 2);
+    QCOMPARE(QContactPhoneNumber(view.first()).number(), QStringLiteral("22"));
+    QCOMPARE(c.detailView(static_cast<QContactDetail::DetailType>(123456)).count(), 1);
+
+    // A copy that is modified detaches, leaving the original's details alone
+    QContact copy(c);
+    QVERIFY(copy.removeDetail(&e1));
+    QCOMPARE(copy.detailView<QContactEmailAddress>().count(), 1);
+    QCOMPARE(c.detailView<QContactEmailAddress>().count(), 2);
+
+    // Streamed contacts are indexed too
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+    out << c;
+    QDataStream in(buffer);
+    QContact streamed;
+    in >> streamed;
+    QCOMPARE(streamed.detailView<QContactPhoneNumber>().toList(), c.details(QContactPhoneNumber::Type));
+
+    c.clearDetails();
+    QVERIFY(c.detailView(QContactPhoneNumber::Type).isEmpty());
+    QCOMPARE(c.detailView().count(), 1);
+}
+
 void tst_QContact::preferences()
 {
     QContact c;
@@ -634,6 +719,27 @@ void tst_QContact::idHash()
     QCOMPARE(set.size(), 3);
 }
 
+void tst_QContact::idManagerUri()
+{
+    // ids built from separate copies of a manager URI refer to the same manager
+    const QString uri(QStringLiteral("qtcontacts:idmanageruri:"));
+    const QString uriCopy(QString::fromLatin1(uri.toLatin1()));
+    const QContactId id1(uri, "1");
+    const QContactId id2(uriCopy, "1");
+    QCOMPARE(id1, id2);
+    QCOMPARE(id2.managerUri(), uri);
+    QCOMPARE(QContactId::fromString(id1.toString()), id1);
+    QCOMPARE(QContactId::fromByteArray(id2.toByteArray()), id2);
+
+    // ordering follows the manager URI, not the order in which the URIs were first seen
+    const QContactId idZ(QStringLiteral("qtcontacts:idmanageruriz:"), "1");
+    const QContactId idY(QStringLiteral("qtcontacts:idmanagerury:"), "2");
+    QVERIFY(idY < idZ);
+    QVERIFY(!(idZ < idY));
+    QVERIFY(id1 < idY);
+    QVERIFY(idY != idZ);
+}
+
 void tst_QContact::hash()
 {
     QContactId id = makeId("a", 1);
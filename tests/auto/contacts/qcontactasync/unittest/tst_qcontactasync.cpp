@@ -186,6 +186,7 @@ private slots:
 
     void contactFetch();
     void contactFetch_data() { addManagers(); }
+    void contactFetchNewContacts();
     void contactFetchById();
     void contactFetchById_data() { addManagers(); }
 
@@ -638,6 +639,39 @@ void tst_QContactAsync::contactFetch()
     }
 }
 
+void tst_QContactAsync::contactFetchNewContacts()
+{
+    QList<QContact> contacts;
+    for (int i = 0; i < 4; ++i) {
+        QContact contact;
+        QContactName name;
+        name.setFirstName(QString::number(i));
+        contact.saveDetail(&name);
+        contacts.append(contact);
+    }
+
+    QContactFetchRequest cfr;
+    QSignalSpy spy(&cfr, SIGNAL(resultsAvailable()));
+    QVERIFY(cfr.newContacts().isEmpty());
+
+    // partial results are appended
+    QContactManagerEngine::appendContactFetchRequestResults(&cfr, contacts.mid(0, 2), QContactManager::NoError, QContactAbstractRequest::ActiveState);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(cfr.contacts(), contacts.mid(0, 2));
+    QCOMPARE(cfr.newContacts(), contacts.mid(0, 2));
+
+    QContactManagerEngine::appendContactFetchRequestResults(&cfr, contacts.mid(2, 1), QContactManager::NoError, QContactAbstractRequest::ActiveState);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(cfr.contacts(), contacts.mid(0, 3));
+    QCOMPARE(cfr.newContacts(), contacts.mid(2, 1));
+
+    // replaced results are all new
+    QContactManagerEngine::updateContactFetchRequest(&cfr, contacts.mid(3), QContactManager::NoError, QContactAbstractRequest::FinishedState);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(cfr.contacts(), contacts.mid(3));
+    QCOMPARE(cfr.newContacts(), contacts.mid(3));
+}
+
 void tst_QContactAsync::contactFetchById()
 {
     QFETCH(QString, uri);
@@ -0,0 +1,5 @@
+include(../../auto.pri)
+
+QT += contacts contacts-private
+
+SOURCES  += tst_qcontactbinaryformat.cpp
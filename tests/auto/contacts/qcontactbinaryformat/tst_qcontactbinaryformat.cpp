@@ -0,0 +1,348 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtContacts/QContactDetail>
+#include <QtContacts/qcontacts.h>
+
+#include <QSet>
+
+#include <QtTest/QtTest>
+#include <QtContacts/qcontacts.h>
+#include <QtContacts/private/qcontactbinaryformat_p.h>
+#include <QtCore/qendian.h>
+
+//TESTED_COMPONENT=src/contacts
+
+QTCONTACTS_USE_NAMESPACE
+class tst_QContactBinaryFormat : public QObject
+{
+Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void partialDecode();
+    void invalidData();
+    void mappedEngine();
+
+private:
+    QList<QContact> testContacts() const;
+    QByteArray write(const QList<QContact> &contacts) const;
+};
+
+static const QString TestUri(QStringLiteral("qtcontacts:binaryformat:"));
+
+static quint32 word(const QByteArray &data, quint32 offset)
+{
+    return qFromLittleEndian<quint32>(data.constData() + offset);
+}
+
+// Returns the offset in data of the string with the given index, from the header and string table
+static quint32 stringOffset(const QByteArray &data, quint32 index)
+{
+    const quint32 stringCount = word(data, 8 * sizeof(quint32));
+    const quint32 tableOffset = word(data, 9 * sizeof(quint32));
+    return tableOffset + (stringCount + 1) * sizeof(quint32) + word(data, tableOffset + index * sizeof(quint32));
+}
+
+QList<QContact> tst_QContactBinaryFormat::testContacts() const
+{
+    QList<QContact> contacts;
+    const QContactCollectionId collectionId(TestUri, QByteArrayLiteral("collection"));
+
+    QContact alice;
+    alice.setId(QContactId(TestUri, QByteArrayLiteral("alice")));
+    alice.setCollectionId(collectionId);
+    QContactName name;
+    name.setFirstName(QStringLiteral("Alice"));
+    name.setLastName(QStringLiteral("Liddell"));
+    alice.saveDetail(&name);
+    QContactPhoneNumber home;
+    home.setNumber(QStringLiteral("12345"));
+    home.setContexts(QContactDetail::ContextHome);
+    home.setSubTypes(QList<int>() << QContactPhoneNumber::SubTypeMobile << QContactPhoneNumber::SubTypeVoice);
+    alice.saveDetail(&home);
+    QContactPhoneNumber work;
+    work.setNumber(QStringLiteral("67890"));
+    work.setContexts(QContactDetail::ContextWork);
+    alice.saveDetail(&work);
+    QContactBirthday birthday;
+    birthday.setDateTime(QDateTime(QDate(1852, 5, 4), QTime(12, 0)));
+    alice.saveDetail(&birthday);
+    QContactTag tag;
+    tag.setTag(QStringLiteral("Liddell"));     // shares its text with the name
+    alice.saveDetail(&tag);
+    alice.setPreferredDetail(QStringLiteral("call"), work);
+    contacts.append(alice);
+
+    QContact bob;
+    bob.setId(QContactId(TestUri, QByteArrayLiteral("bob")));
+    bob.setType(QContactType::TypeGroup);
+    QContactDisplayLabel label;
+    label.setLabel(QStringLiteral("Bob's group"));
+    QContactManagerEngine::setDetailAccessConstraints(&label, QContactDetail::ReadOnly | QContactDetail::Irremovable);
+    bob.saveDetail(&label, QContact::IgnoreAccessConstraints);
+    contacts.append(bob);
+
+    QContact carol;
+    carol.setId(QContactId(TestUri, QByteArrayLiteral("carol")));
+    carol.setCollectionId(collectionId);
+    QContactEmailAddress email;
+    email.setEmailAddress(QStringLiteral("carol@example.com"));
+    carol.saveDetail(&email);
+    contacts.append(carol);
+
+    return contacts;
+}
+
+QByteArray tst_QContactBinaryFormat::write(const QList<QContact> &contacts) const
+{
+    QContactBinaryWriter writer;
+    // out of order, as the writer sorts the contacts by id
+    for (int i = contacts.size() - 1; i >= 0; --i)
+        writer.addContact(contacts.at(i));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (!writer.write(&buffer))
+        return QByteArray();
+    return buffer.data();
+}
+
+void tst_QContactBinaryFormat::roundTrip()
+{
+    const QList<QContact> contacts(testContacts());
+    const QByteArray data(write(contacts));
+    QVERIFY(!data.isEmpty());
+
+    QContactBinaryReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+    QVERIFY(reader.isValid());
+    QCOMPARE(reader.contactCount(), contacts.size());
+    QCOMPARE(reader.indexOf(QByteArrayLiteral("nobody")), -1);
+
+    foreach (const QContact &expected, contacts) {
+        const int index = reader.indexOf(expected.id().localId());
+        QVERIFY(index != -1);
+        QCOMPARE(reader.localId(index), expected.id().localId());
+        QCOMPARE(reader.collectionLocalId(index), expected.collectionId().localId());
+
+        const QContact decoded(reader.contact(index, TestUri));
+        QCOMPARE(decoded, expected);
+        QCOMPARE(decoded.collectionId(), expected.collectionId());
+        QCOMPARE(decoded.details(), expected.details());
+        QCOMPARE(decoded.type(), expected.type());
+        foreach (const QContactDetail &detail, expected.details())
+            QCOMPARE(decoded.details(detail.type()).first().accessConstraints(), detail.accessConstraints());
+    }
+
+    // the preferred detail is restored, even though details have new keys
+    const QContact alice(reader.contact(reader.indexOf(QByteArrayLiteral("alice")), TestUri));
+    QCOMPARE(alice.preferredDetail(QStringLiteral("call")).value(QContactPhoneNumber::FieldNumber).toString(), QStringLiteral("67890"));
+    QCOMPARE(alice.detail<QContactPhoneNumber>().subTypes(), QList<int>() << QContactPhoneNumber::SubTypeMobile << QContactPhoneNumber::SubTypeVoice);
+    QCOMPARE(alice.detail<QContactBirthday>().dateTime(), QDateTime(QDate(1852, 5, 4), QTime(12, 0)));
+
+    // contacts in the same collection share a key
+    const int carol = reader.indexOf(QByteArrayLiteral("carol"));
+    QCOMPARE(reader.collectionKey(carol), reader.collectionKey(reader.indexOf(QByteArrayLiteral("alice"))));
+    QVERIFY(reader.collectionKey(carol) != reader.collectionKey(reader.indexOf(QByteArrayLiteral("bob"))));
+}
+
+void tst_QContactBinaryFormat::partialDecode()
+{
+    const QByteArray data(write(testContacts()));
+    QContactBinaryReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+    QVERIFY(reader.isValid());
+
+    const int index = reader.indexOf(QByteArrayLiteral("alice"));
+    QSet<QContactDetail::DetailType> types;
+    types << QContactDetail::TypePhoneNumber;
+    const QContact alice(reader.contact(index, TestUri, types));
+
+    // the type is always decoded, first, with only the requested details after it
+    QCOMPARE(alice.details().size(), 3);
+    QCOMPARE(alice.details().first().type(), QContactDetail::TypeType);
+    QCOMPARE(alice.details(QContactDetail::TypePhoneNumber).size(), 2);
+    QVERIFY(alice.detail<QContactName>().isEmpty());
+    QCOMPARE(alice.id(), QContactId(TestUri, QByteArrayLiteral("alice")));
+
+    // decoded contacts do not refer to the data
+    QByteArray copy(data);
+    QContact decoded;
+    {
+        QContactBinaryReader copyReader(reinterpret_cast<const uchar *>(copy.constData()), copy.size());
+        decoded = copyReader.contact(index, TestUri);
+    }
+    copy.fill('\0');
+    QCOMPARE(decoded.detail<QContactName>().firstName(), QStringLiteral("Alice"));
+    QCOMPARE(decoded.id().localId(), QByteArrayLiteral("alice"));
+}
+
+void tst_QContactBinaryFormat::invalidData()
+{
+    QVERIFY(!QContactBinaryReader().isValid());
+    QCOMPARE(QContactBinaryReader().contactCount(), 0);
+
+    const QByteArray garbage(64, 'x');
+    QVERIFY(!QContactBinaryReader(reinterpret_cast<const uchar *>(garbage.constData()), garbage.size()).isValid());
+
+    const QByteArray data(write(testContacts()));
+    QVERIFY(QContactBinaryReader(reinterpret_cast<const uchar *>(data.constData()), data.size()).isValid());
+    QVERIFY(!QContactBinaryReader(reinterpret_cast<const uchar *>(data.constData()), data.size() - 1).isValid());
+    QVERIFY(!QContactBinaryReader(reinterpret_cast<const uchar *>(data.constData()), 8).isValid());
+
+    // an empty store is valid
+    QContactBinaryWriter writer;
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(writer.write(&buffer));
+    QContactBinaryReader empty(reinterpret_cast<const uchar *>(buffer.data().constData()), buffer.data().size());
+    QVERIFY(empty.isValid());
+    QCOMPARE(empty.contactCount(), 0);
+    QCOMPARE(empty.indexOf(QByteArrayLiteral("alice")), -1);
+
+    // counts which would wrap around in 32-bit size checks are rejected, not read past the data
+    QList<QContact> contacts(testContacts());
+    QContactExtendedDetail aliases;
+    aliases.setName(QStringLiteral("aliases"));
+    aliases.setData(QStringList() << QStringLiteral("Caz") << QStringLiteral("Caroline"));
+    contacts[2].saveDetail(&aliases);
+    QByteArray corrupt(write(contacts));
+    QVERIFY(!corrupt.isEmpty());
+
+    const quint32 valueCount = word(corrupt, 6 * sizeof(quint32));
+    const quint32 valueOffset = word(corrupt, 7 * sizeof(quint32));
+    quint32 stringList = 0xffffffff;
+    for (quint32 i = 0; i < valueCount; ++i) {
+        const quint32 record = valueOffset + 2 * i * sizeof(quint32);
+        if ((word(corrupt, record) >> 16) == 5)     // a string list value
+            stringList = word(corrupt, record + sizeof(quint32));
+    }
+    QVERIFY(stringList != 0xffffffff);
+    qToLittleEndian<quint32>(0xffffffff, corrupt.data() + stringOffset(corrupt, stringList));
+
+    // alice's contact record is the first, and has preferences
+    const quint32 preferences = word(corrupt, word(corrupt, 3 * sizeof(quint32)) + 2 * sizeof(quint32));
+    qToLittleEndian<quint32>(0x80000000, corrupt.data() + stringOffset(corrupt, preferences));
+
+    QContactBinaryReader reader(reinterpret_cast<const uchar *>(corrupt.constData()), corrupt.size());
+    QVERIFY(reader.isValid());
+    const QContact alice(reader.contact(reader.indexOf(QByteArrayLiteral("alice")), TestUri));
+    QCOMPARE(alice.detail<QContactName>().firstName(), QStringLiteral("Alice"));
+    QVERIFY(alice.preferredDetail(QStringLiteral("call")).isEmpty());
+    const QContact carol(reader.contact(reader.indexOf(QByteArrayLiteral("carol")), TestUri));
+    QCOMPARE(carol.detail<QContactEmailAddress>().emailAddress(), QStringLiteral("carol@example.com"));
+    QCOMPARE(carol.detail<QContactExtendedDetail>().name(), QStringLiteral("aliases"));
+    QVERIFY(!carol.detail<QContactExtendedDetail>().data().isValid());
+
+    // the writer refuses field numbers which don't fit in the value records
+    QContact dave;
+    dave.setId(QContactId(TestUri, QByteArrayLiteral("dave")));
+    QContactNote note;
+    QVERIFY(note.setValue(0x10000, QStringLiteral("too far")));
+    dave.saveDetail(&note);
+    QContactBinaryWriter unrepresentable;
+    unrepresentable.addContact(dave);
+    QBuffer refused;
+    refused.open(QIODevice::WriteOnly);
+    QVERIFY(!unrepresentable.write(&refused));
+    QVERIFY(refused.data().isEmpty());
+}
+
+void tst_QContactBinaryFormat::mappedEngine()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path(dir.filePath(QStringLiteral("contacts.bin")));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QContactBinaryWriter writer;
+        foreach (const QContact &contact, testContacts())
+            writer.addContact(contact);
+        QVERIFY(writer.write(&file));
+    }
+
+    QMap<QString, QString> parameters;
+    parameters.insert(QStringLiteral("file"), path);
+    QContactManager manager(QStringLiteral("mapped"), parameters);
+    QCOMPARE(manager.managerName(), QStringLiteral("mapped"));
+    QCOMPARE(manager.contactIds().size(), 3);
+    QCOMPARE(manager.collections().size(), 1);
+
+    // ids are given the engine's manager URI
+    const QContactId aliceId(manager.managerUri(), QByteArrayLiteral("alice"));
+    QContact alice(manager.contact(aliceId));
+    QCOMPARE(manager.error(), QContactManager::NoError);
+    QCOMPARE(alice.id(), aliceId);
+    QCOMPARE(alice.detail<QContactName>().firstName(), QStringLiteral("Alice"));
+    QCOMPARE(alice.collectionId(), QContactCollectionId(manager.managerUri(), QByteArrayLiteral("collection")));
+
+    QContactDetailFilter filter;
+    filter.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    filter.setValue(QStringLiteral("67890"));
+    QCOMPARE(manager.contactIds(filter), QList<QContactId>() << aliceId);
+
+    // the fetch hint limits the details of the results, not those which are filtered on
+    QContactFetchHint hint;
+    hint.setDetailTypesHint(QList<QContactDetail::DetailType>() << QContactDetail::TypeName);
+    QList<QContact> fetched(manager.contacts(filter, QList<QContactSortOrder>(), hint));
+    QCOMPARE(fetched.size(), 1);
+    QCOMPARE(fetched.first().detail<QContactName>().lastName(), QStringLiteral("Liddell"));
+    QVERIFY(fetched.first().details(QContactDetail::TypePhoneNumber).isEmpty());
+
+    QContactSortOrder byEmail;
+    byEmail.setDetailType(QContactEmailAddress::Type, QContactEmailAddress::FieldEmailAddress);
+    byEmail.setBlankPolicy(QContactSortOrder::BlanksLast);
+    QList<QContactId> sorted(manager.contactIds(QList<QContactSortOrder>() << byEmail));
+    QCOMPARE(sorted.size(), 3);
+    QCOMPARE(sorted.first().localId(), QByteArrayLiteral("carol"));
+
+    QContactFetchByIdRequest request;
+    request.setManager(&manager);
+    request.setIds(QList<QContactId>() << aliceId << QContactId(manager.managerUri(), QByteArrayLiteral("nobody")));
+    QVERIFY(request.start());
+    QVERIFY(request.isFinished());
+    QCOMPARE(request.contacts().size(), 2);
+    QCOMPARE(request.contacts().first().id(), aliceId);
+    QCOMPARE(request.errorMap().value(1), QContactManager::DoesNotExistError);
+
+    // the store is read-only
+    QContact dave;
+    QContactEmailAddress email;
+    email.setEmailAddress(QStringLiteral("dave@example.com"));
+    dave.saveDetail(&email);
+    QVERIFY(!manager.saveContact(&dave));
+    QVERIFY(!manager.removeContact(aliceId));
+    QCOMPARE(manager.contactIds().size(), 3);
+
+    QContactManager missing(QStringLiteral("mapped"), QMap<QString, QString>());
+    QCOMPARE(missing.managerName(), QStringLiteral("invalid"));
+}
+
+QTEST_MAIN(tst_QContactBinaryFormat)
+#include "tst_qcontactbinaryformat.moc"
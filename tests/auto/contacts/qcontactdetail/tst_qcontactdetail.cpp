@@ -57,6 +57,7 @@ private slots:
     void datastream();
     void traits();
     void keys();
+    void keysFromThreads();
     void detailUris();
 };
 
@@ -550,6 +551,40 @@ void tst_QContactDetail::keys()
     QVERIFY(d.key() != d2.key());
 }
 
+void tst_QContactDetail::keysFromThreads()
+{
+    // keys are allocated in per-thread blocks, and must still be unique across threads
+    const int threadCount = 4;
+    const int detailsPerThread = 3000;
+    QList<int> threadKeys[threadCount];
+    QList<QThread *> threads;
+    for (int i = 0; i < threadCount; i++) {
+        QList<int> *keys = &threadKeys[i];
+        threads.append(QThread::create([keys] {
+            for (int j = 0; j < detailsPerThread; j++) {
+                QContactDetail d;
+                keys->append(d.key());
+                d.resetKey();
+                keys->append(d.key());
+            }
+        }));
+    }
+    foreach (QThread *thread, threads)
+        thread->start();
+    foreach (QThread *thread, threads) {
+        QVERIFY(thread->wait());
+        delete thread;
+    }
+
+    QSet<int> allKeys;
+    for (int i = 0; i < threadCount; i++) {
+        QCOMPARE(threadKeys[i].size(), 2 * detailsPerThread);
+        foreach (int key, threadKeys[i])
+            allKeys.insert(key);
+    }
+    QCOMPARE(allKeys.size(), 2 * threadCount * detailsPerThread);
+}
+
 void tst_QContactDetail::detailUris()
 {
     QContactDetail d;
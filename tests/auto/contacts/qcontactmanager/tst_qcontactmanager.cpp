@@ -153,6 +153,9 @@ private slots:
     void ctors();
     void invalidManager();
     void memoryManager();
+    void memoryManagerJournal();
+    void memoryManagerBatchSave();
+    void engineSchema();
     void overrideManager();
     void changeSet();
     void fetchHint();
@@ -264,6 +267,41 @@ public:
 };
 QHash<QMetaMethod, int> QContactLazyEngine::connectionCounts;
 
+/* A backend with a restricted schema, which counts how often it is asked for it */
+class QContactSchemaEngine : public QContactManagerEngine
+{
+public:
+    QContactSchemaEngine() : schemaRequests(0), phoneNumbers(false) {}
+    QString managerName() const {return "schema";}
+
+    /*! \reimp */
+    int managerVersion() const {return 0;}
+
+    QList<QContactType::TypeValues> supportedContactTypes() const
+    {
+        ++schemaRequests;
+        return QList<QContactType::TypeValues>() << QContactType::TypeGroup;
+    }
+    QList<QContactDetail::DetailType> supportedContactDetailTypes() const
+    {
+        ++schemaRequests;
+        QList<QContactDetail::DetailType> types;
+        types << QContactType::Type << QContactName::Type;
+        if (phoneNumbers)
+            types << QContactPhoneNumber::Type;
+        return types;
+    }
+
+    void setPhoneNumbersSupported(bool supported)
+    {
+        phoneNumbers = supported;
+        invalidateSchema();
+    }
+
+    mutable int schemaRequests;
+    bool phoneNumbers;
+};
+
 /* Static lazy engine factory */
 class LazyEngineFactory : public QContactManagerEngineFactory
 {
@@ -1522,6 +1560,241 @@ void tst_QContactManager::memoryManager()
     QCOMPARE(m5.contactIds().count(), 0);
 }
 
+void tst_QContactManager::memoryManagerJournal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QMap<QString, QString> params;
+    params.insert("journal", dir.filePath("contacts"));
+
+    QContactCollectionId collectionId;
+    QContactId aliceId;
+    QContactId bobId;
+    QContactId carolId;
+    {
+        QContactManager m("memory", params);
+
+        QContactCollection collection;
+        collection.setMetaData(QContactCollection::KeyName, QString("Friends"));
+        QVERIFY(m.saveCollection(&collection));
+        collectionId = collection.id();
+
+        QContact alice;
+        QContactName name;
+        name.setFirstName("Alice");
+        alice.saveDetail(&name);
+        alice.setCollectionId(collectionId);
+        QVERIFY(m.saveContact(&alice));
+        aliceId = alice.id();
+
+        QContact bob;
+        name.setFirstName("Bob");
+        bob.saveDetail(&name);
+        QVERIFY(m.saveContact(&bob));
+        bobId = bob.id();
+
+        QContact carol;
+        name.setFirstName("Carol");
+        carol.saveDetail(&name);
+        QVERIFY(m.saveContact(&carol));
+        carolId = carol.id();
+
+        QContactRelationship relationship;
+        relationship.setFirst(aliceId);
+        relationship.setSecond(bobId);
+        relationship.setRelationshipType(QContactRelationship::HasManager());
+        QVERIFY(m.saveRelationship(&relationship));
+
+        QVERIFY(m.removeContact(carolId));
+        QVERIFY(m.setSelfContactId(bobId));
+
+        name = alice.detail(QContactName::Type);
+        name.setLastName("Jones");
+        alice.saveDetail(&name);
+        QVERIFY(m.saveContact(&alice));
+    }
+
+    // the store is anonymous, so the ids are given the new manager's URI
+    {
+        QContactManager m("memory", params);
+        const QContactId alice(m.managerUri(), aliceId.localId());
+        const QContactId bob(m.managerUri(), bobId.localId());
+
+        QCOMPARE(m.contactIds().count(), 2);
+        QVERIFY(m.contactIds().contains(alice));
+        QVERIFY(m.contactIds().contains(bob));
+        QCOMPARE(m.contact(alice).detail(QContactName::Type).value(QContactName::FieldLastName).toString(), QString("Jones"));
+        QCOMPARE(m.contact(alice).collectionId(), QContactCollectionId(m.managerUri(), collectionId.localId()));
+        QCOMPARE(m.collection(m.contact(alice).collectionId()).metaData(QContactCollection::KeyName).toString(), QString("Friends"));
+        QCOMPARE(m.selfContactId(), bob);
+
+        const QList<QContactRelationship> relationships = m.relationships(QContactRelationship::HasManager(), alice);
+        QCOMPARE(relationships.count(), 1);
+        QCOMPARE(relationships.at(0).second(), bob);
+        QCOMPARE(m.contact(bob).relationships().count(), 1);
+
+        // removed contacts' ids are not handed out again
+        QContact dave;
+        QContactName name;
+        name.setFirstName("Dave");
+        dave.saveDetail(&name);
+        QVERIFY(m.saveContact(&dave));
+        QVERIFY(dave.id().localId() != carolId.localId());
+
+        // enough changes to compact the journal into a snapshot
+        QContactNote note;
+        note.setNote(QString(200, QLatin1Char('x')));
+        for (int i = 0; i < 1000; ++i) {
+            QContact contact;
+            contact.saveDetail(&note);
+            QVERIFY(m.saveContact(&contact));
+        }
+    }
+
+    QVERIFY(QFile::exists(dir.filePath("contacts.snapshot")));
+    {
+        QContactManager m("memory", params);
+        QCOMPARE(m.contactIds().count(), 1003);
+        QCOMPARE(m.selfContactId(), QContactId(m.managerUri(), bobId.localId()));
+        QCOMPARE(m.relationships(QContactRelationship::HasManager()).count(), 1);
+    }
+}
+
+void tst_QContactManager::memoryManagerBatchSave()
+{
+    QContactManager m("memory");
+
+    QList<QContact> contacts;
+    for (int i = 0; i < 100; ++i) {
+        QContact c;
+        QContactName name;
+        name.setFirstName(QString::number(i));
+        c.saveDetail(&name);
+        contacts.append(c);
+    }
+    QVERIFY(m.saveContacts(&contacts));
+    QCOMPARE(m.contactIds().count(), 100);
+
+    // the whole batch is stamped with one time
+    const QDateTime created = contacts.first().detail<QContactTimestamp>().created();
+    QVERIFY(created.isValid());
+    foreach (const QContact &c, contacts) {
+        QVERIFY(!c.id().isNull());
+        QCOMPARE(c.detail<QContactTimestamp>().created(), created);
+        QCOMPARE(c.detail<QContactTimestamp>().lastModified(), created);
+    }
+
+    // contacts after a removed one are still found by id
+    QVERIFY(m.removeContact(contacts.at(10).id()));
+    contacts.removeAt(10);
+
+    QMap<int, QContactManager::Error> errorMap;
+    for (int i = 0; i < contacts.size(); ++i) {
+        QContactName name = contacts.at(i).detail<QContactName>();
+        name.setLastName(QStringLiteral("Saved"));
+        contacts[i].saveDetail(&name);
+    }
+    QContact missing;
+    missing.setId(QContactId(m.managerUri(), QByteArrayLiteral("missing")));
+    contacts.insert(50, missing);
+    QVERIFY(!m.saveContacts(&contacts, &errorMap));
+    QCOMPARE(errorMap.size(), 1);
+    QCOMPARE(errorMap.value(50), QContactManager::DoesNotExistError);
+    contacts.removeAt(50);
+
+    QCOMPARE(m.contactIds().count(), 99);
+    foreach (const QContact &c, contacts) {
+        const QContact stored = m.contact(c.id());
+        QCOMPARE(stored.detail<QContactName>().lastName(), QStringLiteral("Saved"));
+        QCOMPARE(stored.detail<QContactName>().firstName(), c.detail<QContactName>().firstName());
+        QCOMPARE(stored.detail<QContactTimestamp>().created(), created);
+        QCOMPARE(stored.detail<QContactTimestamp>().lastModified(), contacts.first().detail<QContactTimestamp>().lastModified());
+    }
+
+    // partial saves use the same path
+    QList<QContact> partial;
+    partial << m.contact(contacts.last().id());
+    QContactPhoneNumber phone;
+    phone.setNumber(QStringLiteral("12345"));
+    partial[0].saveDetail(&phone);
+    QVERIFY(m.saveContacts(&partial, QList<QContactDetail::DetailType>() << QContactPhoneNumber::Type));
+    QCOMPARE(m.contact(contacts.last().id()).detail<QContactPhoneNumber>().number(), QStringLiteral("12345"));
+    QCOMPARE(m.contact(contacts.last().id()).detail<QContactName>().lastName(), QStringLiteral("Saved"));
+
+    // batch removals keep the remaining contacts in order and found by id
+    QList<QContactId> removed;
+    QList<QContactId> remaining;
+    for (int i = 0; i < contacts.size(); ++i) {
+        if (i % 3 == 0)
+            removed.append(contacts.at(i).id());
+        else
+            remaining.append(contacts.at(i).id());
+    }
+    QVERIFY(m.removeContacts(removed));
+    QCOMPARE(m.contactIds(), remaining);
+    foreach (const QContactId &id, remaining)
+        QCOMPARE(m.contact(id).id(), id);
+    foreach (const QContactId &id, removed)
+        QVERIFY(m.contact(id).isEmpty());
+
+    QVERIFY(m.removeContact(remaining.takeLast()));
+    QVERIFY(m.removeContact(remaining.takeFirst()));
+    QCOMPARE(m.contactIds(), remaining);
+    foreach (const QContactId &id, remaining)
+        QCOMPARE(m.contact(id).id(), id);
+}
+
+void tst_QContactManager::engineSchema()
+{
+    QContactSchemaEngine engine;
+    QContactManager::Error error = QContactManager::UnspecifiedError;
+
+    QContact group;
+    group.setType(QContactType::TypeGroup);
+    QContactName name;
+    name.setFirstName("Group");
+    group.saveDetail(&name);
+    QVERIFY(engine.validateContact(group, &error));
+    QCOMPARE(error, QContactManager::NoError);
+
+    // the default type is not in this engine's schema
+    QContact contact;
+    QVERIFY(!engine.validateContact(contact, &error));
+    QCOMPARE(error, QContactManager::InvalidContactTypeError);
+
+    QContactPhoneNumber phone;
+    phone.setNumber("12345");
+    group.saveDetail(&phone);
+    QVERIFY(!engine.validateContact(group, &error));
+    QCOMPARE(error, QContactManager::InvalidDetailError);
+
+    // the schema is read once, not for each validation
+    QCOMPARE(engine.schemaRequests, 2);
+
+    // until the engine says that it changed
+    engine.setPhoneNumbersSupported(true);
+    QVERIFY(engine.validateContact(group, &error));
+    QCOMPARE(error, QContactManager::NoError);
+    QVERIFY(engine.validateContact(group, &error));
+    QCOMPARE(engine.schemaRequests, 4);
+
+    // a new engine reads its own schema
+    {
+        QContactSchemaEngine other;
+        QVERIFY(!other.validateContact(group, &error));
+        QCOMPARE(error, QContactManager::InvalidDetailError);
+        QCOMPARE(other.schemaRequests, 2);
+    }
+
+    // the memory engine accepts what the default schema allows
+    QContactManager m("memory");
+    QVERIFY(m.saveContact(&group));
+    QContact facet;
+    facet.setType(QContactType::TypeFacet);
+    QVERIFY(!m.saveContact(&facet));
+    QCOMPARE(m.error(), QContactManager::InvalidContactTypeError);
+}
+
 void tst_QContactManager::overrideManager()
 {
     QString defaultStore = QContactManager::availableManagers().value(0);
@@ -26,85 +26,96 @@
 **
 ****************************************************************************/
 
-#include <malloc.h>
 #include <QtTest/QtTest>
 
 #include <QtContacts/qcontacts.h>
 
+#include <stdlib.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define MEMUSAGE_HAVE_MALLINFO2
+#endif
+
 //TESTED_COMPONENT=src/contacts
 
 QTCONTACTS_USE_NAMESPACE
 
-// Define global op new so we can track some amount of allocations
-static qulonglong cAllocated = 0;
-static qulonglong nAllocations = 0;
+// Replace the global operator new and delete so we can count allocations.  This is standard C++,
+// unlike hooking malloc, but the replacement doesn't reach into DLLs on Windows.  Detail privates,
+// their pool slabs and variant payloads all come from operator new.
+static QBasicAtomicInteger<qulonglong> cAllocated = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInteger<qulonglong> nAllocations = Q_BASIC_ATOMIC_INITIALIZER(0);
 
-/*
-void * operator new(size_t sz)
+void *operator new(size_t sz)
 {
-    nAllocations++;
-    cAllocated += sz;
-    return malloc(sz);
+    nAllocations.fetchAndAddRelaxed(1);
+    cAllocated.fetchAndAddRelaxed(sz);
+    void *block = malloc(sz ? sz : 1);
+    if (!block)
+        qBadAlloc();
+    return block;
 }
-void * operator new[](size_t sz)
+void *operator new[](size_t sz)
 {
-    nAllocations++;
-    cAllocated += sz;
-    return malloc(sz);
+    return operator new(sz);
 }
-void operator delete(void * block)
+void operator delete(void *block) noexcept
 {
-    if (block)
-        free(block);
+    free(block);
 }
-
-void operator delete[](void *block)
+void operator delete[](void *block) noexcept
 {
-    if (block)
-        free(block);
+    free(block);
+}
+void operator delete(void *block, size_t) noexcept
+{
+    free(block);
+}
+void operator delete[](void *block, size_t) noexcept
+{
+    free(block);
 }
-*/
-
 
-// Also hook malloc (with glibc)
-void *(*old_hook)(size_t, const void*);
-void *qmallochook(size_t size, const void* )
+// Qt containers allocate with malloc, which the replacement above doesn't see, so with glibc the
+// growth of the malloc heap is reported as well.  mallinfo2() is used for that because
+// __malloc_hook, which could count the calls, is gone from current glibc.
+static qlonglong mallocHeapInUse()
 {
-    void * ret;
-    nAllocations++;
-    cAllocated += size;
-    __malloc_hook = old_hook;
-    ret = malloc(size);
-    __malloc_hook = qmallochook;
-    return ret;
+#ifdef MEMUSAGE_HAVE_MALLINFO2
+    const struct mallinfo2 info = mallinfo2();
+    return qlonglong(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
 }
 
-// I can't seem to get the __malloc_init_hook method working (C++ mangling?)
-static int qmallocinithook()
+// The detail pool is opt-in, and it has to be enabled before the first detail is created
+static int enableDetailPool()
 {
-    old_hook = __malloc_hook;
-    __malloc_hook = qmallochook;
+    qputenv("QTCONTACTS_DETAIL_POOL", "1");
     return 1;
 }
 
-Q_CONSTRUCTOR_FUNCTION(qmallocinithook);
+Q_CONSTRUCTOR_FUNCTION(enableDetailPool);
 
 class QMemUsed
 {
 public:
-    QMemUsed() : mLabel(0), mAllocated(cAllocated), mAllocations(nAllocations), mItems(0)
+    QMemUsed() : mLabel(0), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(0)
     {
     }
-    QMemUsed(const char* name) : mLabel(name), mAllocated(cAllocated), mAllocations(nAllocations), mItems(0)
+    QMemUsed(const char* name) : mLabel(name), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(0)
     {
     }
-    QMemUsed(const char* name, int nItems) : mLabel(name), mAllocated(cAllocated), mAllocations(nAllocations), mItems(nItems)
+    QMemUsed(const char* name, int nItems) : mLabel(name), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(nItems)
     {
     }
     ~QMemUsed()
     {
-        mAllocated = cAllocated - mAllocated;
-        mAllocations = nAllocations - mAllocations;
+        mAllocated = cAllocated.loadRelaxed() - mAllocated;
+        mAllocations = nAllocations.loadRelaxed() - mAllocations;
+        if (mHeapInUse >= 0)
+            mHeapInUse = mallocHeapInUse() - mHeapInUse;
         QString allocations = mAllocations > 1 ? QString("allocations") : QString("allocation");
         if (mItems > 1) {
             QString msg("%1 bytes in %2 %8 (for %3 x %6 -> %4 bytes, %5 allocations per %7)");
@@ -116,10 +127,13 @@ public:
             QString msg("%1 bytes in %2 %3");
             qDebug() << msg.arg(mAllocated).arg(mAllocations).arg(allocations).toLatin1().constData();
         }
+        if (mHeapInUse >= 0)
+            qDebug() << QString("malloc heap grew by %1 bytes").arg(mHeapInUse).toLatin1().constData();
     }
     QLatin1String mLabel;
     qulonglong mAllocated;
     qulonglong mAllocations;
+    qlonglong mHeapInUse;
     int mItems;
 };
 
@@ -139,6 +153,7 @@ public slots:
 private slots:
     void single();
     void multiple();
+    void bulk();
 
 private:
     QMemUsed mem;
@@ -310,5 +325,65 @@ void tst_QContactMemUsage::multiple()
 
 }
 
+void tst_QContactMemUsage::bulk()
+{
+    // Detail privates are pooled, so once a bulk operation has released its details, the
+    // next one should allocate (almost) nothing for them
+    qulonglong allocations[3];
+    qlonglong heapGrowth[3];
+    for (int round = 0; round < 3; round++) {
+        QList<QContactDetail> details;
+        details.reserve(3000);
+        const qulonglong before = nAllocations.loadRelaxed();
+        const qlonglong heapBefore = mallocHeapInUse();
+        {
+            QMemUsed m(round == 0 ? "detail in first round" : "detail in later round", 3000);
+            for (int i = 0; i < 1000; i++) {
+                details.append(QContactPhoneNumber());
+                details.append(QContactAddress());
+                details.append(QContactName());
+            }
+        }
+        allocations[round] = nAllocations.loadRelaxed() - before;
+        heapGrowth[round] = mallocHeapInUse() - heapBefore;
+    }
+
+    // Copies made when detaching, as when engines modify the details they fetch.  The blocks
+    // released by the rounds above may already be enough, so the later round must merely not
+    // allocate more than the first.
+    qulonglong copyAllocations[2];
+    {
+        QContactPhoneNumber prototype;
+        prototype.setNumber("1234");
+        for (int round = 0; round < 2; round++) {
+            QList<QContactPhoneNumber> details;
+            details.reserve(1000);
+            const qulonglong before = nAllocations.loadRelaxed();
+            {
+                QMemUsed m(round == 0 ? "detached copy in first round" : "detached copy in later round", 1000);
+                for (int i = 0; i < 1000; i++) {
+                    QContactPhoneNumber copy(prototype);
+                    copy.setSubTypes(QList<int>() << QContactPhoneNumber::SubTypeMobile);
+                    details.append(copy);
+                }
+            }
+            copyAllocations[round] = nAllocations.loadRelaxed() - before;
+        }
+    }
+
+    if (allocations[0] == 0)
+        QSKIP("The allocations of the contacts library are not counted on this platform");
+    QVERIFY(allocations[1] < allocations[0]);
+    QVERIFY(allocations[2] < allocations[0]);
+    QVERIFY(copyAllocations[1] <= copyAllocations[0]);
+#ifdef MEMUSAGE_HAVE_MALLINFO2
+    // the details of later rounds reuse the slabs which the first round left in the pool
+    QVERIFY(heapGrowth[1] < heapGrowth[0]);
+    QVERIFY(heapGrowth[2] < heapGrowth[0]);
+#else
+    Q_UNUSED(heapGrowth);
+#endif
+}
+
 QTEST_MAIN(tst_QContactMemUsage)
 #include "tst_qcontactmemusage.moc"
@@ -113,6 +113,207 @@ property Contact testContact
             model.autoUpdate = false;
         }
 
+        function test_modelRoles()
+        {
+            var model = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "ContactModel {" +
+                        "manager: \"memory\";" +
+                        "autoUpdate:true;" +
+                    "}",
+                    testHelper);
+            var spy = Qt.createQmlObject(
+                    "import QtTest 1.0;" +
+                    "SignalSpy {" +
+                        "signalName: \"contactsChanged\";" +
+                    "}",
+                    testHelper);
+            contactsChangedSpy = spy;
+            contactsChangedSpy.target = model;
+            testHelper.model = model;
+            testHelper.emptyContactsDb();
+
+            testContact = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "Contact {" +
+                        "DisplayLabel { label: 'Alice In Wonderland' }" +
+                        "PhoneNumber { number: '99999999' }" +
+                        "Avatar { imageUrl: 'http://example.com/alice.png' }" +
+                    "}",
+                    testHelper);
+            contactsChangedSpy.clear()
+            model.saveContact(testContact)
+            waitForContactsChanged (1)
+
+            // the delegate reads the lightweight roles next to the contact role
+            var view = Qt.createQmlObject(
+                    "import QtQuick 2.0;" +
+                    "Repeater {" +
+                        "delegate: Item {" +
+                            "property string label: display;" +
+                            "property string number: phoneNumber;" +
+                            "property url avatar: avatarUrl;" +
+                            "property string contactId: contact.contactId;" +
+                        "}" +
+                    "}",
+                    testHelper);
+            view.model = model;
+            compare(view.count, 1)
+            compare(view.itemAt(0).label, "Alice In Wonderland")
+            compare(view.itemAt(0).number, "99999999")
+            compare(view.itemAt(0).avatar, "http://example.com/alice.png")
+            compare(view.itemAt(0).contactId, model.contacts[0].contactId)
+
+            // the roles follow changes to the contact
+            testContact = model.contacts[0]
+            testContact.phoneNumber.number = "88888"
+            contactsChangedSpy.clear()
+            model.saveContact(testContact)
+            waitForContactsChanged (1)
+            compare(view.itemAt(0).number, "88888")
+
+            // a contact without the details has empty roles
+            testContact.removeDetail(testContact.detail(ContactDetail.PhoneNumber));
+            testContact.removeDetail(testContact.detail(ContactDetail.Avatar));
+            contactsChangedSpy.clear()
+            model.saveContact(testContact)
+            waitForContactsChanged (1)
+            compare(view.itemAt(0).number, "")
+            compare(view.itemAt(0).avatar, "")
+
+            view.destroy();
+            testHelper.emptyContactsDb();
+            model.autoUpdate = false;
+        }
+
+        function test_progressiveLoading()
+        {
+            // the memory backend delivers the fetch results in batches of 100 contacts
+            var contactCount = 250;
+            var writer = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "ContactModel {" +
+                        "manager: \"memory\";" +
+                        "autoUpdate:false;" +
+                    "}",
+                    testHelper);
+            for (var i = 0; i < contactCount; i++) {
+                var newContact = Qt.createQmlObject(
+                        "import QtContacts 5.0;" +
+                        "Contact { Name { firstName: 'Batch" + i + "' } }",
+                        testHelper);
+                writer.saveContact(newContact);
+            }
+
+            var model = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "ContactModel {" +
+                        "manager: \"memory\";" +
+                        "autoUpdate:true;" +
+                    "}",
+                    testHelper);
+            var insertedSpy = Qt.createQmlObject(
+                    "import QtTest 1.0;" +
+                    "SignalSpy {" +
+                        "signalName: \"rowsInserted\";" +
+                    "}",
+                    testHelper);
+            insertedSpy.target = model;
+            for (var waited = 0; model.contacts.length < contactCount && waited < 5000; waited += 50)
+                wait(50);
+            wait(100); // any contact queued twice would be inserted by now
+            compare(model.contacts.length, contactCount)
+
+            // every contact is inserted once, whatever the batches were
+            var insertedRows = 0;
+            for (i = 0; i < insertedSpy.count; i++)
+                insertedRows += insertedSpy.signalArguments[i][2] - insertedSpy.signalArguments[i][1] + 1;
+            compare(insertedRows, contactCount)
+            var ids = {};
+            var contactIds = [];
+            for (i = 0; i < model.contacts.length; i++) {
+                var contactId = model.contacts[i].contactId;
+                verify(ids[contactId] === undefined, "contact " + contactId + " is in the model once")
+                ids[contactId] = true;
+                contactIds.push(contactId);
+            }
+
+            writer.removeContacts(contactIds);
+            for (waited = 0; model.contacts.length > 0 && waited < 5000; waited += 50)
+                wait(50);
+            compare(model.contacts.length, 0)
+            model.autoUpdate = false;
+        }
+
+        function test_autoUpdateInterval()
+        {
+            var writer = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "ContactModel {" +
+                        "manager: \"memory\";" +
+                        "autoUpdate:false;" +
+                    "}",
+                    testHelper);
+            var model = Qt.createQmlObject(
+                    "import QtContacts 5.0;" +
+                    "ContactModel {" +
+                        "manager: \"memory\";" +
+                        "autoUpdate:true;" +
+                        "autoUpdateInterval:200;" +
+                    "}",
+                    testHelper);
+            compare(model.autoUpdateInterval, 200)
+            var spy = Qt.createQmlObject(
+                    "import QtTest 1.0;" +
+                    "SignalSpy {" +
+                        "signalName: \"contactsChanged\";" +
+                    "}",
+                    testHelper);
+            spy.target = model;
+            var insertedSpy = Qt.createQmlObject(
+                    "import QtTest 1.0;" +
+                    "SignalSpy {" +
+                        "signalName: \"rowsInserted\";" +
+                    "}",
+                    testHelper);
+            insertedSpy.target = model;
+            wait(100); // the initial fetch of the empty database
+            compare(model.contacts.length, 0)
+
+            // the notifications of all the saves are applied with one fetch
+            spy.clear();
+            insertedSpy.clear();
+            for (var i = 0; i < 3; i++) {
+                var newContact = Qt.createQmlObject(
+                        "import QtContacts 5.0;" +
+                        "Contact { Name { firstName: 'Coalesced" + i + "' } }",
+                        testHelper);
+                writer.saveContact(newContact);
+            }
+            spy.wait();
+            wait(300); // no further update follows
+            compare(spy.count, 1, "Changes were not coalesced")
+            compare(model.contacts.length, 3)
+            var insertedRows = 0;
+            for (i = 0; i < insertedSpy.count; i++)
+                insertedRows += insertedSpy.signalArguments[i][2] - insertedSpy.signalArguments[i][1] + 1;
+            compare(insertedRows, 3)
+            var names = [];
+            var contactIds = [];
+            for (i = 0; i < model.contacts.length; i++) {
+                names.push(model.contacts[i].name.firstName);
+                contactIds.push(model.contacts[i].contactId);
+            }
+            names.sort();
+            compare(names, ["Coalesced0", "Coalesced1", "Coalesced2"])
+
+            writer.removeContacts(contactIds);
+            for (var waited = 0; model.contacts.length > 0 && waited < 5000; waited += 50)
+                wait(50);
+            compare(model.contacts.length, 0)
+            model.autoUpdate = false;
+        }
+
         property Component component
         property ContactsTestHelper testHelper
 
@@ -7,6 +7,7 @@ SUBDIRS += \
     qorganizeritemdetail \
     qorganizeritemdetails \
     qorganizeritemfilter \
+    qorganizeritemmemusage \
     qorganizeritemsortorder \
     qorganizermanager \
     qorganizermanagerdetails \
@@ -820,6 +820,72 @@ TestCase {
         compare(containsItems[12], false);
     }
 
+    function test_organizermodel_itemsbytimeperiod_data() {
+        return utility.getManagerListData();
+    }
+
+    function test_organizermodel_itemsbytimeperiod(data) {
+        var organizerModel = utility.create_testobject("import QtQuick 2.0\n"
+            + "import QtOrganizer 5.0\n"
+            + "OrganizerModel {\n"
+            + "  manager: '" + data.managerToBeTested + "'\n"
+            + "  startPeriod: new Date(2011, 12, 8)\n"
+            + "  endPeriod: new Date(2011, 12, 9)\n"
+            + "}\n", modelTests);
+        utility.init(organizerModel)
+        utility.waitModelChange()
+        utility.empty_calendar()
+
+        var event1 = utility.create_testobject("import QtQuick 2.0\n"
+            + "import QtOrganizer 5.0\n"
+            + "Event {\n"
+            + "  startDateTime: new Date(2011, 12, 8, 10, 0)\n"
+            + "  endDateTime: new Date(2011, 12, 8, 11, 0)\n"
+            + "}\n", modelTests);
+
+        var event2 = utility.create_testobject("import QtQuick 2.0\n"
+            + "import QtOrganizer 5.0\n"
+            + "Event {\n"
+            + "  startDateTime: new Date(2011, 12, 8, 9, 0)\n"
+            + "  endDateTime: new Date(2011, 12, 8, 18, 0)\n"
+            + "}\n", modelTests);
+
+        var todo3 = utility.create_testobject("import QtQuick 2.0\n"
+            + "import QtOrganizer 5.0\n"
+            + "Todo {\n"
+            + "  dueDateTime: new Date(2011, 12, 8, 15, 0)\n"
+            + "}\n", modelTests);
+
+        organizerModel.saveItem(event1);
+        utility.waitModelChange()
+        organizerModel.saveItem(event2);
+        utility.waitModelChange()
+        organizerModel.saveItem(todo3);
+        utility.waitModelChange()
+        compare(organizerModel.items.length, 3);
+
+        compare(organizerModel.itemsByTimePeriod(new Date(2011, 12, 8, 10, 30), new Date(2011, 12, 8, 10, 45)).length, 2);
+        compare(organizerModel.itemsByTimePeriod(new Date(2011, 12, 8, 14, 0), new Date(2011, 12, 8, 16, 0)).length, 2);
+        compare(organizerModel.itemsByTimePeriod(new Date(2011, 12, 8, 19, 0), new Date(2011, 12, 8, 20, 0)).length, 0);
+        compare(organizerModel.itemsByTimePeriod(new Date(2011, 12, 8, 16, 0)).length, 1);
+        compare(organizerModel.itemIds(new Date(2011, 12, 8, 12, 0), new Date(2011, 12, 8, 13, 0)).length, 2);
+        compare(organizerModel.itemIds(new Date(2011, 12, 8, 9, 30)).length, 1);
+        verify(!organizerModel.containsItems(new Date(2011, 12, 8, 19, 0), new Date(2011, 12, 8, 20, 0)));
+
+        // results must follow changes made to the items in the model
+        var item;
+        for (var i = 0; i < organizerModel.items.length; i++) {
+            if (organizerModel.items[i].startDateTime.getTime() === new Date(2011, 12, 8, 10, 0).getTime())
+                item = organizerModel.items[i];
+        }
+        item.startDateTime = new Date(2011, 12, 8, 19, 0);
+        item.endDateTime = new Date(2011, 12, 8, 19, 30);
+        compare(organizerModel.itemsByTimePeriod(new Date(2011, 12, 8, 19, 0), new Date(2011, 12, 8, 20, 0)).length, 1);
+        verify(organizerModel.containsItems(new Date(2011, 12, 8, 19, 0), new Date(2011, 12, 8, 20, 0)));
+
+        utility.empty_calendar()
+    }
+
     function modelChangedSignalTestItems() {
         return [
             // events
@@ -71,6 +71,12 @@ TestCase {
         target: model
     }
 
+    SignalSpy {
+        id: modelResetSpy
+        signalName: "modelReset"
+        target: model
+    }
+
     SignalSpy {
         id: fetchSpy
         signalName: "itemsFetched"
@@ -1016,6 +1022,99 @@ TestCase {
     }
 
 
+    // update() must not reset the model and must reuse the wrappers of unchanged items,
+    // including generated occurrences
+    function test_updateReusesItems() {
+        for (var i in utility.getManagerList()) {
+            model.manager = utility.getManagerList()[i];
+            model.startPeriod = localDate('2012-01-01');
+            model.endPeriod = localDate('2012-01-31');
+            model.autoUpdate = true;
+            spyManagerChanged.wait(spyWaitDelay)
+            cleanDatabase();
+            compare(model.itemCount, 0, "Model not empty")
+
+            var testEvent = createTestItemFromData({
+                event: {
+                    "displayLabel" : "recevent",
+                    "start" : localDateTime('2012-01-02T14:00:00'),
+                    "end" : localDateTime('2012-01-02T15:00:00'),
+                    "recurrenceDates": [],
+                    "exceptionDates": []
+                },
+                rrule: {
+                    "frequency": RecurrenceRule.Daily,
+                    "limit": 3,
+                    "interval": 1,
+                    "daysOfWeek": [],
+                    "daysOfMonth": [],
+                    "daysOfYear": [],
+                    "monthsOfYear": [],
+                    "positions": [],
+                    "firstDayOfWeek": Qt.Monday
+                }
+            });
+            model.saveItem(testEvent);
+            modelChangedSpy.wait(spyWaitDelay);
+            compare(model.itemCount, 3);
+
+            var oldItems = [];
+            for (var j = 0; j < model.itemCount; j++)
+                oldItems.push(model.items[j]);
+
+            modelResetSpy.clear();
+            modelChangedSpy.clear();
+            model.update();
+            modelChangedSpy.wait(spyWaitDelay);
+            compare(modelResetSpy.count, 0, "Model was reset");
+            compare(model.itemCount, oldItems.length);
+            for (j = 0; j < model.itemCount; j++)
+                verify(model.items[j] === oldItems[j], "Item wrapper was recreated at " + j);
+
+            cleanDatabase();
+            compare(model.itemCount, 0, "Model not empty")
+        }
+    }
+
+
+    // changes reported within autoUpdateInterval must be applied to the model in one go
+    function test_autoUpdateInterval() {
+        for (var i in utility.getManagerList()) {
+            model.manager = utility.getManagerList()[i];
+            model.startPeriod = localDate('2012-01-01');
+            model.endPeriod = localDate('2012-01-31');
+            model.autoUpdate = true;
+            spyManagerChanged.wait(spyWaitDelay)
+            cleanDatabase();
+            compare(model.itemCount, 0, "Model not empty")
+
+            compare(model.autoUpdateInterval, 0);
+            model.autoUpdateInterval = 200;
+            compare(model.autoUpdateInterval, 200);
+
+            modelChangedSpy.clear();
+            for (var j = 0; j < 3; j++) {
+                model.saveItem(createTestItemFromData({
+                    event: {
+                        "displayLabel" : "event" + j,
+                        "start" : localDateTime('2012-01-0' + (j + 2) + 'T14:00:00'),
+                        "end" : localDateTime('2012-01-0' + (j + 2) + 'T15:00:00'),
+                        "recurrenceDates": [],
+                        "exceptionDates": []
+                    }
+                }));
+            }
+            modelChangedSpy.wait(spyWaitDelay);
+            compare(model.itemCount, 3);
+            compare(modelChangedSpy.count, 1, "Changes were not coalesced");
+
+            model.autoUpdateInterval = 0;
+            cleanDatabase();
+            compare(model.itemCount, 0, "Model not empty")
+        }
+    }
+
+
 
 
     // Helper functions
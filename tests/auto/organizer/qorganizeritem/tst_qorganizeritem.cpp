@@ -61,6 +61,7 @@ private slots:
     void emptiness();
     void idComparison();
     void idHash();
+    void idManagerUri();
     void idStringFunctions();
     void hash();
     void datastream();
@@ -620,6 +621,27 @@ void tst_QOrganizerItem::idHash()
     QCOMPARE(set.size(), 3);
 }
 
+void tst_QOrganizerItem::idManagerUri()
+{
+    // ids built from separate copies of a manager URI refer to the same manager
+    const QString uri(QStringLiteral("qtorganizer:idmanageruri:"));
+    const QString uriCopy(QString::fromLatin1(uri.toLatin1()));
+    const QOrganizerItemId id1(uri, "1");
+    const QOrganizerItemId id2(uriCopy, "1");
+    QCOMPARE(id1, id2);
+    QCOMPARE(id2.managerUri(), uri);
+    QCOMPARE(QOrganizerItemId::fromString(id1.toString()), id1);
+    QCOMPARE(QOrganizerItemId::fromByteArray(id2.toByteArray()), id2);
+
+    // ordering follows the manager URI, not the order in which the URIs were first seen
+    const QOrganizerItemId idZ(QStringLiteral("qtorganizer:idmanageruriz:"), "1");
+    const QOrganizerItemId idY(QStringLiteral("qtorganizer:idmanagerury:"), "2");
+    QVERIFY(idY < idZ);
+    QVERIFY(!(idZ < idY));
+    QVERIFY(id1 < idY);
+    QVERIFY(idY != idZ);
+}
+
 void tst_QOrganizerItem::idStringFunctions()
 {
     // TODO: review test
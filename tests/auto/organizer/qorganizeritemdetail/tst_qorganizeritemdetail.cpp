@@ -56,6 +56,7 @@ private slots:
     void datastream();
     void traits();
     void keys();
+    void keysFromThreads();
 };
 
 tst_QOrganizerItemDetail::tst_QOrganizerItemDetail()
@@ -608,5 +609,39 @@ void tst_QOrganizerItemDetail::keys()
     QVERIFY(d.key() != d2.key());
 }
 
+void tst_QOrganizerItemDetail::keysFromThreads()
+{
+    // keys are allocated in per-thread blocks, and must still be unique across threads
+    const int threadCount = 4;
+    const int detailsPerThread = 3000;
+    QList<int> threadKeys[threadCount];
+    QList<QThread *> threads;
+    for (int i = 0; i < threadCount; i++) {
+        QList<int> *keys = &threadKeys[i];
+        threads.append(QThread::create([keys] {
+            for (int j = 0; j < detailsPerThread; j++) {
+                QOrganizerItemDetail d;
+                keys->append(d.key());
+                d.resetKey();
+                keys->append(d.key());
+            }
+        }));
+    }
+    foreach (QThread *thread, threads)
+        thread->start();
+    foreach (QThread *thread, threads) {
+        QVERIFY(thread->wait());
+        delete thread;
+    }
+
+    QSet<int> allKeys;
+    for (int i = 0; i < threadCount; i++) {
+        QCOMPARE(threadKeys[i].size(), 2 * detailsPerThread);
+        foreach (int key, threadKeys[i])
+            allKeys.insert(key);
+    }
+    QCOMPARE(allKeys.size(), 2 * threadCount * detailsPerThread);
+}
+
 QTEST_MAIN(tst_QOrganizerItemDetail)
 #include "tst_qorganizeritemdetail.moc"
@@ -0,0 +1,5 @@
+include(../../auto.pri)
+
+QT += organizer
+
+SOURCES  += tst_qorganizeritemmemusage.cpp
@@ -0,0 +1,270 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtOrganizer/qorganizer.h>
+
+#include <stdlib.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define MEMUSAGE_HAVE_MALLINFO2
+#endif
+
+//TESTED_COMPONENT=src/organizer
+
+QTORGANIZER_USE_NAMESPACE
+
+// Replace the global operator new and delete so we can count allocations.  This is standard C++,
+// unlike hooking malloc, but the replacement doesn't reach into DLLs on Windows.  Detail privates,
+// their pool slabs and variant payloads all come from operator new.
+static QBasicAtomicInteger<qulonglong> cAllocated = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInteger<qulonglong> nAllocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+void *operator new(size_t sz)
+{
+    nAllocations.fetchAndAddRelaxed(1);
+    cAllocated.fetchAndAddRelaxed(sz);
+    void *block = malloc(sz ? sz : 1);
+    if (!block)
+        qBadAlloc();
+    return block;
+}
+void *operator new[](size_t sz)
+{
+    return operator new(sz);
+}
+void operator delete(void *block) noexcept
+{
+    free(block);
+}
+void operator delete[](void *block) noexcept
+{
+    free(block);
+}
+void operator delete(void *block, size_t) noexcept
+{
+    free(block);
+}
+void operator delete[](void *block, size_t) noexcept
+{
+    free(block);
+}
+
+// Qt containers allocate with malloc, which the replacement above doesn't see, so with glibc the
+// growth of the malloc heap is reported as well.  mallinfo2() is used for that because
+// __malloc_hook, which could count the calls, is gone from current glibc.
+static qlonglong mallocHeapInUse()
+{
+#ifdef MEMUSAGE_HAVE_MALLINFO2
+    const struct mallinfo2 info = mallinfo2();
+    return qlonglong(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+// The detail pool is opt-in, and it has to be enabled before the first detail is created
+static int enableDetailPool()
+{
+    qputenv("QTORGANIZER_DETAIL_POOL", "1");
+    return 1;
+}
+
+Q_CONSTRUCTOR_FUNCTION(enableDetailPool);
+
+class QMemUsed
+{
+public:
+    QMemUsed() : mLabel(0), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(0)
+    {
+    }
+    QMemUsed(const char* name) : mLabel(name), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(0)
+    {
+    }
+    QMemUsed(const char* name, int nItems) : mLabel(name), mAllocated(cAllocated.loadRelaxed()), mAllocations(nAllocations.loadRelaxed()), mHeapInUse(mallocHeapInUse()), mItems(nItems)
+    {
+    }
+    ~QMemUsed()
+    {
+        mAllocated = cAllocated.loadRelaxed() - mAllocated;
+        mAllocations = nAllocations.loadRelaxed() - mAllocations;
+        if (mHeapInUse >= 0)
+            mHeapInUse = mallocHeapInUse() - mHeapInUse;
+        QString allocations = mAllocations > 1 ? QString("allocations") : QString("allocation");
+        if (mItems > 1) {
+            QString msg("%1 bytes in %2 %8 (for %3 x %6 -> %4 bytes, %5 allocations per %7)");
+            qDebug() << msg.arg(mAllocated).arg(mAllocations).arg(mItems).arg(((double)mAllocated) / mItems).arg(((double) mAllocations) / mItems).arg(mLabel).arg(mLabel).arg(allocations).toLatin1().constData();
+        } else if (mLabel.latin1()){
+            QString msg("%1 bytes in %2 %4 for %3");
+            qDebug() << msg.arg(mAllocated).arg(mAllocations).arg(mLabel).arg(allocations).toLatin1().constData();
+        } else {
+            QString msg("%1 bytes in %2 %3");
+            qDebug() << msg.arg(mAllocated).arg(mAllocations).arg(allocations).toLatin1().constData();
+        }
+        if (mHeapInUse >= 0)
+            qDebug() << QString("malloc heap grew by %1 bytes").arg(mHeapInUse).toLatin1().constData();
+    }
+    QLatin1String mLabel;
+    qulonglong mAllocated;
+    qulonglong mAllocations;
+    qlonglong mHeapInUse;
+    int mItems;
+};
+
+class tst_QOrganizerItemMemUsage : public QObject
+{
+Q_OBJECT
+
+private slots:
+    void single();
+    void multiple();
+    void values();
+    void bulk();
+};
+
+void tst_QOrganizerItemMemUsage::single()
+{
+    {
+        QMemUsed m("Description");
+        QOrganizerItemDescription d;
+    }
+
+    {
+        QMemUsed m("Location");
+        QOrganizerItemLocation l;
+    }
+
+    {
+        QMemUsed m("EventTime");
+        QOrganizerEventTime t;
+    }
+}
+
+void tst_QOrganizerItemMemUsage::multiple()
+{
+    {
+        QList<QOrganizerItemDetail> details;
+        QMemUsed m("Description", 100);
+        for (int i = 0; i < 100; i++) {
+            QOrganizerItemDescription d;
+            details.append(d);
+        }
+    }
+
+    {
+        QList<QOrganizerItemDetail> details;
+        QMemUsed m("Location", 100);
+        for (int i = 0; i < 100; i++) {
+            QOrganizerItemLocation l;
+            details.append(l);
+        }
+    }
+}
+
+void tst_QOrganizerItemMemUsage::values()
+{
+    {
+        QString v("Meeting");
+        QMemUsed m("Description with description");
+        QOrganizerItemDescription d;
+        d.setDescription(v);
+    }
+
+    {
+        QMemUsed m("EventTime with start and end");
+        QOrganizerEventTime t;
+        t.setStartDateTime(QDateTime(QDate(2010, 10, 10), QTime(10, 0)));
+        t.setEndDateTime(QDateTime(QDate(2010, 10, 10), QTime(11, 0)));
+    }
+
+    {
+        QMemUsed m("Location with all fields");
+        QOrganizerItemLocation l;
+        l.setLabel("Room 1");
+        l.setLatitude(60.17);
+        l.setLongitude(24.94);
+    }
+
+    {
+        QList<QOrganizerItemDetail> details;
+        QMemUsed m("EventTime with start, end and all-day", 100);
+        for (int i = 0; i < 100; i++) {
+            QOrganizerEventTime t;
+            t.setStartDateTime(QDateTime(QDate(2010, 10, 10), QTime(10, 0)));
+            t.setEndDateTime(QDateTime(QDate(2010, 10, 10), QTime(11, 0)));
+            t.setAllDay(false);
+            details.append(t);
+        }
+    }
+
+    {
+        QMemUsed m("Location with custom fields");
+        QOrganizerItemLocation l;
+        QVariant v = QString("1234");
+        for (int field = 100; field < 110; field++)
+            l.setValue(field, v);
+    }
+}
+
+void tst_QOrganizerItemMemUsage::bulk()
+{
+    // Detail privates are pooled, so later rounds should allocate (almost) nothing for them
+    qulonglong allocations[3];
+    qlonglong heapGrowth[3];
+    for (int round = 0; round < 3; round++) {
+        QList<QOrganizerItemDetail> details;
+        details.reserve(2000);
+        const qulonglong before = nAllocations.loadRelaxed();
+        const qlonglong heapBefore = mallocHeapInUse();
+        {
+            QMemUsed m(round == 0 ? "detail in first round" : "detail in later round", 2000);
+            for (int i = 0; i < 1000; i++) {
+                details.append(QOrganizerItemDescription());
+                details.append(QOrganizerEventTime());
+            }
+        }
+        allocations[round] = nAllocations.loadRelaxed() - before;
+        heapGrowth[round] = mallocHeapInUse() - heapBefore;
+    }
+
+    if (allocations[0] == 0)
+        QSKIP("The allocations of the organizer library are not counted on this platform");
+    QVERIFY(allocations[1] < allocations[0]);
+    QVERIFY(allocations[2] < allocations[0]);
+#ifdef MEMUSAGE_HAVE_MALLINFO2
+    // the details of later rounds reuse the slabs which the first round left in the pool
+    QVERIFY(heapGrowth[1] < heapGrowth[0]);
+    QVERIFY(heapGrowth[2] < heapGrowth[0]);
+#else
+    Q_UNUSED(heapGrowth);
+#endif
+}
+
+QTEST_MAIN(tst_QOrganizerItemMemUsage)
+#include "tst_qorganizeritemmemusage.moc"
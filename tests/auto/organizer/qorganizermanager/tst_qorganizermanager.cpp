@@ -139,6 +139,8 @@ private slots:
     void ctors();
     void invalidManager();
     void memoryManager();
+    void memoryManagerJournal();
+    void memoryManagerJournalCorruptItem();
     void changeSet();
     void fetchHint();
     void testFilterFunction();
@@ -1953,6 +1955,195 @@ void tst_QOrganizerManager::memoryManager()
     QCOMPARE(m5.itemIds().count(), 0);
 }
 
+void tst_QOrganizerManager::memoryManagerJournal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QMap<QString, QString> params;
+    params.insert("journal", dir.filePath("organizer"));
+
+    QOrganizerRecurrenceRule rrule;
+    rrule.setFrequency(QOrganizerRecurrenceRule::Weekly);
+    rrule.setDaysOfWeek(QSet<Qt::DayOfWeek>() << Qt::Monday << Qt::Wednesday);
+    rrule.setLimit(10);
+
+    QOrganizerCollectionId collectionId;
+    QOrganizerItemId eventId;
+    QOrganizerItemId exceptionId;
+    QOrganizerItemId noteId;
+    {
+        QOrganizerManager m("memory", params);
+
+        QOrganizerCollection collection;
+        collection.setMetaData(QOrganizerCollection::KeyName, QString("Work"));
+        QVERIFY(m.saveCollection(&collection));
+        collectionId = collection.id();
+
+        QOrganizerEvent event;
+        event.setDisplayLabel(QStringLiteral("Standup"));
+        event.setStartDateTime(QDateTime(QDate(2010, 1, 4), QTime(9, 0)));
+        event.setEndDateTime(QDateTime(QDate(2010, 1, 4), QTime(9, 15)));
+        event.setRecurrenceRule(rrule);
+        event.setExceptionDates(QSet<QDate>() << QDate(2010, 1, 6));
+        event.setCollectionId(collectionId);
+        QVERIFY(m.saveItem(&event));
+        eventId = event.id();
+
+        QOrganizerEventOccurrence exception;
+        exception.setParentId(eventId);
+        exception.setOriginalDate(QDate(2010, 1, 11));
+        exception.setStartDateTime(QDateTime(QDate(2010, 1, 11), QTime(10, 0)));
+        exception.setEndDateTime(QDateTime(QDate(2010, 1, 11), QTime(10, 15)));
+        exception.setDisplayLabel(QStringLiteral("Late standup"));
+        QVERIFY(m.saveItem(&exception));
+        exceptionId = exception.id();
+
+        QOrganizerNote note;
+        note.setDisplayLabel(QStringLiteral("Removed"));
+        QVERIFY(m.saveItem(&note));
+        QVERIFY(m.removeItem(note.id()));
+        noteId = note.id();
+    }
+
+    // the store is anonymous, so the ids are given the new manager's URI
+    {
+        QOrganizerManager m("memory", params);
+        const QOrganizerItemId event(m.managerUri(), eventId.localId());
+        const QOrganizerItemId exception(m.managerUri(), exceptionId.localId());
+
+        QCOMPARE(m.itemIds().count(), 2);
+        QOrganizerEvent savedEvent = m.item(event);
+        QCOMPARE(savedEvent.displayLabel(), QStringLiteral("Standup"));
+        QCOMPARE(savedEvent.recurrenceRule(), rrule);
+        QCOMPARE(savedEvent.exceptionDates(), QSet<QDate>() << QDate(2010, 1, 6) << QDate(2010, 1, 11));
+        QCOMPARE(savedEvent.collectionId(), QOrganizerCollectionId(m.managerUri(), collectionId.localId()));
+        QCOMPARE(m.collection(savedEvent.collectionId()).metaData(QOrganizerCollection::KeyName).toString(), QString("Work"));
+
+        QOrganizerEventOccurrence savedException = m.item(exception);
+        QCOMPARE(savedException.parentId(), event);
+        QCOMPARE(savedException.originalDate(), QDate(2010, 1, 11));
+
+        // occurrences are generated again from the reloaded rule and exception dates, and the
+        // stored exception takes the place of the one it replaces
+        const QList<QOrganizerItem> occurrences = m.itemOccurrences(savedEvent, QDateTime(QDate(2010, 1, 1), QTime(0, 0)),
+                                                                    QDateTime(QDate(2010, 1, 31), QTime(0, 0)));
+        QVERIFY(!occurrences.isEmpty());
+        bool foundException = false;
+        foreach (const QOrganizerItem &item, occurrences) {
+            const QOrganizerEventOccurrence occurrence(item);
+            QCOMPARE(occurrence.parentId(), event);
+            QVERIFY(occurrence.originalDate() != QDate(2010, 1, 6));
+            if (occurrence.originalDate() == QDate(2010, 1, 11)) {
+                QCOMPARE(occurrence.id(), exception);
+                QCOMPARE(occurrence.startDateTime(), QDateTime(QDate(2010, 1, 11), QTime(10, 0)));
+                foundException = true;
+            }
+        }
+        QVERIFY(foundException);
+
+        // removing the event removes its exception, which was indexed without being decoded
+        QOrganizerNote note;
+        QVERIFY(m.saveItem(&note));
+        QVERIFY(note.id().localId() != noteId.localId());
+        QVERIFY(m.removeItem(event));
+        QCOMPARE(m.itemIds().count(), 1);
+
+        // enough changes to compact the journal into a snapshot
+        QOrganizerEvent recurring;
+        recurring.setStartDateTime(QDateTime(QDate(2010, 1, 4), QTime(9, 0)));
+        recurring.setRecurrenceRule(rrule);
+        recurring.setDescription(QString(200, QLatin1Char('x')));
+        for (int i = 0; i < 1000; ++i) {
+            recurring.setId(QOrganizerItemId());
+            QVERIFY(m.saveItem(&recurring));
+        }
+        eventId = recurring.id();
+    }
+
+    const QStringList snapshotFilter(QStringLiteral("organizer.snapshot.*"));
+    const QStringList snapshots = QDir(dir.path()).entryList(snapshotFilter, QDir::Files);
+    QCOMPARE(snapshots.count(), 1);
+    {
+        QOrganizerManager m("memory", params);
+        QCOMPARE(m.itemIds().count(), 1001);
+        QOrganizerEvent savedEvent = m.item(QOrganizerItemId(m.managerUri(), eventId.localId()));
+        QCOMPARE(savedEvent.recurrenceRule(), rrule);
+        QCOMPARE(savedEvent.description(), QString(200, QLatin1Char('x')));
+        QCOMPARE(m.itemOccurrences(savedEvent, QDate(2010, 1, 1).startOfDay(), QDate(2010, 3, 1).startOfDay()).count(), 10);
+
+        // compact again while the loaded snapshot is mapped: its items, still undecoded, must
+        // stay readable, and it is only replaced once the engine is gone
+        QOrganizerTodo todo;
+        todo.setDescription(QString(200, QLatin1Char('y')));
+        for (int i = 0; i < 2000; ++i) {
+            todo.setId(QOrganizerItemId());
+            QVERIFY(m.saveItem(&todo));
+        }
+        QVERIFY(QDir(dir.path()).entryList(snapshotFilter, QDir::Files).contains(snapshots.first()));
+        QCOMPARE(m.itemsForExport().count(), 3001);
+    }
+
+    const QStringList compacted = QDir(dir.path()).entryList(snapshotFilter, QDir::Files);
+    QCOMPARE(compacted.count(), 1);
+    QVERIFY(compacted.first() != snapshots.first());
+    {
+        QOrganizerManager m("memory", params);
+        QCOMPARE(m.itemIds().count(), 3001);
+    }
+}
+
+void tst_QOrganizerManager::memoryManagerJournalCorruptItem()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QMap<QString, QString> params;
+    params.insert("journal", dir.filePath("organizer"));
+
+    QOrganizerItemId brokenId;
+    QOrganizerItemId intactId;
+    {
+        QOrganizerManager m("memory", params);
+        QOrganizerEvent broken;
+        broken.setDisplayLabel(QStringLiteral("Broken"));
+        broken.setStartDateTime(QDateTime(QDate(2010, 1, 4), QTime(9, 0)));
+        QVERIFY(m.saveItem(&broken));
+        brokenId = broken.id();
+
+        QOrganizerTodo intact;
+        intact.setDisplayLabel(QStringLiteral("Intact"));
+        QVERIFY(m.saveItem(&intact));
+        intactId = intact.id();
+    }
+
+    // give the display label of the first item a value tag which doesn't exist
+    QFile file(dir.filePath("organizer"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    QByteArray label;
+    {
+        QDataStream out(&label, QIODevice::WriteOnly);
+        out << QStringLiteral("Broken");
+    }
+    const int index = data.indexOf(label);
+    QVERIFY(index > 0);
+    data[index - 1] = char(0xff);
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(data), qint64(data.size()));
+    file.close();
+
+    // items are only decoded when accessed, so the corrupt one is found then, and dropped
+    QOrganizerManager m("memory", params);
+    const QOrganizerItemId broken(m.managerUri(), brokenId.localId());
+    const QOrganizerItemId intact(m.managerUri(), intactId.localId());
+    QCOMPARE(m.itemIds().count(), 2);
+    const QString warning = QStringLiteral("Dropping organizer item %1, which is corrupt in the journal").arg(broken.toString());
+    QTest::ignoreMessage(QtWarningMsg, qPrintable(warning));
+    QVERIFY(m.item(broken).isEmpty());
+    QCOMPARE(m.error(), QOrganizerManager::DoesNotExistError);
+    QCOMPARE(m.itemIds(), QList<QOrganizerItemId>() << intact);
+    QCOMPARE(m.item(intact).displayLabel(), QStringLiteral("Intact"));
+}
+
 void tst_QOrganizerManager::recurrenceWithGenerator_data()
 {
     QTest::addColumn<QString>("uri");
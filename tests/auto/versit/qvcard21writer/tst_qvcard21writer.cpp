@@ -31,6 +31,7 @@
 #include "tst_qvcard21writer.h"
 #ifdef QT_BUILD_INTERNAL
 #include <QtVersit/private/qvcard21writer_p.h>
+#include <QtVersit/private/qversitencoding_p.h>
 #endif
 #include <QtVersit/qversitproperty.h>
 #include <QtVersit/qversitdocument.h>
@@ -392,6 +393,30 @@ void tst_QVCard21Writer::testQuotedPrintableEncode()
     inputOutput = QStringLiteral("~");
     QVERIFY(mWriter->quotedPrintableEncode(inputOutput));
     QCOMPARE(inputOutput, QStringLiteral("=7E"));
+
+    // Every character, at every position of a value long enough for the vectorized scan,
+    // is encoded the same way by both scans
+    for (int simd = 0; simd < 2; ++simd) {
+        VersitEncoding::setSimdEnabled(simd);
+        for (ushort c = 0; c < 0x120; ++c) {
+            const bool special = QVCard21Writer::shouldBeQuotedPrintableEncoded(QChar(c));
+            const QString escaped = special
+                    ? QString::fromLatin1("=%1").arg(c, 2, 16, QLatin1Char('0')).toUpper()
+                    : QString(QChar(c));
+            for (int position = 0; position < 19; position += 3) {
+                QString value(19, QLatin1Char('a'));
+                value[position] = QChar(c);
+                QString expected(value);
+                expected.replace(position, 1, escaped);
+                QCOMPARE(mWriter->quotedPrintableEncode(value), special);
+                QCOMPARE(value, expected);
+            }
+        }
+        QString unicode(QStringLiteral("\u0100\u2603 plain text \u00e9\u4e2d"));
+        QVERIFY(mWriter->quotedPrintableEncode(unicode));
+        QCOMPARE(unicode, QStringLiteral("\u0100\u2603 plain text =E9\u4e2d"));
+    }
+    VersitEncoding::setSimdEnabled(true);
 }
 #endif
 
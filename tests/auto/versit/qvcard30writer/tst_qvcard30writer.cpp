@@ -174,6 +174,21 @@ void tst_QVCard30Writer::testEncodeVersitProperty_data()
     property.setName(QStringLiteral("EMAIL"));
     property.setValue(QString::fromLatin1("john@%1.com").arg(KATAKANA_NOKIA));
     QTest::newRow("special chars") << property << expectedResult;
+
+    // Long non-ASCII values are folded after the same number of characters as ASCII ones
+    QString longValue = KATAKANA_NOKIA.repeated(30);
+    expectedResult = "NOTE:" + longValue.left(71).toUtf8() + "\r\n "
+            + longValue.mid(71).toUtf8() + "\r\n";
+    property = QVersitProperty();
+    property.setName(QStringLiteral("NOTE"));
+    property.setValue(longValue);
+    QTest::newRow("folded non-ASCII") << property << expectedResult;
+
+    // A surrogate pair isn't split by a fold
+    longValue = QString(70, QLatin1Char('a')) + QString::fromUcs4(U"\U0001F600") + QLatin1Char('b');
+    expectedResult = "NOTE:" + QByteArray(70, 'a') + "\r\n " + "\xf0\x9f\x98\x80" + "b\r\n";
+    property.setValue(longValue);
+    QTest::newRow("folded surrogate pair") << property << expectedResult;
 }
 
 void tst_QVCard30Writer::testEncodeParameters()
@@ -0,0 +1,6 @@
+include(../../auto.pri)
+
+QT += contacts versit
+
+HEADERS += tst_qversitcontactexportpipeline.h
+SOURCES += tst_qversitcontactexportpipeline.cpp
@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/versit
+
+#include "tst_qversitcontactexportpipeline.h"
+#include <QtVersit/qversitcontactexporter.h>
+#include <QtVersit/qversitcontactexportpipeline.h>
+#include <QtVersit/qversitwriter.h>
+#include <QtContacts/qcontactname.h>
+#include <QtContacts/qcontactphonenumber.h>
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+
+QTVERSIT_USE_NAMESPACE
+
+void tst_QVersitContactExportPipeline::init()
+{
+    QMap<QString, QString> parameters;
+    parameters.insert(QStringLiteral("id"), QStringLiteral("tst_QVersitContactExportPipeline"));
+    mManagerUri = QContactManager::buildUri(QStringLiteral("memory"), parameters);
+    // Keeps the memory engine's data alive while the pipeline's own manager comes and goes
+    mManager = QContactManager::fromUri(mManagerUri);
+    QVERIFY(mManager);
+}
+
+void tst_QVersitContactExportPipeline::cleanup()
+{
+    mManager->removeContacts(mManager->contactIds());
+    delete mManager;
+}
+
+void tst_QVersitContactExportPipeline::testExport()
+{
+    QList<QContact> contacts;
+    for (int i = 0; i < 250; i++) {
+        QContact contact;
+        QContactName name;
+        name.setFirstName(QString::number(i));
+        name.setLastName(QStringLiteral("Person"));
+        contact.saveDetail(&name);
+        QContactPhoneNumber phone;
+        phone.setNumber(QString::number(5550000 + i));
+        contact.saveDetail(&phone);
+        contacts.append(contact);
+    }
+    QVERIFY(mManager->saveContacts(&contacts));
+
+    // What a serial export of the same contacts produces
+    QVersitContactExporter exporter;
+    QVERIFY(exporter.exportContacts(mManager->contacts(mManager->contactIds())));
+    QByteArray expected;
+    QVersitWriter writer(&expected);
+    QVERIFY(writer.startWriting(exporter.documents(), QVersitDocument::VCard30Type));
+    QVERIFY(writer.waitForFinished());
+
+    QBuffer output;
+    output.open(QBuffer::WriteOnly);
+    QVersitContactExportPipeline pipeline;
+    QCOMPARE(pipeline.state(), QVersitContactExportPipeline::InactiveState);
+    QCOMPARE(pipeline.batchSize(), 100);
+    QCOMPARE(pipeline.versitType(), QVersitDocument::VCard30Type);
+    pipeline.setDevice(&output);
+    pipeline.setManagerUri(mManagerUri);
+    pipeline.setBatchSize(30);
+    pipeline.setMaxThreadCount(4);
+    QSignalSpy batchSpy(&pipeline, SIGNAL(batchFinished(int,QMap<int,QVersitContactExporter::Error>)));
+    QSignalSpy stateSpy(&pipeline, SIGNAL(stateChanged(QVersitContactExportPipeline::State)));
+
+    QVERIFY(pipeline.start());
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.state(), QVersitContactExportPipeline::FinishedState);
+    QCOMPARE(pipeline.error(), QVersitContactExportPipeline::NoError);
+    QCOMPARE(pipeline.writtenContactCount(), 250);
+    QCOMPARE(stateSpy.count(), 2);
+
+    // The batches are written in order
+    QCOMPARE(batchSpy.count(), 9);
+    for (int i = 0; i < batchSpy.count(); i++)
+        QCOMPARE(batchSpy.at(i).at(0).toInt(), i * 30);
+    QCOMPARE(output.data(), expected);
+}
+
+void tst_QVersitContactExportPipeline::testStartErrors()
+{
+    QVersitContactExportPipeline pipeline;
+    pipeline.setManagerUri(mManagerUri);
+
+    // No device
+    QVERIFY(!pipeline.start());
+    QCOMPARE(pipeline.error(), QVersitContactExportPipeline::IOError);
+    QCOMPARE(pipeline.state(), QVersitContactExportPipeline::InactiveState);
+
+    // Device not opened
+    QBuffer output;
+    pipeline.setDevice(&output);
+    QVERIFY(!pipeline.start());
+    QCOMPARE(pipeline.error(), QVersitContactExportPipeline::IOError);
+
+    // Nothing to export
+    output.open(QBuffer::WriteOnly);
+    QVERIFY(pipeline.start());
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.error(), QVersitContactExportPipeline::NoError);
+    QCOMPARE(pipeline.writtenContactCount(), 0);
+    QVERIFY(output.data().isEmpty());
+}
+
+QTEST_MAIN(tst_QVersitContactExportPipeline)
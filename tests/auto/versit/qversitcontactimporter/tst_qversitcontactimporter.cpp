@@ -1829,6 +1829,57 @@ void tst_QVersitContactImporter::testEmailWithContextOther()
     QVERIFY(contexts.contains(QContactDetail::ContextOther));
 }
 
+void tst_QVersitContactImporter::testParallelImport()
+{
+    QList<QVersitDocument> documents;
+    for (int i = 0; i < 100; i++) {
+        QVersitDocument document(QVersitDocument::VCard30Type);
+        if (i % 17 == 5) {
+            document.setType(QVersitDocument::InvalidType);
+        } else if (i % 23 == 7) {
+            documents.append(document); // empty
+            continue;
+        }
+        QVersitProperty property;
+        property.setName(QStringLiteral("FN"));
+        property.setValue(QStringLiteral("Contact %1").arg(i));
+        document.addProperty(property);
+        property.setName(QStringLiteral("TEL"));
+        property.setValue(QString::number(1000 + i));
+        property.insertParameter(QStringLiteral("TYPE"), QStringLiteral("HOME"));
+        document.addProperty(property);
+        documents.append(document);
+    }
+
+    QVersitContactImporter serialImporter;
+    QVERIFY(!serialImporter.importDocuments(documents));
+
+    QVersitContactImporter parallelImporter;
+    parallelImporter.setMaxThreadCount(4);
+    QCOMPARE(parallelImporter.maxThreadCount(), 4);
+    QVERIFY(!parallelImporter.importDocuments(documents));
+    QCOMPARE(parallelImporter.errorMap(), serialImporter.errorMap());
+    QCOMPARE(parallelImporter.contacts().size(), serialImporter.contacts().size());
+    for (int i = 0; i < serialImporter.contacts().size(); i++)
+        QCOMPARE(parallelImporter.contacts().at(i), serialImporter.contacts().at(i));
+    QCOMPARE(parallelImporter.contacts().first().detail<QContactDisplayLabel>().label(),
+             QStringLiteral("Contact 0"));
+
+    // A client handler which hasn't been declared thread-safe is still called for every
+    // property, in order
+    mImporter->setMaxThreadCount(4);
+    QVERIFY(!mImporter->handlersThreadSafe());
+    QVERIFY(!mImporter->importDocuments(documents));
+    QCOMPARE(mImporter->errorMap(), serialImporter.errorMap());
+    QCOMPARE(mImporter->contacts().size(), serialImporter.contacts().size());
+    QList<QVersitProperty> expectedProperties;
+    foreach (const QVersitDocument& document, documents) {
+        if (document.type() != QVersitDocument::InvalidType)
+            expectedProperties.append(document.properties());
+    }
+    QCOMPARE(mPropertyHandler->mPreProcessedProperties, expectedProperties);
+}
+
 QVersitDocument tst_QVersitContactImporter::createDocumentWithProperty(
     const QVersitProperty& property)
 {
@@ -94,6 +94,7 @@ private slots: // Tests
     void testPropertyHandler();
     void testInvalidDocument();
     void testEmailWithContextOther();
+    void testParallelImport();
 
 private: // Utilities
 
@@ -0,0 +1,6 @@
+include(../../auto.pri)
+
+QT += contacts versit
+
+HEADERS += tst_qversitcontactimportpipeline.h
+SOURCES += tst_qversitcontactimportpipeline.cpp
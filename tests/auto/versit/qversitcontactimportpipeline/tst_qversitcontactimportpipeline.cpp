@@ -0,0 +1,157 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/versit
+
+#include "tst_qversitcontactimportpipeline.h"
+#include <QtVersit/qversitcontactimportpipeline.h>
+#include <QtContacts/qcontactname.h>
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+
+QTVERSIT_USE_NAMESPACE
+
+static QByteArray vCards(int count)
+{
+    QByteArray input;
+    for (int i = 0; i < count; i++) {
+        input += "BEGIN:VCARD\r\nVERSION:3.0\r\nN:Person;" + QByteArray::number(i) + "\r\n"
+                 "FN:" + QByteArray::number(i) + " Person\r\nEND:VCARD\r\n";
+    }
+    return input;
+}
+
+void tst_QVersitContactImportPipeline::init()
+{
+    QMap<QString, QString> parameters;
+    parameters.insert(QStringLiteral("id"), QStringLiteral("tst_QVersitContactImportPipeline"));
+    mManagerUri = QContactManager::buildUri(QStringLiteral("memory"), parameters);
+    // Keeps the memory engine's data alive while the pipeline's own manager comes and goes
+    mManager = QContactManager::fromUri(mManagerUri);
+    QVERIFY(mManager);
+}
+
+void tst_QVersitContactImportPipeline::cleanup()
+{
+    mManager->removeContacts(mManager->contactIds());
+    delete mManager;
+}
+
+void tst_QVersitContactImportPipeline::testImport()
+{
+    QBuffer input;
+    input.setData(vCards(250));
+    input.open(QBuffer::ReadOnly);
+
+    QVersitContactImportPipeline pipeline;
+    QCOMPARE(pipeline.state(), QVersitContactImportPipeline::InactiveState);
+    QCOMPARE(pipeline.batchSize(), 100);
+    pipeline.setDevice(&input);
+    pipeline.setManagerUri(mManagerUri);
+    pipeline.setBatchSize(100);
+    QSignalSpy batchSpy(&pipeline, SIGNAL(batchFinished(int,QList<QContactId>,QMap<int,QVersitContactImporter::Error>,QMap<int,QContactManager::Error>)));
+    QSignalSpy stateSpy(&pipeline, SIGNAL(stateChanged(QVersitContactImportPipeline::State)));
+
+    QVERIFY(pipeline.start());
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.state(), QVersitContactImportPipeline::FinishedState);
+    QCOMPARE(pipeline.error(), QVersitContactImportPipeline::NoError);
+    QCOMPARE(pipeline.savedContactCount(), 250);
+    QCOMPARE(stateSpy.count(), 2);
+
+    QCOMPARE(batchSpy.count(), 3);
+    QList<QContactId> savedIds;
+    for (int i = 0; i < batchSpy.count(); i++) {
+        QCOMPARE(batchSpy.at(i).at(0).toInt(), i * 100);
+        savedIds += batchSpy.at(i).at(1).value<QList<QContactId> >();
+    }
+    QCOMPARE(savedIds.count(), 250);
+
+    QList<QContact> contacts = mManager->contacts(savedIds);
+    QCOMPARE(contacts.count(), 250);
+    // The batches are saved in input order
+    for (int i = 0; i < contacts.count(); i++)
+        QCOMPARE(contacts.at(i).detail<QContactName>().firstName(), QString::number(i));
+}
+
+void tst_QVersitContactImportPipeline::testImportErrors()
+{
+    QBuffer input;
+    input.setData("BEGIN:VCARD\r\nVERSION:3.0\r\nFN:First\r\nEND:VCARD\r\n"
+                  "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nEND:VCALENDAR\r\n"
+                  "BEGIN:VCARD\r\nVERSION:3.0\r\nFN:Second\r\nEND:VCARD\r\n");
+    input.open(QBuffer::ReadOnly);
+
+    QVersitContactImportPipeline pipeline;
+    pipeline.setDevice(&input);
+    pipeline.setManagerUri(mManagerUri);
+    pipeline.setBatchSize(2);
+    QSignalSpy batchSpy(&pipeline, SIGNAL(batchFinished(int,QList<QContactId>,QMap<int,QVersitContactImporter::Error>,QMap<int,QContactManager::Error>)));
+
+    QVERIFY(pipeline.start());
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.state(), QVersitContactImportPipeline::FinishedState);
+    QCOMPARE(pipeline.error(), QVersitContactImportPipeline::ImportError);
+    QCOMPARE(pipeline.savedContactCount(), 2);
+
+    QCOMPARE(batchSpy.count(), 2);
+    QMap<int, QVersitContactImporter::Error> importErrors =
+            batchSpy.at(0).at(2).value<QMap<int, QVersitContactImporter::Error> >();
+    QCOMPARE(importErrors.count(), 1);
+    QVERIFY(importErrors.contains(1));
+    QCOMPARE(batchSpy.at(0).at(1).value<QList<QContactId> >().count(), 1);
+    QCOMPARE(batchSpy.at(1).at(0).toInt(), 2);
+    QCOMPARE(batchSpy.at(1).at(1).value<QList<QContactId> >().count(), 1);
+}
+
+void tst_QVersitContactImportPipeline::testStartErrors()
+{
+    QVersitContactImportPipeline pipeline;
+    pipeline.setManagerUri(mManagerUri);
+
+    // No device
+    QVERIFY(!pipeline.start());
+    QCOMPARE(pipeline.error(), QVersitContactImportPipeline::IOError);
+    QCOMPARE(pipeline.state(), QVersitContactImportPipeline::InactiveState);
+
+    // Device not opened
+    QBuffer input;
+    input.setData(vCards(1));
+    pipeline.setDevice(&input);
+    QVERIFY(!pipeline.start());
+    QCOMPARE(pipeline.error(), QVersitContactImportPipeline::IOError);
+
+    input.open(QBuffer::ReadOnly);
+    QVERIFY(pipeline.start());
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.error(), QVersitContactImportPipeline::NoError);
+    QCOMPARE(pipeline.savedContactCount(), 1);
+}
+
+QTEST_MAIN(tst_QVersitContactImportPipeline)
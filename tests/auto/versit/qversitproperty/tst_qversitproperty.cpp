@@ -107,6 +107,46 @@ void tst_QVersitProperty::testParameters()
     QCOMPARE(mVersitProperty->parameters().count(), 0);
 }
 
+void tst_QVersitProperty::testParameterOrder()
+{
+    // Values of a parameter come back most recently inserted first, as from a QMultiHash
+    mVersitProperty->insertParameter(QStringLiteral("TYPE"), QStringLiteral("HOME"));
+    mVersitProperty->insertParameter(QStringLiteral("type"), QStringLiteral("VOICE"));
+    mVersitProperty->insertParameter(QStringLiteral("ENCODING"), QStringLiteral("B"));
+    QMultiHash<QString,QString> parameters = mVersitProperty->parameters();
+    QCOMPARE(parameters.values(QStringLiteral("TYPE")),
+             QStringList() << QStringLiteral("VOICE") << QStringLiteral("HOME"));
+    QCOMPARE(parameters.value(QStringLiteral("ENCODING")), QStringLiteral("B"));
+
+    // setParameters() keeps that order
+    QVersitProperty property;
+    property.setParameters(parameters);
+    QCOMPARE(property.parameters().values(QStringLiteral("TYPE")),
+             parameters.values(QStringLiteral("TYPE")));
+
+    // The order in which different parameters were inserted doesn't affect equality
+    QVersitProperty reordered;
+    reordered.insertParameter(QStringLiteral("ENCODING"), QStringLiteral("B"));
+    reordered.insertParameter(QStringLiteral("TYPE"), QStringLiteral("HOME"));
+    reordered.insertParameter(QStringLiteral("TYPE"), QStringLiteral("VOICE"));
+    QVERIFY(reordered == *mVersitProperty);
+    QCOMPARE(qHash(reordered), qHash(*mVersitProperty));
+    reordered.removeParameter(QStringLiteral("type"), QStringLiteral("HOME"));
+    QVERIFY(reordered != *mVersitProperty);
+
+    // Well-known names are shared rather than copied, and unknown ones still work
+    const QVersitPropertyPrivate* d = QVersitPropertyPrivate::get(*mVersitProperty);
+    mVersitProperty->setName(QStringLiteral("tel"));
+    QCOMPARE(mVersitProperty->name(), QStringLiteral("TEL"));
+    QCOMPARE(d->mNameAtom, QVersitAtoms::Tel);
+    mVersitProperty->setName(QStringLiteral("X-Unknown"));
+    QCOMPARE(mVersitProperty->name(), QStringLiteral("X-UNKNOWN"));
+    QCOMPARE(d->mNameAtom, QVersitAtoms::Unknown);
+    QCOMPARE(d->parameterValues(QStringLiteral("TYPE")),
+             QStringList() << QStringLiteral("VOICE") << QStringLiteral("HOME"));
+    QVERIFY(d->hasParameter(QStringLiteral("ENCODING"), QStringLiteral("B")));
+}
+
 void tst_QVersitProperty::testValue()
 {
     QString value(QStringLiteral("050484747"));
@@ -52,6 +52,7 @@ private slots: //test methods
     void testGroup();
     void testName();
     void testParameters();
+    void testParameterOrder();
     void testValue();
     void testEmbeddedDocument();
     void testEquality();
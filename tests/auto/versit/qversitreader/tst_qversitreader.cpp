@@ -30,6 +30,7 @@
 
 #include "tst_qversitreader.h"
 #include <QtVersit/qversitproperty.h>
+#include <QtVersit/private/qversitencoding_p.h>
 #include <QtVersit/private/qversitreader_p.h>
 #include <QtVersit/private/qversitutils_p.h>
 #include <QtTest/QtTest>
@@ -963,6 +964,31 @@ void tst_QVersitReader::testParseNextVersitProperty_data()
             << expectedProperty;
     }
 
+    // Base64 values whose length isn't a multiple of 4, with and without padding, some long
+    // enough for the vectorized decoder to handle the start of them
+    foreach (int length, QList<int>() << 1 << 2 << 4 << 5 << 13 << 14 << 25 << 26) {
+        QByteArray data;
+        for (int i = 0; i < length; ++i)
+            data.append(char(0xf0 + i));
+        QVersitProperty expectedProperty;
+        expectedProperty.setName(QStringLiteral("PHOTO"));
+        expectedProperty.setValue(data);
+        expectedProperty.setValueType(QVersitProperty::BinaryType);
+
+        const QByteArray padded(data.toBase64());
+        QByteArray unpadded(padded);
+        while (unpadded.endsWith('='))
+            unpadded.chop(1);
+        QTest::newRow((QByteArray("vcard21 base64 tail padded ") + QByteArray::number(length)).constData())
+            << QVersitDocument::VCard21Type
+            << QByteArray("PHOTO;ENCODING=BASE64:") + padded + QByteArray("\r\n\r\n")
+            << expectedProperty;
+        QTest::newRow((QByteArray("vcard30 base64 tail unpadded ") + QByteArray::number(length)).constData())
+            << QVersitDocument::VCard30Type
+            << QByteArray("PHOTO;ENCODING=B:") + unpadded + QByteArray("\r\n\r\n")
+            << expectedProperty;
+    }
+
     {
         QVersitProperty expectedProperty;
         expectedProperty.setGroups(QStringList() << QStringLiteral("HOME") << QStringLiteral("Springfield"));
@@ -1323,8 +1349,14 @@ void tst_QVersitReader::testDecodeQuotedPrintable()
     QFETCH(QByteArray, encoded);
 
     QFETCH(QByteArray, decoded);
-    mReaderPrivate->decodeQuotedPrintable(&encoded);
-    QCOMPARE(encoded, decoded);
+    // the vectorized and scalar scans must agree
+    for (int simd = 0; simd < 2; ++simd) {
+        VersitEncoding::setSimdEnabled(simd);
+        QByteArray value(encoded);
+        mReaderPrivate->decodeQuotedPrintable(&value);
+        QCOMPARE(value, decoded);
+    }
+    VersitEncoding::setSimdEnabled(true);
 #endif
 }
 
@@ -1374,6 +1406,34 @@ void tst_QVersitReader::testDecodeQuotedPrintable_data()
     QTest::newRow("White spaces")
             << QByteArray("=09=20")
             << QByteArray("\t ");
+
+    QTest::newRow("soft line break keeps the next byte")
+            << QByteArray("a=\r\nb=\r\n=41")
+            << QByteArray("abA");
+
+    QTest::newRow("consecutive soft line breaks")
+            << QByteArray("one=\r\n=\r\n=\r\ntwo")
+            << QByteArray("onetwo");
+
+    QTest::newRow("soft line break at the end")
+            << QByteArray("the end=\r\n")
+            << QByteArray("the end");
+
+    QTest::newRow("trailing equals")
+            << QByteArray("trailing=")
+            << QByteArray("trailing=");
+
+    QTest::newRow("trailing equals and one character")
+            << QByteArray("trailing=4")
+            << QByteArray("trailing=4");
+
+    QTest::newRow("escapes after a long unescaped run")
+            << QByteArray("0123456789abcdefghijklmnopqrstuvwxyz=3D=\r\n0123456789abcdef=41")
+            << QByteArray("0123456789abcdefghijklmnopqrstuvwxyz=0123456789abcdefA");
+
+    QTest::newRow("soft line break across a 16-byte block")
+            << QByteArray("0123456789abcd=\r\nefghijklmnopqrstuvwxyz")
+            << QByteArray("0123456789abcdefghijklmnopqrstuvwxyz");
 #endif
 }
 void tst_QVersitReader::testParamName()
@@ -1974,6 +2034,11 @@ void tst_QVersitReader::testReadLine_data()
                 << "one:\r\n\r\ntwo:\r\n"
                 << (QList<QString>() << QStringLiteral("one:") << QStringLiteral("two:"));
 
+        QTest::newRow("equals before a blank line " + codecName)
+                << codecName
+                << "qp:soft=\r\nbreak=\r\n\r\nnext:line\r\n"
+                << (QList<QString>() << QStringLiteral("qp:soft=") << QStringLiteral("break") << QStringLiteral("next:line"));
+
         QTest::newRow("folded lines " + codecName)
                 << codecName
                 << "fold:ed\r\n  line\r\nsecond: line\r\n"
@@ -1989,6 +2054,19 @@ void tst_QVersitReader::testReadLine_data()
                 << "8letter:\r\n  on one line\r\n"
                 << (QList<QString>() << QStringLiteral("8letter: on one line"));
 
+        QString manyFolds(QStringLiteral("photo:"));
+        QString unfolded(manyFolds);
+        for (int i = 0; i < 50; i++) {
+            manyFolds += QStringLiteral("abcdefg\r\n ");
+            unfolded += QStringLiteral("abcdefg");
+        }
+        manyFolds += QStringLiteral("end\r\nnext:line\r\n");
+        unfolded += QStringLiteral("end");
+        QTest::newRow("line folded many times " + codecName)
+                << codecName
+                << manyFolds
+                << (QList<QString>() << unfolded << QStringLiteral("next:line"));
+
         QTest::newRow("three mac lines " + codecName)
                 << codecName
                 << "one:\rtwo:\rthree:\r"
@@ -2003,6 +2081,42 @@ void tst_QVersitReader::testReadLine_data()
 #endif
 }
 
+void tst_QVersitReader::testReadLineMapped()
+{
+#ifndef QT_BUILD_INTERNAL
+    QSKIP("Testing private API");
+#else
+    QFETCH(QByteArray, codecName);
+    QFETCH(QString, data);
+    QFETCH(QList<QString>, expectedLines);
+
+    QTextCodec* codec = QTextCodec::codecForName(codecName);
+    const QByteArray bytes(data.toUtf8());
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(bytes), qint64(bytes.size()));
+    QVERIFY(file.seek(0));
+
+    LineReader lineReader(&file, codec);
+    if (codecName != "UTF-8") {
+        // Only byte based codecs can be mapped; the others fall back to reading the file
+        QVERIFY(!lineReader.isMemoryMapped());
+        return;
+    }
+    QCOMPARE(lineReader.isMemoryMapped(), !bytes.isEmpty());
+
+    foreach (const QString& expectedLine, expectedLines) {
+        QVERIFY(!lineReader.atEnd());
+        LByteArray line = lineReader.readLine();
+        QCOMPARE(line.toByteArray(), expectedLine.toUtf8());
+    }
+
+    LByteArray line = lineReader.readLine();
+    QVERIFY(line.isEmpty());
+    QVERIFY(lineReader.atEnd());
+#endif
+}
+
 void tst_QVersitReader::testByteArrayInput()
 {
     delete mReader;
@@ -2025,6 +2139,123 @@ void tst_QVersitReader::testByteArrayInput()
     QCOMPARE(properties.first().value(), QStringLiteral("John"));
 }
 
+void tst_QVersitReader::testFileInput()
+{
+    QByteArray input;
+    for (int i = 0; i < 20; i++) {
+        input += "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:Person " + QByteArray::number(i) + "\r\n"
+                 "NOTE;ENCODING=QUOTED-PRINTABLE:first=\r\nsecond\r\n"
+                 "ORG:folded\r\n  line\r\n"
+                 "PHOTO;ENCODING=BASE64:" + SAMPLE_GIF_BASE64 + "\r\n\r\n"
+                 "EMAIL;ENCODING=QUOTED-PRINTABLE:john.citizen=40exam=\r\nple.com=\r\n\r\n"
+                 "END:VCARD\r\n\r\n";
+    }
+
+    QVersitReader byteArrayReader(input);
+    QVERIFY(byteArrayReader.startReading());
+    QVERIFY(byteArrayReader.waitForFinished());
+    QCOMPARE(byteArrayReader.error(), QVersitReader::NoError);
+    QList<QVersitDocument> expected = byteArrayReader.results();
+    QCOMPARE(expected.count(), 20);
+    QVersitProperty email = expected.first().properties().last();
+    QCOMPARE(email.name(), QStringLiteral("EMAIL"));
+    QCOMPARE(email.value(), QStringLiteral("john.citizen@example.com"));
+
+    // A file is read through a memory mapping, which must give the same documents
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(input), qint64(input.size()));
+    QVERIFY(file.seek(0));
+    QVersitReader fileReader(&file);
+    QVERIFY(fileReader.startReading());
+    QVERIFY(fileReader.waitForFinished());
+    QCOMPARE(fileReader.error(), QVersitReader::NoError);
+    QCOMPARE(fileReader.results(), expected);
+}
+
+void tst_QVersitReader::testParallelReading()
+{
+    QByteArray input;
+    for (int i = 0; i < 50; i++) {
+        input += "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:Person " + QByteArray::number(i) + "\r\n"
+                 "NOTE;ENCODING=QUOTED-PRINTABLE:first=\r\nEND:second\r\n"
+                 "AGENT:BEGIN:VCARD\r\nFN:Agent\r\nEND:VCARD\r\n"
+                 "END:VCARD\r\n\r\n";
+        input += "BEGIN:VCALENDAR\r\nVERSION:2.0\r\n"
+                 "BEGIN:VEVENT\r\nSUMMARY:Event " + QByteArray::number(i) + "\r\nEND:VEVENT\r\n"
+                 "END:VCALENDAR\r\n";
+    }
+
+    QVersitReader sequentialReader(input);
+    QCOMPARE(sequentialReader.maxThreadCount(), 1);
+    QVERIFY(sequentialReader.startReading());
+    QVERIFY(sequentialReader.waitForFinished());
+    QCOMPARE(sequentialReader.error(), QVersitReader::NoError);
+    QList<QVersitDocument> expected = sequentialReader.results();
+    QCOMPARE(expected.count(), 100);
+
+    QVersitReader parallelReader(input);
+    parallelReader.setMaxThreadCount(4);
+    QCOMPARE(parallelReader.maxThreadCount(), 4);
+    QVERIFY(parallelReader.startReading());
+    QVERIFY(parallelReader.waitForFinished());
+    QCOMPARE(parallelReader.state(), QVersitReader::FinishedState);
+    QCOMPARE(parallelReader.error(), QVersitReader::NoError);
+    QCOMPARE(parallelReader.results(), expected);
+
+    // A line outside of any document fails to parse without losing the documents around it
+    QVersitReader malformedReader(QByteArray(
+            "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:John\r\nEND:VCARD\r\n"
+            "FN:Stray\r\n"
+            "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:James\r\nEND:VCARD\r\n"));
+    malformedReader.setMaxThreadCount(2);
+    QVERIFY(malformedReader.startReading());
+    QVERIFY(malformedReader.waitForFinished());
+    QCOMPARE(malformedReader.error(), QVersitReader::ParseError);
+    QCOMPARE(malformedReader.results().count(), 2);
+}
+
+void tst_QVersitReader::testTakeResults()
+{
+    QByteArray input;
+    for (int i = 0; i < 20; i++)
+        input += "BEGIN:VCARD\r\nVERSION:2.1\r\nFN:Person " + QByteArray::number(i) + "\r\nEND:VCARD\r\n";
+
+    QVersitReader reader(input);
+    QCOMPARE(reader.maxBufferedResults(), 0);
+    reader.setMaxBufferedResults(3);
+    QCOMPARE(reader.maxBufferedResults(), 3);
+    QVERIFY(reader.startReading());
+
+    // The reader waits for documents to be taken, so it can only finish if we keep up with it
+    QList<QVersitDocument> taken;
+    QElapsedTimer timer;
+    timer.start();
+    while (reader.state() == QVersitReader::ActiveState && timer.elapsed() < 10000) {
+        QList<QVersitDocument> results = reader.takeResults();
+        QVERIFY(results.count() <= 3);
+        taken += results;
+        QThread::yieldCurrentThread();
+    }
+    QVERIFY(reader.waitForFinished());
+    taken += reader.takeResults();
+    QCOMPARE(reader.error(), QVersitReader::NoError);
+    QVERIFY(reader.results().isEmpty());
+    QCOMPARE(taken.count(), 20);
+    for (int i = 0; i < taken.count(); i++) {
+        QCOMPARE(taken.at(i).properties().first().value(),
+                 QStringLiteral("Person ") + QString::number(i));
+    }
+
+    // Cancelling releases a reader that is waiting for its results to be taken
+    reader.setMaxBufferedResults(1);
+    QVERIFY(reader.startReading());
+    QTRY_VERIFY(!reader.results().isEmpty());
+    reader.cancel();
+    QVERIFY(reader.waitForFinished());
+    QCOMPARE(reader.state(), QVersitReader::CanceledState);
+}
+
 void tst_QVersitReader::testRemoveBackSlashEscaping()
 {
 #ifndef QT_BUILD_INTERNAL
@@ -92,7 +92,12 @@ private slots: // Tests
     void testExtractParams();
     void testReadLine();
     void testReadLine_data();
+    void testReadLineMapped();
+    void testReadLineMapped_data() { testReadLine_data(); }
     void testByteArrayInput();
+    void testFileInput();
+    void testParallelReading();
+    void testTakeResults();
     void testRemoveBackSlashEscaping();
 
 private: // Data
@@ -4,7 +4,9 @@ SUBDIRS += \
     qvcard21writer \
     qvcard30writer \
     qversitcontactexporter \
+    qversitcontactexportpipeline \
     qversitcontactimporter \
+    qversitcontactimportpipeline \
     qversitcontactplugins \
     qversitdocument \
     qversitproperty \
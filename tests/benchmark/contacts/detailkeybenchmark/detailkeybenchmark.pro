@@ -0,0 +1,5 @@
+TEMPLATE = app
+CONFIG += testcase release
+TARGET = tst_detailkeybenchmark
+QT += contacts testlib
+SOURCES  += tst_detailkeybenchmark.cpp
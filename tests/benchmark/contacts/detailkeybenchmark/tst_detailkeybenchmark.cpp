@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtContacts/QContact>
+#include <QtContacts/qcontactdetails.h>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtDebug>
+
+//TESTED_COMPONENT=src/contacts
+
+QTCONTACTS_USE_NAMESPACE
+
+namespace {
+    const int detailsPerThread = 200000;
+
+    // The key allocation every detail used to do: one increment of a process-wide counter
+    QAtomicInt sharedKey(1);
+
+    void createDetails()
+    {
+        for (int i = 0; i < detailsPerThread; ++i) {
+            QContactPhoneNumber number;
+            number.resetKey();
+        }
+    }
+
+    void incrementSharedKey()
+    {
+        for (int i = 0; i < detailsPerThread; ++i) {
+            sharedKey.fetchAndAddOrdered(1);
+            sharedKey.fetchAndAddOrdered(1);
+        }
+    }
+
+    // Runs work on threadCount threads at once, and returns the elapsed nanoseconds
+    qint64 runThreads(int threadCount, void (*work)())
+    {
+        QList<QThread *> threads;
+        for (int i = 0; i < threadCount; ++i)
+            threads.append(QThread::create(work));
+
+        QElapsedTimer timer;
+        timer.start();
+        foreach (QThread *thread, threads)
+            thread->start();
+        foreach (QThread *thread, threads)
+            thread->wait();
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        qDeleteAll(threads);
+        return elapsed;
+    }
+}
+
+//---------------------------------------------
+
+class tst_detailkeybenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_detailkeybenchmark() {}
+    ~tst_detailkeybenchmark() {}
+
+private slots:
+    void keys_data() {
+        QTest::addColumn<int>("threadCount");
+        QTest::addColumn<bool>("sharedCounter");
+
+        // "shared counter" rows only do the two key increments per detail of the old
+        // allocation scheme, to show how much of the construction cost contention was
+        const int threadCounts[] = { 1, 2, 4, 8 };
+        for (int threadCount : threadCounts) {
+            QTest::newRow(qPrintable(QStringLiteral("details, %1 threads").arg(threadCount))) << threadCount << false;
+            QTest::newRow(qPrintable(QStringLiteral("shared counter, %1 threads").arg(threadCount))) << threadCount << true;
+        }
+    }
+
+    void keys() {
+        QFETCH(int, threadCount);
+        QFETCH(bool, sharedCounter);
+
+        const qint64 elapsed = runThreads(threadCount, sharedCounter ? incrementSharedKey : createDetails);
+        double result = static_cast<double>(elapsed) / (static_cast<double>(threadCount) * detailsPerThread); // nsec per detail and thread
+        qDebug() << threadCount << "threads took" << elapsed << "nanoseconds (" << result << "nsec per detail per thread )";
+        QTest::setBenchmarkResult(result, QTest::WalltimeNanoseconds);
+    }
+};
+
+QTEST_MAIN(tst_detailkeybenchmark)
+#include "tst_detailkeybenchmark.moc"
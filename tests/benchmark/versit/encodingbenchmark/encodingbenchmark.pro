@@ -0,0 +1,6 @@
+TEMPLATE = app
+CONFIG += testcase release
+TARGET = tst_encodingbenchmark
+QT += versit versit-private testlib
+SOURCES  += tst_encodingbenchmark.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
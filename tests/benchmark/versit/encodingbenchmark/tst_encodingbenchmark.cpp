@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtVersit/private/qversitencoding_p.h>
+
+#include <QRandomGenerator>
+
+//TESTED_COMPONENT=src/versit
+
+QTVERSIT_USE_NAMESPACE
+
+namespace {
+    const int dataSize = 1024 * 1024;
+
+    QByteArray generateBinaryData()
+    {
+        QByteArray retn(dataSize, Qt::Uninitialized);
+        QRandomGenerator generator(55555); // seed with constant so we get identical runs.
+        for (int i = 0; i < retn.size(); ++i)
+            retn[i] = static_cast<char>(generator.generate() & 0xff);
+        return retn;
+    }
+
+    QByteArray generateQuotedPrintableData()
+    {
+        // Mostly plain text with an occasional escaped byte and soft line break, like a
+        // typical QUOTED-PRINTABLE NOTE value.
+        QByteArray retn;
+        retn.reserve(dataSize);
+        static const QByteArray chunk("Meeting notes from the weekly sync =C3=A9t=C3=A9 and =3D=\r\n");
+        while (retn.size() < dataSize)
+            retn.append(chunk);
+        return retn;
+    }
+
+    QString generatePlainText()
+    {
+        // A NOTE value with an occasional character which has to be escaped
+        QString retn;
+        retn.reserve(dataSize);
+        static const QString chunk(QStringLiteral("Meeting notes from the weekly sync, =3 items\n"));
+        while (retn.size() < dataSize)
+            retn.append(chunk);
+        return retn;
+    }
+}
+
+class tst_encodingbenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_encodingbenchmark() {}
+    ~tst_encodingbenchmark() {}
+
+public slots:
+    void init() {}
+    void cleanup() { VersitEncoding::setSimdEnabled(true); }
+
+private slots:
+    void initTestCase()
+    {
+        mBinary = generateBinaryData();
+        mBase64 = mBinary.toBase64();
+        mQuotedPrintable = generateQuotedPrintableData();
+        mPlainText = generatePlainText();
+        // The SIMD and scalar paths must agree with QByteArray before timing them.
+        QCOMPARE(VersitEncoding::toBase64(mBinary), mBase64);
+        QCOMPARE(VersitEncoding::fromBase64(mBase64), mBinary);
+        VersitEncoding::setSimdEnabled(false);
+        QCOMPARE(VersitEncoding::toBase64(mBinary), mBase64);
+        QCOMPARE(VersitEncoding::fromBase64(mBase64), mBinary);
+        QByteArray scalarDecoded(mQuotedPrintable);
+        VersitEncoding::decodeQuotedPrintable(&scalarDecoded);
+        QString scalarEncoded(mPlainText);
+        VersitEncoding::encodeQuotedPrintable(&scalarEncoded);
+        VersitEncoding::setSimdEnabled(true);
+        QByteArray simdDecoded(mQuotedPrintable);
+        VersitEncoding::decodeQuotedPrintable(&simdDecoded);
+        QCOMPARE(simdDecoded, scalarDecoded);
+        QString simdEncoded(mPlainText);
+        VersitEncoding::encodeQuotedPrintable(&simdEncoded);
+        QCOMPARE(simdEncoded, scalarEncoded);
+    }
+
+    void toBase64_data() { addSimdRows(); }
+    void toBase64()
+    {
+        QFETCH(bool, simd);
+        VersitEncoding::setSimdEnabled(simd);
+        QByteArray result;
+        QBENCHMARK {
+            result = VersitEncoding::toBase64(mBinary);
+        }
+        QCOMPARE(result.size(), mBase64.size());
+    }
+
+    void toBase64QByteArray()
+    {
+        QByteArray result;
+        QBENCHMARK {
+            result = mBinary.toBase64();
+        }
+        QCOMPARE(result.size(), mBase64.size());
+    }
+
+    void fromBase64_data() { addSimdRows(); }
+    void fromBase64()
+    {
+        QFETCH(bool, simd);
+        VersitEncoding::setSimdEnabled(simd);
+        QByteArray result;
+        QBENCHMARK {
+            result = VersitEncoding::fromBase64(mBase64);
+        }
+        QCOMPARE(result.size(), mBinary.size());
+    }
+
+    void fromBase64QByteArray()
+    {
+        QByteArray result;
+        QBENCHMARK {
+            result = QByteArray::fromBase64(mBase64);
+        }
+        QCOMPARE(result.size(), mBinary.size());
+    }
+
+    void decodeQuotedPrintable_data() { addSimdRows(); }
+    void decodeQuotedPrintable()
+    {
+        QFETCH(bool, simd);
+        VersitEncoding::setSimdEnabled(simd);
+        QByteArray result;
+        QBENCHMARK {
+            result = mQuotedPrintable;
+            VersitEncoding::decodeQuotedPrintable(&result);
+        }
+        QVERIFY(result.size() < mQuotedPrintable.size());
+    }
+
+    void encodeQuotedPrintable_data() { addSimdRows(); }
+    void encodeQuotedPrintable()
+    {
+        QFETCH(bool, simd);
+        VersitEncoding::setSimdEnabled(simd);
+        QString result;
+        QBENCHMARK {
+            result = mPlainText;
+            VersitEncoding::encodeQuotedPrintable(&result);
+        }
+        QVERIFY(result.size() > mPlainText.size());
+    }
+
+private:
+    void addSimdRows()
+    {
+        QTest::addColumn<bool>("simd");
+        QTest::newRow("scalar") << false;
+        QTest::newRow("simd") << true;
+    }
+
+    QByteArray mBinary;
+    QByteArray mBase64;
+    QByteArray mQuotedPrintable;
+    QString mPlainText;
+};
+
+QTEST_MAIN(tst_encodingbenchmark)
+#include "tst_encodingbenchmark.moc"